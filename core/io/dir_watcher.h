@@ -0,0 +1,62 @@
+/*************************************************************************/
+/*  dir_watcher.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef DIR_WATCHER_H
+#define DIR_WATCHER_H
+
+#include "core/error/error_list.h"
+#include "core/string/ustring.h"
+#include "core/templates/set.h"
+
+// Tells which directories had entries created, removed, modified or moved, without
+// listing them again. Subdirectories are not included, each one is watched on its own.
+// Paths can be absolute or start with res:// or user://, changes are reported with
+// the same path the directory was added with.
+// Only available where the platform provides it, `create()` returns nullptr otherwise.
+
+class DirWatcher {
+protected:
+	static DirWatcher *(*_create)();
+
+public:
+	static DirWatcher *create();
+
+	virtual Error add_dir(const String &p_path) = 0;
+	// False once the directory was removed (or moved), even if it's back.
+	virtual bool is_watching(const String &p_path) const = 0;
+
+	// Adds the directories that changed since the last call to `r_changed`.
+	// Returns false if changes were lost, then all directories must be considered changed.
+	virtual bool get_changes(Set<String> &r_changed) = 0;
+
+	virtual ~DirWatcher() {}
+};
+
+#endif // DIR_WATCHER_H
@@ -0,0 +1,302 @@
+/*************************************************************************/
+/*  file_access_async.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "file_access_async.h"
+
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+
+FileAccessAsync *FileAccessAsync::singleton = nullptr;
+FileAccessAsync *(*FileAccessAsync::_create)() = nullptr;
+
+FileAccessAsync *FileAccessAsync::get_singleton() {
+	return singleton;
+}
+
+FileAccessAsync *FileAccessAsync::create() {
+	ERR_FAIL_COND_V_MSG(singleton, nullptr, "FileAccessAsync singleton already exist.");
+	if (_create) {
+		return _create();
+	}
+	return memnew(FileAccessAsync);
+}
+
+Error FileAccessAsync::_read_with_file_access(Request *p_request) {
+	Error err;
+	FileAccessRef f = FileAccess::open(p_request->path, FileAccess::READ, &err);
+	if (!f) {
+		return err != OK ? err : ERR_FILE_CANT_OPEN;
+	}
+
+	uint64_t file_length = f->get_length();
+	uint64_t offset = MIN(p_request->offset, file_length);
+	uint64_t length = file_length - offset;
+	if (p_request->length >= 0) {
+		length = MIN(length, (uint64_t)p_request->length);
+	}
+	f->seek(offset);
+
+	p_request->data.resize(length);
+	if (length > 0) {
+		uint64_t read = f->get_buffer(p_request->data.ptrw(), length);
+		if (read < length) {
+			p_request->data.resize(read);
+		}
+	}
+	return f->get_error() == ERR_FILE_EOF ? OK : f->get_error();
+}
+
+void FileAccessAsync::_worker_function(void *p_userdata) {
+	FileAccessAsync *faa = (FileAccessAsync *)p_userdata;
+
+	while (true) {
+		faa->queue_sem.wait();
+
+		faa->mutex.lock();
+		if (faa->exit_workers) {
+			faa->mutex.unlock();
+			break;
+		}
+		Request *request = faa->queue.front()->get();
+		faa->queue.pop_front();
+		faa->mutex.unlock();
+
+		faa->_complete(request, _read_with_file_access(request));
+	}
+}
+
+void FileAccessAsync::_queue_in_pool(Request *p_request) {
+	MutexLock lock(mutex);
+
+	if (workers.is_empty()) {
+		// Reads spend most of their time blocked on the disk, a few threads are enough
+		// to keep it busy without competing with the ones doing actual work.
+		int count = CLAMP(OS::get_singleton()->get_processor_count(), 2, 4);
+		for (int i = 0; i < count; i++) {
+			Thread *thread = memnew(Thread);
+			thread->start(_worker_function, this);
+			workers.push_back(thread);
+		}
+	}
+
+	queue.push_back(p_request);
+	queue_sem.post();
+}
+
+void FileAccessAsync::_submit(Request *p_request) {
+	_queue_in_pool(p_request);
+}
+
+void FileAccessAsync::_complete(Request *p_request, Error p_error) {
+	mutex.lock();
+
+	p_request->error = p_error;
+	p_request->status = p_error == OK ? REQUEST_STATUS_DONE : REQUEST_STATUS_ERROR;
+	for (int i = 0; i < p_request->waiters; i++) {
+		p_request->done.post();
+	}
+
+	RequestID id = p_request->id;
+	CompletionCallback callback = p_request->callback;
+	void *userdata = p_request->userdata;
+
+	if (p_request->discard) {
+		requests.erase(id);
+		if (p_request->waiters == 0) {
+			memdelete(p_request);
+		}
+	}
+
+	mutex.unlock();
+
+	if (callback) {
+		callback(userdata, id, p_error);
+	}
+}
+
+FileAccessAsync::RequestID FileAccessAsync::_queue_request(const String &p_path, uint64_t p_offset, int64_t p_length, CompletionCallback p_callback, void *p_userdata, bool p_discard) {
+	Request *request = memnew(Request);
+	request->path = p_path;
+	request->offset = p_offset;
+	request->length = p_length;
+	request->callback = p_callback;
+	request->userdata = p_userdata;
+	request->discard = p_discard;
+
+	mutex.lock();
+	request->id = ++last_id;
+	requests[request->id] = request;
+	mutex.unlock();
+
+	RequestID id = request->id; // The request may be gone once submitted.
+	_submit(request);
+	return id;
+}
+
+FileAccessAsync::RequestID FileAccessAsync::read_request(const String &p_path, uint64_t p_offset, int64_t p_length, CompletionCallback p_callback, void *p_userdata) {
+	ERR_FAIL_COND_V(p_path.is_empty(), INVALID_REQUEST_ID);
+	return _queue_request(p_path, p_offset, p_length, p_callback, p_userdata, false);
+}
+
+void FileAccessAsync::prefetch(const String &p_path) {
+	ERR_FAIL_COND(p_path.is_empty());
+	if (!can_prefetch()) {
+		// Reading the file here would only read it twice.
+		return;
+	}
+	_queue_request(p_path, 0, PREFETCH_MAX_SIZE, nullptr, nullptr, true);
+}
+
+FileAccessAsync::RequestStatus FileAccessAsync::get_request_status(RequestID p_id) const {
+	MutexLock lock(mutex);
+	Request *const *request = requests.getptr(p_id);
+	if (!request || (*request)->discard) {
+		return REQUEST_STATUS_NONE;
+	}
+	return (*request)->status;
+}
+
+Error FileAccessAsync::wait(RequestID p_id) {
+	mutex.lock();
+	Request **requestp = requests.getptr(p_id);
+	if (!requestp || (*requestp)->discard) {
+		mutex.unlock();
+		ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Invalid async file request ID: " + itos(p_id) + ".");
+	}
+	Request *request = *requestp;
+
+	if (request->status == REQUEST_STATUS_PENDING) {
+		request->waiters++;
+		mutex.unlock();
+		request->done.wait();
+		mutex.lock();
+		request->waiters--;
+	}
+
+	Error err = request->error;
+	if (request->discard && request->waiters == 0) {
+		// Erased while waiting, the last waiter frees it.
+		memdelete(request);
+	}
+	mutex.unlock();
+
+	return err;
+}
+
+Error FileAccessAsync::get_request_error(RequestID p_id) const {
+	MutexLock lock(mutex);
+	Request *const *request = requests.getptr(p_id);
+	ERR_FAIL_COND_V_MSG(!request, ERR_INVALID_PARAMETER, "Invalid async file request ID: " + itos(p_id) + ".");
+	return (*request)->error;
+}
+
+Vector<uint8_t> FileAccessAsync::get_request_data(RequestID p_id) const {
+	MutexLock lock(mutex);
+	Request *const *request = requests.getptr(p_id);
+	ERR_FAIL_COND_V_MSG(!request, Vector<uint8_t>(), "Invalid async file request ID: " + itos(p_id) + ".");
+	ERR_FAIL_COND_V_MSG((*request)->status == REQUEST_STATUS_PENDING, Vector<uint8_t>(), "Async file request " + itos(p_id) + " is still pending.");
+	return (*request)->data;
+}
+
+void FileAccessAsync::erase_request(RequestID p_id) {
+	MutexLock lock(mutex);
+	Request **requestp = requests.getptr(p_id);
+	if (!requestp) {
+		return;
+	}
+	Request *request = *requestp;
+
+	if (request->status == REQUEST_STATUS_PENDING) {
+		// Still owned by the backend, it will be freed on completion.
+		request->discard = true;
+		return;
+	}
+
+	requests.erase(p_id);
+	request->discard = true;
+	if (request->waiters == 0) {
+		memdelete(request);
+	}
+}
+
+FileAccessAsync::FileAccessAsync() {
+	singleton = this;
+}
+
+FileAccessAsync::~FileAccessAsync() {
+	mutex.lock();
+	exit_workers = true;
+	mutex.unlock();
+
+	// Workers finish the read they are doing before exiting.
+	for (int i = 0; i < workers.size(); i++) {
+		queue_sem.post();
+	}
+	for (int i = 0; i < workers.size(); i++) {
+		workers[i]->wait_to_finish();
+		memdelete(workers[i]);
+	}
+	workers.clear();
+
+	// Anything left in the queue was never started, cancel it so waiters and callbacks see it end.
+	mutex.lock();
+	List<Request *> cancelled = queue;
+	queue.clear();
+	mutex.unlock();
+	for (List<Request *>::Element *E = cancelled.front(); E; E = E->next()) {
+		_complete(E->get(), ERR_UNAVAILABLE);
+	}
+
+	// Requests can only be freed once the threads woken up in `wait()` are done with them.
+	while (true) {
+		mutex.lock();
+		bool waiting = false;
+		const RequestID *k = nullptr;
+		while ((k = requests.next(k))) {
+			if (requests[*k]->waiters > 0) {
+				waiting = true;
+				break;
+			}
+		}
+		mutex.unlock();
+		if (!waiting) {
+			break;
+		}
+		OS::get_singleton()->delay_usec(1000);
+	}
+
+	const RequestID *k = nullptr;
+	while ((k = requests.next(k))) {
+		memdelete(requests[*k]);
+	}
+	requests.clear();
+
+	singleton = nullptr;
+}
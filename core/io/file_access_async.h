@@ -0,0 +1,134 @@
+/*************************************************************************/
+/*  file_access_async.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FILE_ACCESS_ASYNC_H
+#define FILE_ACCESS_ASYNC_H
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/string/ustring.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/list.h"
+#include "core/templates/vector.h"
+
+// Asynchronous file reads. Requests are queued and completed in the background;
+// their status can be polled, waited on, or observed through a completion callback
+// (called from an I/O thread, so it must be thread-safe and must not block).
+// The default implementation reads through FileAccess on a small pool of worker
+// threads, so it works for every path (including files inside packs); platforms
+// can provide a native implementation through `_create`.
+// When destroyed, reads that have started are finished, and queued ones are cancelled
+// with ERR_UNAVAILABLE.
+
+class FileAccessAsync {
+public:
+	enum RequestStatus {
+		REQUEST_STATUS_NONE,
+		REQUEST_STATUS_PENDING,
+		REQUEST_STATUS_DONE,
+		REQUEST_STATUS_ERROR,
+	};
+
+	enum {
+		INVALID_REQUEST_ID = -1,
+		PREFETCH_MAX_SIZE = 64 * 1024 * 1024,
+	};
+
+	typedef int64_t RequestID;
+	typedef void (*CompletionCallback)(void *p_userdata, RequestID p_id, Error p_error);
+
+protected:
+	struct Request {
+		RequestID id = INVALID_REQUEST_ID;
+		String path;
+		uint64_t offset = 0;
+		int64_t length = -1; // Until the end of the file.
+		Vector<uint8_t> data;
+		Error error = OK;
+		RequestStatus status = REQUEST_STATUS_PENDING;
+		CompletionCallback callback = nullptr;
+		void *userdata = nullptr;
+		bool discard = false; // Prefetch, erased as soon as it completes.
+		int waiters = 0;
+		Semaphore done;
+	};
+
+	static FileAccessAsync *singleton;
+	static FileAccessAsync *(*_create)();
+
+	mutable Mutex mutex;
+	HashMap<RequestID, Request *> requests;
+	RequestID last_id = 0;
+
+	// Worker pool, started on first use.
+	List<Request *> queue;
+	Semaphore queue_sem;
+	Vector<Thread *> workers;
+	bool exit_workers = false;
+
+	static void _worker_function(void *p_userdata);
+	static Error _read_with_file_access(Request *p_request);
+
+	RequestID _queue_request(const String &p_path, uint64_t p_offset, int64_t p_length, CompletionCallback p_callback, void *p_userdata, bool p_discard);
+	void _queue_in_pool(Request *p_request);
+
+	// Called once a request has been filled (or failed), from any thread.
+	void _complete(Request *p_request, Error p_error);
+
+	// Implementations may override this to use a native API. It is called without the
+	// lock held and must eventually call `_complete()`, or hand the request to the pool.
+	virtual void _submit(Request *p_request);
+
+public:
+	static FileAccessAsync *get_singleton();
+	static FileAccessAsync *create();
+
+	// Reads `p_length` bytes (or up to the end of the file if negative) starting at `p_offset`.
+	RequestID read_request(const String &p_path, uint64_t p_offset = 0, int64_t p_length = -1, CompletionCallback p_callback = nullptr, void *p_userdata = nullptr);
+	// Hints the OS to start caching a whole file in the background, when the
+	// implementation can do it without reading the data itself. Does nothing otherwise.
+	// The data isn't kept, whoever needs it still reads the file.
+	void prefetch(const String &p_path);
+	virtual bool can_prefetch() const { return false; }
+
+	RequestStatus get_request_status(RequestID p_id) const;
+	Error wait(RequestID p_id);
+	Error get_request_error(RequestID p_id) const;
+	Vector<uint8_t> get_request_data(RequestID p_id) const;
+	void erase_request(RequestID p_id);
+
+	virtual String get_backend_name() const { return "threads"; }
+
+	FileAccessAsync();
+	virtual ~FileAccessAsync();
+};
+
+#endif // FILE_ACCESS_ASYNC_H
@@ -1979,6 +1979,10 @@ Vector<uint8_t> Image::get_data() const {
 	return data;
 }
 
+uint64_t Image::get_cache_cost() const {
+	return data.size();
+}
+
 void Image::create(int p_width, int p_height, bool p_use_mipmaps, Format p_format) {
 	ERR_FAIL_COND_MSG(p_width <= 0, "Image width must be greater than 0.");
 	ERR_FAIL_COND_MSG(p_height <= 0, "Image height must be greater than 0.");
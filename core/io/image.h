@@ -290,6 +290,8 @@ public:
 
 	Vector<uint8_t> get_data() const;
 
+	virtual uint64_t get_cache_cost() const override;
+
 	Error load(const String &p_path);
 	Error save_png(const String &p_path) const;
 	Vector<uint8_t> save_png_to_buffer() const;
@@ -288,6 +288,11 @@ void Resource::_take_over_path(const String &p_path) {
 	set_path(p_path, true);
 }
 
+uint64_t Resource::get_cache_cost() const {
+	// Flat estimate for resources that don't report their own cost.
+	return 1024;
+}
+
 RID Resource::get_rid() const {
 	return RID();
 }
@@ -454,6 +459,15 @@ RWLock ResourceCache::lock;
 RWLock ResourceCache::path_cache_lock;
 #endif
 
+Mutex ResourceCache::retained_mutex;
+LRUCache<String, ResourceCache::RetainedResource, ResourceCache::_retained_evicted> ResourceCache::retained(INT32_MAX);
+Vector<Ref<Resource>> ResourceCache::retained_evicted;
+uint64_t ResourceCache::retained_budget = 0;
+uint64_t ResourceCache::retained_memory = 0;
+SafeNumeric<uint64_t> ResourceCache::hit_count;
+SafeNumeric<uint64_t> ResourceCache::miss_count;
+SafeNumeric<uint64_t> ResourceCache::eviction_count;
+
 void ResourceCache::clear() {
 	if (resources.size()) {
 		ERR_PRINT("Resources still in use at exit (run with --verbose for details).");
@@ -512,6 +526,103 @@ int ResourceCache::get_cached_resource_count() {
 	return rc;
 }
 
+void ResourceCache::_retained_evicted(String &p_path, RetainedResource &p_retained) {
+	retained_memory -= p_retained.cost;
+	// Not released here, freeing it may cascade into freeing other resources while the mutex is held.
+	retained_evicted.push_back(p_retained.resource);
+}
+
+void ResourceCache::_track_load(const Ref<Resource> &p_resource, bool p_cache_hit) {
+	if (p_cache_hit) {
+		hit_count.increment();
+	} else {
+		miss_count.increment();
+	}
+
+	if (p_resource.is_null() || p_resource->get_path().is_empty()) {
+		return;
+	}
+
+	const String path = p_resource->get_path();
+	const uint64_t cost = p_resource->get_cache_cost();
+	Vector<Ref<Resource>> evicted;
+
+	retained_mutex.lock();
+
+	if (retained_budget > 0) {
+		const RetainedResource *existing = retained.getptr(path);
+		if (existing) {
+			retained_memory -= existing->cost;
+			// May be a different resource replacing it, release it outside the mutex too.
+			retained_evicted.push_back(existing->resource);
+		}
+
+		if (cost <= retained_budget) {
+			RetainedResource entry;
+			entry.resource = p_resource;
+			entry.cost = cost;
+			retained.insert(path, entry);
+			retained_memory += cost;
+			while (retained_memory > retained_budget && retained.evict_least_recent()) {
+				eviction_count.increment();
+			}
+		} else if (existing) {
+			// Too large to ever fit, don't push everything else out for it.
+			retained.erase(path);
+		}
+	}
+
+	SWAP(evicted, retained_evicted);
+
+	retained_mutex.unlock();
+}
+
+void ResourceCache::set_retention_budget(uint64_t p_bytes) {
+	Vector<Ref<Resource>> evicted;
+
+	retained_mutex.lock();
+	retained_budget = p_bytes;
+	while (retained_memory > retained_budget && retained.evict_least_recent()) {
+		eviction_count.increment();
+	}
+	SWAP(evicted, retained_evicted);
+	retained_mutex.unlock();
+}
+
+uint64_t ResourceCache::get_retention_budget() {
+	return retained_budget;
+}
+
+uint64_t ResourceCache::get_retained_memory() {
+	retained_mutex.lock();
+	uint64_t memory = retained_memory;
+	retained_mutex.unlock();
+
+	return memory;
+}
+
+void ResourceCache::clear_retained() {
+	Vector<Ref<Resource>> evicted;
+
+	retained_mutex.lock();
+	while (retained.evict_least_recent()) {
+	}
+	SWAP(evicted, retained_evicted);
+	retained_mutex.unlock();
+}
+
+uint64_t ResourceCache::get_hit_count() {
+	return hit_count.get();
+}
+
+uint64_t ResourceCache::get_miss_count() {
+	return miss_count.get();
+}
+
+uint64_t ResourceCache::get_eviction_count() {
+	return eviction_count.get();
+}
+
 void ResourceCache::dump(const char *p_file, bool p_short) {
 #ifdef DEBUG_ENABLED
 	lock.read_lock();
@@ -34,6 +34,7 @@
 #include "core/io/resource_uid.h"
 #include "core/object/class_db.h"
 #include "core/object/ref_counted.h"
+#include "core/templates/lru.h"
 #include "core/templates/safe_refcount.h"
 #include "core/templates/self_list.h"
 
@@ -140,6 +141,8 @@ public:
 
 	virtual RID get_rid() const; // some resources may offer conversion to RID
 
+	virtual uint64_t get_cache_cost() const; // estimated memory held by this resource, used to budget ResourceCache retention
+
 #ifdef TOOLS_ENABLED
 	//helps keep IDs same number when loading/saving scenes. -1 clears ID and it Returns -1 when no id stored
 	void set_id_for_path(const String &p_path, const String &p_id);
@@ -165,6 +168,28 @@ class ResourceCache {
 	static void clear();
 	friend void register_core_types();
 
+	// Recently loaded resources are kept referenced here, so releasing the last
+	// user reference does not free them right away. Least recently loaded ones
+	// are dropped once their estimated cost goes over the budget.
+	struct RetainedResource {
+		Ref<Resource> resource;
+		uint64_t cost = 0;
+	};
+
+	static void _retained_evicted(String &p_path, RetainedResource &p_retained);
+
+	static Mutex retained_mutex;
+	static LRUCache<String, RetainedResource, _retained_evicted> retained;
+	static Vector<Ref<Resource>> retained_evicted;
+	static uint64_t retained_budget;
+	static uint64_t retained_memory;
+
+	static SafeNumeric<uint64_t> hit_count;
+	static SafeNumeric<uint64_t> miss_count;
+	static SafeNumeric<uint64_t> eviction_count;
+
+	static void _track_load(const Ref<Resource> &p_resource, bool p_cache_hit);
+
 public:
 	static void reload_externals();
 	static bool has(const String &p_path);
@@ -172,6 +197,15 @@ public:
 	static void dump(const char *p_file = nullptr, bool p_short = false);
 	static void get_cached_resources(List<Ref<Resource>> *p_resources);
 	static int get_cached_resource_count();
+
+	static void set_retention_budget(uint64_t p_bytes);
+	static uint64_t get_retention_budget();
+	static uint64_t get_retained_memory();
+	static void clear_retained();
+
+	static uint64_t get_hit_count();
+	static uint64_t get_miss_count();
+	static uint64_t get_eviction_count();
 };
 
 #endif // RESOURCE_H
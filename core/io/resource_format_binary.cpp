@@ -628,7 +628,7 @@ Error ResourceLoaderBinary::load() {
 
 		if (path.find("://") == -1 && path.is_rel_path()) {
 			// path is relative to file being loaded, so convert to a resource path
-			path = ProjectSettings::get_singleton()->localize_path(path.get_base_dir().plus_file(external_resources[i].path));
+			path = ProjectSettings::get_singleton()->localize_path(res_path.get_base_dir().plus_file(external_resources[i].path));
 		}
 
 		external_resources.write[i].path = path; //remap happens here, not on load because on load it can actually be used for filesystem dock resource remap
@@ -32,6 +32,7 @@
 
 #include "core/config/project_settings.h"
 #include "core/io/file_access.h"
+#include "core/io/file_access_async.h"
 #include "core/io/resource_importer.h"
 #include "core/os/os.h"
 #include "core/string/print_string.h"
@@ -217,13 +218,35 @@ RES ResourceLoader::_load(const String &p_path, const String &p_original_path, c
 	ERR_FAIL_V_MSG(RES(), "No loader found for resource: " + p_path + ".");
 }
 
+// Hints the OS to start caching the file a load task will need while it waits for a
+// free slot. Only done where the OS can read ahead on its own (io_uring backend on
+// Linux). The loader still reads the file synchronously through FileAccess once it
+// starts, it may just find the data already cached.
+static void _prefetch_resource_file(const String &p_path) {
+	FileAccessAsync *faa = FileAccessAsync::get_singleton();
+	if (!faa || !faa->can_prefetch()) {
+		return;
+	}
+
+	String path = p_path;
+	if (ResourceFormatImporter::get_singleton() && FileAccess::exists(p_path + ".import")) {
+		path = ResourceFormatImporter::get_singleton()->get_internal_resource_path(p_path);
+	}
+	if (!path.is_empty()) {
+		faa->prefetch(path);
+	}
+}
+
 void ResourceLoader::_thread_load_function(void *p_userdata) {
 	ThreadLoadTask &load_task = *(ThreadLoadTask *)p_userdata;
 	load_task.loader_id = Thread::get_caller_id();
 
 	if (load_task.semaphore) {
 		//this is an actual thread, so wait for Ok from semaphore
-		thread_load_semaphore->wait(); //wait until its ok to start loading
+		if (!thread_load_semaphore->try_wait()) {
+			_prefetch_resource_file(load_task.remapped_path);
+			thread_load_semaphore->wait(); //wait until its ok to start loading
+		}
 	}
 	load_task.resource = _load(load_task.remapped_path, load_task.remapped_path != load_task.local_path ? load_task.local_path : String(), load_task.type_hint, load_task.cache_mode, &load_task.error, load_task.use_sub_threads, &load_task.progress);
 
@@ -275,7 +298,17 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 		}
 	}
 
+	// The task may be erased as soon as the mutex is released.
+	RES loaded;
+	if (load_task.cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE) {
+		loaded = load_task.resource;
+	}
+
 	thread_load_mutex->unlock();
+
+	if (loaded.is_valid()) {
+		ResourceCache::_track_load(loaded, false);
+	}
 }
 
 static String _validate_local_path(const String &p_path) {
@@ -356,6 +389,10 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 				}
 			}
 			ResourceCache::lock.read_unlock();
+
+			if (load_task.status == THREAD_LOAD_LOADED) {
+				ResourceCache::_track_load(load_task.resource, true);
+			}
 		}
 
 		if (p_source_resource != String()) {
@@ -546,6 +583,8 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, Resour
 				ResourceCache::lock.read_unlock();
 				thread_load_mutex->unlock();
 
+				ResourceCache::_track_load(res, true);
+
 				if (r_error) {
 					*r_error = OK;
 				}
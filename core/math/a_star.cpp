@@ -34,6 +34,50 @@
 #include "core/object/script_language.h"
 #include "scene/scene_string_names.h"
 
+thread_local AStar::SearchStatePool AStar::search_state_pool;
+
+void AStar::SearchState::begin(uint32_t p_point_count) {
+	if (prev_points.size() < p_point_count) {
+		const uint32_t old_count = prev_points.size();
+		prev_points.resize(p_point_count);
+		g_scores.resize(p_point_count);
+		open_passes.resize(p_point_count);
+		closed_passes.resize(p_point_count);
+		for (uint32_t i = old_count; i < p_point_count; i++) {
+			open_passes[i] = 0;
+			closed_passes[i] = 0;
+		}
+	}
+
+	pass++;
+	if (pass == 0) {
+		// Wrapped around, the passes of old searches would match again.
+		memset(open_passes.ptr(), 0, open_passes.size() * sizeof(uint32_t));
+		memset(closed_passes.ptr(), 0, closed_passes.size() * sizeof(uint32_t));
+		pass = 1;
+	}
+	open_list.clear();
+}
+
+AStar::SearchState *AStar::SearchStatePool::acquire() {
+	if (states.is_empty()) {
+		return memnew(SearchState);
+	}
+	SearchState *state = states[states.size() - 1];
+	states.resize(states.size() - 1);
+	return state;
+}
+
+void AStar::SearchStatePool::release(SearchState *p_state) {
+	states.push_back(p_state);
+}
+
+AStar::SearchStatePool::~SearchStatePool() {
+	for (uint32_t i = 0; i < states.size(); i++) {
+		memdelete(states[i]);
+	}
+}
+
 int AStar::get_available_point_id() const {
 	if (points.has(last_free_id)) {
 		int cur_new_id = last_free_id + 1;
@@ -58,14 +102,16 @@ void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
 		pt->id = p_id;
 		pt->pos = p_pos;
 		pt->weight_scale = p_weight_scale;
-		pt->prev_point = nullptr;
-		pt->open_pass = 0;
-		pt->closed_pass = 0;
 		pt->enabled = true;
 		points.set(p_id, pt);
+		graph_dirty.set();
 	} else {
 		found_pt->pos = p_pos;
 		found_pt->weight_scale = p_weight_scale;
+		if (!graph_dirty.is_set()) {
+			graph.positions[found_pt->index] = p_pos;
+			graph.weight_scales[found_pt->index] = p_weight_scale;
+		}
 	}
 }
 
@@ -83,6 +129,9 @@ void AStar::set_point_position(int p_id, const Vector3 &p_pos) {
 	ERR_FAIL_COND(!p_exists);
 
 	p->pos = p_pos;
+	if (!graph_dirty.is_set()) {
+		graph.positions[p->index] = p_pos;
+	}
 }
 
 real_t AStar::get_point_weight_scale(int p_id) const {
@@ -100,6 +149,9 @@ void AStar::set_point_weight_scale(int p_id, real_t p_weight_scale) {
 	ERR_FAIL_COND(p_weight_scale < 1);
 
 	p->weight_scale = p_weight_scale;
+	if (!graph_dirty.is_set()) {
+		graph.weight_scales[p->index] = p_weight_scale;
+	}
 }
 
 void AStar::remove_point(int p_id) {
@@ -126,6 +178,7 @@ void AStar::remove_point(int p_id) {
 	memdelete(p);
 	points.remove(p_id);
 	last_free_id = p_id;
+	graph_dirty.set();
 }
 
 void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
@@ -164,6 +217,7 @@ void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 	}
 
 	segments.insert(s);
+	graph_dirty.set();
 }
 
 void AStar::disconnect_points(int p_id, int p_with_id, bool bidirectional) {
@@ -203,6 +257,7 @@ void AStar::disconnect_points(int p_id, int p_with_id, bool bidirectional) {
 		if (s.direction != Segment::NONE) {
 			segments.insert(s);
 		}
+		graph_dirty.set();
 	}
 }
 
@@ -249,6 +304,7 @@ void AStar::clear() {
 	}
 	segments.clear();
 	points.clear();
+	graph_dirty.set();
 }
 
 int AStar::get_point_count() const {
@@ -319,62 +375,105 @@ Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
 	return closest_point;
 }
 
-bool AStar::_solve(Point *begin_point, Point *end_point) {
-	pass++;
+void AStar::_update_graph() {
+	if (!graph_dirty.is_set()) {
+		return;
+	}
+	MutexLock lock(graph_mutex);
+	if (!graph_dirty.is_set()) {
+		// Built by another thread meanwhile.
+		return;
+	}
+
+	const uint32_t point_count = points.get_num_elements();
+	graph.ids.resize(point_count);
+	graph.positions.resize(point_count);
+	graph.weight_scales.resize(point_count);
+	graph.enabled.resize(point_count);
+	graph.neighbour_offsets.resize(point_count + 1);
+	graph.neighbours.clear();
+
+	uint32_t index = 0;
+	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
+		Point *p = *(it.value);
+		p->index = index;
+		graph.ids[index] = p->id;
+		graph.positions[index] = p->pos;
+		graph.weight_scales[index] = p->weight_scale;
+		graph.enabled[index] = p->enabled;
+		index++;
+	}
+
+	index = 0;
+	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
+		Point *p = *(it.value);
+		graph.neighbour_offsets[index++] = graph.neighbours.size();
+		for (OAHashMap<int, Point *>::Iterator neighbour = p->neighbours.iter(); neighbour.valid; neighbour = p->neighbours.next_iter(neighbour)) {
+			graph.neighbours.push_back((*neighbour.value)->index);
+		}
+	}
+	graph.neighbour_offsets[point_count] = graph.neighbours.size();
 
-	if (!end_point->enabled) {
+	graph_dirty.clear();
+}
+
+template <class T>
+bool AStar::_solve(T *p_cost_owner, SearchState &r_state, uint32_t p_begin_index, uint32_t p_end_index) {
+	if (!graph.enabled[p_end_index]) {
 		return false;
 	}
 
+	r_state.begin(graph.ids.size());
+	const uint32_t pass = r_state.pass;
+	const int end_id = graph.ids[p_end_index];
+
 	bool found_route = false;
 
-	Vector<Point *> open_list;
-	SortArray<Point *, SortPoints> sorter;
+	// The points are not moved up in the open list when their score is
+	// improved, they are added again. The worse copies are skipped once the
+	// point is closed.
+	LocalVector<SearchState::OpenPoint> &open_list = r_state.open_list;
+	SortArray<SearchState::OpenPoint> sorter;
 
-	begin_point->g_score = 0;
-	begin_point->f_score = _estimate_cost(begin_point->id, end_point->id);
-	open_list.push_back(begin_point);
+	r_state.g_scores[p_begin_index] = 0;
+	r_state.open_passes[p_begin_index] = pass;
+	open_list.push_back({ p_cost_owner->_estimate_cost(graph.ids[p_begin_index], end_id), 0, p_begin_index });
 
 	while (!open_list.is_empty()) {
-		Point *p = open_list[0]; // The currently processed point
+		const uint32_t p = open_list[0].index; // The currently processed point
 
-		if (p == end_point) {
+		if (p == p_end_index) {
 			found_route = true;
 			break;
 		}
 
-		sorter.pop_heap(0, open_list.size(), open_list.ptrw()); // Remove the current point from the open list
-		open_list.remove(open_list.size() - 1);
-		p->closed_pass = pass; // Mark the point as closed
+		sorter.pop_heap(0, open_list.size(), open_list.ptr()); // Remove the current point from the open list
+		open_list.resize(open_list.size() - 1);
+		if (r_state.closed_passes[p] == pass) {
+			continue;
+		}
+		r_state.closed_passes[p] = pass; // Mark the point as closed
 
-		for (OAHashMap<int, Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
-			Point *e = *(it.value); // The neighbour point
+		const uint32_t neighbours_end = graph.neighbour_offsets[p + 1];
+		for (uint32_t i = graph.neighbour_offsets[p]; i < neighbours_end; i++) {
+			const uint32_t e = graph.neighbours[i]; // The neighbour point
 
-			if (!e->enabled || e->closed_pass == pass) {
+			if (!graph.enabled[e] || r_state.closed_passes[e] == pass) {
 				continue;
 			}
 
-			real_t tentative_g_score = p->g_score + _compute_cost(p->id, e->id) * e->weight_scale;
+			real_t tentative_g_score = r_state.g_scores[p] + p_cost_owner->_compute_cost(graph.ids[p], graph.ids[e]) * graph.weight_scales[e];
 
-			bool new_point = false;
-
-			if (e->open_pass != pass) { // The point wasn't inside the open list.
-				e->open_pass = pass;
-				open_list.push_back(e);
-				new_point = true;
-			} else if (tentative_g_score >= e->g_score) { // The new path is worse than the previous.
+			if (r_state.open_passes[e] == pass && tentative_g_score >= r_state.g_scores[e]) { // The new path is worse than the previous.
 				continue;
 			}
 
-			e->prev_point = p;
-			e->g_score = tentative_g_score;
-			e->f_score = e->g_score + _estimate_cost(e->id, end_point->id);
+			r_state.open_passes[e] = pass;
+			r_state.prev_points[e] = p;
+			r_state.g_scores[e] = tentative_g_score;
 
-			if (new_point) { // The position of the new points is already known.
-				sorter.push_heap(0, open_list.size() - 1, 0, e, open_list.ptrw());
-			} else {
-				sorter.push_heap(0, open_list.find(e), 0, e, open_list.ptrw());
-			}
+			open_list.push_back({ tentative_g_score + p_cost_owner->_estimate_cost(graph.ids[e], end_id), tentative_g_score, e });
+			sorter.push_heap(0, open_list.size() - 1, 0, open_list[open_list.size() - 1], open_list.ptr());
 		}
 	}
 
@@ -428,19 +527,22 @@ Vector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 		return ret;
 	}
 
-	Point *begin_point = a;
-	Point *end_point = b;
+	_update_graph();
+	const uint32_t begin_index = a->index;
+	const uint32_t end_index = b->index;
 
-	bool found_route = _solve(begin_point, end_point);
+	SearchState *state = search_state_pool.acquire();
+	bool found_route = _solve(this, *state, begin_index, end_index);
 	if (!found_route) {
+		search_state_pool.release(state);
 		return Vector<Vector3>();
 	}
 
-	Point *p = end_point;
+	uint32_t p = end_index;
 	int pc = 1; // Begin point
-	while (p != begin_point) {
+	while (p != begin_index) {
 		pc++;
-		p = p->prev_point;
+		p = state->prev_points[p];
 	}
 
 	Vector<Vector3> path;
@@ -449,16 +551,17 @@ Vector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 	{
 		Vector3 *w = path.ptrw();
 
-		Point *p2 = end_point;
+		p = end_index;
 		int idx = pc - 1;
-		while (p2 != begin_point) {
-			w[idx--] = p2->pos;
-			p2 = p2->prev_point;
+		while (p != begin_index) {
+			w[idx--] = graph.positions[p];
+			p = state->prev_points[p];
 		}
 
-		w[0] = p2->pos; // Assign first
+		w[0] = graph.positions[p]; // Assign first
 	}
 
+	search_state_pool.release(state);
 	return path;
 }
 
@@ -477,19 +580,22 @@ Vector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 		return ret;
 	}
 
-	Point *begin_point = a;
-	Point *end_point = b;
+	_update_graph();
+	const uint32_t begin_index = a->index;
+	const uint32_t end_index = b->index;
 
-	bool found_route = _solve(begin_point, end_point);
+	SearchState *state = search_state_pool.acquire();
+	bool found_route = _solve(this, *state, begin_index, end_index);
 	if (!found_route) {
+		search_state_pool.release(state);
 		return Vector<int>();
 	}
 
-	Point *p = end_point;
+	uint32_t p = end_index;
 	int pc = 1; // Begin point
-	while (p != begin_point) {
+	while (p != begin_index) {
 		pc++;
-		p = p->prev_point;
+		p = state->prev_points[p];
 	}
 
 	Vector<int> path;
@@ -498,16 +604,17 @@ Vector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 	{
 		int *w = path.ptrw();
 
-		p = end_point;
+		p = end_index;
 		int idx = pc - 1;
-		while (p != begin_point) {
-			w[idx--] = p->id;
-			p = p->prev_point;
+		while (p != begin_index) {
+			w[idx--] = graph.ids[p];
+			p = state->prev_points[p];
 		}
 
-		w[0] = p->id; // Assign first
+		w[0] = graph.ids[p]; // Assign first
 	}
 
+	search_state_pool.release(state);
 	return path;
 }
 
@@ -517,6 +624,9 @@ void AStar::set_point_disabled(int p_id, bool p_disabled) {
 	ERR_FAIL_COND(!p_exists);
 
 	p->enabled = !p_disabled;
+	if (!graph_dirty.is_set()) {
+		graph.enabled[p->index] = p->enabled;
+	}
 }
 
 bool AStar::is_point_disabled(int p_id) const {
@@ -700,19 +810,22 @@ Vector<Vector2> AStar2D::get_point_path(int p_from_id, int p_to_id) {
 		return ret;
 	}
 
-	AStar::Point *begin_point = a;
-	AStar::Point *end_point = b;
+	astar._update_graph();
+	const uint32_t begin_index = a->index;
+	const uint32_t end_index = b->index;
 
-	bool found_route = _solve(begin_point, end_point);
+	AStar::SearchState *state = AStar::search_state_pool.acquire();
+	bool found_route = astar._solve(this, *state, begin_index, end_index);
 	if (!found_route) {
+		AStar::search_state_pool.release(state);
 		return Vector<Vector2>();
 	}
 
-	AStar::Point *p = end_point;
+	uint32_t p = end_index;
 	int pc = 1; // Begin point
-	while (p != begin_point) {
+	while (p != begin_index) {
 		pc++;
-		p = p->prev_point;
+		p = state->prev_points[p];
 	}
 
 	Vector<Vector2> path;
@@ -721,16 +834,17 @@ Vector<Vector2> AStar2D::get_point_path(int p_from_id, int p_to_id) {
 	{
 		Vector2 *w = path.ptrw();
 
-		AStar::Point *p2 = end_point;
+		p = end_index;
 		int idx = pc - 1;
-		while (p2 != begin_point) {
-			w[idx--] = Vector2(p2->pos.x, p2->pos.y);
-			p2 = p2->prev_point;
+		while (p != begin_index) {
+			w[idx--] = Vector2(astar.graph.positions[p].x, astar.graph.positions[p].y);
+			p = state->prev_points[p];
 		}
 
-		w[0] = Vector2(p2->pos.x, p2->pos.y); // Assign first
+		w[0] = Vector2(astar.graph.positions[p].x, astar.graph.positions[p].y); // Assign first
 	}
 
+	AStar::search_state_pool.release(state);
 	return path;
 }
 
@@ -749,19 +863,22 @@ Vector<int> AStar2D::get_id_path(int p_from_id, int p_to_id) {
 		return ret;
 	}
 
-	AStar::Point *begin_point = a;
-	AStar::Point *end_point = b;
+	astar._update_graph();
+	const uint32_t begin_index = a->index;
+	const uint32_t end_index = b->index;
 
-	bool found_route = _solve(begin_point, end_point);
+	AStar::SearchState *state = AStar::search_state_pool.acquire();
+	bool found_route = astar._solve(this, *state, begin_index, end_index);
 	if (!found_route) {
+		AStar::search_state_pool.release(state);
 		return Vector<int>();
 	}
 
-	AStar::Point *p = end_point;
+	uint32_t p = end_index;
 	int pc = 1; // Begin point
-	while (p != begin_point) {
+	while (p != begin_index) {
 		pc++;
-		p = p->prev_point;
+		p = state->prev_points[p];
 	}
 
 	Vector<int> path;
@@ -770,81 +887,20 @@ Vector<int> AStar2D::get_id_path(int p_from_id, int p_to_id) {
 	{
 		int *w = path.ptrw();
 
-		p = end_point;
+		p = end_index;
 		int idx = pc - 1;
-		while (p != begin_point) {
-			w[idx--] = p->id;
-			p = p->prev_point;
+		while (p != begin_index) {
+			w[idx--] = astar.graph.ids[p];
+			p = state->prev_points[p];
 		}
 
-		w[0] = p->id; // Assign first
+		w[0] = astar.graph.ids[p]; // Assign first
 	}
 
+	AStar::search_state_pool.release(state);
 	return path;
 }
 
-bool AStar2D::_solve(AStar::Point *begin_point, AStar::Point *end_point) {
-	astar.pass++;
-
-	if (!end_point->enabled) {
-		return false;
-	}
-
-	bool found_route = false;
-
-	Vector<AStar::Point *> open_list;
-	SortArray<AStar::Point *, AStar::SortPoints> sorter;
-
-	begin_point->g_score = 0;
-	begin_point->f_score = _estimate_cost(begin_point->id, end_point->id);
-	open_list.push_back(begin_point);
-
-	while (!open_list.is_empty()) {
-		AStar::Point *p = open_list[0]; // The currently processed point
-
-		if (p == end_point) {
-			found_route = true;
-			break;
-		}
-
-		sorter.pop_heap(0, open_list.size(), open_list.ptrw()); // Remove the current point from the open list
-		open_list.remove(open_list.size() - 1);
-		p->closed_pass = astar.pass; // Mark the point as closed
-
-		for (OAHashMap<int, AStar::Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
-			AStar::Point *e = *(it.value); // The neighbour point
-
-			if (!e->enabled || e->closed_pass == astar.pass) {
-				continue;
-			}
-
-			real_t tentative_g_score = p->g_score + _compute_cost(p->id, e->id) * e->weight_scale;
-
-			bool new_point = false;
-
-			if (e->open_pass != astar.pass) { // The point wasn't inside the open list.
-				e->open_pass = astar.pass;
-				open_list.push_back(e);
-				new_point = true;
-			} else if (tentative_g_score >= e->g_score) { // The new path is worse than the previous.
-				continue;
-			}
-
-			e->prev_point = p;
-			e->g_score = tentative_g_score;
-			e->f_score = e->g_score + _estimate_cost(e->id, end_point->id);
-
-			if (new_point) { // The position of the new points is already known.
-				sorter.push_heap(0, open_list.size() - 1, 0, e, open_list.ptrw());
-			} else {
-				sorter.push_heap(0, open_list.find(e), 0, e, open_list.ptrw());
-			}
-		}
-	}
-
-	return found_route;
-}
-
 void AStar2D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_available_point_id"), &AStar2D::get_available_point_id);
 	ClassDB::bind_method(D_METHOD("add_point", "id", "position", "weight_scale"), &AStar2D::add_point, DEFVAL(1.0));
@@ -32,7 +32,10 @@
 #define A_STAR_H
 
 #include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/oa_hash_map.h"
+#include "core/templates/safe_refcount.h"
 
 /**
 	A* pathfinding algorithm
@@ -43,6 +46,7 @@
 class AStar : public RefCounted {
 	GDCLASS(AStar, RefCounted);
 	friend class AStar2D;
+	friend class AStarGrid2D;
 
 	struct Point {
 		Point() {}
@@ -55,26 +59,63 @@ class AStar : public RefCounted {
 		OAHashMap<int, Point *> neighbours = 4u;
 		OAHashMap<int, Point *> unlinked_neighbours = 4u;
 
-		// Used for pathfinding.
-		Point *prev_point = nullptr;
-		real_t g_score = 0;
-		real_t f_score = 0;
-		uint64_t open_pass = 0;
-		uint64_t closed_pass = 0;
+		// Index in the graph, valid while it is not dirty.
+		uint32_t index = 0;
 	};
 
-	struct SortPoints {
-		_FORCE_INLINE_ bool operator()(const Point *A, const Point *B) const { // Returns true when the Point A is worse than Point B.
-			if (A->f_score > B->f_score) {
-				return true;
-			} else if (A->f_score < B->f_score) {
-				return false;
-			} else {
-				return A->g_score < B->g_score; // If the f_costs are the same then prioritize the points that are further away from the start.
+	// Contiguous copy of the points searched by the paths. Built again when
+	// the points or their connections change, only the positions, weights
+	// and enabled states are updated in place.
+	struct Graph {
+		LocalVector<int> ids;
+		LocalVector<Vector3> positions;
+		LocalVector<real_t> weight_scales;
+		LocalVector<uint8_t> enabled;
+
+		// The neighbours of the point `i` are in `neighbours`, from
+		// `neighbour_offsets[i]` to `neighbour_offsets[i + 1]`.
+		LocalVector<uint32_t> neighbour_offsets;
+		LocalVector<uint32_t> neighbours;
+	};
+
+	// Buffers of a path search, indexed like the graph points.
+	struct SearchState {
+		struct OpenPoint {
+			real_t f_score = 0;
+			real_t g_score = 0;
+			uint32_t index = 0;
+
+			// Returns true when this point is worse than the other one.
+			_FORCE_INLINE_ bool operator<(const OpenPoint &p_other) const {
+				if (f_score != p_other.f_score) {
+					return f_score > p_other.f_score;
+				}
+				return g_score < p_other.g_score; // If the f_costs are the same then prioritize the points that are further away from the start.
 			}
-		}
+		};
+
+		LocalVector<OpenPoint> open_list;
+		LocalVector<uint32_t> prev_points;
+		LocalVector<real_t> g_scores;
+		LocalVector<uint32_t> open_passes;
+		LocalVector<uint32_t> closed_passes;
+		uint32_t pass = 0;
+
+		void begin(uint32_t p_point_count);
 	};
 
+	// The search states are pooled per thread, so paths can be searched from
+	// several threads, and from the cost callbacks of another search.
+	struct SearchStatePool {
+		LocalVector<SearchState *> states;
+
+		SearchState *acquire();
+		void release(SearchState *p_state);
+		~SearchStatePool();
+	};
+
+	static thread_local SearchStatePool search_state_pool;
+
 	struct Segment {
 		union {
 			struct {
@@ -109,12 +150,17 @@ class AStar : public RefCounted {
 	};
 
 	int last_free_id = 0;
-	uint64_t pass = 1;
 
 	OAHashMap<int, Point *> points;
 	Set<Segment> segments;
 
-	bool _solve(Point *begin_point, Point *end_point);
+	Graph graph;
+	SafeFlag graph_dirty{ true };
+	Mutex graph_mutex;
+
+	void _update_graph();
+	template <class T>
+	bool _solve(T *p_cost_owner, SearchState &r_state, uint32_t p_begin_index, uint32_t p_end_index);
 
 protected:
 	static void _bind_methods();
@@ -159,10 +205,9 @@ public:
 
 class AStar2D : public RefCounted {
 	GDCLASS(AStar2D, RefCounted);
+	friend class AStar;
 	AStar astar;
 
-	bool _solve(AStar::Point *begin_point, AStar::Point *end_point);
-
 protected:
 	static void _bind_methods();
 
@@ -0,0 +1,413 @@
+/*************************************************************************/
+/*  a_star_grid_2d.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "a_star_grid_2d.h"
+
+#include "core/templates/sort_array.h"
+
+static _FORCE_INLINE_ real_t _octile_distance(const Vector2i &p_from, const Vector2i &p_to) {
+	const int dx = ABS(p_to.x - p_from.x);
+	const int dy = ABS(p_to.y - p_from.y);
+	return MAX(dx, dy) - MIN(dx, dy) + MIN(dx, dy) * Math_SQRT2;
+}
+
+bool AStarGrid2D::_is_forced(int p_x, int p_y, int p_dx, int p_dy) const {
+	// Diagonal moves can't cut corners, so a cell reached straight is a jump
+	// point when a side cell opens up after being blocked on the cell before.
+	if (p_dx != 0) {
+		return (_is_walkable(p_x, p_y - 1) && !_is_walkable(p_x - p_dx, p_y - 1)) ||
+				(_is_walkable(p_x, p_y + 1) && !_is_walkable(p_x - p_dx, p_y + 1));
+	}
+	return (_is_walkable(p_x - 1, p_y) && !_is_walkable(p_x - 1, p_y - p_dy)) ||
+			(_is_walkable(p_x + 1, p_y) && !_is_walkable(p_x + 1, p_y - p_dy));
+}
+
+void AStarGrid2D::_update_jump_distance(int p_x, int p_y, JumpDirection p_direction, int p_dx, int p_dy) {
+	const int next_x = p_x + p_dx;
+	const int next_y = p_y + p_dy;
+
+	int32_t distance;
+	if (!_is_walkable(next_x, next_y)) {
+		distance = 0;
+	} else if (_is_forced(next_x, next_y, p_dx, p_dy)) {
+		distance = 1;
+	} else {
+		// The next cell is computed first, continue its distance.
+		const int32_t next_distance = jump_distances[(next_y * size.x + next_x) * JUMP_MAX + p_direction];
+		distance = next_distance > 0 ? next_distance + 1 : next_distance - 1;
+	}
+	jump_distances[(p_y * size.x + p_x) * JUMP_MAX + p_direction] = distance;
+}
+
+void AStarGrid2D::_update_row_jump_distances(int p_y) {
+	for (int x = size.x - 1; x >= 0; x--) {
+		_update_jump_distance(x, p_y, JUMP_RIGHT, 1, 0);
+	}
+	for (int x = 0; x < size.x; x++) {
+		_update_jump_distance(x, p_y, JUMP_LEFT, -1, 0);
+	}
+}
+
+void AStarGrid2D::_update_column_jump_distances(int p_x) {
+	for (int y = size.y - 1; y >= 0; y--) {
+		_update_jump_distance(p_x, y, JUMP_DOWN, 0, 1);
+	}
+	for (int y = 0; y < size.y; y++) {
+		_update_jump_distance(p_x, y, JUMP_UP, 0, -1);
+	}
+}
+
+void AStarGrid2D::_update_jump_distances() {
+	if (!jump_distances_dirty.is_set()) {
+		return;
+	}
+	MutexLock lock(jump_distances_mutex);
+	if (!jump_distances_dirty.is_set()) {
+		// Built by another thread meanwhile.
+		return;
+	}
+
+	jump_distances.resize(size.x * size.y * JUMP_MAX);
+	for (int y = 0; y < size.y; y++) {
+		_update_row_jump_distances(y);
+	}
+	for (int x = 0; x < size.x; x++) {
+		_update_column_jump_distances(x);
+	}
+
+	jump_distances_dirty.clear();
+}
+
+bool AStarGrid2D::_jump_straight(const Vector2i &p_from, int p_dx, int p_dy, const Vector2i &p_to, Vector2i &r_jump_point) const {
+	JumpDirection direction;
+	int steps_to_end = 0;
+	if (p_dx != 0) {
+		direction = p_dx > 0 ? JUMP_RIGHT : JUMP_LEFT;
+		if (p_to.y == p_from.y) {
+			steps_to_end = (p_to.x - p_from.x) * p_dx;
+		}
+	} else {
+		direction = p_dy > 0 ? JUMP_DOWN : JUMP_UP;
+		if (p_to.x == p_from.x) {
+			steps_to_end = (p_to.y - p_from.y) * p_dy;
+		}
+	}
+
+	const int32_t distance = jump_distances[(p_from.y * size.x + p_from.x) * JUMP_MAX + direction];
+
+	// The end is a jump point as well, if it comes first on the way.
+	if (steps_to_end > 0 && steps_to_end <= ABS(distance)) {
+		r_jump_point = p_to;
+		return true;
+	}
+	if (distance > 0) {
+		r_jump_point = Vector2i(p_from.x + p_dx * distance, p_from.y + p_dy * distance);
+		return true;
+	}
+	return false;
+}
+
+bool AStarGrid2D::_jump_diagonal(const Vector2i &p_from, int p_dx, int p_dy, const Vector2i &p_to, Vector2i &r_jump_point) const {
+	Vector2i cell = p_from;
+	Vector2i straight_jump_point;
+	while (_is_walkable(cell.x + p_dx, cell.y) && _is_walkable(cell.x, cell.y + p_dy) && _is_walkable(cell.x + p_dx, cell.y + p_dy)) {
+		cell.x += p_dx;
+		cell.y += p_dy;
+
+		// Stop where one of the straight directions would find a jump point.
+		if (cell == p_to || _jump_straight(cell, p_dx, 0, p_to, straight_jump_point) || _jump_straight(cell, 0, p_dy, p_to, straight_jump_point)) {
+			r_jump_point = cell;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool AStarGrid2D::_solve(AStar::SearchState &r_state, const Vector2i &p_from, const Vector2i &p_to) const {
+	r_state.begin(size.x * size.y);
+	const uint32_t pass = r_state.pass;
+
+	const uint32_t begin_index = p_from.y * size.x + p_from.x;
+	const uint32_t end_index = p_to.y * size.x + p_to.x;
+
+	LocalVector<AStar::SearchState::OpenPoint> &open_list = r_state.open_list;
+	SortArray<AStar::SearchState::OpenPoint> sorter;
+
+	r_state.g_scores[begin_index] = 0;
+	r_state.open_passes[begin_index] = pass;
+	r_state.prev_points[begin_index] = begin_index;
+	open_list.push_back({ _octile_distance(p_from, p_to), 0, begin_index });
+
+	while (!open_list.is_empty()) {
+		const uint32_t p = open_list[0].index; // The currently processed cell
+
+		if (p == end_index) {
+			return true;
+		}
+
+		sorter.pop_heap(0, open_list.size(), open_list.ptr());
+		open_list.resize(open_list.size() - 1);
+		if (r_state.closed_passes[p] == pass) {
+			continue;
+		}
+		r_state.closed_passes[p] = pass;
+
+		const Vector2i cell(p % size.x, p / size.x);
+
+		// Only follow the directions that can't be reached as well through
+		// the parent jump point. The jumps skip the directions that are
+		// blocked.
+		Vector2i directions[8];
+		int direction_count = 0;
+		if (p == begin_index) {
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					if (dx != 0 || dy != 0) {
+						directions[direction_count++] = Vector2i(dx, dy);
+					}
+				}
+			}
+		} else {
+			const uint32_t prev = r_state.prev_points[p];
+			const int dx = SGN(cell.x - int(prev % size.x));
+			const int dy = SGN(cell.y - int(prev / size.x));
+			if (dx != 0 && dy != 0) {
+				directions[direction_count++] = Vector2i(dx, dy);
+				directions[direction_count++] = Vector2i(dx, 0);
+				directions[direction_count++] = Vector2i(0, dy);
+			} else if (dx != 0) {
+				directions[direction_count++] = Vector2i(dx, 0);
+				directions[direction_count++] = Vector2i(dx, -1);
+				directions[direction_count++] = Vector2i(dx, 1);
+				directions[direction_count++] = Vector2i(0, -1);
+				directions[direction_count++] = Vector2i(0, 1);
+			} else {
+				directions[direction_count++] = Vector2i(0, dy);
+				directions[direction_count++] = Vector2i(-1, dy);
+				directions[direction_count++] = Vector2i(1, dy);
+				directions[direction_count++] = Vector2i(-1, 0);
+				directions[direction_count++] = Vector2i(1, 0);
+			}
+		}
+
+		for (int i = 0; i < direction_count; i++) {
+			const Vector2i &direction = directions[i];
+			Vector2i jump_point;
+			const bool found = direction.x != 0 && direction.y != 0
+					? _jump_diagonal(cell, direction.x, direction.y, p_to, jump_point)
+					: _jump_straight(cell, direction.x, direction.y, p_to, jump_point);
+			if (!found) {
+				continue;
+			}
+
+			const uint32_t e = jump_point.y * size.x + jump_point.x;
+			if (r_state.closed_passes[e] == pass) {
+				continue;
+			}
+
+			real_t tentative_g_score = r_state.g_scores[p] + _octile_distance(cell, jump_point);
+
+			if (r_state.open_passes[e] == pass && tentative_g_score >= r_state.g_scores[e]) { // The new path is worse than the previous.
+				continue;
+			}
+
+			r_state.open_passes[e] = pass;
+			r_state.prev_points[e] = p;
+			r_state.g_scores[e] = tentative_g_score;
+
+			open_list.push_back({ tentative_g_score + _octile_distance(jump_point, p_to), tentative_g_score, e });
+			sorter.push_heap(0, open_list.size() - 1, 0, open_list[open_list.size() - 1], open_list.ptr());
+		}
+	}
+
+	return false;
+}
+
+Vector<Vector2i> AStarGrid2D::_get_cell_path(const Vector2i &p_from, const Vector2i &p_to) {
+	ERR_FAIL_COND_V_MSG(!is_in_bounds(p_from), Vector<Vector2i>(), vformat("Can't get path. Point %s out of bounds of the grid (%s).", p_from, size));
+	ERR_FAIL_COND_V_MSG(!is_in_bounds(p_to), Vector<Vector2i>(), vformat("Can't get path. Point %s out of bounds of the grid (%s).", p_to, size));
+
+	if (!_is_walkable(p_from.x, p_from.y) || !_is_walkable(p_to.x, p_to.y)) {
+		return Vector<Vector2i>();
+	}
+
+	if (p_from == p_to) {
+		Vector<Vector2i> path;
+		path.push_back(p_from);
+		return path;
+	}
+
+	_update_jump_distances();
+
+	AStar::SearchState *state = AStar::search_state_pool.acquire();
+	bool found_route = _solve(*state, p_from, p_to);
+	if (!found_route) {
+		AStar::search_state_pool.release(state);
+		return Vector<Vector2i>();
+	}
+
+	// The route only holds the jump points, fill the cells between them.
+	const uint32_t begin_index = p_from.y * size.x + p_from.x;
+	uint32_t index = p_to.y * size.x + p_to.x;
+	int cell_count = 1;
+	while (index != begin_index) {
+		const uint32_t prev = state->prev_points[index];
+		cell_count += MAX(ABS(int(index % size.x) - int(prev % size.x)), ABS(int(index / size.x) - int(prev / size.x)));
+		index = prev;
+	}
+
+	Vector<Vector2i> path;
+	path.resize(cell_count);
+	Vector2i *w = path.ptrw();
+
+	int idx = cell_count - 1;
+	index = p_to.y * size.x + p_to.x;
+	while (index != begin_index) {
+		const uint32_t prev = state->prev_points[index];
+		Vector2i cell(index % size.x, index / size.x);
+		const Vector2i prev_cell(prev % size.x, prev / size.x);
+		const Vector2i step(SGN(prev_cell.x - cell.x), SGN(prev_cell.y - cell.y));
+		while (cell != prev_cell) {
+			w[idx--] = cell;
+			cell += step;
+		}
+		index = prev;
+	}
+	w[idx] = p_from;
+
+	AStar::search_state_pool.release(state);
+	return path;
+}
+
+void AStarGrid2D::set_size(const Vector2i &p_size) {
+	ERR_FAIL_COND(p_size.x < 0 || p_size.y < 0);
+	size = p_size;
+
+	// All the cells are walkable.
+	walkable_data.resize((size.x * size.y + 7) / 8);
+	walkable_data.fill(0xFF);
+	jump_distances_dirty.set();
+}
+
+Vector2i AStarGrid2D::get_size() const {
+	return size;
+}
+
+void AStarGrid2D::set_cell_size(const Vector2 &p_cell_size) {
+	cell_size = p_cell_size;
+}
+
+Vector2 AStarGrid2D::get_cell_size() const {
+	return cell_size;
+}
+
+void AStarGrid2D::set_walkable_data(const Vector<uint8_t> &p_data) {
+	ERR_FAIL_COND_MSG(p_data.size() != (size.x * size.y + 7) / 8, vformat("The walkable data must have one bit per cell of the grid (%d bytes).", (size.x * size.y + 7) / 8));
+	walkable_data = p_data;
+	jump_distances_dirty.set();
+}
+
+Vector<uint8_t> AStarGrid2D::get_walkable_data() const {
+	return walkable_data;
+}
+
+bool AStarGrid2D::is_in_bounds(const Vector2i &p_cell) const {
+	return p_cell.x >= 0 && p_cell.y >= 0 && p_cell.x < size.x && p_cell.y < size.y;
+}
+
+void AStarGrid2D::set_point_solid(const Vector2i &p_cell, bool p_solid) {
+	ERR_FAIL_COND_MSG(!is_in_bounds(p_cell), vformat("Can't set if point is solid. Point %s out of bounds of the grid (%s).", p_cell, size));
+
+	const uint32_t ofs = p_cell.y * size.x + p_cell.x;
+	if (p_solid) {
+		walkable_data.write[ofs >> 3] &= ~(1 << (ofs & 7));
+	} else {
+		walkable_data.write[ofs >> 3] |= 1 << (ofs & 7);
+	}
+
+	if (!jump_distances_dirty.is_set()) {
+		// The cell only changes the distances along its row and column, and
+		// the jump points of the rows and columns next to it.
+		for (int y = MAX(p_cell.y - 1, 0); y <= MIN(p_cell.y + 1, size.y - 1); y++) {
+			_update_row_jump_distances(y);
+		}
+		for (int x = MAX(p_cell.x - 1, 0); x <= MIN(p_cell.x + 1, size.x - 1); x++) {
+			_update_column_jump_distances(x);
+		}
+	}
+}
+
+bool AStarGrid2D::is_point_solid(const Vector2i &p_cell) const {
+	ERR_FAIL_COND_V_MSG(!is_in_bounds(p_cell), false, vformat("Can't get if point is solid. Point %s out of bounds of the grid (%s).", p_cell, size));
+	return !_is_walkable(p_cell.x, p_cell.y);
+}
+
+Vector<Vector2> AStarGrid2D::get_point_path(const Vector2i &p_from, const Vector2i &p_to) {
+	const Vector<Vector2i> cell_path = _get_cell_path(p_from, p_to);
+
+	Vector<Vector2> path;
+	path.resize(cell_path.size());
+	Vector2 *w = path.ptrw();
+	for (int i = 0; i < cell_path.size(); i++) {
+		w[i] = Vector2(cell_path[i]) * cell_size;
+	}
+	return path;
+}
+
+TypedArray<Vector2i> AStarGrid2D::get_id_path(const Vector2i &p_from, const Vector2i &p_to) {
+	const Vector<Vector2i> cell_path = _get_cell_path(p_from, p_to);
+
+	TypedArray<Vector2i> path;
+	path.resize(cell_path.size());
+	for (int i = 0; i < cell_path.size(); i++) {
+		path[i] = cell_path[i];
+	}
+	return path;
+}
+
+void AStarGrid2D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_size", "size"), &AStarGrid2D::set_size);
+	ClassDB::bind_method(D_METHOD("get_size"), &AStarGrid2D::get_size);
+	ClassDB::bind_method(D_METHOD("set_cell_size", "cell_size"), &AStarGrid2D::set_cell_size);
+	ClassDB::bind_method(D_METHOD("get_cell_size"), &AStarGrid2D::get_cell_size);
+	ClassDB::bind_method(D_METHOD("set_walkable_data", "data"), &AStarGrid2D::set_walkable_data);
+	ClassDB::bind_method(D_METHOD("get_walkable_data"), &AStarGrid2D::get_walkable_data);
+
+	ClassDB::bind_method(D_METHOD("is_in_bounds", "id"), &AStarGrid2D::is_in_bounds);
+	ClassDB::bind_method(D_METHOD("set_point_solid", "id", "solid"), &AStarGrid2D::set_point_solid, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("is_point_solid", "id"), &AStarGrid2D::is_point_solid);
+
+	ClassDB::bind_method(D_METHOD("get_point_path", "from_id", "to_id"), &AStarGrid2D::get_point_path);
+	ClassDB::bind_method(D_METHOD("get_id_path", "from_id", "to_id"), &AStarGrid2D::get_id_path);
+
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2I, "size"), "set_size", "get_size");
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "cell_size"), "set_cell_size", "get_cell_size");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_BYTE_ARRAY, "walkable_data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_walkable_data", "get_walkable_data");
+}
@@ -0,0 +1,111 @@
+/*************************************************************************/
+/*  a_star_grid_2d.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef A_STAR_GRID_2D_H
+#define A_STAR_GRID_2D_H
+
+#include "core/math/a_star.h"
+#include "core/variant/typed_array.h"
+
+/**
+	A* pathfinding on a uniform grid, using Jump Point Search with
+	precomputed straight jump distances (JPS+).
+*/
+
+class AStarGrid2D : public RefCounted {
+	GDCLASS(AStarGrid2D, RefCounted);
+
+	enum JumpDirection {
+		JUMP_RIGHT,
+		JUMP_LEFT,
+		JUMP_DOWN,
+		JUMP_UP,
+		JUMP_MAX,
+	};
+
+	Vector2i size;
+	Vector2 cell_size = Vector2(1, 1);
+
+	// One bit per cell, row after row, set when the cell is walkable. Same
+	// layout as the BitMap data.
+	Vector<uint8_t> walkable_data;
+
+	// Distances from each cell along the straight directions, `JUMP_MAX`
+	// per cell. A positive distance is the number of steps to the next jump
+	// point, otherwise its opposite is the number of steps before a wall.
+	// Updated around the changed cells, or built again when the whole grid
+	// changes.
+	LocalVector<int32_t> jump_distances;
+	SafeFlag jump_distances_dirty{ true };
+	Mutex jump_distances_mutex;
+
+	_FORCE_INLINE_ bool _is_walkable(int p_x, int p_y) const {
+		if (p_x < 0 || p_y < 0 || p_x >= size.x || p_y >= size.y) {
+			return false;
+		}
+		const uint32_t ofs = p_y * size.x + p_x;
+		return walkable_data[ofs >> 3] & (1 << (ofs & 7));
+	}
+
+	bool _is_forced(int p_x, int p_y, int p_dx, int p_dy) const;
+	void _update_jump_distance(int p_x, int p_y, JumpDirection p_direction, int p_dx, int p_dy);
+	void _update_row_jump_distances(int p_y);
+	void _update_column_jump_distances(int p_x);
+	void _update_jump_distances();
+
+	bool _jump_straight(const Vector2i &p_from, int p_dx, int p_dy, const Vector2i &p_to, Vector2i &r_jump_point) const;
+	bool _jump_diagonal(const Vector2i &p_from, int p_dx, int p_dy, const Vector2i &p_to, Vector2i &r_jump_point) const;
+	bool _solve(AStar::SearchState &r_state, const Vector2i &p_from, const Vector2i &p_to) const;
+	Vector<Vector2i> _get_cell_path(const Vector2i &p_from, const Vector2i &p_to);
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_size(const Vector2i &p_size);
+	Vector2i get_size() const;
+	void set_cell_size(const Vector2 &p_cell_size);
+	Vector2 get_cell_size() const;
+
+	void set_walkable_data(const Vector<uint8_t> &p_data);
+	Vector<uint8_t> get_walkable_data() const;
+
+	bool is_in_bounds(const Vector2i &p_cell) const;
+	void set_point_solid(const Vector2i &p_cell, bool p_solid = true);
+	bool is_point_solid(const Vector2i &p_cell) const;
+
+	Vector<Vector2> get_point_path(const Vector2i &p_from, const Vector2i &p_to);
+	TypedArray<Vector2i> get_id_path(const Vector2i &p_from, const Vector2i &p_to);
+
+	AStarGrid2D() {}
+	~AStarGrid2D() {}
+};
+
+#endif // A_STAR_GRID_2D_H
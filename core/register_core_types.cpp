@@ -43,6 +43,7 @@
 #include "core/input/input_map.h"
 #include "core/io/config_file.h"
 #include "core/io/dtls_server.h"
+#include "core/io/file_access_async.h"
 #include "core/io/http_client.h"
 #include "core/io/image_loader.h"
 #include "core/io/json.h"
@@ -63,6 +64,7 @@
 #include "core/io/udp_server.h"
 #include "core/io/xml_parser.h"
 #include "core/math/a_star.h"
+#include "core/math/a_star_grid_2d.h"
 #include "core/math/expression.h"
 #include "core/math/geometry_2d.h"
 #include "core/math/geometry_3d.h"
@@ -92,6 +94,7 @@ static _Marshalls *_marshalls = nullptr;
 static _EngineDebugger *_engine_debugger = nullptr;
 
 static IP *ip = nullptr;
+static FileAccessAsync *file_access_async = nullptr;
 
 static _Geometry2D *_geometry_2d = nullptr;
 static _Geometry3D *_geometry_3d = nullptr;
@@ -219,6 +222,7 @@ void register_core_types() {
 	GDREGISTER_VIRTUAL_CLASS(PackedDataContainerRef);
 	GDREGISTER_CLASS(AStar);
 	GDREGISTER_CLASS(AStar2D);
+	GDREGISTER_CLASS(AStarGrid2D);
 	GDREGISTER_CLASS(EncodedObjectAsID);
 	GDREGISTER_CLASS(RandomNumberGenerator);
 
@@ -235,6 +239,7 @@ void register_core_types() {
 	native_extension_manager = memnew(NativeExtensionManager);
 
 	ip = IP::create();
+	file_access_async = FileAccessAsync::create();
 
 	_geometry_2d = memnew(_Geometry2D);
 	_geometry_3d = memnew(_Geometry3D);
@@ -351,6 +356,10 @@ void unregister_core_types() {
 
 	ResourceLoader::finalize();
 
+	if (file_access_async) {
+		memdelete(file_access_async);
+	}
+
 	ClassDB::cleanup_defaults();
 	ObjectDB::cleanup();
 
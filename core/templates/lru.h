@@ -35,7 +35,7 @@
 #include "hash_map.h"
 #include "list.h"
 
-template <class TKey, class TData>
+template <class TKey, class TData, void (*BeforeEvict)(TKey &, TData &) = nullptr>
 class LRUCache {
 private:
 	struct Pair {
@@ -55,6 +55,15 @@ private:
 	HashMap<TKey, Element> _map;
 	size_t capacity;
 
+	void _evict_back() {
+		Element d = _list.back();
+		if constexpr (BeforeEvict != nullptr) {
+			BeforeEvict(d->get().key, d->get().data);
+		}
+		_map.erase(d->get().key);
+		_list.pop_back();
+	}
+
 public:
 	const TData *insert(const TKey &p_key, const TData &p_value) {
 		Element *e = _map.getptr(p_key);
@@ -67,9 +76,7 @@ public:
 		_map[p_key] = _list.front();
 
 		while (_map.size() > capacity) {
-			Element d = _list.back();
-			_map.erase(d->get().key);
-			_list.pop_back();
+			_evict_back();
 		}
 
 		return &n->get().data;
@@ -80,6 +87,25 @@ public:
 		_list.clear();
 	}
 
+	bool erase(const TKey &p_key) {
+		Element *e = _map.getptr(p_key);
+		if (!e) {
+			return false;
+		}
+		_list.erase(*e);
+		_map.erase(p_key);
+		return true;
+	}
+
+	// Evicts the least recently used entry, returns false if the cache was empty.
+	bool evict_least_recent() {
+		if (_list.is_empty()) {
+			return false;
+		}
+		_evict_back();
+		return true;
+	}
+
 	bool has(const TKey &p_key) const {
 		return _map.getptr(p_key);
 	}
@@ -102,14 +128,13 @@ public:
 	}
 
 	_FORCE_INLINE_ size_t get_capacity() const { return capacity; }
+	_FORCE_INLINE_ size_t get_size() const { return _map.size(); }
 
 	void set_capacity(size_t p_capacity) {
 		if (capacity > 0) {
 			capacity = p_capacity;
 			while (_map.size() > capacity) {
-				Element d = _list.back();
-				_map.erase(d->get().key);
-				_list.pop_back();
+				_evict_back();
 			}
 		}
 	}
@@ -35,39 +35,77 @@
 #include "core/os/keyboard.h"
 #include "core/string/string_buffer.h"
 
-char32_t VariantParser::StreamFile::get_char() {
-	return f->get_8();
+char32_t VariantParser::Stream::_refill_and_get_char() {
+	if (eof) {
+		return 0;
+	}
+
+	readahead_pointer = 0;
+	readahead_filled = _read_buffer(readahead_buffer, readahead_enabled ? READAHEAD_SIZE : 1);
+	if (readahead_filled == 0) {
+		// You need to try to read again when you have reached the end for EOF to be reported.
+		eof = true;
+		return 0;
+	}
+
+	return readahead_buffer[readahead_pointer++];
 }
 
-bool VariantParser::StreamFile::is_utf8() const {
-	return true;
+void VariantParser::Stream::_append_string_run(StringBuffer<> &r_str, int &r_line) {
+	// Copy everything up to the next character that needs special handling in a
+	// string literal in a single append, instead of one character at a time.
+	const char32_t *src = &readahead_buffer[readahead_pointer];
+	const uint32_t available = readahead_filled - readahead_pointer;
+	uint32_t run = 0;
+
+	while (run < available) {
+		const char32_t c = src[run];
+		if (c == '"' || c == '\\' || c == 0) {
+			break;
+		}
+		if (c == '\n') {
+			r_line++;
+		}
+		run++;
+	}
+
+	if (run > 0) {
+		r_str.append(src, run);
+		readahead_pointer += run;
+	}
 }
 
-bool VariantParser::StreamFile::is_eof() const {
-	return f->eof_reached();
+uint32_t VariantParser::StreamFile::_read_buffer(char32_t *p_buffer, uint32_t p_num_chars) {
+	// Files are read as bytes and widened in place (back to front, so nothing is
+	// overwritten before being read), the tokenizer takes care of UTF-8 decoding.
+	uint8_t *bytes = (uint8_t *)p_buffer;
+	uint64_t read = f->get_buffer(bytes, p_num_chars);
+	for (uint64_t i = read; i > 0; i--) {
+		p_buffer[i - 1] = bytes[i - 1];
+	}
+	return read;
 }
 
-char32_t VariantParser::StreamString::get_char() {
-	if (pos > s.length()) {
-		return 0;
-	} else if (pos == s.length()) {
-		// You need to try to read again when you have reached the end for EOF to be reported,
-		// so this works the same as files (like StreamFile does)
-		pos++;
+bool VariantParser::StreamFile::is_utf8() const {
+	return true;
+}
+
+uint32_t VariantParser::StreamString::_read_buffer(char32_t *p_buffer, uint32_t p_num_chars) {
+	int remaining = s.length() - pos;
+	if (remaining <= 0) {
 		return 0;
-	} else {
-		return s[pos++];
 	}
+
+	uint32_t read = MIN((uint32_t)remaining, p_num_chars);
+	memcpy(p_buffer, s.ptr() + pos, read * sizeof(char32_t));
+	pos += read;
+	return read;
 }
 
 bool VariantParser::StreamString::is_utf8() const {
 	return false;
 }
 
-bool VariantParser::StreamString::is_eof() const {
-	return pos > s.length();
-}
-
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 const char *VariantParser::tk_name[TK_MAX] = {
@@ -205,8 +243,9 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 				[[fallthrough]];
 			}
 			case '"': {
-				String str;
+				StringBuffer<> str;
 				while (true) {
+					p_stream->_append_string_run(str, line);
 					char32_t ch = p_stream->get_char();
 
 					if (ch == 0) {
@@ -289,16 +328,17 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 					}
 				}
 
+				String parsed = str.as_string();
 				if (p_stream->is_utf8()) {
-					str.parse_utf8(str.ascii(true).get_data());
+					parsed.parse_utf8(parsed.ascii(true).get_data());
 				}
 				if (string_name) {
 					r_token.type = TK_STRING_NAME;
-					r_token.value = StringName(str);
+					r_token.value = StringName(parsed);
 					string_name = false; //reset
 				} else {
 					r_token.type = TK_STRING;
-					r_token.value = str;
+					r_token.value = parsed;
 				}
 				return OK;
 
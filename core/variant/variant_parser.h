@@ -33,38 +33,76 @@
 
 #include "core/io/file_access.h"
 #include "core/io/resource.h"
+#include "core/string/string_buffer.h"
 #include "core/variant/variant.h"
 
 class VariantParser {
 public:
 	struct Stream {
-		virtual char32_t get_char() = 0;
-		virtual bool is_utf8() const = 0;
-		virtual bool is_eof() const = 0;
-
+	private:
+		enum {
+			READAHEAD_SIZE = 2048
+		};
+
+		// Characters are pulled from the backing storage in blocks, so the
+		// tokenizer does not pay for a virtual call (and, for files, a
+		// FileAccess call) on every character.
+		char32_t readahead_buffer[READAHEAD_SIZE];
+		uint32_t readahead_pointer = 0;
+		uint32_t readahead_filled = 0;
+		bool eof = false;
+
+		char32_t _refill_and_get_char();
+		void _append_string_run(StringBuffer<> &r_str, int &r_line);
+
+		friend class VariantParser;
+
+	protected:
+		// Reads up to p_num_chars characters into p_buffer and returns how many were read.
+		// Returning zero signals the end of the stream.
+		virtual uint32_t _read_buffer(char32_t *p_buffer, uint32_t p_num_chars) = 0;
+
+	public:
 		char32_t saved = 0;
 
+		// When disabled, characters are read one at a time so the position of the
+		// underlying storage matches what has been parsed (e.g. to copy the rest of a file).
+		bool readahead_enabled = true;
+
+		_FORCE_INLINE_ char32_t get_char() {
+			if (readahead_pointer < readahead_filled) {
+				return readahead_buffer[readahead_pointer++];
+			}
+			return _refill_and_get_char();
+		}
+		virtual bool is_utf8() const = 0;
+		bool is_eof() const { return eof; }
+
 		Stream() {}
 		virtual ~Stream() {}
 	};
 
 	struct StreamFile : public Stream {
+	protected:
+		virtual uint32_t _read_buffer(char32_t *p_buffer, uint32_t p_num_chars);
+
+	public:
 		FileAccess *f = nullptr;
 
-		virtual char32_t get_char();
 		virtual bool is_utf8() const;
-		virtual bool is_eof() const;
 
 		StreamFile() {}
 	};
 
 	struct StreamString : public Stream {
+	protected:
+		virtual uint32_t _read_buffer(char32_t *p_buffer, uint32_t p_num_chars);
+
+	public:
 		String s;
 		int pos = 0;
 
-		virtual char32_t get_char();
 		virtual bool is_utf8() const;
-		virtual bool is_eof() const;
 
 		StreamString() {}
 	};
@@ -0,0 +1,403 @@
+/*************************************************************************/
+/*  file_access_async_io_uring.cpp                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "file_access_async_io_uring.h"
+
+#ifdef IO_URING_ENABLED
+
+#include "core/config/project_settings.h"
+#include "core/io/file_access_pack.h"
+#include "core/os/os.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int _io_uring_setup(unsigned int p_entries, io_uring_params *p_params) {
+	return (int)syscall(__NR_io_uring_setup, p_entries, p_params);
+}
+
+static int _io_uring_enter(int p_fd, unsigned int p_to_submit, unsigned int p_min_complete, unsigned int p_flags) {
+	return (int)syscall(__NR_io_uring_enter, p_fd, p_to_submit, p_min_complete, p_flags, nullptr, 0);
+}
+
+static int _io_uring_register(int p_fd, unsigned int p_opcode, void *p_arg, unsigned int p_nr_args) {
+	return (int)syscall(__NR_io_uring_register, p_fd, p_opcode, p_arg, p_nr_args);
+}
+
+bool FileAccessAsyncIOUring::_init_ring() {
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	ring_fd = _io_uring_setup(RING_ENTRIES, &params);
+	if (ring_fd < 0) {
+		ring_fd = -1;
+		return false;
+	}
+
+	// IORING_OP_READ is only available since Linux 5.6, check for it.
+	const int probe_ops = 256;
+	io_uring_probe *probe = (io_uring_probe *)memalloc(sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op));
+	memset(probe, 0, sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op));
+	bool supported = _io_uring_register(ring_fd, IORING_REGISTER_PROBE, probe, probe_ops) >= 0 && probe->ops_len > IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+	can_advise = supported && probe->ops_len > IORING_OP_FADVISE && (probe->ops[IORING_OP_FADVISE].flags & IO_URING_OP_SUPPORTED);
+	memfree(probe);
+	if (!supported) {
+		_finish_ring();
+		return false;
+	}
+
+	sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (single_mmap) {
+		sq_ring_size = MAX(sq_ring_size, cq_ring_size);
+		cq_ring_size = sq_ring_size;
+	}
+
+	sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if (sq_ring == MAP_FAILED) {
+		sq_ring = nullptr;
+		_finish_ring();
+		return false;
+	}
+
+	if (single_mmap) {
+		cq_ring = sq_ring;
+	} else {
+		cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		if (cq_ring == MAP_FAILED) {
+			cq_ring = nullptr;
+			_finish_ring();
+			return false;
+		}
+	}
+
+	sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	void *sqes_map = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+	if (sqes_map == MAP_FAILED) {
+		_finish_ring();
+		return false;
+	}
+	sqes = (io_uring_sqe *)sqes_map;
+
+	uint8_t *sq = (uint8_t *)sq_ring;
+	sq_head = (uint32_t *)(sq + params.sq_off.head);
+	sq_tail = (uint32_t *)(sq + params.sq_off.tail);
+	sq_mask = *(uint32_t *)(sq + params.sq_off.ring_mask);
+	sq_entries = params.sq_entries;
+	sq_array = (uint32_t *)(sq + params.sq_off.array);
+
+	uint8_t *cq = (uint8_t *)cq_ring;
+	cq_head = (uint32_t *)(cq + params.cq_off.head);
+	cq_tail = (uint32_t *)(cq + params.cq_off.tail);
+	cq_mask = *(uint32_t *)(cq + params.cq_off.ring_mask);
+	cq_entries = params.cq_entries;
+	cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+
+	return true;
+}
+
+void FileAccessAsyncIOUring::_finish_ring() {
+	if (sqes) {
+		munmap(sqes, sqes_size);
+		sqes = nullptr;
+	}
+	if (cq_ring && cq_ring != sq_ring) {
+		munmap(cq_ring, cq_ring_size);
+	}
+	cq_ring = nullptr;
+	if (sq_ring) {
+		munmap(sq_ring, sq_ring_size);
+		sq_ring = nullptr;
+	}
+	if (ring_fd >= 0) {
+		close(ring_fd);
+		ring_fd = -1;
+	}
+}
+
+bool FileAccessAsyncIOUring::_push_sqe(uint8_t p_opcode, int p_fd, void *p_buffer, uint32_t p_length, uint64_t p_offset, uint64_t p_user_data, bool p_count, uint32_t p_advice) {
+	MutexLock lock(submit_mutex);
+
+	// Keep one completion slot free for the wake-up used on exit, so the kernel never
+	// has to drop or buffer completions.
+	if (p_count && in_flight + 1 >= cq_entries) {
+		return false;
+	}
+
+	uint32_t tail = *sq_tail;
+	if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+		return false;
+	}
+
+	uint32_t index = tail & sq_mask;
+	io_uring_sqe *sqe = &sqes[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode = p_opcode;
+	sqe->fd = p_fd;
+	sqe->addr = (uint64_t)(uintptr_t)p_buffer;
+	sqe->len = p_length;
+	sqe->off = p_offset;
+	sqe->fadvise_advice = p_advice;
+	sqe->user_data = p_user_data;
+	sq_array[index] = index;
+
+	__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	int ret;
+	do {
+		ret = _io_uring_enter(ring_fd, tail + 1 - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE), 0, 0);
+	} while (ret < 0 && errno == EINTR);
+	// On other errors the entry stays in the ring and is picked up by the next submission.
+
+	if (p_count) {
+		in_flight++;
+	}
+	return true;
+}
+
+bool FileAccessAsyncIOUring::_push_read(InFlightRead *p_read) {
+	uint8_t *buffer = p_read->request->data.ptrw() + p_read->done;
+	uint32_t length = (uint32_t)(p_read->length - p_read->done);
+	return _push_sqe(IORING_OP_READ, p_read->fd, buffer, length, p_read->offset + p_read->done, (uint64_t)(uintptr_t)p_read, true);
+}
+
+void FileAccessAsyncIOUring::_finish_read(InFlightRead *p_read, Error p_error) {
+	close(p_read->fd);
+	Request *request = p_read->request;
+	memdelete(p_read);
+	_complete(request, p_error);
+}
+
+void FileAccessAsyncIOUring::_read_completed(InFlightRead *p_read, int p_result) {
+	if (p_read->advise) {
+		// Only a hint, the prefetch is done whatever the result.
+		_finish_read(p_read, OK);
+		return;
+	}
+
+	if (p_result == -EINTR || p_result == -EAGAIN) {
+		p_result = 0;
+	} else if (p_result < 0) {
+		_finish_read(p_read, ERR_FILE_CANT_READ);
+		return;
+	} else if (p_result == 0) {
+		// Shorter than expected, the file was truncated meanwhile.
+		p_read->request->data.resize(p_read->done);
+		_finish_read(p_read, OK);
+		return;
+	}
+
+	p_read->done += p_result;
+	if (p_read->done == p_read->length) {
+		_finish_read(p_read, OK);
+		return;
+	}
+
+	// Partial read, queue the rest, or finish it here if the ring is busy.
+	if (_push_read(p_read)) {
+		return;
+	}
+	while (p_read->done < p_read->length) {
+		ssize_t read = pread(p_read->fd, p_read->request->data.ptrw() + p_read->done, p_read->length - p_read->done, p_read->offset + p_read->done);
+		if (read < 0 && errno == EINTR) {
+			continue;
+		}
+		if (read <= 0) {
+			p_read->request->data.resize(p_read->done);
+			_finish_read(p_read, read < 0 ? ERR_FILE_CANT_READ : OK);
+			return;
+		}
+		p_read->done += read;
+	}
+	_finish_read(p_read, OK);
+}
+
+void FileAccessAsyncIOUring::_reaper_function(void *p_userdata) {
+	FileAccessAsyncIOUring *faa = (FileAccessAsyncIOUring *)p_userdata;
+
+	while (true) {
+		int ret = _io_uring_enter(faa->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+		if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+			ERR_PRINT("io_uring_enter failed, stopping asynchronous reads (errno " + itos(errno) + ").");
+			break;
+		}
+
+		// Only this thread consumes completions.
+		uint32_t head = *faa->cq_head;
+		uint32_t tail = __atomic_load_n(faa->cq_tail, __ATOMIC_ACQUIRE);
+		while (head != tail) {
+			io_uring_cqe *cqe = &faa->cqes[head & faa->cq_mask];
+			uint64_t user_data = cqe->user_data;
+			int result = cqe->res;
+			head++;
+			__atomic_store_n(faa->cq_head, head, __ATOMIC_RELEASE);
+
+			if (user_data == 0) {
+				continue; // Wake-up.
+			}
+
+			faa->submit_mutex.lock();
+			faa->in_flight--;
+			faa->submit_mutex.unlock();
+
+			faa->_read_completed((InFlightRead *)(uintptr_t)user_data, result);
+		}
+
+		MutexLock lock(faa->submit_mutex);
+		if (faa->exit_reaper && faa->in_flight == 0) {
+			break;
+		}
+	}
+}
+
+void FileAccessAsyncIOUring::_submit(Request *p_request) {
+	// Only plain OS files can be read by the kernel, everything else goes through FileAccess.
+	// Prefetches of other files are dropped, the pool could only read them twice.
+	String path;
+	if (!PackedData::get_singleton() || PackedData::get_singleton()->is_disabled() || !PackedData::get_singleton()->has_path(p_request->path)) {
+		path = ProjectSettings::get_singleton() ? ProjectSettings::get_singleton()->globalize_path(p_request->path) : p_request->path;
+	}
+	if (!path.begins_with("/")) {
+		if (p_request->discard) {
+			_complete(p_request, OK);
+		} else {
+			_queue_in_pool(p_request);
+		}
+		return;
+	}
+
+	int fd = open(path.utf8().get_data(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		_complete(p_request, errno == ENOENT ? ERR_FILE_NOT_FOUND : ERR_FILE_CANT_OPEN);
+		return;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		_complete(p_request, ERR_FILE_CANT_OPEN);
+		return;
+	}
+
+	uint64_t file_length = st.st_size;
+	uint64_t offset = MIN(p_request->offset, file_length);
+	uint64_t length = file_length - offset;
+	if (p_request->length >= 0) {
+		length = MIN(length, (uint64_t)p_request->length);
+	}
+
+	if (p_request->discard) {
+		// Prefetch, let the kernel start its readahead in the background. Without ring
+		// support, fadvise only queues the readahead too, but the call may block a bit.
+		InFlightRead *advise = memnew(InFlightRead);
+		advise->request = p_request;
+		advise->fd = fd;
+		advise->advise = true;
+		if (!can_advise || length > UINT32_MAX || !_push_sqe(IORING_OP_FADVISE, fd, nullptr, (uint32_t)length, offset, (uint64_t)(uintptr_t)advise, true, POSIX_FADV_WILLNEED)) {
+			memdelete(advise);
+			posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+			close(fd);
+			_complete(p_request, OK);
+		}
+		return;
+	}
+
+	if (length == 0) {
+		close(fd);
+		_complete(p_request, OK);
+		return;
+	}
+
+	if (length > MAX_READ_SIZE) {
+		close(fd);
+		_queue_in_pool(p_request);
+		return;
+	}
+
+	p_request->data.resize(length);
+
+	InFlightRead *read = memnew(InFlightRead);
+	read->request = p_request;
+	read->fd = fd;
+	read->offset = offset;
+	read->length = length;
+
+	if (!_push_read(read)) {
+		// Ring full, the pool takes over.
+		memdelete(read);
+		close(fd);
+		_queue_in_pool(p_request);
+	}
+}
+
+FileAccessAsync *FileAccessAsyncIOUring::_create_io_uring() {
+	FileAccessAsyncIOUring *faa = memnew(FileAccessAsyncIOUring);
+	if (faa->ring_fd >= 0) {
+		return faa;
+	}
+
+	print_verbose("io_uring is not available, using threads for asynchronous file reads.");
+	memdelete(faa);
+	return memnew(FileAccessAsync);
+}
+
+void FileAccessAsyncIOUring::make_default() {
+	_create = _create_io_uring;
+}
+
+FileAccessAsyncIOUring::FileAccessAsyncIOUring() {
+	if (_init_ring()) {
+		reaper.start(_reaper_function, this);
+	}
+}
+
+FileAccessAsyncIOUring::~FileAccessAsyncIOUring() {
+	if (ring_fd < 0) {
+		return;
+	}
+
+	submit_mutex.lock();
+	exit_reaper = true;
+	submit_mutex.unlock();
+
+	// Wake up the reaper, it exits once all reads in flight are done.
+	while (!_push_sqe(IORING_OP_NOP, -1, nullptr, 0, 0, 0, false)) {
+		OS::get_singleton()->delay_usec(1000);
+	}
+	reaper.wait_to_finish();
+
+	_finish_ring();
+}
+
+#endif // IO_URING_ENABLED
@@ -0,0 +1,121 @@
+/*************************************************************************/
+/*  file_access_async_io_uring.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FILE_ACCESS_ASYNC_IO_URING_H
+#define FILE_ACCESS_ASYNC_IO_URING_H
+
+#include "core/io/file_access_async.h"
+
+#if defined(UNIX_ENABLED) && defined(__linux__) && !defined(__ANDROID__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(IO_URING_OP_SUPPORTED)
+#define IO_URING_ENABLED
+#endif
+#endif
+#endif
+
+#ifdef IO_URING_ENABLED
+
+// Submits reads of regular files to the kernel through io_uring (Linux 5.6+), using
+// the raw system calls. Paths that don't map to an OS file (e.g. inside a pack), or
+// requests that don't fit in the ring, go through the worker pool of the base class.
+// Prefetches are submitted as asynchronous fadvise operations (Linux 5.6+ too).
+// If the kernel doesn't support io_uring (or it's blocked), the base class is used instead.
+
+class FileAccessAsyncIOUring : public FileAccessAsync {
+	enum {
+		RING_ENTRIES = 64,
+		MAX_READ_SIZE = 1 << 30,
+	};
+
+	struct InFlightRead {
+		Request *request = nullptr;
+		int fd = -1;
+		uint64_t offset = 0;
+		uint64_t length = 0;
+		uint64_t done = 0;
+		bool advise = false; // Prefetch, only asks the kernel to read ahead.
+	};
+
+	int ring_fd = -1;
+
+	void *sq_ring = nullptr;
+	size_t sq_ring_size = 0;
+	void *cq_ring = nullptr;
+	size_t cq_ring_size = 0;
+	io_uring_sqe *sqes = nullptr;
+	size_t sqes_size = 0;
+
+	uint32_t *sq_head = nullptr;
+	uint32_t *sq_tail = nullptr;
+	uint32_t sq_mask = 0;
+	uint32_t sq_entries = 0;
+	uint32_t *sq_array = nullptr;
+
+	uint32_t *cq_head = nullptr;
+	uint32_t *cq_tail = nullptr;
+	uint32_t cq_mask = 0;
+	uint32_t cq_entries = 0;
+	io_uring_cqe *cqes = nullptr;
+
+	Mutex submit_mutex;
+	uint32_t in_flight = 0;
+	bool can_advise = false;
+	bool exit_reaper = false;
+	Thread reaper;
+
+	bool _init_ring();
+	void _finish_ring();
+	bool _push_sqe(uint8_t p_opcode, int p_fd, void *p_buffer, uint32_t p_length, uint64_t p_offset, uint64_t p_user_data, bool p_count, uint32_t p_advice = 0);
+	bool _push_read(InFlightRead *p_read);
+	void _read_completed(InFlightRead *p_read, int p_result);
+	void _finish_read(InFlightRead *p_read, Error p_error);
+
+	static void _reaper_function(void *p_userdata);
+	static FileAccessAsync *_create_io_uring();
+
+protected:
+	virtual void _submit(Request *p_request) override;
+
+public:
+	virtual bool can_prefetch() const override { return true; }
+	virtual String get_backend_name() const override { return "io_uring"; }
+
+	static void make_default();
+
+	FileAccessAsyncIOUring();
+	virtual ~FileAccessAsyncIOUring();
+};
+
+#endif // IO_URING_ENABLED
+
+#endif // FILE_ACCESS_ASYNC_IO_URING_H
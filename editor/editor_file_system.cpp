@@ -37,13 +37,15 @@
 #include "core/io/resource_saver.h"
 #include "core/os/os.h"
 #include "core/variant/variant_parser.h"
+#include "editor_import_cache.h"
 #include "editor_node.h"
 #include "editor_resource_preview.h"
 #include "editor_settings.h"
+#include "scene/resources/resource_format_text.h"
 
 EditorFileSystem *EditorFileSystem::singleton = nullptr;
 //the name is the version, to keep compatibility with different versions of Godot
-#define CACHE_FILE_NAME "filesystem_cache7"
+#define CACHE_FILE_NAME "filesystem_cache9"
 
 void EditorFileSystemDirectory::sort_files() {
 	files.sort_custom<FileInfoSort>();
@@ -253,7 +255,7 @@ void EditorFileSystem::_scan_filesystem() {
 
 			} else {
 				Vector<String> split = l.split("::");
-				ERR_CONTINUE(split.size() != 9);
+				ERR_CONTINUE(split.size() != 14);
 				String name = split[0];
 				String file;
 
@@ -280,6 +282,16 @@ void EditorFileSystem::_scan_filesystem() {
 					}
 				}
 
+				fc.size = split[9].to_int();
+				fc.hash = split[10].strip_edges();
+				fc.importer_name = split[11].get_slice("<>", 0);
+				fc.importer_version = split[11].get_slice("<>", 1).to_int();
+				String dest_files = split[12].strip_edges();
+				if (dest_files.length()) {
+					fc.import_dest_files = dest_files.split("<>");
+				}
+				fc.import_md5_modified_time = split[13].to_int();
+
 				file_cache[name] = fc;
 			}
 		}
@@ -314,14 +326,14 @@ void EditorFileSystem::_scan_filesystem() {
 	new_filesystem = memnew(EditorFileSystemDirectory);
 	new_filesystem->parent = nullptr;
 
-	DirAccess *d = DirAccess::create(DirAccess::ACCESS_RESOURCES);
-	d->change_dir("res://");
-	_scan_new_dir(new_filesystem, d, sp);
+	if (first_scan) {
+		fast_import_check_settings = revalidate_import_files ? String() : filesystem_settings_version_for_import;
+	}
+
+	_scan_new_dir(new_filesystem, "res://", sp);
 
 	file_cache.clear(); //clear caches, no longer needed
 
-	memdelete(d);
-
 	if (!first_scan) {
 		//on the first scan this is done from the main thread after re-importing
 		_save_filesystem_cache();
@@ -349,7 +361,40 @@ void EditorFileSystem::_thread_func(void *_userdata) {
 	sd->_scan_filesystem();
 }
 
-bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_imported_files) {
+void EditorFileSystem::_get_scan_importers(HashMap<String, ScanImporter> &r_importers) const {
+	List<Ref<ResourceImporter>> importers;
+	ResourceFormatImporter::get_singleton()->get_importers(&importers);
+
+	for (const Ref<ResourceImporter> &E : importers) {
+		String name = E->get_importer_name();
+		if (r_importers.has(name)) {
+			continue; // The first one registered wins, like in get_importer_by_name().
+		}
+		ScanImporter si;
+		si.importer = E;
+		si.format_version = E->get_format_version();
+		r_importers[name] = si;
+	}
+}
+
+Ref<ResourceImporter> EditorFileSystem::_get_importer(const String &p_name, const HashMap<String, ScanImporter> *p_importers, int &r_format_version) const {
+	if (p_importers) {
+		const ScanImporter *si = p_importers->getptr(p_name);
+		if (!si) {
+			return Ref<ResourceImporter>();
+		}
+		r_format_version = si->format_version;
+		return si->importer;
+	}
+
+	Ref<ResourceImporter> importer = ResourceFormatImporter::get_singleton()->get_importer_by_name(p_name);
+	if (importer.is_valid()) {
+		r_format_version = importer->get_format_version();
+	}
+	return importer;
+}
+
+bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_imported_files, ImportInfo *r_info, const HashMap<String, ScanImporter> *p_importers) const {
 	if (!reimport_on_missing_imported_files && p_only_imported_files) {
 		return false;
 	}
@@ -358,11 +403,6 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 		return true;
 	}
 
-	if (!ResourceFormatImporter::get_singleton()->are_import_settings_valid(p_path)) {
-		//reimport settings are not valid, reimport
-		return true;
-	}
-
 	Error err;
 	FileAccess *f = FileAccess::open(p_path + ".import", FileAccess::READ, &err);
 
@@ -389,6 +429,7 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 	String dest_md5 = "";
 	int version = 0;
 	bool found_uid = false;
+	bool settings_valid = true;
 
 	while (true) {
 		assign = Variant();
@@ -418,6 +459,8 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 				importer_name = value;
 			} else if (assign == "uid") {
 				found_uid = true;
+			} else if (assign == "valid") {
+				settings_valid = value;
 			} else if (!p_only_imported_files) {
 				if (assign == "source_file") {
 					source_file = value;
@@ -433,6 +476,25 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 
 	memdelete(f);
 
+	// Known from here on, also for the early returns.
+	if (r_info) {
+		r_info->importer_name = importer_name;
+		r_info->importer_version = version;
+		r_info->dest_files.clear();
+		for (const String &E : to_check) {
+			r_info->dest_files.push_back(E);
+		}
+	}
+
+	int format_version = 0;
+	Ref<ResourceImporter> importer = _get_importer(importer_name, p_importers, format_version);
+
+	// Same as ResourceFormatImporter::are_import_settings_valid(), which asks every importer for its name.
+	if (!settings_valid || (importer.is_valid() && !importer->are_import_settings_valid(p_path))) {
+		//reimport settings are not valid, reimport
+		return true;
+	}
+
 	if (importer_name == "keep") {
 		return false; //keep mode, do not reimport
 	}
@@ -441,9 +503,11 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 		return true; //UUID not found, old format, reimport.
 	}
 
-	Ref<ResourceImporter> importer = ResourceFormatImporter::get_singleton()->get_importer_by_name(importer_name);
+	if (importer.is_null()) {
+		return true; // The importer is gone, possibly with a disabled plugin, reimporting reports it.
+	}
 
-	if (importer->get_format_version() > version) {
+	if (format_version > version) {
 		return true; // version changed, reimport
 	}
 
@@ -483,6 +547,8 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 	}
 	memdelete(md5s);
 
+	uint64_t md5_modified_time = FileAccess::get_modified_time(base_path + ".md5");
+
 	//imported files are gone, reimport
 	for (const String &E : to_check) {
 		if (!FileAccess::exists(E)) {
@@ -513,9 +579,74 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 		}
 	}
 
+	if (r_info) {
+		r_info->source_md5 = source_md5;
+		r_info->md5_modified_time = md5_modified_time;
+	}
+
 	return false; //nothing changed
 }
 
+bool EditorFileSystem::_is_cached_import_valid(const String &p_path, const String &p_importer_name, int p_importer_version, ResourceUID::ID p_uid, bool p_import_valid, uint64_t p_md5_modified_time, const Vector<String> &p_dest_files, const HashMap<String, ScanImporter> &p_importers) const {
+	if (p_importer_name == String()) {
+		return false; // Never checked, the .import file must be read.
+	}
+
+	if (p_importer_name == "keep") {
+		return true;
+	}
+
+	// The .import file is unchanged since the index was written, so this repeats the
+	// checks of _test_for_reimport() with what the index remembers of it.
+	if (!p_import_valid || p_uid == ResourceUID::INVALID_ID) {
+		return false;
+	}
+
+	int format_version = 0;
+	Ref<ResourceImporter> importer = _get_importer(p_importer_name, &p_importers, format_version);
+	if (importer.is_null() || format_version > p_importer_version || !importer->are_import_settings_valid(p_path)) {
+		return false;
+	}
+
+	String md5_path = ResourceFormatImporter::get_singleton()->get_import_base_path(p_path) + ".md5";
+	if (p_md5_modified_time == 0 || !FileAccess::exists(md5_path) || FileAccess::get_modified_time(md5_path) != p_md5_modified_time) {
+		return false;
+	}
+
+	if (reimport_on_missing_imported_files) {
+		for (int i = 0; i < p_dest_files.size(); i++) {
+			if (!FileAccess::exists(p_dest_files[i])) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+uint64_t EditorFileSystem::_get_file_size(const String &p_path) {
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+	return f ? f->get_length() : 0;
+}
+
+void EditorFileSystem::_check_file_contents(const String &p_path, uint64_t p_cached_size, const String &p_cached_hash, uint64_t &r_size, String &r_hash, bool &r_unchanged) const {
+	r_unchanged = false;
+	r_size = 0;
+	r_hash = String();
+
+	if (!FileAccess::exists(p_path)) {
+		return;
+	}
+	r_size = _get_file_size(p_path);
+
+	// A different size is enough to know it changed. Without a cached hash the new one
+	// can't tell anything now, but it lets the next modification be compared.
+	if (p_cached_hash == String() || r_size == p_cached_size) {
+		r_hash = FileAccess::get_md5(p_path);
+		r_unchanged = p_cached_hash != String() && r_hash == p_cached_hash;
+	}
+}
+
 bool EditorFileSystem::_update_scan_actions() {
 	sources_changed.clear();
 
@@ -581,15 +712,25 @@ bool EditorFileSystem::_update_scan_actions() {
 				int idx = ia.dir->find_file_index(ia.file);
 				ERR_CONTINUE(idx == -1);
 				String full_path = ia.dir->get_file_path(idx);
-				if (_test_for_reimport(full_path, false)) {
+				ImportInfo info;
+				if (_test_for_reimport(full_path, false, &info)) {
 					//must reimport
 					reimports.push_back(full_path);
 					reimports.append_array(_get_dependencies(full_path));
 				} else {
 					//must not reimport, all was good
 					//update modified times, to avoid reimport
-					ia.dir->files[idx]->modified_time = FileAccess::get_modified_time(full_path);
-					ia.dir->files[idx]->import_modified_time = FileAccess::get_modified_time(full_path + ".import");
+					EditorFileSystemDirectory::FileInfo *fi = ia.dir->files[idx];
+					fi->modified_time = FileAccess::get_modified_time(full_path);
+					fi->import_modified_time = FileAccess::get_modified_time(full_path + ".import");
+					fi->importer_name = info.importer_name;
+					fi->importer_version = info.importer_version;
+					fi->import_dest_files = info.dest_files;
+					fi->import_md5_modified_time = info.md5_modified_time;
+					if (info.source_md5 != String()) {
+						fi->size = _get_file_size(full_path);
+						fi->hash = info.source_md5;
+					}
 				}
 
 				fs_changed = true;
@@ -616,6 +757,7 @@ bool EditorFileSystem::_update_scan_actions() {
 		//only on first scan this is valid and updated, then settings changed.
 		revalidate_import_files = false;
 		filesystem_settings_version_for_import = ResourceFormatImporter::get_singleton()->get_import_settings_hash();
+		fast_import_check_settings = filesystem_settings_version_for_import;
 		_save_filesystem_cache();
 	}
 
@@ -650,10 +792,12 @@ void EditorFileSystem::scan() {
 		filesystem = new_filesystem;
 		new_filesystem = nullptr;
 		_update_scan_actions();
+		_watcher_add_dirs(filesystem);
 		scanning = false;
 		emit_signal(SNAME("filesystem_changed"));
 		emit_signal(SNAME("sources_changed"), sources_changed.size() > 0);
 		_queue_update_script_classes();
+		_prune_text_cache();
 		first_scan = false;
 	} else {
 		ERR_FAIL_COND(thread.is_started());
@@ -682,13 +826,31 @@ EditorFileSystem::ScanProgress EditorFileSystem::ScanProgress::get_sub(int p_cur
 	return sp;
 }
 
-void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess *da, const ScanProgress &p_progress) {
-	List<String> dirs;
-	List<String> files;
+void EditorFileSystem::_scan_dir_thread(uint32_t p_index, ScanThreadData *p_data) {
+	ScannedDir &sd = p_data->scanned_dirs[p_index];
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_RESOURCES);
+	if (da->change_dir(sd.path) != OK) {
+		ERR_PRINT("Cannot go into subdir '" + sd.name + "'.");
+		sd.skip = true;
+		return;
+	}
 
 	String cd = da->get_current_dir();
 
-	p_dir->modified_time = FileAccess::get_modified_time(cd);
+	if (sd.parent != -1) {
+		String parent_path = sd.path.get_base_dir();
+		if (cd == parent_path || !cd.begins_with(parent_path)) {
+			sd.skip = true; //avoid recursion
+			return;
+		}
+	}
+
+	sd.path = cd;
+	sd.modified_time = FileAccess::get_modified_time(cd);
+
+	List<String> dirs;
+	List<String> files;
 
 	da->list_dir_begin();
 	while (true) {
@@ -712,7 +874,7 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 
 			dirs.push_back(f);
 
-		} else {
+		} else if (valid_extensions.has(f.get_extension().to_lower())) {
 			files.push_back(f);
 		}
 	}
@@ -722,71 +884,101 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 	dirs.sort_custom<NaturalNoCaseComparator>();
 	files.sort_custom<NaturalNoCaseComparator>();
 
-	int total = dirs.size() + files.size();
+	for (const String &E : dirs) {
+		sd.subdir_names.push_back(E);
+	}
+
+	sd.files.resize(files.size());
 	int idx = 0;
+	for (List<String>::Element *E = files.front(); E; E = E->next(), idx++) {
+		ScannedFile &sf = sd.files.write[idx];
+		sf.file = E->get();
+
+		String path = cd.plus_file(sf.file);
+		sf.modified_time = FileAccess::get_modified_time(path);
+
+		const FileCache *fc = file_cache.getptr(path);
+
+		bool unchanged = false;
+		if (fc && fc->modification_time == sf.modified_time) {
+			sf.size = fc->size;
+			sf.hash = fc->hash;
+			unchanged = true;
+		} else if (fc) {
+			// Touched, the hash tells if it really changed.
+			_check_file_contents(path, fc->size, fc->hash, sf.size, sf.hash, unchanged);
+		} else {
+			// Not in the cache, e.g. on the first scan. Only the size is recorded, the file is
+			// hashed once it gets modified, so a cold scan doesn't read the whole project.
+			sf.size = _get_file_size(path);
+		}
 
-	for (List<String>::Element *E = dirs.front(); E; E = E->next(), idx++) {
-		if (da->change_dir(E->get()) == OK) {
-			String d = da->get_current_dir();
+		if (import_extensions.has(sf.file.get_extension().to_lower())) {
+			//is imported
+			if (FileAccess::exists(path + ".import")) {
+				sf.import_modified_time = FileAccess::get_modified_time(path + ".import");
+			}
 
-			if (d == cd || !d.begins_with(cd)) {
-				da->change_dir(cd); //avoid recursion
-			} else {
-				EditorFileSystemDirectory *efd = memnew(EditorFileSystemDirectory);
+			if (unchanged && fc->import_modification_time == sf.import_modified_time) {
+				if (p_data->fast_import_check && _is_cached_import_valid(path, fc->importer_name, fc->importer_version, fc->uid, fc->import_valid, fc->import_md5_modified_time, fc->import_dest_files, p_data->importers)) {
+					sf.cache_valid = true;
+				} else if (!_test_for_reimport(path, true, &sf.import_info, &p_data->importers)) {
+					sf.cache_valid = true;
+					sf.import_info_valid = true;
+				}
+			}
+		} else {
+			sf.cache_valid = unchanged;
+		}
+	}
+}
 
-				efd->parent = p_dir;
-				efd->name = E->get();
+void EditorFileSystem::_build_scanned_dir(EditorFileSystemDirectory *p_dir, const LocalVector<ScannedDir> &p_scanned, int p_index, const ScanProgress &p_progress) {
+	const ScannedDir &sd = p_scanned[p_index];
+	const String &cd = sd.path;
 
-				_scan_new_dir(efd, da, p_progress.get_sub(idx, total));
+	p_dir->modified_time = sd.modified_time;
 
-				int idx2 = 0;
-				for (int i = 0; i < p_dir->subdirs.size(); i++) {
-					if (efd->name.naturalnocasecmp_to(p_dir->subdirs[i]->name) < 0) {
-						break;
-					}
-					idx2++;
-				}
-				if (idx2 == p_dir->subdirs.size()) {
-					p_dir->subdirs.push_back(efd);
-				} else {
-					p_dir->subdirs.insert(idx2, efd);
-				}
+	int total = sd.subdirs.size() + sd.files.size();
+	int idx = 0;
 
-				da->change_dir("..");
-			}
-		} else {
-			ERR_PRINT("Cannot go into subdir '" + E->get() + "'.");
+	for (uint32_t i = 0; i < sd.subdirs.size(); i++, idx++) {
+		const ScannedDir &sub = p_scanned[sd.subdirs[i]];
+		if (!sub.skip) {
+			EditorFileSystemDirectory *efd = memnew(EditorFileSystemDirectory);
+
+			efd->parent = p_dir;
+			efd->name = sub.name;
+
+			_build_scanned_dir(efd, p_scanned, sd.subdirs[i], p_progress.get_sub(idx, total));
+
+			// Already sorted by the scan.
+			p_dir->subdirs.push_back(efd);
 		}
 
 		p_progress.update(idx, total);
 	}
 
-	for (List<String>::Element *E = files.front(); E; E = E->next(), idx++) {
-		String ext = E->get().get_extension().to_lower();
-		if (!valid_extensions.has(ext)) {
-			continue; //invalid
-		}
+	for (int i = 0; i < sd.files.size(); i++, idx++) {
+		const ScannedFile &sf = sd.files[i];
+		String ext = sf.file.get_extension().to_lower();
 
 		EditorFileSystemDirectory::FileInfo *fi = memnew(EditorFileSystemDirectory::FileInfo);
-		fi->file = E->get();
+		fi->file = sf.file;
+		fi->size = sf.size;
+		fi->hash = sf.hash;
 
 		String path = cd.plus_file(fi->file);
 
 		FileCache *fc = file_cache.getptr(path);
-		uint64_t mt = FileAccess::get_modified_time(path);
 
 		if (import_extensions.has(ext)) {
 			//is imported
-			uint64_t import_mt = 0;
-			if (FileAccess::exists(path + ".import")) {
-				import_mt = FileAccess::get_modified_time(path + ".import");
-			}
-
-			if (fc && fc->modification_time == mt && fc->import_modification_time == import_mt && !_test_for_reimport(path, true)) {
+			if (sf.cache_valid) {
 				fi->type = fc->type;
 				fi->uid = fc->uid;
 				fi->deps = fc->deps;
-				fi->modified_time = fc->modification_time;
+				fi->modified_time = sf.modified_time;
 				fi->import_modified_time = fc->import_modification_time;
 
 				fi->import_valid = fc->import_valid;
@@ -795,11 +987,23 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				fi->script_class_extends = fc->script_class_extends;
 				fi->script_class_icon_path = fc->script_class_icon_path;
 
+				if (sf.import_info_valid) {
+					fi->importer_name = sf.import_info.importer_name;
+					fi->importer_version = sf.import_info.importer_version;
+					fi->import_dest_files = sf.import_info.dest_files;
+					fi->import_md5_modified_time = sf.import_info.md5_modified_time;
+				} else {
+					fi->importer_name = fc->importer_name;
+					fi->importer_version = fc->importer_version;
+					fi->import_dest_files = fc->import_dest_files;
+					fi->import_md5_modified_time = fc->import_md5_modified_time;
+				}
+
 				if (revalidate_import_files && !ResourceFormatImporter::get_singleton()->are_import_settings_valid(path)) {
 					ItemAction ia;
 					ia.action = ItemAction::ACTION_FILE_TEST_REIMPORT;
 					ia.dir = p_dir;
-					ia.file = E->get();
+					ia.file = sf.file;
 					scan_actions.push_back(ia);
 				}
 
@@ -827,15 +1031,15 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				ItemAction ia;
 				ia.action = ItemAction::ACTION_FILE_TEST_REIMPORT;
 				ia.dir = p_dir;
-				ia.file = E->get();
+				ia.file = sf.file;
 				scan_actions.push_back(ia);
 			}
 		} else {
-			if (fc && fc->modification_time == mt) {
+			if (sf.cache_valid) {
 				//not imported, so just update type if changed
 				fi->type = fc->type;
 				fi->uid = fc->uid;
-				fi->modified_time = fc->modification_time;
+				fi->modified_time = sf.modified_time;
 				fi->deps = fc->deps;
 				fi->import_modified_time = 0;
 				fi->import_valid = true;
@@ -848,7 +1052,7 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				fi->uid = ResourceLoader::get_resource_uid(path);
 				fi->script_class_name = _get_global_script_class(fi->type, path, &fi->script_class_extends, &fi->script_class_icon_path);
 				fi->deps = _get_dependencies(path);
-				fi->modified_time = mt;
+				fi->modified_time = sf.modified_time;
 				fi->import_modified_time = 0;
 				fi->import_valid = true;
 			}
@@ -862,16 +1066,16 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 			}
 		}
 
-		for (int i = 0; i < ScriptServer::get_language_count(); i++) {
-			ScriptLanguage *lang = ScriptServer::get_language(i);
+		for (int j = 0; j < ScriptServer::get_language_count(); j++) {
+			ScriptLanguage *lang = ScriptServer::get_language(j);
 			if (lang->supports_documentation() && fi->type == lang->get_type()) {
 				Ref<Script> script = ResourceLoader::load(path);
 				if (script == nullptr) {
 					continue;
 				}
 				const Vector<DocData::ClassDoc> &docs = script->get_documentation();
-				for (int j = 0; j < docs.size(); j++) {
-					EditorHelp::get_doc_data()->add_doc(docs[j]);
+				for (int k = 0; k < docs.size(); k++) {
+					EditorHelp::get_doc_data()->add_doc(docs[k]);
 				}
 			}
 		}
@@ -881,33 +1085,84 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 	}
 }
 
-void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const ScanProgress &p_progress) {
-	uint64_t current_mtime = FileAccess::get_modified_time(p_dir->get_path());
+void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, const String &p_path, const ScanProgress &p_progress) {
+	LocalVector<ScannedDir> scanned;
 
-	bool updated_dir = false;
-	String cd = p_dir->get_path();
+	ScannedDir root;
+	root.path = p_path;
+	scanned.push_back(root);
 
-	if (current_mtime != p_dir->modified_time || using_fat32_or_exfat) {
-		updated_dir = true;
-		p_dir->modified_time = current_mtime;
-		//ooooops, dir changed, see what's going on
+	ScanThreadData data;
+	data.fast_import_check = fast_import_check_settings != String() && fast_import_check_settings == ResourceFormatImporter::get_singleton()->get_import_settings_hash();
+	_get_scan_importers(data.importers);
 
-		//first mark everything as veryfied
+	// Walk the tree one level at a time, listing and checking the directories of each level in parallel.
+	// Everything that can't be done from other threads is done afterwards, in order, while building the tree.
+	uint32_t level_from = 0;
+	while (level_from < scanned.size()) {
+		uint32_t level_to = scanned.size();
 
-		for (int i = 0; i < p_dir->files.size(); i++) {
-			p_dir->files[i]->verified = false;
-		}
+		data.scanned_dirs = &scanned[level_from];
+		scan_threads.begin_work(level_to - level_from, this, &EditorFileSystem::_scan_dir_thread, &data);
+		scan_threads.end_work();
 
-		for (int i = 0; i < p_dir->subdirs.size(); i++) {
-			p_dir->get_subdir(i)->verified = false;
+		for (uint32_t i = level_from; i < level_to; i++) {
+			if (scanned[i].skip) {
+				continue;
+			}
+			for (int j = 0; j < scanned[i].subdir_names.size(); j++) {
+				ScannedDir sd;
+				sd.name = scanned[i].subdir_names[j];
+				sd.path = scanned[i].path.plus_file(sd.name);
+				sd.parent = i;
+				scanned[i].subdirs.push_back(scanned.size());
+				scanned.push_back(sd);
+			}
 		}
 
-		//then scan files and directories and check what's different
+		level_from = level_to;
+	}
+
+	if (!scanned[0].skip) {
+		_build_scanned_dir(p_dir, scanned, 0, p_progress);
+	}
+}
+
+void EditorFileSystem::_collect_changed_dirs(EditorFileSystemDirectory *p_dir, int p_parent, LocalVector<ChangedDir> &r_dirs) {
+	ChangedDir cd;
+	cd.dir = p_dir;
+	cd.path = p_dir->get_path();
+	cd.parent = p_parent;
+	cd.skip = !_watcher_is_dir_changed(cd.path);
+
+	int index = r_dirs.size();
+	r_dirs.push_back(cd);
+
+	for (int i = 0; i < p_dir->subdirs.size(); i++) {
+		_collect_changed_dirs(p_dir->subdirs[i], index, r_dirs);
+	}
+}
+
+void EditorFileSystem::_scan_changes_thread(uint32_t p_index, ScanThreadData *p_data) {
+	ChangedDir &cd = p_data->changed_dirs[p_index];
+	if (cd.skip) {
+		return;
+	}
+
+	EditorFileSystemDirectory *dir = cd.dir;
 
+	cd.modified_time = FileAccess::get_modified_time(cd.path);
+
+	if (cd.modified_time != dir->modified_time || using_fat32_or_exfat) {
+		//ooooops, dir changed, see what's going on
 		DirAccessRef da = DirAccess::create(DirAccess::ACCESS_RESOURCES);
 
-		Error ret = da->change_dir(cd);
-		ERR_FAIL_COND_MSG(ret != OK, "Cannot change to '" + cd + "' folder.");
+		if (da->change_dir(cd.path) != OK) {
+			cd.skip = true; // Removed, the parent directory notices it.
+			return;
+		}
+
+		cd.updated = true;
 
 		da->list_dir_begin();
 		while (true) {
@@ -924,146 +1179,245 @@ void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const
 				if (f.begins_with(".")) { // Ignore special and . / ..
 					continue;
 				}
+				cd.dir_names.push_back(f);
+			} else if (valid_extensions.has(f.get_extension().to_lower())) {
+				cd.file_names.push_back(f);
+			}
+		}
+
+		da->list_dir_end();
+	}
+
+	cd.files.resize(dir->files.size());
+
+	for (int i = 0; i < dir->files.size(); i++) {
+		const EditorFileSystemDirectory::FileInfo *fi = dir->files[i];
+		ChangedFile &cf = cd.files.write[i];
+
+		String path = cd.path.plus_file(fi->file);
+
+		if (import_extensions.has(fi->file.get_extension().to_lower())) {
+			//check here if file must be imported or not
+
+			cf.modified_time = FileAccess::get_modified_time(path);
+
+			if (cf.modified_time != fi->modified_time) {
+				bool unchanged;
+				_check_file_contents(path, fi->size, fi->hash, cf.size, cf.hash, unchanged);
+				if (!unchanged) {
+					cf.reimport = true; //it was modified, must be reimported.
+					continue;
+				}
+				cf.update_times = true;
+			}
+
+			if (!FileAccess::exists(path + ".import")) {
+				cf.reimport = true; //no .import file, obviously reimport
+			} else {
+				uint64_t import_mt = FileAccess::get_modified_time(path + ".import");
+				if (import_mt != fi->import_modified_time) {
+					cf.reimport = true;
+				} else if (p_data->fast_import_check && _is_cached_import_valid(path, fi->importer_name, fi->importer_version, fi->uid, fi->import_valid, fi->import_md5_modified_time, fi->import_dest_files, p_data->importers)) {
+					// Nothing changed since the last check.
+				} else if (_test_for_reimport(path, true, &cf.import_info, &p_data->importers)) {
+					cf.reimport = true;
+				} else {
+					cf.import_info_valid = true;
+				}
+			}
+		} else if (ResourceCache::has(path)) { //test for potential reload
+
+			cf.modified_time = FileAccess::get_modified_time(path);
+
+			if (cf.modified_time != fi->modified_time) {
+				bool unchanged;
+				_check_file_contents(path, fi->size, fi->hash, cf.size, cf.hash, unchanged);
+				if (unchanged) {
+					cf.update_times = true;
+				} else {
+					cf.reload = true;
+				}
+			}
+		}
+	}
+}
+
+void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const ScanProgress &p_progress) {
+	LocalVector<ChangedDir> dirs;
+	_collect_changed_dirs(p_dir, -1, dirs);
+
+	String import_settings = ResourceFormatImporter::get_singleton()->get_import_settings_hash();
+
+	// Check all directories in parallel first, then turn the results into actions in order.
+	ScanThreadData data;
+	data.changed_dirs = dirs.ptr();
+	data.fast_import_check = fast_import_check_settings != String() && fast_import_check_settings == import_settings;
+	_get_scan_importers(data.importers);
+
+	scan_threads.begin_work(dirs.size(), this, &EditorFileSystem::_scan_changes_thread, &data);
+	scan_threads.end_work();
+
+	for (uint32_t d = 0; d < dirs.size(); d++) {
+		ChangedDir &cd = dirs[d];
 
-				int idx = p_dir->find_dir_index(f);
+		if (cd.parent != -1) {
+			const ChangedDir &parent = dirs[cd.parent];
+			if (parent.removed) {
+				cd.removed = true;
+				continue;
+			}
+			if (parent.updated && !cd.dir->verified) {
+				//this directory was removed, add action to remove it
+				ItemAction ia;
+				ia.action = ItemAction::ACTION_DIR_REMOVE;
+				ia.dir = cd.dir;
+				scan_actions.push_back(ia);
+				cd.removed = true;
+				continue;
+			}
+		}
+
+		p_progress.update(d, dirs.size());
+
+		if (cd.skip) {
+			continue;
+		}
+
+		EditorFileSystemDirectory *dir = cd.dir;
+		const String &path = cd.path;
+
+		if (cd.updated) {
+			dir->modified_time = cd.modified_time;
+
+			//first mark everything as veryfied
+
+			for (int i = 0; i < dir->files.size(); i++) {
+				dir->files[i]->verified = false;
+			}
+
+			for (int i = 0; i < dir->subdirs.size(); i++) {
+				dir->get_subdir(i)->verified = false;
+			}
+
+			//then check what's different
+
+			for (int i = 0; i < cd.dir_names.size(); i++) {
+				const String &f = cd.dir_names[i];
+
+				int idx = dir->find_dir_index(f);
 				if (idx == -1) {
-					if (_should_skip_directory(cd.plus_file(f))) {
+					if (_should_skip_directory(path.plus_file(f))) {
 						continue;
 					}
 
 					EditorFileSystemDirectory *efd = memnew(EditorFileSystemDirectory);
 
-					efd->parent = p_dir;
+					efd->parent = dir;
 					efd->name = f;
-					DirAccess *d = DirAccess::create(DirAccess::ACCESS_RESOURCES);
-					d->change_dir(cd.plus_file(f));
-					_scan_new_dir(efd, d, p_progress.get_sub(1, 1));
-					memdelete(d);
+					_scan_new_dir(efd, path.plus_file(f), p_progress.get_sub(1, 1));
 
 					ItemAction ia;
 					ia.action = ItemAction::ACTION_DIR_ADD;
-					ia.dir = p_dir;
+					ia.dir = dir;
 					ia.file = f;
 					ia.new_dir = efd;
 					scan_actions.push_back(ia);
 				} else {
-					p_dir->subdirs[idx]->verified = true;
+					dir->subdirs[idx]->verified = true;
 				}
+			}
 
-			} else {
-				String ext = f.get_extension().to_lower();
-				if (!valid_extensions.has(ext)) {
-					continue; //invalid
-				}
+			for (int i = 0; i < cd.file_names.size(); i++) {
+				const String &f = cd.file_names[i];
 
-				int idx = p_dir->find_file_index(f);
+				int idx = dir->find_file_index(f);
 
 				if (idx == -1) {
 					//never seen this file, add actition to add it
 					EditorFileSystemDirectory::FileInfo *fi = memnew(EditorFileSystemDirectory::FileInfo);
 					fi->file = f;
 
-					String path = cd.plus_file(fi->file);
-					fi->modified_time = FileAccess::get_modified_time(path);
+					String file_path = path.plus_file(fi->file);
+					fi->modified_time = FileAccess::get_modified_time(file_path);
 					fi->import_modified_time = 0;
-					fi->type = ResourceLoader::get_resource_type(path);
-					fi->script_class_name = _get_global_script_class(fi->type, path, &fi->script_class_extends, &fi->script_class_icon_path);
-					fi->import_valid = ResourceLoader::is_import_valid(path);
-					fi->import_group_file = ResourceLoader::get_import_group_file(path);
+					fi->type = ResourceLoader::get_resource_type(file_path);
+					fi->script_class_name = _get_global_script_class(fi->type, file_path, &fi->script_class_extends, &fi->script_class_icon_path);
+					fi->import_valid = ResourceLoader::is_import_valid(file_path);
+					fi->import_group_file = ResourceLoader::get_import_group_file(file_path);
 
 					{
 						ItemAction ia;
 						ia.action = ItemAction::ACTION_FILE_ADD;
-						ia.dir = p_dir;
+						ia.dir = dir;
 						ia.file = f;
 						ia.new_file = fi;
 						scan_actions.push_back(ia);
 					}
 
-					if (import_extensions.has(ext)) {
+					if (import_extensions.has(f.get_extension().to_lower())) {
 						//if it can be imported, and it was added, it needs to be reimported
 						ItemAction ia;
 						ia.action = ItemAction::ACTION_FILE_TEST_REIMPORT;
-						ia.dir = p_dir;
+						ia.dir = dir;
 						ia.file = f;
 						scan_actions.push_back(ia);
 					}
 
 				} else {
-					p_dir->files[idx]->verified = true;
+					dir->files[idx]->verified = true;
 				}
 			}
 		}
 
-		da->list_dir_end();
-	}
-
-	for (int i = 0; i < p_dir->files.size(); i++) {
-		if (updated_dir && !p_dir->files[i]->verified) {
-			//this file was removed, add action to remove it
-			ItemAction ia;
-			ia.action = ItemAction::ACTION_FILE_REMOVE;
-			ia.dir = p_dir;
-			ia.file = p_dir->files[i]->file;
-			scan_actions.push_back(ia);
-			continue;
-		}
-
-		String path = cd.plus_file(p_dir->files[i]->file);
+		for (int i = 0; i < dir->files.size(); i++) {
+			EditorFileSystemDirectory::FileInfo *fi = dir->files[i];
 
-		if (import_extensions.has(p_dir->files[i]->file.get_extension().to_lower())) {
-			//check here if file must be imported or not
+			if (cd.updated && !fi->verified) {
+				//this file was removed, add action to remove it
+				ItemAction ia;
+				ia.action = ItemAction::ACTION_FILE_REMOVE;
+				ia.dir = dir;
+				ia.file = fi->file;
+				scan_actions.push_back(ia);
+				continue;
+			}
 
-			uint64_t mt = FileAccess::get_modified_time(path);
+			const ChangedFile &cf = cd.files[i];
 
-			bool reimport = false;
+			if (cf.import_info_valid) {
+				fi->importer_name = cf.import_info.importer_name;
+				fi->importer_version = cf.import_info.importer_version;
+				fi->import_dest_files = cf.import_info.dest_files;
+				fi->import_md5_modified_time = cf.import_info.md5_modified_time;
+			}
 
-			if (mt != p_dir->files[i]->modified_time) {
-				reimport = true; //it was modified, must be reimported.
-			} else if (!FileAccess::exists(path + ".import")) {
-				reimport = true; //no .import file, obviously reimport
-			} else {
-				uint64_t import_mt = FileAccess::get_modified_time(path + ".import");
-				if (import_mt != p_dir->files[i]->import_modified_time) {
-					reimport = true;
-				} else if (_test_for_reimport(path, true)) {
-					reimport = true;
-				}
+			if (cf.update_times) {
+				fi->modified_time = cf.modified_time; //only touched, avoid checking it again
 			}
 
-			if (reimport) {
+			if (cf.reimport) {
 				ItemAction ia;
 				ia.action = ItemAction::ACTION_FILE_TEST_REIMPORT;
-				ia.dir = p_dir;
-				ia.file = p_dir->files[i]->file;
+				ia.dir = dir;
+				ia.file = fi->file;
 				scan_actions.push_back(ia);
-			}
-		} else if (ResourceCache::has(path)) { //test for potential reload
-
-			uint64_t mt = FileAccess::get_modified_time(path);
-
-			if (mt != p_dir->files[i]->modified_time) {
-				p_dir->files[i]->modified_time = mt; //save new time, but test for reload
+			} else if (cf.reload) {
+				fi->modified_time = cf.modified_time; //save new time, but test for reload
+				fi->size = cf.size;
+				fi->hash = cf.hash;
 
 				ItemAction ia;
 				ia.action = ItemAction::ACTION_FILE_RELOAD;
-				ia.dir = p_dir;
-				ia.file = p_dir->files[i]->file;
+				ia.dir = dir;
+				ia.file = fi->file;
 				scan_actions.push_back(ia);
 			}
 		}
 	}
 
-	for (int i = 0; i < p_dir->subdirs.size(); i++) {
-		if (updated_dir && !p_dir->subdirs[i]->verified) {
-			//this directory was removed, add action to remove it
-			ItemAction ia;
-			ia.action = ItemAction::ACTION_DIR_REMOVE;
-			ia.dir = p_dir->subdirs[i];
-			scan_actions.push_back(ia);
-			continue;
-		}
-		_scan_fs_changes(p_dir->get_subdir(i), p_progress);
+	if (!data.fast_import_check) {
+		// Everything was checked against the current import settings.
+		fast_import_check_settings = import_settings;
 	}
 }
 
@@ -1102,6 +1456,7 @@ void EditorFileSystem::scan_changes() {
 	}
 
 	_update_extensions();
+	_watcher_poll();
 	sources_changed.clear();
 	scanning_changes = true;
 	scanning_changes_done = false;
@@ -1120,6 +1475,7 @@ void EditorFileSystem::scan_changes() {
 			if (_update_scan_actions()) {
 				emit_signal(SNAME("filesystem_changed"));
 			}
+			_watcher_add_dirs(filesystem);
 		}
 		scanning_changes = false;
 		scanning_changes_done = true;
@@ -1137,6 +1493,7 @@ void EditorFileSystem::scan_changes() {
 void EditorFileSystem::_notification(int p_what) {
 	switch (p_what) {
 		case NOTIFICATION_ENTER_TREE: {
+			_watcher_start();
 			call_deferred(SNAME("scan")); //this should happen after every editor node entered the tree
 
 		} break;
@@ -1161,6 +1518,7 @@ void EditorFileSystem::_notification(int p_what) {
 			}
 			filesystem = nullptr;
 			new_filesystem = nullptr;
+			_watcher_stop();
 
 		} break;
 		case NOTIFICATION_PROCESS: {
@@ -1175,6 +1533,7 @@ void EditorFileSystem::_notification(int p_what) {
 						if (_update_scan_actions()) {
 							emit_signal(SNAME("filesystem_changed"));
 						}
+						_watcher_add_dirs(filesystem);
 						emit_signal(SNAME("sources_changed"), sources_changed.size() > 0);
 						_queue_update_script_classes();
 						first_scan = false;
@@ -1189,9 +1548,11 @@ void EditorFileSystem::_notification(int p_what) {
 					new_filesystem = nullptr;
 					thread.wait_to_finish();
 					_update_scan_actions();
+					_watcher_add_dirs(filesystem);
 					emit_signal(SNAME("filesystem_changed"));
 					emit_signal(SNAME("sources_changed"), sources_changed.size() > 0);
 					_queue_update_script_classes();
+					_prune_text_cache();
 					first_scan = false;
 				}
 
@@ -1234,6 +1595,14 @@ void EditorFileSystem::_save_filesystem_cache(EditorFileSystemDirectory *p_dir,
 			}
 			s += p_dir->files[i]->deps[j];
 		}
+		s += "::" + itos(p_dir->files[i]->size) + "::" + p_dir->files[i]->hash + "::" + p_dir->files[i]->importer_name + "<>" + itos(p_dir->files[i]->importer_version) + "::";
+		for (int j = 0; j < p_dir->files[i]->import_dest_files.size(); j++) {
+			if (j > 0) {
+				s += "<>";
+			}
+			s += p_dir->files[i]->import_dest_files[j];
+		}
+		s += "::" + itos(p_dir->files[i]->import_md5_modified_time);
 
 		p_file->store_line(s);
 	}
@@ -1484,6 +1853,31 @@ void EditorFileSystem::update_script_classes() {
 	ResourceSaver::add_custom_savers();
 }
 
+void EditorFileSystem::_scan_text_cache_files(EditorFileSystemDirectory *p_dir, Set<String> &r_files) {
+	int filecount = p_dir->files.size();
+	const EditorFileSystemDirectory::FileInfo *const *files = p_dir->files.ptr();
+	for (int i = 0; i < filecount; i++) {
+		String ext = files[i]->file.get_extension().to_lower();
+		if (ext == "tscn" || ext == "tres") {
+			r_files.insert(ResourceFormatLoaderText::get_text_cache_file_name(p_dir->get_file_path(i), files[i]->modified_time));
+		}
+	}
+	for (int i = 0; i < p_dir->get_subdir_count(); i++) {
+		_scan_text_cache_files(p_dir->get_subdir(i), r_files);
+	}
+}
+
+void EditorFileSystem::_prune_text_cache() {
+	if (!filesystem || ResourceFormatLoaderText::get_text_cache_path().is_empty()) {
+		return;
+	}
+
+	// Only keep the binary conversions of the text resources as they are now.
+	Set<String> keep_files;
+	_scan_text_cache_files(filesystem, keep_files);
+	ResourceFormatLoaderText::prune_text_cache(keep_files);
+}
+
 void EditorFileSystem::_queue_update_script_classes() {
 	if (update_script_classes_queued.is_set()) {
 		return;
@@ -1559,6 +1953,8 @@ void EditorFileSystem::update_file(const String &p_file) {
 	fs->files[cpos]->script_class_name = _get_global_script_class(type, p_file, &fs->files[cpos]->script_class_extends, &fs->files[cpos]->script_class_icon_path);
 	fs->files[cpos]->import_group_file = ResourceLoader::get_import_group_file(p_file);
 	fs->files[cpos]->modified_time = FileAccess::get_modified_time(p_file);
+	fs->files[cpos]->size = 0;
+	fs->files[cpos]->hash = String(); // Saved from the editor, hashed again if it changes.
 	fs->files[cpos]->deps = _get_dependencies(p_file);
 	fs->files[cpos]->import_valid = ResourceLoader::is_import_valid(p_file);
 
@@ -1707,11 +2103,13 @@ Error EditorFileSystem::_reimport_group(const String &p_group_file, const Vector
 		FileAccessRef md5s = FileAccess::open(base_path + ".md5", FileAccess::WRITE);
 		ERR_FAIL_COND_V_MSG(!md5s, ERR_FILE_CANT_OPEN, "Cannot open MD5 file '" + base_path + ".md5'.");
 
-		md5s->store_line("source_md5=\"" + FileAccess::get_md5(file) + "\"");
+		String source_md5 = FileAccess::get_md5(file);
+		md5s->store_line("source_md5=\"" + source_md5 + "\"");
 		if (dest_paths.size()) {
 			md5s->store_line("dest_md5=\"" + FileAccess::get_multiple_md5(dest_paths) + "\"\n");
 		}
 		md5s->close();
+		uint64_t md5_modified_time = FileAccess::get_modified_time(base_path + ".md5");
 
 		EditorFileSystemDirectory *fs = nullptr;
 		int cpos = -1;
@@ -1724,6 +2122,12 @@ Error EditorFileSystem::_reimport_group(const String &p_group_file, const Vector
 		fs->files[cpos]->deps = _get_dependencies(file);
 		fs->files[cpos]->type = importer->get_resource_type();
 		fs->files[cpos]->import_valid = err == OK;
+		fs->files[cpos]->importer_name = importer->get_importer_name();
+		fs->files[cpos]->importer_version = importer->get_format_version();
+		fs->files[cpos]->import_dest_files = dest_paths;
+		fs->files[cpos]->import_md5_modified_time = md5_modified_time;
+		fs->files[cpos]->hash = source_md5;
+		fs->files[cpos]->size = _get_file_size(file);
 
 		//if file is currently up, maybe the source it was loaded from changed, so import math must be updated for it
 		//to reload properly
@@ -1799,6 +2203,10 @@ void EditorFileSystem::_reimport_file(const String &p_file, const Map<StringName
 		fs->files[cpos]->deps.clear();
 		fs->files[cpos]->type = "";
 		fs->files[cpos]->import_valid = false;
+		fs->files[cpos]->importer_name = "keep";
+		fs->files[cpos]->importer_version = 0;
+		fs->files[cpos]->import_dest_files.clear();
+		fs->files[cpos]->import_md5_modified_time = 0;
 		EditorResourcePreview::get_singleton()->check_for_invalidation(p_file);
 		return;
 	}
@@ -1846,10 +2254,26 @@ void EditorFileSystem::_reimport_file(const String &p_file, const Map<StringName
 	List<String> import_variants;
 	List<String> gen_files;
 	Variant metadata;
-	Error err = importer->import(p_file, base_path, params, &import_variants, &gen_files, &metadata);
+	Error err = OK;
+
+	String source_md5 = FileAccess::get_md5(p_file);
 
-	if (err != OK) {
-		ERR_PRINT("Error importing '" + p_file + "'.");
+	String cache_key;
+	if (import_cache_path != String() && importer->can_use_import_cache() && importer->get_save_extension() != String()) {
+		cache_key = EditorImportCache::get_key(p_file, source_md5, importer, opts, params);
+	}
+
+	if (cache_key != String() && EditorImportCache::fetch(import_cache_path, cache_key, base_path, importer->get_save_extension(), &import_variants, &metadata)) {
+		print_verbose("Reused cached import of '" + p_file + "'.");
+	} else {
+		err = importer->import(p_file, base_path, params, &import_variants, &gen_files, &metadata);
+
+		if (err != OK) {
+			ERR_PRINT("Error importing '" + p_file + "'.");
+		} else if (cache_key != String() && gen_files.is_empty()) {
+			// Files generated elsewhere in the project can't be restored from the cache.
+			EditorImportCache::store(import_cache_path, cache_key, base_path, importer->get_save_extension(), import_variants, metadata);
+		}
 	}
 
 	//as import is complete, save the .import file
@@ -1948,7 +2372,7 @@ void EditorFileSystem::_reimport_file(const String &p_file, const Map<StringName
 	FileAccess *md5s = FileAccess::open(base_path + ".md5", FileAccess::WRITE);
 	ERR_FAIL_COND_MSG(!md5s, "Cannot open MD5 file '" + base_path + ".md5'.");
 
-	md5s->store_line("source_md5=\"" + FileAccess::get_md5(p_file) + "\"");
+	md5s->store_line("source_md5=\"" + source_md5 + "\"");
 	if (dest_paths.size()) {
 		md5s->store_line("dest_md5=\"" + FileAccess::get_multiple_md5(dest_paths) + "\"\n");
 	}
@@ -1962,6 +2386,12 @@ void EditorFileSystem::_reimport_file(const String &p_file, const Map<StringName
 	fs->files[cpos]->type = importer->get_resource_type();
 	fs->files[cpos]->uid = uid;
 	fs->files[cpos]->import_valid = ResourceLoader::is_import_valid(p_file);
+	fs->files[cpos]->importer_name = importer->get_importer_name();
+	fs->files[cpos]->importer_version = importer->get_format_version();
+	fs->files[cpos]->import_dest_files = dest_paths;
+	fs->files[cpos]->import_md5_modified_time = FileAccess::get_modified_time(base_path + ".md5");
+	fs->files[cpos]->hash = source_md5;
+	fs->files[cpos]->size = _get_file_size(p_file);
 
 	if (ResourceUID::get_singleton()->has_id(uid)) {
 		ResourceUID::get_singleton()->set_id(uid, p_file);
@@ -2002,12 +2432,89 @@ void EditorFileSystem::_find_group_files(EditorFileSystemDirectory *efd, Map<Str
 }
 
 void EditorFileSystem::reimport_file_with_custom_parameters(const String &p_file, const String &p_importer, const Map<StringName, Variant> &p_custom_params) {
+	import_cache_path = EditorImportCache::get_cache_path();
 	_reimport_file(p_file, &p_custom_params, p_importer);
 }
 
+void EditorFileSystem::_find_import_dependencies(Vector<ImportFile> &r_files) {
+	HashMap<String, int> indices;
+	Vector<String> dirs;
+	for (int i = 0; i < r_files.size(); i++) {
+		indices[r_files[i].path] = i;
+		dirs.push_back(r_files[i].path.get_base_dir());
+	}
+
+	// A file waits for what it referenced when it was last imported, and for the lower import
+	// orders of its directory, where sources look for the assets they may have started to use.
+	// Files never imported before wait for every lower import order. The files are sorted by
+	// import order, so only earlier files are waited for and there are no cycles.
+	for (int i = 0; i < r_files.size(); i++) {
+		ImportFile &file = r_files.write[i];
+		Set<int> dependencies;
+
+		EditorFileSystemDirectory *fs = nullptr;
+		int cpos = -1;
+		bool imported_before = _find_file(file.path, &fs, cpos) && fs->files[cpos]->import_modified_time != 0;
+
+		if (imported_before) {
+			const Vector<String> &deps = fs->files[cpos]->deps;
+			for (int j = 0; j < deps.size(); j++) {
+				String dep = deps[j].get_slice("::", 0);
+				ResourceUID::ID uid = ResourceUID::get_singleton()->text_to_id(dep);
+				if (uid != ResourceUID::INVALID_ID && ResourceUID::get_singleton()->has_id(uid)) {
+					dep = ResourceUID::get_singleton()->get_id_path(uid);
+				}
+				const int *index = indices.getptr(dep);
+				if (index && *index < i) {
+					dependencies.insert(*index);
+				}
+			}
+		}
+
+		for (int j = 0; j < i && r_files[j].order < file.order; j++) {
+			if (!imported_before || dirs[j] == dirs[i]) {
+				dependencies.insert(j);
+			}
+		}
+
+		for (Set<int>::Element *E = dependencies.front(); E; E = E->next()) {
+			file.dependencies.push_back(E->get());
+			r_files.write[E->get()].dependents.push_back(i);
+		}
+		file.waiting = dependencies.size();
+	}
+}
+
+void EditorFileSystem::_import_done(ImportFile *p_files, int p_index, ImportThreadData *p_import_data) {
+	p_files[p_index].done = true;
+	for (uint32_t i = 0; i < p_files[p_index].dependents.size(); i++) {
+		ImportFile &dependent = p_files[p_files[p_index].dependents[i]];
+		dependent.waiting--;
+		if (dependent.waiting == 0 && dependent.in_threads) {
+			p_import_data->ready.push_back(p_files[p_index].dependents[i]);
+			p_import_data->ready_sem.post();
+		}
+	}
+}
+
 void EditorFileSystem::_reimport_thread(uint32_t p_index, ImportThreadData *p_import_data) {
-	p_import_data->max_index = MAX(p_import_data->reimport_from + int(p_index), p_import_data->max_index);
-	_reimport_file(p_import_data->reimport_files[p_import_data->reimport_from + p_index].path);
+	// Each call imports one of the files that are ready, not necessarily the p_index-th.
+	p_import_data->ready_sem.wait();
+	int index;
+	{
+		MutexLock lock(p_import_data->mutex);
+		index = p_import_data->ready[p_import_data->ready.size() - 1];
+		p_import_data->ready.resize(p_import_data->ready.size() - 1);
+	}
+
+	_reimport_file(p_import_data->reimport_files[index].path);
+
+	{
+		MutexLock lock(p_import_data->mutex);
+		_import_done(p_import_data->reimport_files, index, p_import_data);
+	}
+	p_import_data->last_imported.set(index);
+	p_import_data->imported.increment();
 }
 
 void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
@@ -2053,49 +2560,89 @@ void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 	}
 
 	reimport_files.sort();
+	_find_import_dependencies(reimport_files);
 
 	bool use_threads = GLOBAL_GET("editor/import/use_multiple_threads");
+	import_cache_path = EditorImportCache::get_cache_path();
+
+	ImportFile *files = reimport_files.ptrw();
+	int imported = 0;
+
+	while (imported < reimport_files.size()) {
+		// Import everything the pool can get to without waiting for a file whose importer
+		// can't run on threads. Those are imported here afterwards, one at a time, and
+		// never while the pool is importing.
+		int round_count = 0;
+		for (int i = 0; i < reimport_files.size(); i++) {
+			files[i].in_threads = use_threads && files[i].threaded && !files[i].done;
+			for (uint32_t j = 0; j < files[i].dependencies.size() && files[i].in_threads; j++) {
+				const ImportFile &dependency = files[files[i].dependencies[j]];
+				files[i].in_threads = dependency.done || dependency.in_threads;
+			}
+			if (files[i].in_threads) {
+				round_count++;
+			}
+		}
 
-	int from = 0;
-	for (int i = 0; i < reimport_files.size(); i++) {
-		if (use_threads && reimport_files[i].threaded) {
-			if (i + 1 == reimport_files.size() || reimport_files[i + 1].importer != reimport_files[from].importer) {
-				if (from - i == 0) {
-					//single file, do not use threads
-					pr.step(reimport_files[i].path.get_file(), i);
-					_reimport_file(reimport_files[i].path);
-				} else {
-					Ref<ResourceImporter> importer = ResourceFormatImporter::get_singleton()->get_importer_by_name(reimport_files[from].importer);
-					ERR_CONTINUE(!importer.is_valid());
-
-					importer->import_threaded_begin();
-
-					ImportThreadData data;
-					data.max_index = from;
-					data.reimport_from = from;
-					data.reimport_files = reimport_files.ptr();
-
-					import_threads.begin_work(i - from + 1, this, &EditorFileSystem::_reimport_thread, &data);
-					int current_index = from - 1;
-					do {
-						if (current_index < data.max_index) {
-							current_index = data.max_index;
-							pr.step(reimport_files[current_index].path.get_file(), current_index);
-						}
-						OS::get_singleton()->delay_usec(1);
-					} while (!import_threads.is_done_dispatching());
+		if (round_count > 1) {
+			ImportThreadData data;
+			data.reimport_files = files;
+
+			Vector<Ref<ResourceImporter>> threaded_importers;
+			Set<String> importer_names;
+			for (int i = 0; i < reimport_files.size(); i++) {
+				if (!files[i].in_threads) {
+					continue;
+				}
+				if (!importer_names.has(files[i].importer)) {
+					importer_names.insert(files[i].importer);
+					Ref<ResourceImporter> importer = ResourceFormatImporter::get_singleton()->get_importer_by_name(files[i].importer);
+					if (importer.is_valid()) {
+						importer->import_threaded_begin();
+						threaded_importers.push_back(importer);
+					}
+				}
+				if (files[i].waiting == 0) {
+					data.ready.push_back(i);
+					data.ready_sem.post();
+				}
+			}
 
-					import_threads.end_work();
+			import_threads.begin_work(round_count, this, &EditorFileSystem::_reimport_thread, &data);
 
-					importer->import_threaded_end();
+			int current_index = -1;
+			while (int(data.imported.get()) < round_count) {
+				int round_imported = data.imported.get();
+				if (round_imported > 0 && current_index < round_imported) {
+					current_index = round_imported;
+					pr.step(files[data.last_imported.get()].path.get_file(), imported + round_imported - 1);
 				}
+				OS::get_singleton()->delay_usec(1);
+			}
+
+			import_threads.end_work();
 
-				from = i + 1;
+			for (int i = 0; i < threaded_importers.size(); i++) {
+				threaded_importers.write[i]->import_threaded_end();
 			}
 
-		} else {
-			pr.step(reimport_files[i].path.get_file(), i);
-			_reimport_file(reimport_files[i].path);
+			imported += round_count;
+		}
+
+		// Then the files that are ready here, or the single file of a round not worth the pool.
+		ImportThreadData data;
+		for (int i = 0; i < reimport_files.size(); i++) {
+			if (files[i].done || files[i].waiting > 0) {
+				continue;
+			}
+			if (use_threads && files[i].threaded && (round_count > 1 || !files[i].in_threads)) {
+				continue; // Next round.
+			}
+
+			pr.step(files[i].path.get_file(), imported);
+			_reimport_file(files[i].path);
+			_import_done(files, i, &data);
+			imported++;
 		}
 	}
 
@@ -2256,6 +2803,71 @@ void EditorFileSystem::_update_extensions() {
 	}
 }
 
+void EditorFileSystem::_watcher_start() {
+	if (watcher || !EDITOR_GET("filesystem/directories/use_directory_watcher")) {
+		return;
+	}
+
+	watcher = DirWatcher::create();
+	if (!watcher) {
+		print_verbose("Directory watching is not available, all directories will be checked for changes.");
+		return;
+	}
+	watcher_needs_full_scan = true;
+
+	// Imported files are shared by the whole project, any change there means checking everything.
+	watcher->add_dir(ProjectSettings::IMPORTED_FILES_PATH);
+}
+
+void EditorFileSystem::_watcher_stop() {
+	if (watcher) {
+		memdelete(watcher);
+		watcher = nullptr;
+	}
+	changed_dirs.clear();
+}
+
+void EditorFileSystem::_watcher_add_dirs(EditorFileSystemDirectory *p_dir) {
+	if (!watcher || !p_dir) {
+		return;
+	}
+
+	String path = p_dir->get_path();
+	if (!watcher->is_watching(path)) {
+		Error err = watcher->add_dir(path);
+		if (err != OK) {
+			// Most likely out of watches, go back to checking everything.
+			WARN_PRINT("Could not watch '" + path + "' for changes (" + itos(err) + "), disabling the directory watcher.");
+			_watcher_stop();
+			return;
+		}
+		// Changes before the watch was added were missed.
+		watcher_needs_full_scan = true;
+	}
+
+	for (int i = 0; i < p_dir->get_subdir_count(); i++) {
+		_watcher_add_dirs(p_dir->get_subdir(i));
+	}
+}
+
+void EditorFileSystem::_watcher_poll() {
+	changed_dirs.clear();
+	watcher_scan_all = !watcher || watcher_needs_full_scan;
+	watcher_needs_full_scan = false;
+
+	if (!watcher) {
+		return;
+	}
+
+	if (!watcher->get_changes(changed_dirs) || changed_dirs.has(ProjectSettings::IMPORTED_FILES_PATH)) {
+		watcher_scan_all = true;
+	}
+}
+
+bool EditorFileSystem::_watcher_is_dir_changed(const String &p_path) const {
+	return !watcher || watcher_scan_all || changed_dirs.has(p_path);
+}
+
 EditorFileSystem::EditorFileSystem() {
 	ResourceLoader::import = _resource_import;
 	reimport_on_missing_imported_files = GLOBAL_DEF("editor/import/reimport_missing_imported_files", true);
@@ -2283,11 +2895,14 @@ EditorFileSystem::EditorFileSystem() {
 	scan_changes_pending = false;
 	revalidate_import_files = false;
 	import_threads.init();
+	scan_threads.init();
 	ResourceUID::get_singleton()->clear(); //will be updated on scan
 	ResourceSaver::set_get_resource_id_for_path(_resource_saver_get_resource_id_for_path);
 }
 
 EditorFileSystem::~EditorFileSystem() {
+	_watcher_stop();
 	import_threads.finish();
+	scan_threads.finish();
 	ResourceSaver::set_get_resource_id_for_path(nullptr);
 }
@@ -32,9 +32,12 @@
 #define EDITOR_FILE_SYSTEM_H
 
 #include "core/io/dir_access.h"
+#include "core/io/dir_watcher.h"
+#include "core/io/resource_importer.h"
 #include "core/os/thread.h"
 #include "core/os/thread_safe.h"
 #include "core/templates/safe_refcount.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/set.h"
 #include "core/templates/thread_work_pool.h"
 #include "scene/main/node.h"
@@ -65,6 +68,12 @@ class EditorFileSystemDirectory : public Object {
 		String script_class_name;
 		String script_class_extends;
 		String script_class_icon_path;
+		uint64_t size = 0;
+		String hash; // MD5 of the contents, empty if unknown.
+		String importer_name; // Empty if the import state was not checked yet.
+		int importer_version = 0;
+		Vector<String> import_dest_files;
+		uint64_t import_md5_modified_time = 0;
 	};
 
 	struct FileInfoSort {
@@ -136,6 +145,8 @@ class EditorFileSystem : public Node {
 	Thread thread;
 	static void _thread_func(void *_userdata);
 
+	ThreadWorkPool scan_threads;
+
 	EditorFileSystemDirectory *new_filesystem;
 
 	bool abort_scan;
@@ -169,10 +180,41 @@ class EditorFileSystem : public Node {
 		String script_class_name;
 		String script_class_extends;
 		String script_class_icon_path;
+		uint64_t size = 0;
+		String hash;
+		String importer_name;
+		int importer_version = 0;
+		Vector<String> import_dest_files;
+		uint64_t import_md5_modified_time = 0;
 	};
 
 	HashMap<String, FileCache> file_cache;
 
+	/* What the .import and .md5 files of an imported file say, filled by _test_for_reimport() */
+	struct ImportInfo {
+		String importer_name;
+		int importer_version = 0;
+		Vector<String> dest_files;
+		String source_md5;
+		uint64_t md5_modified_time = 0;
+	};
+
+	// Importers may be scripts, so the scan workers don't call them. The scan thread
+	// looks them up before starting the workers, which then only use this.
+	struct ScanImporter {
+		Ref<ResourceImporter> importer;
+		int format_version = 0;
+	};
+
+	void _get_scan_importers(HashMap<String, ScanImporter> &r_importers) const;
+	Ref<ResourceImporter> _get_importer(const String &p_name, const HashMap<String, ScanImporter> *p_importers, int &r_format_version) const;
+
+	// Import checks can use the importer info stored in the index only while the
+	// import settings are the ones it was written with.
+	String fast_import_check_settings;
+
+	bool _is_cached_import_valid(const String &p_path, const String &p_importer_name, int p_importer_version, ResourceUID::ID p_uid, bool p_import_valid, uint64_t p_md5_modified_time, const Vector<String> &p_dest_files, const HashMap<String, ScanImporter> &p_importers) const;
+
 	struct ScanProgress {
 		float low = 0;
 		float hi = 0;
@@ -181,6 +223,79 @@ class EditorFileSystem : public Node {
 		ScanProgress get_sub(int p_current, int p_total) const;
 	};
 
+	/* Results of the parallel part of the scans, consumed in order by the scan thread */
+	struct ScannedFile {
+		String file;
+		uint64_t modified_time = 0;
+		uint64_t import_modified_time = 0;
+		uint64_t size = 0;
+		String hash;
+		bool cache_valid = false; // The index entry is still good, only times may need updating.
+		bool import_info_valid = false;
+		ImportInfo import_info;
+	};
+
+	struct ScannedDir {
+		String path;
+		String name;
+		int parent = -1;
+		bool skip = false;
+		uint64_t modified_time = 0;
+		Vector<String> subdir_names;
+		LocalVector<int> subdirs;
+		Vector<ScannedFile> files;
+	};
+
+	struct ChangedFile {
+		uint64_t modified_time = 0;
+		uint64_t size = 0;
+		String hash;
+		bool reimport = false;
+		bool reload = false;
+		bool update_times = false; // Touched, but the contents did not change.
+		bool import_info_valid = false;
+		ImportInfo import_info;
+	};
+
+	struct ChangedDir {
+		EditorFileSystemDirectory *dir = nullptr;
+		String path;
+		int parent = -1;
+		bool skip = false; // Nothing changed according to the directory watcher.
+		bool removed = false;
+		bool updated = false;
+		uint64_t modified_time = 0;
+		Vector<String> dir_names;
+		Vector<String> file_names;
+		Vector<ChangedFile> files;
+	};
+
+	struct ScanThreadData {
+		ScannedDir *scanned_dirs = nullptr;
+		ChangedDir *changed_dirs = nullptr;
+		bool fast_import_check = false;
+		HashMap<String, ScanImporter> importers;
+	};
+
+	void _scan_dir_thread(uint32_t p_index, ScanThreadData *p_data);
+	void _scan_changes_thread(uint32_t p_index, ScanThreadData *p_data);
+	static uint64_t _get_file_size(const String &p_path);
+	void _check_file_contents(const String &p_path, uint64_t p_cached_size, const String &p_cached_hash, uint64_t &r_size, String &r_hash, bool &r_unchanged) const;
+	void _build_scanned_dir(EditorFileSystemDirectory *p_dir, const LocalVector<ScannedDir> &p_scanned, int p_index, const ScanProgress &p_progress);
+	void _collect_changed_dirs(EditorFileSystemDirectory *p_dir, int p_parent, LocalVector<ChangedDir> &r_dirs);
+
+	/* Directory watcher, marks directories with changes so scan_changes() can skip the rest */
+	DirWatcher *watcher = nullptr;
+	bool watcher_needs_full_scan = true;
+	bool watcher_scan_all = true;
+	Set<String> changed_dirs;
+
+	void _watcher_start();
+	void _watcher_stop();
+	void _watcher_add_dirs(EditorFileSystemDirectory *p_dir);
+	void _watcher_poll();
+	bool _watcher_is_dir_changed(const String &p_path) const;
+
 	void _save_filesystem_cache();
 	void _save_filesystem_cache(EditorFileSystemDirectory *p_dir, FileAccess *p_file);
 
@@ -193,7 +308,7 @@ class EditorFileSystem : public Node {
 	Set<String> valid_extensions;
 	Set<String> import_extensions;
 
-	void _scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess *da, const ScanProgress &p_progress);
+	void _scan_new_dir(EditorFileSystemDirectory *p_dir, const String &p_path, const ScanProgress &p_progress);
 
 	Thread thread_sources;
 	bool scanning_changes;
@@ -211,7 +326,7 @@ class EditorFileSystem : public Node {
 	void _reimport_file(const String &p_file, const Map<StringName, Variant> *p_custom_options = nullptr, const String &p_custom_importer = String());
 	Error _reimport_group(const String &p_group_file, const Vector<String> &p_files);
 
-	bool _test_for_reimport(const String &p_path, bool p_only_imported_files);
+	bool _test_for_reimport(const String &p_path, bool p_only_imported_files, ImportInfo *r_info = nullptr, const HashMap<String, ScanImporter> *p_importers = nullptr) const;
 
 	bool reimport_on_missing_imported_files;
 
@@ -222,8 +337,19 @@ class EditorFileSystem : public Node {
 		String importer;
 		bool threaded = false;
 		int order = 0;
+		LocalVector<int> dependencies; // Files of the same batch that must be imported first, by index.
+		LocalVector<int> dependents;
+		int waiting = 0; // Dependencies not imported yet.
+		bool in_threads = false; // Imported by the pool in the current round.
+		bool done = false;
 		bool operator<(const ImportFile &p_if) const {
-			return order == p_if.order ? (importer < p_if.importer) : (order < p_if.order);
+			if (order != p_if.order) {
+				return order < p_if.order;
+			}
+			if (threaded != p_if.threaded) {
+				return threaded; // Threaded first, so they are contiguous within an import order.
+			}
+			return importer < p_if.importer;
 		}
 	};
 
@@ -231,6 +357,9 @@ class EditorFileSystem : public Node {
 	SafeFlag update_script_classes_queued;
 	void _queue_update_script_classes();
 
+	void _scan_text_cache_files(EditorFileSystemDirectory *p_dir, Set<String> &r_files);
+	void _prune_text_cache();
+
 	String _get_global_script_class(const String &p_type, const String &p_path, String *r_extends, String *r_icon_path) const;
 
 	static Error _resource_import(const String &p_path);
@@ -246,11 +375,19 @@ class EditorFileSystem : public Node {
 	ThreadWorkPool import_threads;
 
 	struct ImportThreadData {
-		const ImportFile *reimport_files;
-		int reimport_from;
-		int max_index = 0;
+		ImportFile *reimport_files = nullptr;
+		Mutex mutex;
+		Semaphore ready_sem;
+		LocalVector<int> ready; // Files of the round with all their dependencies imported.
+		SafeNumeric<uint32_t> imported;
+		SafeNumeric<uint32_t> last_imported;
 	};
 
+	void _find_import_dependencies(Vector<ImportFile> &r_files);
+	void _import_done(ImportFile *p_files, int p_index, ImportThreadData *p_import_data);
+
+	String import_cache_path; // Shared import cache, empty if disabled.
+
 	void _reimport_thread(uint32_t p_index, ImportThreadData *p_import_data);
 
 	static ResourceUID::ID _resource_saver_get_resource_id_for_path(const String &p_path, bool p_generate);
@@ -0,0 +1,197 @@
+/*************************************************************************/
+/*  editor_import_cache.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "editor_import_cache.h"
+
+#include "core/config/project_settings.h"
+#include "core/io/config_file.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/resource_uid.h"
+#include "core/os/os.h"
+#include "core/variant/variant_parser.h"
+#include "core/version.h"
+#include "core/version_hash.gen.h"
+#include "editor_settings.h"
+
+String EditorImportCache::_get_artifact_suffix(const String &p_variant, const String &p_save_extension) {
+	// Same naming EditorFileSystem uses for the paths in the .import file.
+	if (p_variant == String()) {
+		return "." + p_save_extension;
+	}
+	return "." + p_variant + "." + p_save_extension;
+}
+
+String EditorImportCache::get_cache_path() {
+	String path = EDITOR_GET("filesystem/import/shared_import_cache_path");
+	return path.strip_edges();
+}
+
+String EditorImportCache::_get_referenced_file_md5(const ResourceImporter::ImportOption &p_option, const Variant &p_value) {
+	if (p_value.get_type() != Variant::STRING && p_value.get_type() != Variant::STRING_NAME) {
+		return String();
+	}
+
+	String path = p_value;
+	if (p_option.option.hint != PROPERTY_HINT_FILE && !path.begins_with("res://") && !path.begins_with("uid://")) {
+		return String();
+	}
+
+	ResourceUID::ID uid = ResourceUID::get_singleton()->text_to_id(path);
+	if (uid != ResourceUID::INVALID_ID && ResourceUID::get_singleton()->has_id(uid)) {
+		path = ResourceUID::get_singleton()->get_id_path(uid);
+	}
+
+	if (path == String() || !FileAccess::exists(path)) {
+		return String();
+	}
+	return FileAccess::get_md5(path);
+}
+
+String EditorImportCache::get_key(const String &p_source_file, const String &p_source_md5, const Ref<ResourceImporter> &p_importer, const List<ResourceImporter::ImportOption> &p_options, const Map<StringName, Variant> &p_params) {
+	// The same importer version can import differently in another engine build.
+	String key = "engine=" VERSION_FULL_BUILD "-" + String(VERSION_HASH) + "\n";
+	key += "source_md5=" + p_source_md5 + "\n";
+	key += "extension=" + p_source_file.get_extension().to_lower() + "\n";
+	key += "importer=" + p_importer->get_importer_name() + "\n";
+	key += "importer_version=" + itos(p_importer->get_format_version()) + "\n";
+	key += "settings=" + p_importer->get_import_settings_string() + "\n";
+
+	for (const ResourceImporter::ImportOption &E : p_options) {
+		String value;
+		const Map<StringName, Variant>::Element *v = p_params.find(E.option.name);
+		if (v) {
+			VariantWriter::write_to_string(v->get(), value);
+		}
+		key += E.option.name + "=" + value + "\n";
+
+		if (v) {
+			// Options naming other files (e.g. a normal map) depend on their contents too.
+			String md5 = _get_referenced_file_md5(E, v->get());
+			if (md5 != String()) {
+				key += E.option.name + ".md5=" + md5 + "\n";
+			}
+		}
+	}
+
+	return key.md5_text();
+}
+
+bool EditorImportCache::fetch(const String &p_cache_path, const String &p_key, const String &p_save_path, const String &p_save_extension, List<String> *r_platform_variants, Variant *r_metadata) {
+	String entry_path = p_cache_path.plus_file(p_key.substr(0, 2)).plus_file(p_key);
+
+	Ref<ConfigFile> entry;
+	entry.instantiate();
+	if (entry->load(entry_path.plus_file("entry.cfg")) != OK) {
+		return false;
+	}
+
+	Vector<String> variants = entry->get_value("entry", "variants", Vector<String>());
+	if (variants.is_empty()) {
+		variants.push_back(String());
+	}
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	String save_path = ProjectSettings::get_singleton()->globalize_path(p_save_path);
+
+	for (int i = 0; i < variants.size(); i++) {
+		String suffix = _get_artifact_suffix(variants[i], p_save_extension);
+		if (da->copy(entry_path.plus_file("artifact" + suffix), save_path + suffix) != OK) {
+			// Incomplete entry, import normally and let it be stored again.
+			return false;
+		}
+	}
+
+	r_platform_variants->clear();
+	for (int i = 0; i < variants.size(); i++) {
+		if (variants[i] != String()) {
+			r_platform_variants->push_back(variants[i]);
+		}
+	}
+	// Null metadata is not saved at all.
+	*r_metadata = entry->has_section_key("entry", "metadata") ? entry->get_value("entry", "metadata") : Variant();
+
+	return true;
+}
+
+void EditorImportCache::store(const String &p_cache_path, const String &p_key, const String &p_save_path, const String &p_save_extension, const List<String> &p_platform_variants, const Variant &p_metadata) {
+	String bucket_path = p_cache_path.plus_file(p_key.substr(0, 2));
+	String entry_path = bucket_path.plus_file(p_key);
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->dir_exists(entry_path)) {
+		return;
+	}
+
+	// Fill a private directory first and move it in place at the end, so other
+	// threads and editors sharing the cache never see a partial entry.
+	String tmp_path = entry_path + ".tmp" + itos(OS::get_singleton()->get_process_id()) + "_" + String::num_uint64(Thread::get_caller_id());
+	Error err = da->make_dir_recursive(tmp_path);
+	ERR_FAIL_COND_MSG(err != OK, "Cannot create import cache directory '" + tmp_path + "'.");
+
+	Vector<String> variants;
+	for (const String &E : p_platform_variants) {
+		variants.push_back(E);
+	}
+
+	String save_path = ProjectSettings::get_singleton()->globalize_path(p_save_path);
+
+	Vector<String> files;
+	if (variants.is_empty()) {
+		files.push_back(_get_artifact_suffix(String(), p_save_extension));
+	} else {
+		for (int i = 0; i < variants.size(); i++) {
+			files.push_back(_get_artifact_suffix(variants[i], p_save_extension));
+		}
+	}
+
+	for (int i = 0; i < files.size() && err == OK; i++) {
+		err = da->copy(save_path + files[i], tmp_path.plus_file("artifact" + files[i]));
+	}
+
+	if (err == OK) {
+		Ref<ConfigFile> entry;
+		entry.instantiate();
+		entry->set_value("entry", "variants", variants);
+		entry->set_value("entry", "metadata", p_metadata);
+		err = entry->save(tmp_path.plus_file("entry.cfg"));
+	}
+
+	if (err == OK && da->rename(tmp_path, entry_path) == OK) {
+		return;
+	}
+
+	// Failed, or someone else stored the same entry meanwhile.
+	if (da->change_dir(tmp_path) == OK) {
+		da->erase_contents_recursive();
+		da->change_dir(bucket_path);
+		da->remove(tmp_path);
+	}
+}
@@ -0,0 +1,51 @@
+/*************************************************************************/
+/*  editor_import_cache.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef EDITOR_IMPORT_CACHE_H
+#define EDITOR_IMPORT_CACHE_H
+
+#include "core/io/resource_importer.h"
+
+// Stores import results in a directory, keyed by the contents of the source
+// file and everything else that affects the import, so identical assets are
+// only imported once across projects, branches and machines sharing it.
+class EditorImportCache {
+	static String _get_artifact_suffix(const String &p_variant, const String &p_save_extension);
+	static String _get_referenced_file_md5(const ResourceImporter::ImportOption &p_option, const Variant &p_value);
+
+public:
+	static String get_cache_path();
+
+	static String get_key(const String &p_source_file, const String &p_source_md5, const Ref<ResourceImporter> &p_importer, const List<ResourceImporter::ImportOption> &p_options, const Map<StringName, Variant> &p_params);
+	static bool fetch(const String &p_cache_path, const String &p_key, const String &p_save_path, const String &p_save_extension, List<String> *r_platform_variants, Variant *r_metadata);
+	static void store(const String &p_cache_path, const String &p_key, const String &p_save_path, const String &p_save_extension, const List<String> &p_platform_variants, const Variant &p_metadata);
+};
+
+#endif // EDITOR_IMPORT_CACHE_H
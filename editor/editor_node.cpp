@@ -63,6 +63,7 @@
 #include "scene/gui/texture_progress_bar.h"
 #include "scene/main/window.h"
 #include "scene/resources/packed_scene.h"
+#include "scene/resources/resource_format_text.h"
 #include "servers/display_server.h"
 #include "servers/navigation_server_2d.h"
 #include "servers/navigation_server_3d.h"
@@ -5727,6 +5728,9 @@ EditorNode::EditorNode() {
 	}
 
 	FileAccess::set_backup_save(EDITOR_GET("filesystem/on_save/safe_save_on_backup_then_rename"));
+	if (EDITOR_GET("filesystem/on_load/cache_text_resources_as_binary")) {
+		ResourceFormatLoaderText::set_text_cache_path(EditorPaths::get_singleton()->get_project_data_dir().plus_file("text_cache"));
+	}
 
 	{
 		int display_scale = EditorSettings::get_singleton()->get("interface/editor/display_scale");
@@ -455,6 +455,14 @@ void EditorSettings::_load_defaults(Ref<ConfigFile> p_extra_config) {
 	hints["filesystem/directories/autoscan_project_path"] = PropertyInfo(Variant::STRING, "filesystem/directories/autoscan_project_path", PROPERTY_HINT_GLOBAL_DIR);
 	_initial_set("filesystem/directories/default_project_path", OS::get_singleton()->has_environment("HOME") ? OS::get_singleton()->get_environment("HOME") : OS::get_singleton()->get_system_dir(OS::SYSTEM_DIR_DOCUMENTS));
 	hints["filesystem/directories/default_project_path"] = PropertyInfo(Variant::STRING, "filesystem/directories/default_project_path", PROPERTY_HINT_GLOBAL_DIR);
+	_initial_set("filesystem/directories/use_directory_watcher", true);
+
+	// On load
+	_initial_set("filesystem/on_load/cache_text_resources_as_binary", false);
+
+	// Import
+	_initial_set("filesystem/import/shared_import_cache_path", "");
+	hints["filesystem/import/shared_import_cache_path"] = PropertyInfo(Variant::STRING, "filesystem/import/shared_import_cache_path", PROPERTY_HINT_GLOBAL_DIR);
 
 	// On save
 	_initial_set("filesystem/on_save/compress_binary_resources", true);
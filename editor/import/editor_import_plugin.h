@@ -52,6 +52,7 @@ public:
 	virtual int get_import_order() const override;
 	virtual void get_import_options(List<ImportOption> *r_options, int p_preset) const override;
 	virtual bool get_option_visibility(const String &p_option, const Map<StringName, Variant> &p_options) const override;
+	virtual bool can_use_import_cache() const override { return false; } // Scripts may depend on anything.
 	virtual Error import(const String &p_source_file, const String &p_save_path, const Map<StringName, Variant> &p_options, List<String> *r_platform_variants, List<String> *r_gen_files, Variant *r_metadata = nullptr) override;
 };
 
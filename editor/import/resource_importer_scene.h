@@ -175,6 +175,7 @@ public:
 	virtual void show_advanced_options(const String &p_path) override;
 
 	virtual bool can_import_threaded() const override { return false; }
+	virtual bool can_use_import_cache() const override { return false; }
 
 	ResourceImporterScene();
 };
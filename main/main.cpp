@@ -1096,6 +1096,16 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 					"memory/limits/multithreaded_server/rid_pool_prealloc",
 					PROPERTY_HINT_RANGE,
 					"0,500,1")); // No negative and limit to 500 due to crashes
+	GLOBAL_DEF("memory/limits/resource_cache/retention_budget_mb", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/resource_cache/retention_budget_mb",
+			PropertyInfo(Variant::INT,
+					"memory/limits/resource_cache/retention_budget_mb",
+					PROPERTY_HINT_RANGE,
+					"0,4096,1,or_greater"));
+	if (!editor && !project_manager) {
+		// The editor manages resource lifetimes itself (reloading, renaming), don't keep them around.
+		ResourceCache::set_retention_budget(uint64_t(int(GLOBAL_GET("memory/limits/resource_cache/retention_budget_mb"))) * 1024 * 1024);
+	}
 	GLOBAL_DEF("network/limits/debugger/max_chars_per_second", 32768);
 	ProjectSettings::get_singleton()->set_custom_property_info("network/limits/debugger/max_chars_per_second",
 			PropertyInfo(Variant::INT,
@@ -2635,6 +2645,9 @@ void Main::cleanup(bool p_force) {
 
 	OS::get_singleton()->delete_main_loop();
 
+	// Release retained resources while the servers and script languages they depend on are still around.
+	ResourceCache::clear_retained();
+
 	OS::get_singleton()->_cmdline.clear();
 	OS::get_singleton()->_execpath = "";
 	OS::get_singleton()->_local_clipboard = "";
@@ -73,6 +73,10 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_HITS);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_MISSES);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_EVICTIONS);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_RETAINED_MEMORY);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -112,6 +116,10 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/driver/output_latency",
+		"resources/cache_hits",
+		"resources/cache_misses",
+		"resources/cache_evictions",
+		"resources/retained_memory",
 
 	};
 
@@ -166,6 +174,14 @@ double Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case RESOURCE_CACHE_HITS:
+			return ResourceCache::get_hit_count();
+		case RESOURCE_CACHE_MISSES:
+			return ResourceCache::get_miss_count();
+		case RESOURCE_CACHE_EVICTIONS:
+			return ResourceCache::get_eviction_count();
+		case RESOURCE_CACHE_RETAINED_MEMORY:
+			return ResourceCache::get_retained_memory();
 
 		default: {
 		}
@@ -201,6 +217,10 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_MEMORY,
 
 	};
 
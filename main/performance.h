@@ -87,6 +87,10 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		RESOURCE_CACHE_HITS,
+		RESOURCE_CACHE_MISSES,
+		RESOURCE_CACHE_EVICTIONS,
+		RESOURCE_CACHE_RETAINED_MEMORY,
 		MONITOR_MAX
 	};
 
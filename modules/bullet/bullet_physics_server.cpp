@@ -231,6 +231,20 @@ int BulletPhysicsServer3D::space_get_contact_count(RID p_space) const {
 	return space->get_debug_contact_count();
 }
 
+PackedByteArray BulletPhysicsServer3D::space_save_state(RID p_space) const {
+	SpaceBullet *space = space_owner.getornull(p_space);
+	ERR_FAIL_COND_V(!space, PackedByteArray());
+
+	ERR_FAIL_V_MSG(PackedByteArray(), "Space state snapshots are not supported by the Bullet physics engine.");
+}
+
+Error BulletPhysicsServer3D::space_restore_state(RID p_space, const PackedByteArray &p_state) {
+	SpaceBullet *space = space_owner.getornull(p_space);
+	ERR_FAIL_COND_V(!space, ERR_INVALID_PARAMETER);
+
+	ERR_FAIL_V_MSG(ERR_UNAVAILABLE, "Space state snapshots are not supported by the Bullet physics engine.");
+}
+
 RID BulletPhysicsServer3D::area_create() {
 	AreaBullet *area = bulletnew(AreaBullet);
 	area->set_collision_layer(1);
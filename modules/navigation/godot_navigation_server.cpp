@@ -118,6 +118,7 @@ GodotNavigationServer::GodotNavigationServer() :
 }
 
 GodotNavigationServer::~GodotNavigationServer() {
+	finish_path_queries();
 	flush_queries();
 }
 
@@ -204,6 +205,20 @@ real_t GodotNavigationServer::map_get_edge_connection_margin(RID p_map) const {
 	return map->get_edge_connection_margin();
 }
 
+COMMAND_2(map_set_use_hierarchical_paths, RID, p_map, bool, p_enabled) {
+	NavMap *map = map_owner.getornull(p_map);
+	ERR_FAIL_COND(map == nullptr);
+
+	map->set_use_hierarchical_paths(p_enabled);
+}
+
+bool GodotNavigationServer::map_get_use_hierarchical_paths(RID p_map) const {
+	const NavMap *map = map_owner.getornull(p_map);
+	ERR_FAIL_COND_V(map == nullptr, false);
+
+	return map->get_use_hierarchical_paths();
+}
+
 Vector<Vector3> GodotNavigationServer::map_get_path(RID p_map, Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_layers) const {
 	const NavMap *map = map_owner.getornull(p_map);
 	ERR_FAIL_COND_V(map == nullptr, Vector<Vector3>());
@@ -239,6 +254,59 @@ RID GodotNavigationServer::map_get_closest_point_owner(RID p_map, const Vector3
 	return map->get_closest_point_owner(p_point);
 }
 
+Vector3 GodotNavigationServer::map_get_flow_direction(RID p_map, const PackedVector3Array &p_targets, const Vector3 &p_position, uint32_t p_layers) const {
+	const NavMap *map = map_owner.getornull(p_map);
+	ERR_FAIL_COND_V(map == nullptr, Vector3());
+
+	return map->get_flow_direction(p_targets, p_position, p_layers);
+}
+
+RID GodotNavigationServer::map_query_paths(RID p_map, const PackedVector3Array &p_origins, const PackedVector3Array &p_destinations, bool p_optimize, const PackedInt32Array &p_layers, const Callable &p_callback) const {
+	NavMap *map = map_owner.getornull(p_map);
+	ERR_FAIL_COND_V(map == nullptr, RID());
+	ERR_FAIL_COND_V_MSG(p_origins.size() != p_destinations.size(), RID(), "There must be one destination per origin.");
+	ERR_FAIL_COND_V_MSG(!p_layers.is_empty() && p_layers.size() != p_origins.size(), RID(), "There must be either no layers or one layers mask per origin.");
+
+	GodotNavigationServer *mut_this = const_cast<GodotNavigationServer *>(this);
+	MutexLock lock(mut_this->operations_mutex);
+	RID rid = path_query_owner.make_rid();
+	NavPathQuery *query = path_query_owner.getornull(rid);
+	query->set_self(rid);
+	query->map = map;
+	query->optimize = p_optimize;
+	query->origins = p_origins;
+	query->destinations = p_destinations;
+	query->layers = p_layers;
+	query->callback = p_callback;
+	query->paths.resize(p_origins.size());
+	mut_this->pending_path_queries.push_back(query);
+	return rid;
+}
+
+bool GodotNavigationServer::path_query_is_done(RID p_query) const {
+	GodotNavigationServer *mut_this = const_cast<GodotNavigationServer *>(this);
+	MutexLock lock(mut_this->operations_mutex);
+	const NavPathQuery *query = path_query_owner.getornull(p_query);
+	ERR_FAIL_COND_V(query == nullptr, false);
+
+	return query->done;
+}
+
+Array GodotNavigationServer::path_query_get_paths(RID p_query) const {
+	GodotNavigationServer *mut_this = const_cast<GodotNavigationServer *>(this);
+	MutexLock lock(mut_this->operations_mutex);
+	const NavPathQuery *query = path_query_owner.getornull(p_query);
+	ERR_FAIL_COND_V(query == nullptr, Array());
+	ERR_FAIL_COND_V_MSG(!query->done, Array(), "The paths of this query are not computed yet.");
+
+	Array paths;
+	paths.resize(query->paths.size());
+	for (uint32_t i = 0; i < query->paths.size(); i++) {
+		paths[i] = PackedVector3Array(query->paths[i]);
+	}
+	return paths;
+}
+
 RID GodotNavigationServer::region_create() const {
 	GodotNavigationServer *mut_this = const_cast<GodotNavigationServer *>(this);
 	MutexLock lock(mut_this->operations_mutex);
@@ -468,6 +536,13 @@ COMMAND_1(free, RID, p_object) {
 			agents[i]->set_map(nullptr);
 		}
 
+		// The pending queries of this map won't find any path.
+		for (uint32_t i = 0; i < pending_path_queries.size(); i++) {
+			if (pending_path_queries[i]->map == map) {
+				pending_path_queries[i]->map = nullptr;
+			}
+		}
+
 		int map_index = active_maps.find(map);
 		active_maps.remove(map_index);
 		active_maps_update_id.remove(map_index);
@@ -495,6 +570,13 @@ COMMAND_1(free, RID, p_object) {
 
 		agent_owner.free(p_object);
 
+	} else if (path_query_owner.owns(p_object)) {
+		NavPathQuery *query = path_query_owner.getornull(p_object);
+
+		// Running queries are always finished before the commands are flushed.
+		pending_path_queries.erase(query);
+		path_query_owner.free(p_object);
+
 	} else {
 		ERR_FAIL_COND("Invalid ID.");
 	}
@@ -519,25 +601,101 @@ void GodotNavigationServer::flush_queries() {
 }
 
 void GodotNavigationServer::process(real_t p_delta_time) {
+	// The path queries read the maps, they must be done before anything changes.
+	finish_path_queries();
+
 	flush_queries();
 
-	if (!active) {
-		return;
+	if (active) {
+		// In c++ we can't be sure that this is performed in the main thread
+		// even with mutable functions.
+		MutexLock lock(operations_mutex);
+		for (uint32_t i(0); i < active_maps.size(); i++) {
+			active_maps[i]->sync();
+			active_maps[i]->step(p_delta_time, work_pool);
+			active_maps[i]->dispatch_callbacks();
+
+			// Emit a signal if a map changed.
+			const uint32_t new_map_update_id = active_maps[i]->get_map_update_id();
+			if (new_map_update_id != active_maps_update_id[i]) {
+				emit_signal(SNAME("map_changed"), active_maps[i]->get_self());
+				active_maps_update_id[i] = new_map_update_id;
+			}
+		}
 	}
 
-	// In c++ we can't be sure that this is performed in the main thread
-	// even with mutable functions.
+	dispatch_path_queries();
+}
+
+void GodotNavigationServer::compute_path_query_job(uint32_t p_index, void *p_userdata) {
+	const PathQueryJob &job = path_query_jobs[p_index];
+	NavPathQuery *query = job.query;
+	const uint32_t layers = query->layers.is_empty() ? 1 : uint32_t(query->layers[job.index]);
+	query->paths[job.index] = query->map->get_path(query->origins[job.index], query->destinations[job.index], query->optimize, layers);
+}
+
+void GodotNavigationServer::dispatch_path_queries() {
 	MutexLock lock(operations_mutex);
-	for (uint32_t i(0); i < active_maps.size(); i++) {
-		active_maps[i]->sync();
-		active_maps[i]->step(p_delta_time);
-		active_maps[i]->dispatch_callbacks();
-
-		// Emit a signal if a map changed.
-		const uint32_t new_map_update_id = active_maps[i]->get_map_update_id();
-		if (new_map_update_id != active_maps_update_id[i]) {
-			emit_signal(SNAME("map_changed"), active_maps[i]->get_self());
-			active_maps_update_id[i] = new_map_update_id;
+	if (pending_path_queries.is_empty()) {
+		return;
+	}
+
+	// The maps were just synced and only change again during the next
+	// `process`, so the workers can read them until then.
+	path_query_jobs.clear();
+	for (uint32_t i = 0; i < pending_path_queries.size(); i++) {
+		NavPathQuery *query = pending_path_queries[i];
+		if (query->map != nullptr) {
+			for (uint32_t j = 0; j < query->paths.size(); j++) {
+				PathQueryJob job;
+				job.query = query;
+				job.index = j;
+				path_query_jobs.push_back(job);
+			}
+		}
+		running_path_queries.push_back(query);
+	}
+	pending_path_queries.clear();
+
+	if (path_query_jobs.is_empty()) {
+		return;
+	}
+
+	if (work_pool.get_thread_count() == 0) {
+		work_pool.init();
+	}
+	work_pool.begin_work(path_query_jobs.size(), this, &GodotNavigationServer::compute_path_query_job, nullptr);
+}
+
+void GodotNavigationServer::finish_path_queries() {
+	LocalVector<NavPathQuery *> finished;
+	{
+		MutexLock lock(operations_mutex);
+		if (work_pool.is_working()) {
+			work_pool.end_work();
+		}
+		path_query_jobs.clear();
+
+		for (uint32_t i = 0; i < running_path_queries.size(); i++) {
+			running_path_queries[i]->done = true;
+			if (!running_path_queries[i]->callback.is_null()) {
+				finished.push_back(running_path_queries[i]);
+			}
+		}
+		running_path_queries.clear();
+	}
+
+	// Call back without holding the lock, so the callbacks can use the server.
+	for (uint32_t i = 0; i < finished.size(); i++) {
+		// Copy the callback, as it may free the query.
+		const Callable callback = finished[i]->callback;
+		const Variant query = finished[i]->get_self();
+		const Variant *args[1] = { &query };
+		Variant ret;
+		Callable::CallError call_error;
+		callback.call(args, 1, ret, call_error);
+		if (call_error.error != Callable::CallError::CALL_OK) {
+			ERR_PRINT("Error calling the path query callback: " + Variant::get_callable_error_text(callback, args, 1, call_error));
 		}
 	}
 }
@@ -34,6 +34,7 @@
 #include "core/templates/local_vector.h"
 #include "core/templates/rid.h"
 #include "core/templates/rid_owner.h"
+#include "core/templates/thread_work_pool.h"
 #include "servers/navigation_server_3d.h"
 
 #include "nav_map.h"
@@ -68,6 +69,20 @@ struct SetCommand {
 	virtual void exec(GodotNavigationServer *server) = 0;
 };
 
+/// A batch of paths requested with `map_query_paths`.
+struct NavPathQuery : public NavRid {
+	NavMap *map = nullptr;
+	bool optimize = true;
+	Vector<Vector3> origins;
+	Vector<Vector3> destinations;
+	Vector<int32_t> layers;
+	Callable callback;
+
+	/// Written by the workers, one path per origin.
+	LocalVector<Vector<Vector3>> paths;
+	bool done = false;
+};
+
 class GodotNavigationServer : public NavigationServer3D {
 	Mutex commands_mutex;
 	/// Mutex used to make any operation threadsafe.
@@ -78,6 +93,20 @@ class GodotNavigationServer : public NavigationServer3D {
 	mutable RID_Owner<NavMap> map_owner;
 	mutable RID_Owner<NavRegion> region_owner;
 	mutable RID_Owner<RvoAgent> agent_owner;
+	mutable RID_Owner<NavPathQuery> path_query_owner;
+
+	struct PathQueryJob {
+		NavPathQuery *query = nullptr;
+		uint32_t index = 0;
+	};
+
+	/// Queries waiting for the next sync.
+	LocalVector<NavPathQuery *> pending_path_queries;
+	/// Queries being computed, the maps must not change until they are done.
+	LocalVector<NavPathQuery *> running_path_queries;
+	LocalVector<PathQueryJob> path_query_jobs;
+	/// Runs the path queries and, while no query is running, the avoidance.
+	ThreadWorkPool work_pool;
 
 	bool active = true;
 	LocalVector<NavMap *> active_maps;
@@ -102,6 +131,9 @@ public:
 	COMMAND_2(map_set_edge_connection_margin, RID, p_map, real_t, p_connection_margin);
 	virtual real_t map_get_edge_connection_margin(RID p_map) const;
 
+	COMMAND_2(map_set_use_hierarchical_paths, RID, p_map, bool, p_enabled);
+	virtual bool map_get_use_hierarchical_paths(RID p_map) const;
+
 	virtual Vector<Vector3> map_get_path(RID p_map, Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_layers = 1) const;
 
 	virtual Vector3 map_get_closest_point_to_segment(RID p_map, const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision = false) const;
@@ -109,6 +141,11 @@ public:
 	virtual Vector3 map_get_closest_point_normal(RID p_map, const Vector3 &p_point) const;
 	virtual RID map_get_closest_point_owner(RID p_map, const Vector3 &p_point) const;
 
+	virtual Vector3 map_get_flow_direction(RID p_map, const PackedVector3Array &p_targets, const Vector3 &p_position, uint32_t p_layers = 1) const;
+	virtual RID map_query_paths(RID p_map, const PackedVector3Array &p_origins, const PackedVector3Array &p_destinations, bool p_optimize, const PackedInt32Array &p_layers = PackedInt32Array(), const Callable &p_callback = Callable()) const;
+	virtual bool path_query_is_done(RID p_query) const;
+	virtual Array path_query_get_paths(RID p_query) const;
+
 	virtual RID region_create() const;
 	COMMAND_2(region_set_map, RID, p_region, RID, p_map);
 	COMMAND_2(region_set_layers, RID, p_region, uint32_t, p_layers);
@@ -140,6 +177,11 @@ public:
 
 	void flush_queries();
 	virtual void process(real_t p_delta_time);
+
+private:
+	void compute_path_query_job(uint32_t p_index, void *p_userdata);
+	void dispatch_path_queries();
+	void finish_path_queries();
 };
 
 #undef COMMAND_1
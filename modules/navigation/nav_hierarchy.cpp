@@ -0,0 +1,456 @@
+/*************************************************************************/
+/*  nav_hierarchy.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "nav_hierarchy.h"
+
+#include "nav_region.h"
+
+#include <algorithm>
+
+thread_local NavHierarchy::SearchScratch NavHierarchy::search_scratch;
+
+void NavHierarchy::build_clusters(NavRegion *p_region) {
+	std::vector<gd::Polygon> &polygons = p_region->get_polygons();
+	std::vector<gd::Cluster> &clusters = p_region->get_clusters();
+	clusters.clear();
+	p_region->get_portals().clear();
+
+	const uint32_t polygon_count = polygons.size();
+	if (polygon_count == 0) {
+		return;
+	}
+
+	// Size the grid cells so that, with the polygons spread over the two
+	// largest extents of the region, each cell holds about CLUSTER_POLYGONS.
+	AABB bounds(polygons[0].center, Vector3());
+	for (uint32_t i = 1; i < polygon_count; i++) {
+		bounds.expand_to(polygons[i].center);
+	}
+	real_t extents[3] = { bounds.size.x, bounds.size.y, bounds.size.z };
+	std::sort(extents, extents + 3);
+	const real_t area = MAX(extents[2], (real_t)CMP_EPSILON) * MAX(extents[1], (real_t)CMP_EPSILON);
+	const real_t cell_size = Math::sqrt(area * CLUSTER_POLYGONS / polygon_count);
+
+	// Group the polygons by cell.
+	struct PolygonKey {
+		int x = 0;
+		int y = 0;
+		int z = 0;
+		uint32_t polygon = 0;
+
+		bool operator<(const PolygonKey &p_other) const {
+			if (x != p_other.x) {
+				return x < p_other.x;
+			}
+			if (y != p_other.y) {
+				return y < p_other.y;
+			}
+			if (z != p_other.z) {
+				return z < p_other.z;
+			}
+			return polygon < p_other.polygon;
+		}
+
+		bool is_same_cell(const PolygonKey &p_other) const {
+			return x == p_other.x && y == p_other.y && z == p_other.z;
+		}
+	};
+
+	std::vector<PolygonKey> keys(polygon_count);
+	for (uint32_t i = 0; i < polygon_count; i++) {
+		const Vector3 cell = (polygons[i].center - bounds.position) / cell_size;
+		keys[i].x = int(Math::floor(cell.x));
+		keys[i].y = int(Math::floor(cell.y));
+		keys[i].z = int(Math::floor(cell.z));
+		keys[i].polygon = i;
+	}
+	std::sort(keys.begin(), keys.end());
+
+	LocalVector<uint32_t> polygon_cells;
+	polygon_cells.resize(polygon_count);
+	uint32_t cell = 0;
+	for (uint32_t i = 0; i < polygon_count; i++) {
+		if (i > 0 && !keys[i].is_same_cell(keys[i - 1])) {
+			cell++;
+		}
+		polygon_cells[keys[i].polygon] = cell;
+	}
+
+	// Split the cells in clusters of connected polygons.
+	for (uint32_t i = 0; i < polygon_count; i++) {
+		polygons[i].cluster = UINT32_MAX;
+	}
+
+	LocalVector<uint32_t> stack;
+	for (uint32_t i = 0; i < polygon_count; i++) {
+		const uint32_t first_polygon = keys[i].polygon;
+		if (polygons[first_polygon].cluster != UINT32_MAX) {
+			continue;
+		}
+
+		const uint32_t cluster_id = clusters.size();
+		clusters.resize(cluster_id + 1);
+		gd::Cluster &cluster = clusters[cluster_id];
+
+		polygons[first_polygon].cluster = cluster_id;
+		stack.push_back(first_polygon);
+		while (!stack.is_empty()) {
+			const uint32_t polygon_id = stack[stack.size() - 1];
+			stack.resize(stack.size() - 1);
+			cluster.polygons.push_back(polygon_id);
+
+			const gd::Polygon &polygon = polygons[polygon_id];
+			for (size_t e(0); e < polygon.edges.size(); e++) {
+				const gd::Edge &edge = polygon.edges[e];
+				for (int c = 0; c < edge.connections.size(); c++) {
+					gd::Polygon *other = edge.connections[c].polygon;
+					if (other->owner == p_region && other->cluster == UINT32_MAX && polygon_cells[other->id] == polygon_cells[polygon_id]) {
+						other->cluster = cluster_id;
+						stack.push_back(other->id);
+					}
+				}
+			}
+		}
+	}
+}
+
+void NavHierarchy::build_portals(NavRegion *p_region) {
+	const std::vector<gd::Polygon> &polygons = p_region->get_polygons();
+	std::vector<gd::Cluster> &clusters = p_region->get_clusters();
+	std::vector<gd::Portal> &portals = p_region->get_portals();
+
+	portals.clear();
+	for (size_t i(0); i < clusters.size(); i++) {
+		clusters[i].portals.clear();
+	}
+
+	struct Crossing {
+		uint32_t cluster = 0;
+		const NavRegion *other_region = nullptr;
+		uint32_t other_cluster = 0;
+		uint32_t polygon = 0;
+
+		bool operator<(const Crossing &p_other) const {
+			if (cluster != p_other.cluster) {
+				return cluster < p_other.cluster;
+			}
+			if (other_region != p_other.other_region) {
+				return other_region < p_other.other_region;
+			}
+			return other_cluster < p_other.other_cluster;
+		}
+
+		bool is_same_pair(const Crossing &p_other) const {
+			return cluster == p_other.cluster && other_region == p_other.other_region && other_cluster == p_other.other_cluster;
+		}
+	};
+
+	// All the connections leaving the clusters of this region.
+	std::vector<Crossing> crossings;
+	for (size_t i(0); i < polygons.size(); i++) {
+		const gd::Polygon &polygon = polygons[i];
+		for (size_t e(0); e < polygon.edges.size(); e++) {
+			const gd::Edge &edge = polygon.edges[e];
+			for (int c = 0; c < edge.connections.size(); c++) {
+				const gd::Polygon *other = edge.connections[c].polygon;
+				if (other->owner == p_region && other->cluster == polygon.cluster) {
+					continue;
+				}
+
+				Crossing crossing;
+				crossing.cluster = polygon.cluster;
+				crossing.other_region = other->owner;
+				crossing.other_cluster = other->cluster;
+				crossing.polygon = i;
+				crossings.push_back(crossing);
+			}
+		}
+	}
+	std::stable_sort(crossings.begin(), crossings.end());
+
+	// One portal towards each neighbouring cluster, at the crossing nearest
+	// to the middle of their boundary.
+	for (size_t begin(0); begin < crossings.size();) {
+		size_t end = begin + 1;
+		Vector3 middle = polygons[crossings[begin].polygon].center;
+		while (end < crossings.size() && crossings[end].is_same_pair(crossings[begin])) {
+			middle += polygons[crossings[end].polygon].center;
+			end++;
+		}
+		middle /= real_t(end - begin);
+
+		size_t best = begin;
+		real_t best_distance = 1e20;
+		for (size_t i = begin; i < end; i++) {
+			const real_t distance = polygons[crossings[i].polygon].center.distance_squared_to(middle);
+			if (distance < best_distance) {
+				best = i;
+				best_distance = distance;
+			}
+		}
+
+		const Crossing &crossing = crossings[best];
+		gd::Portal portal;
+		portal.cluster = crossing.cluster;
+		portal.polygon = crossing.polygon;
+		portal.position = polygons[crossing.polygon].center;
+		portal.other_region = crossing.other_region;
+		portal.other_cluster = crossing.other_cluster;
+
+		clusters[crossing.cluster].portals.push_back(portals.size());
+		portals.push_back(portal);
+
+		begin = end;
+	}
+
+	// The costs between the portals of each cluster.
+	SearchScratch &scratch = search_scratch;
+	for (uint32_t c = 0; c < clusters.size(); c++) {
+		const gd::Cluster &cluster = clusters[c];
+		for (uint32_t i = 0; i < cluster.portals.size(); i++) {
+			gd::Portal &portal = portals[cluster.portals[i]];
+			compute_cluster_distances(p_region, c, portal.polygon, portal.position, scratch);
+
+			for (uint32_t j = 0; j < cluster.portals.size(); j++) {
+				const gd::Portal &other = portals[cluster.portals[j]];
+				const float cost = scratch.distances[other.polygon];
+				if (i != j && cost < 1e30) {
+					gd::Portal::Link link;
+					link.portal = cluster.portals[j];
+					link.cost = cost;
+					portal.links.push_back(link);
+				}
+			}
+		}
+	}
+}
+
+void NavHierarchy::update_offsets(const std::vector<NavRegion *> &p_regions) {
+	cluster_count = 0;
+	portal_count = 0;
+	for (size_t r(0); r < p_regions.size(); r++) {
+		p_regions[r]->set_cluster_offset(cluster_count);
+		p_regions[r]->set_portal_offset(portal_count);
+		cluster_count += p_regions[r]->get_clusters().size();
+		portal_count += p_regions[r]->get_portals().size();
+	}
+}
+
+void NavHierarchy::compute_cluster_distances(const NavRegion *p_region, uint32_t p_cluster, uint32_t p_polygon, const Vector3 &p_position, SearchScratch &r_scratch) {
+	// Dijkstra over the polygon centers of the cluster.
+	const std::vector<gd::Polygon> &polygons = p_region->get_polygons();
+	const gd::Cluster &cluster = p_region->get_clusters()[p_cluster];
+	if (r_scratch.distances.size() < polygons.size()) {
+		r_scratch.distances.resize(polygons.size());
+	}
+	for (uint32_t i = 0; i < cluster.polygons.size(); i++) {
+		r_scratch.distances[cluster.polygons[i]] = 1e30;
+	}
+
+	std::vector<SearchScratch::OpenEntry> &open = r_scratch.open;
+	open.clear();
+
+	r_scratch.distances[p_polygon] = p_position.distance_to(polygons[p_polygon].center);
+	open.push_back({ r_scratch.distances[p_polygon], r_scratch.distances[p_polygon], p_polygon });
+
+	while (!open.empty()) {
+		const SearchScratch::OpenEntry entry = open.front();
+		std::pop_heap(open.begin(), open.end());
+		open.pop_back();
+		if (entry.traveled_distance > r_scratch.distances[entry.id]) {
+			continue;
+		}
+
+		const gd::Polygon &polygon = polygons[entry.id];
+		for (size_t e(0); e < polygon.edges.size(); e++) {
+			const gd::Edge &edge = polygon.edges[e];
+			for (int c = 0; c < edge.connections.size(); c++) {
+				const gd::Polygon *other = edge.connections[c].polygon;
+				if (other->owner != p_region || other->cluster != p_cluster) {
+					continue;
+				}
+
+				const float distance = entry.traveled_distance + polygon.center.distance_to(other->center);
+				if (distance < r_scratch.distances[other->id]) {
+					r_scratch.distances[other->id] = distance;
+					open.push_back({ distance, distance, other->id });
+					std::push_heap(open.begin(), open.end());
+				}
+			}
+		}
+	}
+}
+
+bool NavHierarchy::find_corridor(const gd::Polygon *p_begin_poly, const Vector3 &p_begin_point, const gd::Polygon *p_end_poly, const Vector3 &p_end_point, uint32_t p_layers, LocalVector<uint32_t> &r_clusters) const {
+	const NavRegion *begin_region = p_begin_poly->owner;
+	const NavRegion *end_region = p_end_poly->owner;
+	if (begin_region->get_clusters().empty() || end_region->get_clusters().empty()) {
+		return false;
+	}
+
+	const uint32_t begin_cluster = p_begin_poly->cluster;
+	const uint32_t end_cluster = p_end_poly->cluster;
+	if (begin_region == end_region && begin_cluster == end_cluster) {
+		return false;
+	}
+
+	SearchScratch &scratch = search_scratch;
+
+	// Costs from the begin and end points to the portals of their clusters.
+	const gd::Cluster &begin = begin_region->get_clusters()[begin_cluster];
+	const std::vector<gd::Portal> &begin_portals = begin_region->get_portals();
+	compute_cluster_distances(begin_region, begin_cluster, p_begin_poly->id, p_begin_point, scratch);
+	scratch.begin_costs.resize(begin.portals.size());
+	for (uint32_t i = 0; i < begin.portals.size(); i++) {
+		scratch.begin_costs[i] = scratch.distances[begin_portals[begin.portals[i]].polygon];
+	}
+
+	const gd::Cluster &end = end_region->get_clusters()[end_cluster];
+	const std::vector<gd::Portal> &end_portals = end_region->get_portals();
+	compute_cluster_distances(end_region, end_cluster, p_end_poly->id, p_end_point, scratch);
+	scratch.end_costs.resize(end.portals.size());
+	for (uint32_t i = 0; i < end.portals.size(); i++) {
+		scratch.end_costs[i] = scratch.distances[end_portals[end.portals[i]].polygon];
+	}
+
+	// A* over the portals of the map, with a node for each of the begin and end points.
+	const uint32_t begin_node = portal_count;
+	const uint32_t end_node = begin_node + 1;
+	scratch.distances.resize(end_node + 1);
+	scratch.previous.resize(end_node + 1);
+	scratch.node_regions.resize(end_node + 1);
+	for (uint32_t i = 0; i <= end_node; i++) {
+		scratch.distances[i] = 1e30;
+	}
+
+	std::vector<SearchScratch::OpenEntry> &open = scratch.open;
+	open.clear();
+	scratch.distances[begin_node] = 0.0;
+	open.push_back({ 0.0, 0.0, begin_node });
+
+	bool found = false;
+	while (!open.empty()) {
+		const SearchScratch::OpenEntry entry = open.front();
+		std::pop_heap(open.begin(), open.end());
+		open.pop_back();
+		if (entry.traveled_distance > scratch.distances[entry.id]) {
+			continue;
+		}
+		if (entry.id == end_node) {
+			found = true;
+			break;
+		}
+
+		if (entry.id == begin_node) {
+			for (uint32_t i = 0; i < begin.portals.size(); i++) {
+				const uint32_t node = begin_region->get_portal_offset() + begin.portals[i];
+				const float distance = scratch.begin_costs[i];
+				if (distance < scratch.distances[node]) {
+					scratch.distances[node] = distance;
+					scratch.previous[node] = begin_node;
+					scratch.node_regions[node] = begin_region;
+					open.push_back({ distance + float(begin_portals[begin.portals[i]].position.distance_to(p_end_point)), distance, node });
+					std::push_heap(open.begin(), open.end());
+				}
+			}
+			continue;
+		}
+
+		const NavRegion *region = scratch.node_regions[entry.id];
+		const uint32_t portal_id = entry.id - region->get_portal_offset();
+		const gd::Portal &portal = region->get_portals()[portal_id];
+
+		if (region == end_region && portal.cluster == end_cluster) {
+			for (uint32_t i = 0; i < end.portals.size(); i++) {
+				if (end.portals[i] == portal_id && scratch.end_costs[i] < 1e30) {
+					const float distance = entry.traveled_distance + scratch.end_costs[i];
+					if (distance < scratch.distances[end_node]) {
+						scratch.distances[end_node] = distance;
+						scratch.previous[end_node] = entry.id;
+						open.push_back({ distance, distance, end_node });
+						std::push_heap(open.begin(), open.end());
+					}
+				}
+			}
+		}
+
+		// The other portals of the cluster.
+		for (uint32_t i = 0; i < portal.links.size(); i++) {
+			const gd::Portal::Link &link = portal.links[i];
+			const uint32_t node = region->get_portal_offset() + link.portal;
+			const float distance = entry.traveled_distance + link.cost;
+			if (distance < scratch.distances[node]) {
+				scratch.distances[node] = distance;
+				scratch.previous[node] = entry.id;
+				scratch.node_regions[node] = region;
+				open.push_back({ distance + float(region->get_portals()[link.portal].position.distance_to(p_end_point)), distance, node });
+				std::push_heap(open.begin(), open.end());
+			}
+		}
+
+		// The portal of the neighbouring cluster towards this one, only in a region with compatible layers.
+		const NavRegion *other_region = portal.other_region;
+		if ((p_layers & other_region->get_layers()) == 0) {
+			continue;
+		}
+		const gd::Cluster &other_cluster = other_region->get_clusters()[portal.other_cluster];
+		for (uint32_t i = 0; i < other_cluster.portals.size(); i++) {
+			const gd::Portal &other = other_region->get_portals()[other_cluster.portals[i]];
+			if (other.other_region != region || other.other_cluster != portal.cluster) {
+				continue;
+			}
+
+			const uint32_t node = other_region->get_portal_offset() + other_cluster.portals[i];
+			const float distance = entry.traveled_distance + portal.position.distance_to(other.position);
+			if (distance < scratch.distances[node]) {
+				scratch.distances[node] = distance;
+				scratch.previous[node] = entry.id;
+				scratch.node_regions[node] = other_region;
+				open.push_back({ distance + float(other.position.distance_to(p_end_point)), distance, node });
+				std::push_heap(open.begin(), open.end());
+			}
+			break;
+		}
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	r_clusters.clear();
+	r_clusters.push_back(begin_region->get_cluster_offset() + begin_cluster);
+	r_clusters.push_back(end_region->get_cluster_offset() + end_cluster);
+	for (uint32_t node = scratch.previous[end_node]; node != begin_node; node = scratch.previous[node]) {
+		const NavRegion *region = scratch.node_regions[node];
+		r_clusters.push_back(region->get_cluster_offset() + region->get_portals()[node - region->get_portal_offset()].cluster);
+	}
+
+	return true;
+}
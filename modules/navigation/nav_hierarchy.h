@@ -0,0 +1,105 @@
+/*************************************************************************/
+/*  nav_hierarchy.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef NAV_HIERARCHY_H
+#define NAV_HIERARCHY_H
+
+#include "core/math/vector3.h"
+#include "core/templates/local_vector.h"
+#include "nav_utils.h"
+
+#include <vector>
+
+/// Abstract graph over the map polygons, used to plan long paths.
+///
+/// The polygons of each region are grouped in clusters of connected polygons
+/// inside the same cell of a grid sized to hold about `CLUSTER_POLYGONS`
+/// polygons per cluster. Each cluster gets a portal towards every
+/// neighbouring cluster, and the cost between the portals of each cluster is
+/// precomputed. Paths are planned over the portals first, then refined by
+/// searching only the polygons of the crossed clusters.
+///
+/// The clusters and portals are stored in the regions, so that a map sync
+/// only rebuilds them for the regions that changed or got new connections.
+class NavHierarchy {
+	enum {
+		CLUSTER_POLYGONS = 128,
+	};
+
+	uint32_t cluster_count = 0;
+	uint32_t portal_count = 0;
+
+	/// Buffers reused by the searches, there is one per thread so searches can run in parallel.
+	struct SearchScratch {
+		struct OpenEntry {
+			float cost = 0.0;
+			float traveled_distance = 0.0;
+			uint32_t id = 0;
+
+			/// Reversed, so the standard max-heap pops the least cost first.
+			bool operator<(const OpenEntry &p_other) const {
+				return cost > p_other.cost;
+			}
+		};
+
+		std::vector<OpenEntry> open;
+		LocalVector<float> distances;
+		LocalVector<uint32_t> previous;
+		LocalVector<const NavRegion *> node_regions;
+		LocalVector<float> begin_costs;
+		LocalVector<float> end_costs;
+	};
+
+	static thread_local SearchScratch search_scratch;
+
+	/// Distances from a point of a polygon to the other polygons of its cluster, indexed by polygon.
+	static void compute_cluster_distances(const NavRegion *p_region, uint32_t p_cluster, uint32_t p_polygon, const Vector3 &p_position, SearchScratch &r_scratch);
+
+public:
+	/// Groups the polygons of a region in clusters, when its polygons changed.
+	static void build_clusters(NavRegion *p_region);
+
+	/// Places the portals of a region and the costs between them, when its connections changed.
+	static void build_portals(NavRegion *p_region);
+
+	/// Numbers the clusters and portals of all the regions in the map.
+	void update_offsets(const std::vector<NavRegion *> &p_regions);
+
+	uint32_t get_cluster_count() const {
+		return cluster_count;
+	}
+
+	/// Plans over the portals from the begin polygon to the end one, and
+	/// returns the map indices of the clusters crossed by the abstract path.
+	/// Returns false if both polygons are in the same cluster or no abstract path exists.
+	bool find_corridor(const gd::Polygon *p_begin_poly, const Vector3 &p_begin_point, const gd::Polygon *p_end_poly, const Vector3 &p_end_point, uint32_t p_layers, LocalVector<uint32_t> &r_clusters) const;
+};
+
+#endif // NAV_HIERARCHY_H
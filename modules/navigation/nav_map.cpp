@@ -30,7 +30,7 @@
 
 #include "nav_map.h"
 
-#include "core/os/threaded_array_processor.h"
+#include "core/templates/thread_work_pool.h"
 #include "nav_region.h"
 #include "rvo_agent.h"
 
@@ -42,6 +42,47 @@
 
 #define THREE_POINTS_CROSS_PRODUCT(m_a, m_b, m_c) (((m_c) - (m_a)).cross((m_b) - (m_a)))
 
+thread_local NavMap::PathQueryScratch NavMap::path_query_scratch;
+
+void NavMap::PathQueryScratch::reset(uint32_t p_polygon_count) {
+	navigation_polys.clear();
+	to_visit.clear();
+
+	if (navigation_poly_ids.size() < p_polygon_count) {
+		navigation_poly_ids.resize(p_polygon_count);
+		pass_ids.resize(p_polygon_count, 0);
+	}
+
+	// Bumping the pass invalidates all the ids, clear them only when it wraps around.
+	pass++;
+	if (pass == 0) {
+		std::fill(pass_ids.begin(), pass_ids.end(), 0);
+		pass = 1;
+	}
+}
+
+void NavMap::PathQueryScratch::set_corridor(uint32_t p_cluster_count) {
+	if (corridor_pass_ids.size() < p_cluster_count) {
+		corridor_pass_ids.resize(p_cluster_count, 0);
+	}
+
+	corridor_pass++;
+	if (corridor_pass == 0) {
+		std::fill(corridor_pass_ids.begin(), corridor_pass_ids.end(), 0);
+		corridor_pass = 1;
+	}
+
+	for (uint32_t i = 0; i < corridor_clusters.size(); i++) {
+		corridor_pass_ids[corridor_clusters[i]] = corridor_pass;
+	}
+}
+
+NavMap::~NavMap() {
+	for (uint32_t i = 0; i < flow_fields.size(); i++) {
+		memdelete(flow_fields[i]);
+	}
+}
+
 void NavMap::set_up(Vector3 p_up) {
 	up = p_up;
 	regenerate_polygons = true;
@@ -57,6 +98,15 @@ void NavMap::set_edge_connection_margin(float p_edge_connection_margin) {
 	regenerate_links = true;
 }
 
+void NavMap::set_use_hierarchical_paths(bool p_enabled) {
+	if (use_hierarchical_paths == p_enabled) {
+		return;
+	}
+	use_hierarchical_paths = p_enabled;
+	// The hierarchy is not kept up to date while unused.
+	hierarchy_dirty = p_enabled;
+}
+
 gd::PointKey NavMap::get_point_key(const Vector3 &p_pos) const {
 	const int x = int(Math::floor(p_pos.x / cell_size));
 	const int y = int(Math::floor(p_pos.y / cell_size));
@@ -70,79 +120,73 @@ gd::PointKey NavMap::get_point_key(const Vector3 &p_pos) const {
 	return p;
 }
 
-Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_layers) const {
-	// Find the start poly and the end poly on this map.
-	const gd::Polygon *begin_poly = nullptr;
-	const gd::Polygon *end_poly = nullptr;
-	Vector3 begin_point;
-	Vector3 end_point;
-	float begin_d = 1e20;
-	float end_d = 1e20;
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
-
-		// Only consider the polygon if it in a region with compatible layers.
-		if ((p_layers & p.owner->get_layers()) == 0) {
-			continue;
-		}
+static _FORCE_INLINE_ real_t get_aabb_distance_squared(const AABB &p_aabb, const Vector3 &p_point) {
+	const Vector3 end = p_aabb.position + p_aabb.size;
+	real_t distance_squared = 0.0;
+	for (int i = 0; i < 3; i++) {
+		const real_t gap = MAX(MAX(p_aabb.position[i] - p_point[i], p_point[i] - end[i]), 0.0);
+		distance_squared += gap * gap;
+	}
+	return distance_squared;
+}
 
-		// For each point cast a face and check the distance between the origin/destination
-		for (size_t point_id = 0; point_id < p.points.size(); point_id++) {
-			const Vector3 p1 = p.points[point_id].pos;
-			const Vector3 p2 = p.points[(point_id + 1) % p.points.size()].pos;
-			const Vector3 p3 = p.points[(point_id + 2) % p.points.size()].pos;
-			const Face3 face(p1, p2, p3);
+static _FORCE_INLINE_ real_t get_aabb_distance_squared(const AABB &p_aabb, const AABB &p_other) {
+	const Vector3 end = p_aabb.position + p_aabb.size;
+	const Vector3 other_end = p_other.position + p_other.size;
+	real_t distance_squared = 0.0;
+	for (int i = 0; i < 3; i++) {
+		const real_t gap = MAX(MAX(p_aabb.position[i] - other_end[i], p_other.position[i] - end[i]), 0.0);
+		distance_squared += gap * gap;
+	}
+	return distance_squared;
+}
 
-			Vector3 point = face.get_closest_point_to(p_origin);
-			float distance_to_point = point.distance_to(p_origin);
-			if (distance_to_point < begin_d) {
-				begin_d = distance_to_point;
-				begin_poly = &p;
-				begin_point = point;
-			}
+// Index of the polygon in the map, used by the path query scratch buffers.
+static _FORCE_INLINE_ uint32_t get_polygon_index(const gd::Polygon *p_polygon) {
+	return p_polygon->owner->get_polygon_offset() + p_polygon->id;
+}
 
-			point = face.get_closest_point_to(p_destination);
-			distance_to_point = point.distance_to(p_destination);
-			if (distance_to_point < end_d) {
-				end_d = distance_to_point;
-				end_poly = &p;
-				end_point = point;
+// Polygons are convex, so their triangle fan covers them.
+static bool get_closest_point_on_polygon(const gd::Polygon &p_polygon, const Vector3 &p_point, Vector3 &r_point, real_t &r_distance_squared, Vector3 *r_normal = nullptr) {
+	bool found = false;
+	for (size_t point_id = 2; point_id < p_polygon.points.size(); point_id++) {
+		const Face3 f(p_polygon.points[0].pos, p_polygon.points[point_id - 1].pos, p_polygon.points[point_id].pos);
+		const Vector3 inters = f.get_closest_point_to(p_point);
+		const real_t d = inters.distance_squared_to(p_point);
+		if (d < r_distance_squared) {
+			r_point = inters;
+			r_distance_squared = d;
+			if (r_normal) {
+				*r_normal = f.get_plane().normal;
 			}
+			found = true;
 		}
 	}
+	return found;
+}
 
-	// Check for trivial cases
-	if (!begin_poly || !end_poly) {
-		return Vector<Vector3>();
-	}
-	if (begin_poly == end_poly) {
-		Vector<Vector3> path;
-		path.resize(2);
-		path.write[0] = begin_point;
-		path.write[1] = end_point;
-		return path;
-	}
+bool NavMap::search_route(PathQueryScratch &scratch, const gd::Polygon *p_begin_poly, const Vector3 &p_begin_point, const gd::Polygon *&r_end_poly, Vector3 &r_end_point, const Vector3 &p_destination, uint32_t p_layers, bool p_use_corridor, int &r_least_cost_id) const {
+	scratch.reset(polygon_count);
 
 	// List of all reachable navigation polys.
-	std::vector<gd::NavigationPoly> navigation_polys;
-	navigation_polys.reserve(polygons.size() * 0.75);
+	std::vector<gd::NavigationPoly> &navigation_polys = scratch.navigation_polys;
 
 	// Add the start polygon to the reachable navigation polygons.
-	gd::NavigationPoly begin_navigation_poly = gd::NavigationPoly(begin_poly);
+	gd::NavigationPoly begin_navigation_poly = gd::NavigationPoly(p_begin_poly);
 	begin_navigation_poly.self_id = 0;
-	begin_navigation_poly.entry = begin_point;
-	begin_navigation_poly.back_navigation_edge_pathway_start = begin_point;
-	begin_navigation_poly.back_navigation_edge_pathway_end = begin_point;
+	begin_navigation_poly.entry = p_begin_point;
+	begin_navigation_poly.back_navigation_edge_pathway_start = p_begin_point;
+	begin_navigation_poly.back_navigation_edge_pathway_end = p_begin_point;
 	navigation_polys.push_back(begin_navigation_poly);
+	scratch.set_navigation_poly_id(get_polygon_index(p_begin_poly), 0);
 
-	// List of polygon IDs to visit.
-	List<uint32_t> to_visit;
-	to_visit.push_back(0);
+	// Heap of the polygons to visit, ordered by estimated cost.
+	std::vector<PathQueryScratch::OpenEntry> &to_visit = scratch.to_visit;
 
 	// This is an implementation of the A* algorithm.
 	int least_cost_id = 0;
 	bool found_route = false;
+	const gd::Polygon *end_poly = r_end_poly;
 
 	const gd::Polygon *reachable_end = nullptr;
 	float reachable_d = 1e30;
@@ -164,48 +208,68 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 					continue;
 				}
 
+				// When refining a hierarchical path, stay in the corridor.
+				if (p_use_corridor && !scratch.is_in_corridor(connection.polygon->owner->get_cluster_offset() + connection.polygon->cluster)) {
+					continue;
+				}
+
 				Vector3 pathway[2] = { connection.pathway_start, connection.pathway_end };
 				const Vector3 new_entry = Geometry3D::get_closest_point_to_segment(least_cost_poly->entry, pathway);
 				const float new_distance = least_cost_poly->entry.distance_to(new_entry) + least_cost_poly->traveled_distance;
 
-				const std::vector<gd::NavigationPoly>::iterator it = std::find(
-						navigation_polys.begin(),
-						navigation_polys.end(),
-						gd::NavigationPoly(connection.polygon));
-
-				if (it != navigation_polys.end()) {
+				gd::NavigationPoly *navigation_poly;
+				const uint32_t polygon_index = get_polygon_index(connection.polygon);
+				const int navigation_poly_id = scratch.get_navigation_poly_id(polygon_index);
+				if (navigation_poly_id != -1) {
 					// Polygon already visited, check if we can reduce the travel cost.
-					if (new_distance < it->traveled_distance) {
-						it->back_navigation_poly_id = least_cost_id;
-						it->back_navigation_edge = connection.edge;
-						it->back_navigation_edge_pathway_start = connection.pathway_start;
-						it->back_navigation_edge_pathway_end = connection.pathway_end;
-						it->traveled_distance = new_distance;
-						it->entry = new_entry;
+					navigation_poly = &navigation_polys[navigation_poly_id];
+					if (new_distance >= navigation_poly->traveled_distance) {
+						continue;
 					}
 				} else {
 					// Add the neighbour polygon to the reachable ones.
-					gd::NavigationPoly new_navigation_poly = gd::NavigationPoly(connection.polygon);
-					new_navigation_poly.self_id = navigation_polys.size();
-					new_navigation_poly.back_navigation_poly_id = least_cost_id;
-					new_navigation_poly.back_navigation_edge = connection.edge;
-					new_navigation_poly.back_navigation_edge_pathway_start = connection.pathway_start;
-					new_navigation_poly.back_navigation_edge_pathway_end = connection.pathway_end;
-					new_navigation_poly.traveled_distance = new_distance;
-					new_navigation_poly.entry = new_entry;
-					navigation_polys.push_back(new_navigation_poly);
-
-					// Add the neighbour polygon to the polygons to visit.
-					to_visit.push_back(navigation_polys.size() - 1);
+					scratch.set_navigation_poly_id(polygon_index, navigation_polys.size());
+					navigation_polys.push_back(gd::NavigationPoly(connection.polygon));
+					navigation_poly = &navigation_polys.back();
+					navigation_poly->self_id = navigation_polys.size() - 1;
+
+					// The vector may have grown.
+					least_cost_poly = &navigation_polys[least_cost_id];
 				}
+
+				navigation_poly->back_navigation_poly_id = least_cost_id;
+				navigation_poly->back_navigation_edge = connection.edge;
+				navigation_poly->back_navigation_edge_pathway_start = connection.pathway_start;
+				navigation_poly->back_navigation_edge_pathway_end = connection.pathway_end;
+				navigation_poly->traveled_distance = new_distance;
+				navigation_poly->entry = new_entry;
+
+				// Add the neighbour polygon to the polygons to visit. Entries left
+				// by a previous, higher, cost are skipped when popped.
+				to_visit.push_back({ new_distance + new_entry.distance_to(r_end_point), new_distance, navigation_poly->self_id });
+				std::push_heap(to_visit.begin(), to_visit.end());
 			}
 		}
 
-		// Removes the least cost polygon from the list of polygons to visit so we can advance.
-		to_visit.erase(least_cost_id);
+		// Pop the polygon with the minimum cost from the polygons to visit.
+		least_cost_id = -1;
+		while (!to_visit.empty()) {
+			const PathQueryScratch::OpenEntry entry = to_visit.front();
+			std::pop_heap(to_visit.begin(), to_visit.end());
+			to_visit.pop_back();
+			if (entry.traveled_distance <= navigation_polys[entry.id].traveled_distance) {
+				least_cost_id = entry.id;
+				break;
+			}
+		}
 
 		// When the list of polygons to visit is empty at this point it means the End Polygon is not reachable
-		if (to_visit.size() == 0) {
+		if (least_cost_id == -1) {
+			// In a corridor, let the caller fall back to the whole map.
+			if (p_use_corridor) {
+				break;
+			}
+
 			// Thus use the further reachable polygon
 			ERR_BREAK_MSG(is_reachable == false, "It's not expect to not find the most reachable polygons");
 			is_reachable = false;
@@ -216,42 +280,21 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 
 			// Set as end point the furthest reachable point.
 			end_poly = reachable_end;
-			end_d = 1e20;
-			for (size_t point_id = 2; point_id < end_poly->points.size(); point_id++) {
-				Face3 f(end_poly->points[point_id - 2].pos, end_poly->points[point_id - 1].pos, end_poly->points[point_id].pos);
-				Vector3 spoint = f.get_closest_point_to(p_destination);
-				float dpoint = spoint.distance_to(p_destination);
-				if (dpoint < end_d) {
-					end_point = spoint;
-					end_d = dpoint;
-				}
-			}
+			real_t end_d = 1e20;
+			get_closest_point_on_polygon(*end_poly, p_destination, r_end_point, end_d);
 
 			// Reset open and navigation_polys
 			gd::NavigationPoly np = navigation_polys[0];
-			navigation_polys.clear();
+			scratch.reset(polygon_count);
 			navigation_polys.push_back(np);
-			to_visit.clear();
-			to_visit.push_back(0);
+			scratch.set_navigation_poly_id(get_polygon_index(p_begin_poly), 0);
+			least_cost_id = 0;
 
 			reachable_end = nullptr;
 
 			continue;
 		}
 
-		// Find the polygon with the minimum cost from the list of polygons to visit.
-		least_cost_id = -1;
-		float least_cost = 1e30;
-		for (List<uint32_t>::Element *element = to_visit.front(); element != nullptr; element = element->next()) {
-			gd::NavigationPoly *np = &navigation_polys[element->get()];
-			float cost = np->traveled_distance;
-			cost += np->entry.distance_to(end_point);
-			if (cost < least_cost) {
-				least_cost_id = np->self_id;
-				least_cost = cost;
-			}
-		}
-
 		// Stores the further reachable end polygon, in case our goal is not reachable.
 		if (is_reachable) {
 			float d = navigation_polys[least_cost_id].entry.distance_to(p_destination);
@@ -261,8 +304,6 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 			}
 		}
 
-		ERR_BREAK(least_cost_id == -1);
-
 		// Check if we reached the end
 		if (navigation_polys[least_cost_id].poly == end_poly) {
 			found_route = true;
@@ -270,6 +311,52 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 		}
 	}
 
+	if (found_route) {
+		r_end_poly = end_poly;
+		r_least_cost_id = least_cost_id;
+	}
+	return found_route;
+}
+
+Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_layers) const {
+	// Find the start poly and the end poly on this map.
+	ClosestPointQueryResult begin_result;
+	query_closest_point(p_origin, p_layers, begin_result);
+	ClosestPointQueryResult end_result;
+	query_closest_point(p_destination, p_layers, end_result);
+
+	const gd::Polygon *begin_poly = begin_result.polygon;
+	const gd::Polygon *end_poly = end_result.polygon;
+	Vector3 begin_point = begin_result.point;
+	Vector3 end_point = end_result.point;
+
+	// Check for trivial cases
+	if (!begin_poly || !end_poly) {
+		return Vector<Vector3>();
+	}
+	if (begin_poly == end_poly) {
+		Vector<Vector3> path;
+		path.resize(2);
+		path.write[0] = begin_point;
+		path.write[1] = end_point;
+		return path;
+	}
+
+	// Reuse the scratch buffers of this thread.
+	PathQueryScratch &scratch = path_query_scratch;
+	std::vector<gd::NavigationPoly> &navigation_polys = scratch.navigation_polys;
+
+	// Plan long paths over the clusters first, then only search the polygons of the crossed clusters.
+	int least_cost_id = -1;
+	bool found_route = false;
+	if (use_hierarchical_paths && !hierarchy_dirty && hierarchy.find_corridor(begin_poly, begin_point, end_poly, end_point, p_layers, scratch.corridor_clusters)) {
+		scratch.set_corridor(hierarchy.get_cluster_count());
+		found_route = search_route(scratch, begin_poly, begin_point, end_poly, end_point, p_destination, p_layers, true, least_cost_id);
+	}
+	if (!found_route) {
+		found_route = search_route(scratch, begin_poly, begin_point, end_poly, end_point, p_destination, p_layers, false, least_cost_id);
+	}
+
 	// If we did not find a route, return an empty path.
 	if (!found_route) {
 		return Vector<Vector3>();
@@ -369,145 +456,394 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 	return path;
 }
 
-Vector3 NavMap::get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) const {
-	bool use_collision = p_use_collision;
-	Vector3 closest_point;
-	real_t closest_point_d = 1e20;
+Vector3 NavMap::get_flow_direction(const Vector<Vector3> &p_targets, const Vector3 &p_position, uint32_t p_layers) const {
+	ClosestPointQueryResult result;
+	query_closest_point(p_position, p_layers, result);
+	if (!result.polygon) {
+		return Vector3();
+	}
 
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+	{
+		MutexLock lock(flow_fields_mutex);
+		const int field_index = find_flow_field(p_targets, p_layers);
+		if (field_index >= 0 && flow_fields[field_index]->map_update_id == map_update_id) {
+			flow_fields[field_index]->last_use = ++flow_field_uses;
+			return get_flow_field_direction(*flow_fields[field_index], result);
+		}
+	}
 
-		// For each point cast a face and check the distance to the segment
-		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
-			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			Vector3 inters;
-			if (f.intersects_segment(p_from, p_to, &inters)) {
-				const real_t d = closest_point_d = p_from.distance_to(inters);
-				if (use_collision == false) {
-					closest_point = inters;
-					use_collision = true;
-					closest_point_d = d;
-				} else if (closest_point_d > d) {
-					closest_point = inters;
-					closest_point_d = d;
-				}
+	// Computed without the lock, so the queries using the other flow fields
+	// do not wait for it.
+	FlowField *field = memnew(FlowField);
+	field->targets = p_targets;
+	field->layers = p_layers;
+	compute_flow_field(*field);
+
+	MutexLock lock(flow_fields_mutex);
+	// Another query may have computed the same field meanwhile, this one replaces it.
+	int field_index = find_flow_field(p_targets, p_layers);
+	if (field_index < 0 && flow_fields.size() < MAX_FLOW_FIELDS) {
+		field_index = flow_fields.size();
+		flow_fields.push_back(nullptr);
+	} else if (field_index < 0) {
+		// Replace the least recently used one.
+		field_index = 0;
+		for (uint32_t i = 1; i < flow_fields.size(); i++) {
+			if (flow_fields[i]->last_use < flow_fields[field_index]->last_use) {
+				field_index = i;
 			}
 		}
+	}
+	if (flow_fields[field_index]) {
+		memdelete(flow_fields[field_index]);
+	}
+	flow_fields[field_index] = field;
 
-		if (use_collision == false) {
-			for (size_t point_id = 0; point_id < p.points.size(); point_id += 1) {
-				Vector3 a, b;
+	field->last_use = ++flow_field_uses;
+	return get_flow_field_direction(*field, result);
+}
+
+int NavMap::find_flow_field(const Vector<Vector3> &p_targets, uint32_t p_layers) const {
+	for (uint32_t i = 0; i < flow_fields.size(); i++) {
+		if (flow_fields[i]->layers == p_layers && flow_fields[i]->targets == p_targets) {
+			return i;
+		}
+	}
+	return -1;
+}
 
-				Geometry3D::get_closest_points_between_segments(
-						p_from,
-						p_to,
-						p.points[point_id].pos,
-						p.points[(point_id + 1) % p.points.size()].pos,
-						a,
-						b);
+Vector3 NavMap::get_flow_field_direction(const FlowField &p_field, const ClosestPointQueryResult &p_position) const {
+	uint32_t index = get_polygon_index(p_position.polygon);
+	if (p_field.distances[index] == FLT_MAX) {
+		// No target can be reached.
+		return Vector3();
+	}
 
-				const real_t d = a.distance_to(b);
-				if (d < closest_point_d) {
-					closest_point_d = d;
-					closest_point = b;
+	// Once on the pathway to the next polygon, head to the following one.
+	Vector3 direction = p_field.exits[index] - p_position.point;
+	while (direction.length_squared() < cell_size * cell_size) {
+		if (p_field.next_polygons[index] == nullptr) {
+			// The target is reached.
+			return Vector3();
+		}
+		index = get_polygon_index(p_field.next_polygons[index]);
+		direction = p_field.exits[index] - p_position.point;
+	}
+
+	return direction.normalized();
+}
+
+void NavMap::compute_flow_field(FlowField &r_field) const {
+	r_field.map_update_id = map_update_id;
+	r_field.distances.resize(polygon_count);
+	r_field.exits.resize(polygon_count);
+	r_field.next_polygons.resize(polygon_count);
+	for (uint32_t i = 0; i < polygon_count; i++) {
+		r_field.distances[i] = FLT_MAX;
+		r_field.next_polygons[i] = nullptr;
+	}
+
+	struct OpenEntry {
+		float distance = 0.0;
+		const gd::Polygon *polygon = nullptr;
+
+		/// Reversed, so the standard max-heap pops the least distance first.
+		bool operator<(const OpenEntry &p_other) const {
+			return distance > p_other.distance;
+		}
+	};
+	std::vector<OpenEntry> to_visit;
+
+	// This is the Dijkstra algorithm, starting from all the targets at once.
+	for (int i = 0; i < r_field.targets.size(); i++) {
+		ClosestPointQueryResult result;
+		query_closest_point(r_field.targets[i], r_field.layers, result);
+		if (!result.polygon) {
+			continue;
+		}
+		const uint32_t index = get_polygon_index(result.polygon);
+		if (r_field.distances[index] == 0.0) {
+			// Another target is in this polygon.
+			continue;
+		}
+		r_field.distances[index] = 0.0;
+		r_field.exits[index] = result.point;
+		to_visit.push_back({ 0.0, result.polygon });
+	}
+
+	while (!to_visit.empty()) {
+		const OpenEntry entry = to_visit.front();
+		std::pop_heap(to_visit.begin(), to_visit.end());
+		to_visit.pop_back();
+
+		const uint32_t index = get_polygon_index(entry.polygon);
+		if (entry.distance > r_field.distances[index]) {
+			// Left by a previous, higher, distance.
+			continue;
+		}
+		const Vector3 point = r_field.exits[index];
+
+		// The connections go both ways, so a connected polygon reaches this
+		// one through the same pathway.
+		for (size_t i = 0; i < entry.polygon->edges.size(); i++) {
+			const gd::Edge &edge = entry.polygon->edges[i];
+			for (int connection_index = 0; connection_index < edge.connections.size(); connection_index++) {
+				const gd::Edge::Connection &connection = edge.connections[connection_index];
+				if ((r_field.layers & connection.polygon->owner->get_layers()) == 0) {
+					continue;
 				}
+
+				Vector3 pathway[2] = { connection.pathway_start, connection.pathway_end };
+				const Vector3 exit = Geometry3D::get_closest_point_to_segment(point, pathway);
+				const float distance = entry.distance + point.distance_to(exit);
+
+				const uint32_t connected_index = get_polygon_index(connection.polygon);
+				if (distance >= r_field.distances[connected_index]) {
+					continue;
+				}
+				r_field.distances[connected_index] = distance;
+				r_field.exits[connected_index] = exit;
+				r_field.next_polygons[connected_index] = entry.polygon;
+
+				to_visit.push_back({ distance, connection.polygon });
+				std::push_heap(to_visit.begin(), to_visit.end());
 			}
 		}
 	}
+}
 
+Vector3 NavMap::get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) const {
+	Vector3 closest_point;
+	if (query_segment_intersection(p_from, p_to, closest_point) || p_use_collision) {
+		return closest_point;
+	}
+
+	query_closest_edge_point_to_segment(p_from, p_to, closest_point);
 	return closest_point;
 }
 
 Vector3 NavMap::get_closest_point(const Vector3 &p_point) const {
-	// TODO this is really not optimal, please redesign the API to directly return all this data
+	ClosestPointQueryResult result;
+	query_closest_point(p_point, UINT32_MAX, result);
+	return result.point;
+}
 
-	Vector3 closest_point;
-	real_t closest_point_d = 1e20;
+Vector3 NavMap::get_closest_point_normal(const Vector3 &p_point) const {
+	ClosestPointQueryResult result;
+	query_closest_point(p_point, UINT32_MAX, result);
+	return result.normal;
+}
+
+RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
+	ClosestPointQueryResult result;
+	query_closest_point(p_point, UINT32_MAX, result);
+	return result.polygon ? result.polygon->owner->get_self() : RID();
+}
+
+// The tree is built by median splits, so its depth is about log2 of the number of
+// polygons and the stack is only exceeded with unexpected trees. The polygons of the
+// node are then visited as if it was a leaf.
+#define BVH_STACK_SIZE 64
+
+// The polygons of a node are contiguous, from the first polygon of its leftmost leaf
+// to the last polygon of its rightmost one.
+static void get_bvh_node_polygons(const std::vector<gd::BVHNode> &p_bvh, uint32_t p_node, uint32_t &r_begin, uint32_t &r_end) {
+	uint32_t node = p_node;
+	while (!p_bvh[node].is_leaf()) {
+		node = p_bvh[node].first;
+	}
+	r_begin = p_bvh[node].first;
 
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+	node = p_node;
+	while (!p_bvh[node].is_leaf()) {
+		node = p_bvh[node].first + 1;
+	}
+	r_end = p_bvh[node].first + p_bvh[node].count;
+}
 
-		// For each point cast a face and check the distance to the point
-		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
-			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			const Vector3 inters = f.get_closest_point_to(p_point);
-			const real_t d = inters.distance_to(p_point);
-			if (d < closest_point_d) {
-				closest_point = inters;
-				closest_point_d = d;
+void NavMap::query_closest_point(const Vector3 &p_point, uint32_t p_layers, ClosestPointQueryResult &r_result) const {
+	struct StackEntry {
+		uint32_t node;
+		real_t distance_squared;
+	};
+	StackEntry stack[BVH_STACK_SIZE];
+
+	for (size_t r(0); r < regions.size(); r++) {
+		const NavRegion *region = regions[r];
+		const std::vector<gd::BVHNode> &bvh = region->get_bvh();
+		if (bvh.empty() || (p_layers & region->get_layers()) == 0) {
+			continue;
+		}
+		const std::vector<gd::Polygon> &region_polygons = region->get_polygons();
+		const std::vector<uint32_t> &bvh_polygons = region->get_bvh_polygons();
+
+		// Branch and bound, visiting the nearest child first.
+		int stack_size = 0;
+		stack[stack_size++] = { 0, get_aabb_distance_squared(bvh[0].aabb, p_point) };
+		while (stack_size > 0) {
+			const StackEntry entry = stack[--stack_size];
+			if (entry.distance_squared >= r_result.distance_squared) {
+				continue;
 			}
+
+			const gd::BVHNode &node = bvh[entry.node];
+			if (node.is_leaf() || stack_size + 2 > BVH_STACK_SIZE) {
+				uint32_t begin, end;
+				get_bvh_node_polygons(bvh, entry.node, begin, end);
+				for (uint32_t i = begin; i < end; i++) {
+					const uint32_t polygon_index = bvh_polygons[i];
+					if (get_closest_point_on_polygon(region_polygons[polygon_index], p_point, r_result.point, r_result.distance_squared, &r_result.normal)) {
+						r_result.polygon = &region_polygons[polygon_index];
+					}
+				}
+				continue;
+			}
+
+			StackEntry left = { node.first, get_aabb_distance_squared(bvh[node.first].aabb, p_point) };
+			StackEntry right = { node.first + 1, get_aabb_distance_squared(bvh[node.first + 1].aabb, p_point) };
+			if (left.distance_squared < right.distance_squared) {
+				SWAP(left, right);
+			}
+			stack[stack_size++] = left;
+			stack[stack_size++] = right;
 		}
 	}
-
-	return closest_point;
 }
 
-Vector3 NavMap::get_closest_point_normal(const Vector3 &p_point) const {
-	// TODO this is really not optimal, please redesign the API to directly return all this data
+bool NavMap::query_segment_intersection(const Vector3 &p_from, const Vector3 &p_to, Vector3 &r_point) const {
+	uint32_t stack[BVH_STACK_SIZE];
+	real_t closest_d = 1e20;
+	bool found = false;
 
-	Vector3 closest_point;
-	Vector3 closest_point_normal;
-	real_t closest_point_d = 1e20;
+	for (size_t r(0); r < regions.size(); r++) {
+		const std::vector<gd::BVHNode> &bvh = regions[r]->get_bvh();
+		if (bvh.empty()) {
+			continue;
+		}
+		const std::vector<gd::Polygon> &region_polygons = regions[r]->get_polygons();
+		const std::vector<uint32_t> &bvh_polygons = regions[r]->get_bvh_polygons();
+
+		int stack_size = 0;
+		stack[stack_size++] = 0;
+		while (stack_size > 0) {
+			const uint32_t node_index = stack[--stack_size];
+			const gd::BVHNode &node = bvh[node_index];
+			if (!node.aabb.intersects_segment(p_from, p_to)) {
+				continue;
+			}
 
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+			if (!node.is_leaf() && stack_size + 2 <= BVH_STACK_SIZE) {
+				stack[stack_size++] = node.first;
+				stack[stack_size++] = node.first + 1;
+				continue;
+			}
 
-		// For each point cast a face and check the distance to the point
-		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
-			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			const Vector3 inters = f.get_closest_point_to(p_point);
-			const real_t d = inters.distance_to(p_point);
-			if (d < closest_point_d) {
-				closest_point = inters;
-				closest_point_normal = f.get_plane().normal;
-				closest_point_d = d;
+			uint32_t begin, end;
+			get_bvh_node_polygons(bvh, node_index, begin, end);
+			for (uint32_t i = begin; i < end; i++) {
+				const gd::Polygon &p = region_polygons[bvh_polygons[i]];
+				for (size_t point_id = 2; point_id < p.points.size(); point_id++) {
+					const Face3 f(p.points[0].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
+					Vector3 inters;
+					if (f.intersects_segment(p_from, p_to, &inters)) {
+						const real_t d = p_from.distance_squared_to(inters);
+						if (d < closest_d) {
+							r_point = inters;
+							closest_d = d;
+							found = true;
+						}
+					}
+				}
 			}
 		}
 	}
 
-	return closest_point_normal;
+	return found;
 }
 
-RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
-	// TODO this is really not optimal, please redesign the API to directly return all this data
+bool NavMap::query_closest_edge_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, Vector3 &r_point) const {
+	struct StackEntry {
+		uint32_t node;
+		real_t distance_squared;
+	};
+	StackEntry stack[BVH_STACK_SIZE];
+	real_t closest_d = 1e20;
+	bool found = false;
 
-	Vector3 closest_point;
-	RID closest_point_owner;
-	real_t closest_point_d = 1e20;
+	// The distance between the boxes bounds the distance to the segment from below.
+	AABB segment_aabb(p_from, Vector3());
+	segment_aabb.expand_to(p_to);
+
+	for (size_t r(0); r < regions.size(); r++) {
+		const std::vector<gd::BVHNode> &bvh = regions[r]->get_bvh();
+		if (bvh.empty()) {
+			continue;
+		}
+		const std::vector<gd::Polygon> &region_polygons = regions[r]->get_polygons();
+		const std::vector<uint32_t> &bvh_polygons = regions[r]->get_bvh_polygons();
+
+		int stack_size = 0;
+		stack[stack_size++] = { 0, get_aabb_distance_squared(bvh[0].aabb, segment_aabb) };
+		while (stack_size > 0) {
+			const StackEntry entry = stack[--stack_size];
+			if (entry.distance_squared >= closest_d) {
+				continue;
+			}
 
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+			const gd::BVHNode &node = bvh[entry.node];
+			if (node.is_leaf() || stack_size + 2 > BVH_STACK_SIZE) {
+				uint32_t begin, end;
+				get_bvh_node_polygons(bvh, entry.node, begin, end);
+				for (uint32_t i = begin; i < end; i++) {
+					const gd::Polygon &p = region_polygons[bvh_polygons[i]];
+					for (size_t point_id = 0; point_id < p.points.size(); point_id++) {
+						Vector3 a, b;
+						Geometry3D::get_closest_points_between_segments(
+								p_from,
+								p_to,
+								p.points[point_id].pos,
+								p.points[(point_id + 1) % p.points.size()].pos,
+								a,
+								b);
+
+						const real_t d = a.distance_squared_to(b);
+						if (d < closest_d) {
+							closest_d = d;
+							r_point = b;
+							found = true;
+						}
+					}
+				}
+				continue;
+			}
 
-		// For each point cast a face and check the distance to the point
-		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
-			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			const Vector3 inters = f.get_closest_point_to(p_point);
-			const real_t d = inters.distance_to(p_point);
-			if (d < closest_point_d) {
-				closest_point = inters;
-				closest_point_owner = p.owner->get_self();
-				closest_point_d = d;
+			StackEntry left = { node.first, get_aabb_distance_squared(bvh[node.first].aabb, segment_aabb) };
+			StackEntry right = { node.first + 1, get_aabb_distance_squared(bvh[node.first + 1].aabb, segment_aabb) };
+			if (left.distance_squared < right.distance_squared) {
+				SWAP(left, right);
 			}
+			stack[stack_size++] = left;
+			stack[stack_size++] = right;
 		}
 	}
 
-	return closest_point_owner;
+	return found;
 }
 
+#undef BVH_STACK_SIZE
+
 void NavMap::add_region(NavRegion *p_region) {
 	regions.push_back(p_region);
-	regenerate_links = true;
+	regions_dirty = true;
 }
 
 void NavMap::remove_region(NavRegion *p_region) {
 	const std::vector<NavRegion *>::iterator it = std::find(regions.begin(), regions.end(), p_region);
 	if (it != regions.end()) {
+		// Unlink the polygons now, they may be freed before the next sync.
+		remove_region_edges(p_region);
 		regions.erase(it);
-		regenerate_links = true;
+		regions_dirty = true;
 	}
 }
 
@@ -518,7 +854,6 @@ bool NavMap::has_agent(RvoAgent *agent) const {
 void NavMap::add_agent(RvoAgent *agent) {
 	if (!has_agent(agent)) {
 		agents.push_back(agent);
-		agents_dirty = true;
 	}
 }
 
@@ -527,7 +862,6 @@ void NavMap::remove_agent(RvoAgent *agent) {
 	const std::vector<RvoAgent *>::iterator it = std::find(agents.begin(), agents.end(), agent);
 	if (it != agents.end()) {
 		agents.erase(it);
-		agents_dirty = true;
 	}
 }
 
@@ -546,104 +880,137 @@ void NavMap::remove_agent_as_controlled(RvoAgent *agent) {
 	}
 }
 
-void NavMap::sync() {
-	// Check if we need to update the links.
-	if (regenerate_polygons) {
-		for (size_t r(0); r < regions.size(); r++) {
-			regions[r]->scratch_polygons();
+void NavMap::add_region_edges(NavRegion *p_region) {
+	std::vector<gd::Polygon> &region_polygons = p_region->get_polygons();
+	for (size_t poly_id(0); poly_id < region_polygons.size(); poly_id++) {
+		gd::Polygon &poly = region_polygons[poly_id];
+
+		for (size_t p(0); p < poly.points.size(); p++) {
+			int next_point = (p + 1) % poly.points.size();
+			gd::EdgeKey ek(poly.points[p].key, poly.points[next_point].key);
+
+			Vector<gd::Edge::Connection> &connections = edge_connections[ek];
+			if (connections.size() <= 1) {
+				// Add the polygon/edge tuple to this key.
+				gd::Edge::Connection new_connection;
+				new_connection.polygon = &poly;
+				new_connection.edge = p;
+				new_connection.pathway_start = poly.points[p].pos;
+				new_connection.pathway_end = poly.points[next_point].pos;
+				connections.push_back(new_connection);
+			} else {
+				// The edge is already connected with another edge, skip.
+				ERR_PRINT("Attempted to merge a navigation mesh triangle edge with another already-merged edge. This happens when the current `cell_size` is different from the one used to generate the navigation mesh. This will cause navigation problem.");
+			}
 		}
-		regenerate_links = true;
 	}
 
-	for (size_t r(0); r < regions.size(); r++) {
-		if (regions[r]->sync()) {
-			regenerate_links = true;
-		}
+	if (!region_polygons.empty()) {
+		dirty_areas.push_back(p_region->get_aabb());
 	}
+}
 
-	if (regenerate_links) {
-		// Remove regions connections.
-		for (size_t r(0); r < regions.size(); r++) {
-			regions[r]->get_connections().clear();
-		}
+void NavMap::remove_region_edges(NavRegion *p_region) {
+	std::vector<gd::Polygon> &region_polygons = p_region->get_polygons();
+	for (size_t poly_id(0); poly_id < region_polygons.size(); poly_id++) {
+		gd::Polygon &poly = region_polygons[poly_id];
 
-		// Resize the polygon count.
-		int count = 0;
-		for (size_t r(0); r < regions.size(); r++) {
-			count += regions[r]->get_polygons().size();
-		}
-		polygons.resize(count);
+		for (size_t p(0); p < poly.points.size(); p++) {
+			int next_point = (p + 1) % poly.points.size();
+			Map<gd::EdgeKey, Vector<gd::Edge::Connection>>::Element *E = edge_connections.find(gd::EdgeKey(poly.points[p].key, poly.points[next_point].key));
+			if (!E) {
+				continue;
+			}
 
-		// Copy all region polygons in the map.
-		count = 0;
-		for (size_t r(0); r < regions.size(); r++) {
-			std::copy(
-					regions[r]->get_polygons().data(),
-					regions[r]->get_polygons().data() + regions[r]->get_polygons().size(),
-					polygons.begin() + count);
-			count += regions[r]->get_polygons().size();
+			for (int i = E->get().size() - 1; i >= 0; i--) {
+				if (E->get()[i].polygon == &poly && E->get()[i].edge == int(p)) {
+					E->get().remove(i);
+				}
+			}
+			if (E->get().is_empty()) {
+				edge_connections.erase(E);
+			}
 		}
+	}
 
-		// Group all edges per key.
-		Map<gd::EdgeKey, Vector<gd::Edge::Connection>> connections;
-		for (size_t poly_id(0); poly_id < polygons.size(); poly_id++) {
-			gd::Polygon &poly(polygons[poly_id]);
+	if (!region_polygons.empty()) {
+		dirty_areas.push_back(p_region->get_aabb());
+	}
+}
 
-			for (size_t p(0); p < poly.points.size(); p++) {
-				int next_point = (p + 1) % poly.points.size();
-				gd::EdgeKey ek(poly.points[p].key, poly.points[next_point].key);
+void NavMap::connect_region_edges(NavRegion *p_region) {
+	p_region->get_connections().clear();
+	p_region->get_free_edges().clear();
 
-				Map<gd::EdgeKey, Vector<gd::Edge::Connection>>::Element *connection = connections.find(ek);
-				if (!connection) {
-					connections[ek] = Vector<gd::Edge::Connection>();
-				}
-				if (connections[ek].size() <= 1) {
-					// Add the polygon/edge tuple to this key.
-					gd::Edge::Connection new_connection;
-					new_connection.polygon = &poly;
-					new_connection.edge = p;
-					new_connection.pathway_start = poly.points[p].pos;
-					new_connection.pathway_end = poly.points[next_point].pos;
-					connections[ek].push_back(new_connection);
-				} else {
-					// The edge is already connected with another edge, skip.
-					ERR_PRINT("Attempted to merge a navigation mesh triangle edge with another already-merged edge. This happens when the current `cell_size` is different from the one used to generate the navigation mesh. This will cause navigation problem.");
-				}
+	std::vector<gd::Polygon> &region_polygons = p_region->get_polygons();
+	for (size_t poly_id(0); poly_id < region_polygons.size(); poly_id++) {
+		gd::Polygon &poly = region_polygons[poly_id];
+
+		for (size_t p(0); p < poly.points.size(); p++) {
+			poly.edges[p].connections.clear();
+
+			int next_point = (p + 1) % poly.points.size();
+			const Map<gd::EdgeKey, Vector<gd::Edge::Connection>>::Element *E = edge_connections.find(gd::EdgeKey(poly.points[p].key, poly.points[next_point].key));
+			if (!E) {
+				continue;
 			}
-		}
 
-		Vector<gd::Edge::Connection> free_edges;
-		for (Map<gd::EdgeKey, Vector<gd::Edge::Connection>>::Element *E = connections.front(); E; E = E->next()) {
-			if (E->get().size() == 2) {
+			const Vector<gd::Edge::Connection> &connections = E->get();
+			const bool is_first = connections[0].polygon == &poly && connections[0].edge == int(p);
+			if (connections.size() == 2) {
 				// Connect edge that are shared in different polygons.
-				gd::Edge::Connection &c1 = E->get().write[0];
-				gd::Edge::Connection &c2 = E->get().write[1];
-				c1.polygon->edges[c1.edge].connections.push_back(c2);
-				c2.polygon->edges[c2.edge].connections.push_back(c1);
 				// Note: The pathway_start/end are full for those connection and do not need to be modified.
-			} else {
-				CRASH_COND_MSG(E->get().size() != 1, vformat("Number of connection != 1. Found: %d", E->get().size()));
-				free_edges.push_back(E->get()[0]);
-			}
-		}
-
-		// Find the compatible near edges.
-		//
-		// Note:
-		// Considering that the edges must be compatible (for obvious reasons)
-		// to be connected, create new polygons to remove that small gap is
-		// not really useful and would result in wasteful computation during
-		// connection, integration and path finding.
-		for (int i = 0; i < free_edges.size(); i++) {
-			const gd::Edge::Connection &free_edge = free_edges[i];
-			Vector3 edge_p1 = free_edge.polygon->points[free_edge.edge].pos;
-			Vector3 edge_p2 = free_edge.polygon->points[(free_edge.edge + 1) % free_edge.polygon->points.size()].pos;
-
-			for (int j = 0; j < free_edges.size(); j++) {
-				const gd::Edge::Connection &other_edge = free_edges[j];
-				if (i == j || free_edge.polygon->owner == other_edge.polygon->owner) {
-					continue;
+				const bool is_second = connections[1].polygon == &poly && connections[1].edge == int(p);
+				if (is_first || is_second) {
+					poly.edges[p].connections.push_back(connections[is_first ? 1 : 0]);
 				}
+			} else if (is_first) {
+				p_region->get_free_edges().push_back(connections[0]);
+			}
+		}
+	}
+}
+
+void NavMap::connect_region_free_edges(NavRegion *p_region) {
+	const std::vector<gd::Edge::Connection> &free_edges = p_region->get_free_edges();
+	if (free_edges.empty()) {
+		return;
+	}
+
+	// Only the free edges of the near regions can be connected.
+	const real_t margin = edge_connection_margin + cell_size;
+	const AABB region_aabb = p_region->get_aabb().grow(margin);
+	LocalVector<NavRegion *> near_regions;
+	for (size_t r(0); r < regions.size(); r++) {
+		if (regions[r] != p_region && !regions[r]->get_free_edges().empty() && regions[r]->get_aabb().intersects(region_aabb)) {
+			near_regions.push_back(regions[r]);
+		}
+	}
+
+	// Find the compatible near edges.
+	//
+	// Note:
+	// Considering that the edges must be compatible (for obvious reasons)
+	// to be connected, create new polygons to remove that small gap is
+	// not really useful and would result in wasteful computation during
+	// connection, integration and path finding.
+	for (size_t i(0); i < free_edges.size(); i++) {
+		const gd::Edge::Connection &free_edge = free_edges[i];
+		Vector3 edge_p1 = free_edge.polygon->points[free_edge.edge].pos;
+		Vector3 edge_p2 = free_edge.polygon->points[(free_edge.edge + 1) % free_edge.polygon->points.size()].pos;
+
+		AABB edge_aabb(edge_p1, Vector3());
+		edge_aabb.expand_to(edge_p2);
+		edge_aabb = edge_aabb.grow(margin);
+
+		for (uint32_t r = 0; r < near_regions.size(); r++) {
+			if (!near_regions[r]->get_aabb().intersects(edge_aabb)) {
+				continue;
+			}
+
+			const std::vector<gd::Edge::Connection> &other_edges = near_regions[r]->get_free_edges();
+			for (size_t j(0); j < other_edges.size(); j++) {
+				const gd::Edge::Connection &other_edge = other_edges[j];
 
 				Vector3 other_edge_p1 = other_edge.polygon->points[other_edge.edge].pos;
 				Vector3 other_edge_p2 = other_edge.polygon->points[(other_edge.edge + 1) % other_edge.polygon->points.size()].pos;
@@ -686,44 +1053,229 @@ void NavMap::sync() {
 				free_edge.polygon->edges[free_edge.edge].connections.push_back(new_connection);
 
 				// Add the connection to the region_connection map.
-				free_edge.polygon->owner->get_connections().push_back(new_connection);
+				p_region->get_connections().push_back(new_connection);
+			}
+		}
+	}
+}
+
+void NavMap::sync() {
+	// Check if we need to update the links.
+	if (regenerate_polygons) {
+		for (size_t r(0); r < regions.size(); r++) {
+			regions[r]->scratch_polygons();
+		}
+		regenerate_links = true;
+	}
+
+	// Key again the edges of the changed regions.
+	LocalVector<NavRegion *> changed_regions;
+	for (size_t r(0); r < regions.size(); r++) {
+		NavRegion *region = regions[r];
+		if (region->is_dirty()) {
+			remove_region_edges(region);
+			region->sync();
+			add_region_edges(region);
+			changed_regions.push_back(region);
+		}
+	}
+
+	// Connect again the regions near the changes, the others keep their
+	// connections as they can't reach the changed polygons.
+	LocalVector<NavRegion *> linked_regions;
+	if (regenerate_links) {
+		for (size_t r(0); r < regions.size(); r++) {
+			linked_regions.push_back(regions[r]);
+		}
+	} else if (!dirty_areas.is_empty()) {
+		const real_t margin = edge_connection_margin + cell_size;
+		for (size_t r(0); r < regions.size(); r++) {
+			if (regions[r]->get_polygons().empty()) {
+				continue;
+			}
+			const AABB region_aabb = regions[r]->get_aabb().grow(margin);
+			for (uint32_t i = 0; i < dirty_areas.size(); i++) {
+				if (region_aabb.intersects(dirty_areas[i])) {
+					linked_regions.push_back(regions[r]);
+					break;
+				}
 			}
 		}
+	}
+
+	if (!changed_regions.is_empty() || !linked_regions.is_empty() || regions_dirty) {
+		// The exact connections and the free edges first, as the free edges
+		// of all the linked regions are needed to connect them.
+		for (uint32_t r = 0; r < linked_regions.size(); r++) {
+			connect_region_edges(linked_regions[r]);
+		}
+		for (uint32_t r = 0; r < linked_regions.size(); r++) {
+			connect_region_free_edges(linked_regions[r]);
+		}
+
+		// Group the connected polygons in clusters, for the long paths.
+		if (use_hierarchical_paths && !hierarchy_dirty) {
+			for (uint32_t r = 0; r < changed_regions.size(); r++) {
+				NavHierarchy::build_clusters(changed_regions[r]);
+			}
+			for (uint32_t r = 0; r < linked_regions.size(); r++) {
+				NavHierarchy::build_portals(linked_regions[r]);
+			}
+			hierarchy.update_offsets(regions);
+		}
+
+		// Number the polygons across the map.
+		polygon_count = 0;
+		for (size_t r(0); r < regions.size(); r++) {
+			regions[r]->set_polygon_offset(polygon_count);
+			polygon_count += regions[r]->get_polygons().size();
+		}
 
 		// Update the update ID.
 		map_update_id = (map_update_id + 1) % 9999999;
 	}
 
-	// Update agents tree.
-	if (agents_dirty) {
-		std::vector<RVO::Agent *> raw_agents;
-		raw_agents.reserve(agents.size());
-		for (size_t i(0); i < agents.size(); i++) {
-			raw_agents.push_back(agents[i]->get_agent());
+	// The hierarchical paths were just enabled, build the whole hierarchy.
+	if (hierarchy_dirty) {
+		for (size_t r(0); r < regions.size(); r++) {
+			NavHierarchy::build_clusters(regions[r]);
+		}
+		for (size_t r(0); r < regions.size(); r++) {
+			NavHierarchy::build_portals(regions[r]);
 		}
-		rvo.buildAgentTree(raw_agents);
+		hierarchy.update_offsets(regions);
+		hierarchy_dirty = false;
 	}
 
 	regenerate_polygons = false;
 	regenerate_links = false;
-	agents_dirty = false;
+	regions_dirty = false;
+	dirty_areas.clear();
+}
+
+void NavMap::update_avoidance_grid() {
+	// The agents are moved between the steps, so the grid is built again
+	// each time: a counting sort of the agents by bucket.
+	avoidance_cell_size = 0.0;
+	for (size_t i(0); i < controlled_agents.size(); i++) {
+		avoidance_cell_size = MAX(avoidance_cell_size, controlled_agents[i]->get_agent()->neighborDist_);
+	}
+	if (avoidance_cell_size <= CMP_EPSILON) {
+		avoidance_cell_size = 1.0;
+	}
+
+	const uint32_t agent_count = agents.size();
+	const uint32_t bucket_count = next_power_of_2(MAX(agent_count, 1u));
+	avoidance_bucket_mask = bucket_count - 1;
+
+	avoidance_buckets.resize(bucket_count + 1);
+	memset(avoidance_buckets.ptr(), 0, avoidance_buckets.size() * sizeof(uint32_t));
+	avoidance_cells.resize(agent_count);
+	avoidance_positions.resize(agent_count);
+	avoidance_agents.resize(agent_count);
+
+	// Count the agents of each bucket.
+	for (uint32_t i = 0; i < agent_count; i++) {
+		avoidance_buckets[get_avoidance_bucket(get_avoidance_cell(agents[i]->get_agent()->position_)) + 1]++;
+	}
+	for (uint32_t b = 0; b < bucket_count; b++) {
+		avoidance_buckets[b + 1] += avoidance_buckets[b];
+	}
+
+	// Place the agents, using the bucket begins as insertion points.
+	for (uint32_t i = 0; i < agent_count; i++) {
+		const RVO::Agent *agent = agents[i]->get_agent();
+		const Vector3i cell = get_avoidance_cell(agent->position_);
+		const uint32_t slot = avoidance_buckets[get_avoidance_bucket(cell)]++;
+		avoidance_cells[slot] = cell;
+		avoidance_positions[slot] = agent->position_;
+		avoidance_agents[slot] = agent;
+	}
+
+	// Each insertion point is now the begin of the next bucket.
+	for (uint32_t b = bucket_count; b > 0; b--) {
+		avoidance_buckets[b] = avoidance_buckets[b - 1];
+	}
+	avoidance_buckets[0] = 0;
+}
+
+void NavMap::compute_agent_neighbors(RVO::Agent *p_agent) const {
+	std::vector<std::pair<float, const RVO::Agent *>> &neighbors = p_agent->agentNeighbors_;
+	neighbors.clear();
+	if (p_agent->maxNeighbors_ == 0) {
+		return;
+	}
+
+	const RVO::Vector3 &position = p_agent->position_;
+	const float range = p_agent->neighborDist_;
+	float range_sq = range * range;
+	const Vector3i from = get_avoidance_cell(position - RVO::Vector3(range, range, range));
+	const Vector3i to = get_avoidance_cell(position + RVO::Vector3(range, range, range));
+
+	for (int z = from.z; z <= to.z; z++) {
+		for (int y = from.y; y <= to.y; y++) {
+			for (int x = from.x; x <= to.x; x++) {
+				const Vector3i cell(x, y, z);
+				const uint32_t bucket = get_avoidance_bucket(cell);
+				const uint32_t end = avoidance_buckets[bucket + 1];
+				for (uint32_t i = avoidance_buckets[bucket]; i < end; i++) {
+					// Other cells can share the bucket.
+					if (avoidance_cells[i] != cell || avoidance_agents[i] == p_agent) {
+						continue;
+					}
+					const float distance_sq = RVO::absSq(avoidance_positions[i] - position);
+					if (distance_sq >= range_sq) {
+						continue;
+					}
+
+					// Same as `RVO::Agent::insertAgentNeighbor()`, without
+					// reading the position from the other agent.
+					if (neighbors.size() < p_agent->maxNeighbors_) {
+						neighbors.push_back(std::make_pair(distance_sq, avoidance_agents[i]));
+					}
+					size_t n = neighbors.size() - 1;
+					while (n != 0 && distance_sq < neighbors[n - 1].first) {
+						neighbors[n] = neighbors[n - 1];
+						n--;
+					}
+					neighbors[n] = std::make_pair(distance_sq, avoidance_agents[i]);
+
+					// Narrows the range once the neighbors are full.
+					if (neighbors.size() == p_agent->maxNeighbors_) {
+						range_sq = neighbors.back().first;
+					}
+				}
+			}
+		}
+	}
 }
 
 void NavMap::compute_single_step(uint32_t index, RvoAgent **agent) {
-	(*(agent + index))->get_agent()->computeNeighbors(&rvo);
-	(*(agent + index))->get_agent()->computeNewVelocity(deltatime);
+	RVO::Agent *rvo_agent = (*(agent + index))->get_agent();
+	compute_agent_neighbors(rvo_agent);
+	rvo_agent->computeNewVelocity(deltatime);
 }
 
-void NavMap::step(real_t p_deltatime) {
+void NavMap::step(real_t p_deltatime, ThreadWorkPool &p_work_pool) {
 	deltatime = p_deltatime;
 	if (controlled_agents.size() > 0) {
-		thread_process_array(
-				controlled_agents.size(),
-				this,
-				&NavMap::compute_single_step,
-				controlled_agents.data());
+		update_avoidance_grid();
+
+		if (p_work_pool.get_thread_count() == 0) {
+			p_work_pool.init();
+		}
+		p_work_pool.do_work(controlled_agents.size(), this, &NavMap::compute_single_step, controlled_agents.data());
+	}
+}
+
+#ifdef TESTS_ENABLED
+void NavMap::compute_neighbors() {
+	update_avoidance_grid();
+	for (size_t i(0); i < agents.size(); i++) {
+		compute_agent_neighbors(agents[i]->get_agent());
 	}
 }
+#endif
 
 void NavMap::dispatch_callbacks() {
 	for (int i(0); i < static_cast<int>(controlled_agents.size()); i++) {
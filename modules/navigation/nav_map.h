@@ -34,9 +34,12 @@
 #include "nav_rid.h"
 
 #include "core/math/math_defs.h"
+#include "core/math/vector3i.h"
+#include "core/os/mutex.h"
 #include "core/templates/map.h"
+#include "nav_hierarchy.h"
 #include "nav_utils.h"
-#include <KdTree.h>
+#include <Agent.h>
 
 /**
 	@author AndreaCatania
@@ -45,6 +48,7 @@
 class NavRegion;
 class RvoAgent;
 class NavRegion;
+class ThreadWorkPool;
 
 class NavMap : public NavRid {
 	/// Map Up
@@ -60,16 +64,40 @@ class NavMap : public NavRid {
 	bool regenerate_polygons = true;
 	bool regenerate_links = true;
 
+	/// Are regions added or removed?
+	bool regions_dirty = false;
+
 	std::vector<NavRegion *> regions;
 
-	/// Map polygons
-	std::vector<gd::Polygon> polygons;
+	/// The polygons are owned by the regions, they are numbered across the map
+	/// using the region offsets.
+	uint32_t polygon_count = 0;
+
+	/// All the edges of the map polygons, grouped per key. Kept between the
+	/// syncs, so only the edges of the changed regions are keyed again.
+	Map<gd::EdgeKey, Vector<gd::Edge::Connection>> edge_connections;
 
-	/// Rvo world
-	RVO::KdTree rvo;
+	/// Bounds of the polygons changed or removed since the last sync. Only
+	/// the regions near them are connected again.
+	LocalVector<AABB> dirty_areas;
 
-	/// Is agent array modified?
-	bool agents_dirty = false;
+	/// Clusters of polygons used to plan long paths, only built when the
+	/// hierarchical paths are used.
+	bool use_hierarchical_paths = false;
+	bool hierarchy_dirty = false;
+	NavHierarchy hierarchy;
+
+	/// Rvo world, a grid of cells as large as the longest neighbor distance.
+	/// The cells are hashed into buckets and the agents are sorted per bucket
+	/// at each step, so the neighbors of an agent are in the buckets of the
+	/// cells overlapping its range. The agent data read by the search is kept
+	/// in separate arrays in the same order.
+	real_t avoidance_cell_size = 1.0;
+	uint32_t avoidance_bucket_mask = 0;
+	LocalVector<uint32_t> avoidance_buckets;
+	LocalVector<Vector3i> avoidance_cells;
+	LocalVector<RVO::Vector3> avoidance_positions;
+	LocalVector<const RVO::Agent *> avoidance_agents;
 
 	/// All the Agents (even the controlled one)
 	std::vector<RvoAgent *> agents;
@@ -85,6 +113,7 @@ class NavMap : public NavRid {
 
 public:
 	NavMap() {}
+	~NavMap();
 
 	void set_up(Vector3 p_up);
 	Vector3 get_up() const {
@@ -101,6 +130,14 @@ public:
 		return edge_connection_margin;
 	}
 
+	/// Plans the paths over clusters of polygons first, then only searches
+	/// the polygons of the crossed clusters. Faster on large maps, but the
+	/// paths may be slightly longer and the syncs are slower.
+	void set_use_hierarchical_paths(bool p_enabled);
+	bool get_use_hierarchical_paths() const {
+		return use_hierarchical_paths;
+	}
+
 	gd::PointKey get_point_key(const Vector3 &p_pos) const;
 
 	Vector<Vector3> get_path(Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_layers = 1) const;
@@ -129,11 +166,127 @@ public:
 		return map_update_id;
 	}
 
+	/// Direction to follow from `p_position` to reach the nearest target. The
+	/// distances to the targets are computed once for all the polygons, and
+	/// cached until the map changes.
+	Vector3 get_flow_direction(const Vector<Vector3> &p_targets, const Vector3 &p_position, uint32_t p_layers) const;
+
 	void sync();
-	void step(real_t p_deltatime);
+	/// Computes the avoidance velocities of the controlled agents using the
+	/// given pool, which must not be working.
+	void step(real_t p_deltatime, ThreadWorkPool &p_work_pool);
 	void dispatch_callbacks();
 
+#ifdef TESTS_ENABLED
+	/// Fills the neighbors of all the agents the way a step does, without
+	/// computing the velocities.
+	void compute_neighbors();
+#endif
+
 private:
+	/// Buffers reused by the path queries, there is one per thread so queries can run in parallel.
+	struct PathQueryScratch {
+		struct OpenEntry {
+			float cost = 0.0;
+			float traveled_distance = 0.0;
+			uint32_t id = 0;
+
+			/// Reversed, so the standard max-heap pops the least cost first.
+			bool operator<(const OpenEntry &p_other) const {
+				return cost > p_other.cost;
+			}
+		};
+
+		std::vector<gd::NavigationPoly> navigation_polys;
+		std::vector<OpenEntry> to_visit;
+
+		/// Index in `navigation_polys` of each map polygon, valid only if reached during this pass.
+		std::vector<uint32_t> navigation_poly_ids;
+		std::vector<uint32_t> pass_ids;
+		uint32_t pass = 0;
+
+		/// Clusters the search is restricted to, when refining a hierarchical path.
+		LocalVector<uint32_t> corridor_clusters;
+		std::vector<uint32_t> corridor_pass_ids;
+		uint32_t corridor_pass = 0;
+
+		void reset(uint32_t p_polygon_count);
+		void set_corridor(uint32_t p_cluster_count);
+
+		bool is_in_corridor(uint32_t p_cluster) const {
+			return corridor_pass_ids[p_cluster] == corridor_pass;
+		}
+
+		int get_navigation_poly_id(uint32_t p_polygon_id) const {
+			return pass_ids[p_polygon_id] == pass ? int(navigation_poly_ids[p_polygon_id]) : -1;
+		}
+
+		void set_navigation_poly_id(uint32_t p_polygon_id, uint32_t p_navigation_poly_id) {
+			navigation_poly_ids[p_polygon_id] = p_navigation_poly_id;
+			pass_ids[p_polygon_id] = pass;
+		}
+	};
+
+	static thread_local PathQueryScratch path_query_scratch;
+
+	/// Distances from all the polygons to a set of targets, shared by the
+	/// agents heading to the same targets.
+	struct FlowField {
+		Vector<Vector3> targets;
+		uint32_t layers = 0;
+		uint32_t map_update_id = 0;
+		uint64_t last_use = 0;
+
+		/// Indexed like the polygons of the path queries.
+		LocalVector<float> distances;
+		/// Point to walk towards: on the pathway to the next polygon, or the
+		/// target itself in the polygons of the targets.
+		LocalVector<Vector3> exits;
+		/// Next polygon towards the targets, null in the polygons of the targets.
+		LocalVector<const gd::Polygon *> next_polygons;
+	};
+
+	static const uint32_t MAX_FLOW_FIELDS = 8;
+	/// Only guards the cache, the fields are computed unlocked and then swapped in.
+	mutable Mutex flow_fields_mutex;
+	mutable LocalVector<FlowField *> flow_fields;
+	mutable uint64_t flow_field_uses = 0;
+
+	struct ClosestPointQueryResult {
+		const gd::Polygon *polygon = nullptr;
+		Vector3 point;
+		Vector3 normal;
+		real_t distance_squared = 1e20;
+	};
+
+	/// Closest point on the polygons of the regions sharing a layer with `p_layers`.
+	void query_closest_point(const Vector3 &p_point, uint32_t p_layers, ClosestPointQueryResult &r_result) const;
+	/// Intersection of the segment with the polygons which is closest to `p_from`.
+	bool query_segment_intersection(const Vector3 &p_from, const Vector3 &p_to, Vector3 &r_point) const;
+	/// Point of the polygon edges closest to the segment.
+	bool query_closest_edge_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, Vector3 &r_point) const;
+
+	/// Index of the cached flow field of the targets, or -1. The flow fields
+	/// mutex must be locked.
+	int find_flow_field(const Vector<Vector3> &p_targets, uint32_t p_layers) const;
+	Vector3 get_flow_field_direction(const FlowField &p_field, const ClosestPointQueryResult &p_position) const;
+	void compute_flow_field(FlowField &r_field) const;
+
+	void add_region_edges(NavRegion *p_region);
+	void remove_region_edges(NavRegion *p_region);
+	void connect_region_edges(NavRegion *p_region);
+	void connect_region_free_edges(NavRegion *p_region);
+
+	bool search_route(PathQueryScratch &scratch, const gd::Polygon *p_begin_poly, const Vector3 &p_begin_point, const gd::Polygon *&r_end_poly, Vector3 &r_end_point, const Vector3 &p_destination, uint32_t p_layers, bool p_use_corridor, int &r_least_cost_id) const;
+
+	_FORCE_INLINE_ uint32_t get_avoidance_bucket(const Vector3i &p_cell) const {
+		return ((uint32_t(p_cell.x) * 73856093u) ^ (uint32_t(p_cell.y) * 19349663u) ^ (uint32_t(p_cell.z) * 83492791u)) & avoidance_bucket_mask;
+	}
+	_FORCE_INLINE_ Vector3i get_avoidance_cell(const RVO::Vector3 &p_position) const {
+		return Vector3i(Math::floor(p_position.x() / avoidance_cell_size), Math::floor(p_position.y() / avoidance_cell_size), Math::floor(p_position.z() / avoidance_cell_size));
+	}
+	void update_avoidance_grid();
+	void compute_agent_neighbors(RVO::Agent *p_agent) const;
 	void compute_single_step(uint32_t index, RvoAgent **agent);
 	void clip_path(const std::vector<gd::NavigationPoly> &p_navigation_polys, Vector<Vector3> &path, const gd::NavigationPoly *from_poly, const Vector3 &p_to_point, const gd::NavigationPoly *p_to_poly) const;
 };
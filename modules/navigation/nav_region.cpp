@@ -32,6 +32,8 @@
 
 #include "nav_map.h"
 
+#include <algorithm>
+
 /**
 	@author AndreaCatania
 */
@@ -94,6 +96,11 @@ void NavRegion::update_polygons() {
 		return;
 	}
 	polygons.clear();
+	bvh.clear();
+	bvh_polygons.clear();
+	free_edges.clear();
+	clusters.clear();
+	portals.clear();
 	polygons_dirty = false;
 
 	if (map == nullptr) {
@@ -118,6 +125,7 @@ void NavRegion::update_polygons() {
 	for (size_t i(0); i < polygons.size(); i++) {
 		gd::Polygon &p = polygons[i];
 		p.owner = this;
+		p.id = i;
 
 		Vector<int> mesh_poly = mesh->get_polygon(i);
 		const int *indices = mesh_poly.ptr();
@@ -158,4 +166,70 @@ void NavRegion::update_polygons() {
 			p.center = center / float(mesh_poly.size());
 		}
 	}
+
+	update_bvh();
+}
+
+#define BVH_LEAF_SIZE 4
+
+void NavRegion::update_bvh() {
+	bvh.clear();
+	bvh_polygons.clear();
+
+	if (polygons.empty()) {
+		return;
+	}
+
+	std::vector<AABB> aabbs(polygons.size());
+	std::vector<Vector3> centers(polygons.size());
+	bvh_polygons.resize(polygons.size());
+	for (size_t i(0); i < polygons.size(); i++) {
+		const gd::Polygon &p = polygons[i];
+		if (!p.points.empty()) {
+			aabbs[i].position = p.points[0].pos;
+			for (size_t j(1); j < p.points.size(); j++) {
+				aabbs[i].expand_to(p.points[j].pos);
+			}
+		}
+		centers[i] = aabbs[i].position + aabbs[i].size * 0.5;
+		bvh_polygons[i] = i;
+	}
+
+	// A binary tree with leaves of at least one polygon has less than twice as many nodes.
+	bvh.reserve(polygons.size() * 2);
+	bvh.resize(1);
+	build_bvh_node(0, 0, polygons.size(), aabbs, centers);
+}
+
+void NavRegion::build_bvh_node(uint32_t p_node, uint32_t p_begin, uint32_t p_end, const std::vector<AABB> &p_aabbs, const std::vector<Vector3> &p_centers) {
+	AABB aabb = p_aabbs[bvh_polygons[p_begin]];
+	AABB centers_aabb(p_centers[bvh_polygons[p_begin]], Vector3());
+	for (uint32_t i = p_begin + 1; i < p_end; i++) {
+		aabb.merge_with(p_aabbs[bvh_polygons[i]]);
+		centers_aabb.expand_to(p_centers[bvh_polygons[i]]);
+	}
+	bvh[p_node].aabb = aabb;
+
+	const int axis = centers_aabb.get_longest_axis_index();
+	if (p_end - p_begin <= BVH_LEAF_SIZE || centers_aabb.size[axis] <= 0.0) {
+		bvh[p_node].first = p_begin;
+		bvh[p_node].count = p_end - p_begin;
+		return;
+	}
+
+	// Split at the median along the longest axis of the centers.
+	const uint32_t middle = (p_begin + p_end) / 2;
+	std::nth_element(bvh_polygons.begin() + p_begin, bvh_polygons.begin() + middle, bvh_polygons.begin() + p_end, [&](uint32_t p_a, uint32_t p_b) {
+		return p_centers[p_a][axis] < p_centers[p_b][axis];
+	});
+
+	const uint32_t left = bvh.size();
+	bvh.resize(left + 2);
+	bvh[p_node].first = left;
+	bvh[p_node].count = 0;
+
+	build_bvh_node(left, p_begin, middle, p_aabbs, p_centers);
+	build_bvh_node(left + 1, middle, p_end, p_aabbs, p_centers);
 }
+
+#undef BVH_LEAF_SIZE
@@ -56,6 +56,23 @@ class NavRegion : public NavRid {
 	/// Cache
 	std::vector<gd::Polygon> polygons;
 
+	/// Bounding volume hierarchy over the polygons, rebuilt with them.
+	std::vector<gd::BVHNode> bvh;
+	std::vector<uint32_t> bvh_polygons;
+
+	/// Edges not shared with another polygon, which may be connected to the
+	/// near regions. Kept between the map syncs like the connections.
+	std::vector<gd::Edge::Connection> free_edges;
+
+	/// Abstract graph over the polygons, see `NavHierarchy`.
+	std::vector<gd::Cluster> clusters;
+	std::vector<gd::Portal> portals;
+
+	/// Index of the first polygon, cluster and portal of this region in the map.
+	uint32_t polygon_offset = 0;
+	uint32_t cluster_offset = 0;
+	uint32_t portal_offset = 0;
+
 public:
 	NavRegion() {}
 
@@ -63,6 +80,10 @@ public:
 		polygons_dirty = true;
 	}
 
+	bool is_dirty() const {
+		return polygons_dirty;
+	}
+
 	void set_map(NavMap *p_map);
 	NavMap *get_map() const {
 		return map;
@@ -88,14 +109,74 @@ public:
 	Vector3 get_connection_pathway_start(int p_connection_id) const;
 	Vector3 get_connection_pathway_end(int p_connection_id) const;
 
+	std::vector<gd::Polygon> &get_polygons() {
+		return polygons;
+	}
+
 	std::vector<gd::Polygon> const &get_polygons() const {
 		return polygons;
 	}
 
+	/// Bounds of the polygons, empty when there are none.
+	AABB get_aabb() const {
+		return bvh.empty() ? AABB() : bvh[0].aabb;
+	}
+
+	std::vector<gd::BVHNode> const &get_bvh() const {
+		return bvh;
+	}
+
+	std::vector<uint32_t> const &get_bvh_polygons() const {
+		return bvh_polygons;
+	}
+
+	std::vector<gd::Edge::Connection> &get_free_edges() {
+		return free_edges;
+	}
+
+	std::vector<gd::Cluster> &get_clusters() {
+		return clusters;
+	}
+
+	std::vector<gd::Cluster> const &get_clusters() const {
+		return clusters;
+	}
+
+	std::vector<gd::Portal> &get_portals() {
+		return portals;
+	}
+
+	std::vector<gd::Portal> const &get_portals() const {
+		return portals;
+	}
+
+	void set_polygon_offset(uint32_t p_offset) {
+		polygon_offset = p_offset;
+	}
+	uint32_t get_polygon_offset() const {
+		return polygon_offset;
+	}
+
+	void set_cluster_offset(uint32_t p_offset) {
+		cluster_offset = p_offset;
+	}
+	uint32_t get_cluster_offset() const {
+		return cluster_offset;
+	}
+
+	void set_portal_offset(uint32_t p_offset) {
+		portal_offset = p_offset;
+	}
+	uint32_t get_portal_offset() const {
+		return portal_offset;
+	}
+
 	bool sync();
 
 private:
 	void update_polygons();
+	void update_bvh();
+	void build_bvh_node(uint32_t p_node, uint32_t p_begin, uint32_t p_end, const std::vector<AABB> &p_aabbs, const std::vector<Vector3> &p_centers);
 };
 
 #endif // NAV_REGION_H
@@ -31,7 +31,9 @@
 #ifndef NAV_UTILS_H
 #define NAV_UTILS_H
 
+#include "core/math/aabb.h"
 #include "core/math/vector3.h"
+#include "core/templates/local_vector.h"
 
 #include <vector>
 
@@ -94,6 +96,12 @@ struct Edge {
 struct Polygon {
 	NavRegion *owner;
 
+	/// The index of this `Polygon` in its region.
+	uint32_t id = 0;
+
+	/// The cluster of this `Polygon` in its region, see `NavHierarchy`.
+	uint32_t cluster = 0;
+
 	/// The points of this `Polygon`
 	std::vector<Point> points;
 
@@ -107,6 +115,51 @@ struct Polygon {
 	Vector3 center;
 };
 
+/// A node of the bounding volume hierarchy over the polygons of a region.
+struct BVHNode {
+	AABB aabb;
+
+	/// For leaves, the range of polygon indices in `NavRegion::get_bvh_polygons()`.
+	/// For internal nodes, `first` is the index of the left child, the right one follows it.
+	uint32_t first = 0;
+	uint32_t count = 0;
+
+	bool is_leaf() const {
+		return count > 0;
+	}
+};
+
+/// A group of connected polygons of a region, see `NavHierarchy`.
+struct Cluster {
+	/// Indices of the polygons in the region.
+	LocalVector<uint32_t> polygons;
+
+	/// Indices of the portals in the region.
+	LocalVector<uint32_t> portals;
+};
+
+/// Where the paths leave a cluster for a neighbouring one.
+struct Portal {
+	struct Link {
+		uint32_t portal = 0;
+		float cost = 0.0;
+	};
+
+	uint32_t cluster = 0;
+
+	/// Index of the polygon in the region.
+	uint32_t polygon = 0;
+	Vector3 position;
+
+	/// The neighbouring cluster, its portal towards this cluster is looked up
+	/// when searching so that each region can be updated alone.
+	const NavRegion *other_region = nullptr;
+	uint32_t other_cluster = 0;
+
+	/// The costs to the other portals of the same cluster.
+	LocalVector<Link> links;
+};
+
 struct NavigationPoly {
 	uint32_t self_id = 0;
 	/// This poly.
@@ -33,7 +33,9 @@
 #include "navigation_mesh_generator.h"
 
 #include "core/math/convex_hull.h"
+#include "core/object/message_queue.h"
 #include "core/os/thread.h"
+#include "core/templates/hash_map.h"
 #include "scene/3d/collision_shape_3d.h"
 #include "scene/3d/mesh_instance_3d.h"
 #include "scene/3d/physics_body_3d.h"
@@ -300,6 +302,24 @@ void NavigationMeshGenerator::_convert_detail_mesh_to_native_navigation_mesh(con
 	}
 }
 
+void NavigationMeshGenerator::_init_recast_config(Ref<NavigationMesh> p_nav_mesh, rcConfig &r_cfg) {
+	memset(&r_cfg, 0, sizeof(r_cfg));
+
+	r_cfg.cs = p_nav_mesh->get_cell_size();
+	r_cfg.ch = p_nav_mesh->get_cell_height();
+	r_cfg.walkableSlopeAngle = p_nav_mesh->get_agent_max_slope();
+	r_cfg.walkableHeight = (int)Math::ceil(p_nav_mesh->get_agent_height() / r_cfg.ch);
+	r_cfg.walkableClimb = (int)Math::floor(p_nav_mesh->get_agent_max_climb() / r_cfg.ch);
+	r_cfg.walkableRadius = (int)Math::ceil(p_nav_mesh->get_agent_radius() / r_cfg.cs);
+	r_cfg.maxEdgeLen = (int)(p_nav_mesh->get_edge_max_length() / p_nav_mesh->get_cell_size());
+	r_cfg.maxSimplificationError = p_nav_mesh->get_edge_max_error();
+	r_cfg.minRegionArea = (int)(p_nav_mesh->get_region_min_size() * p_nav_mesh->get_region_min_size());
+	r_cfg.mergeRegionArea = (int)(p_nav_mesh->get_region_merge_size() * p_nav_mesh->get_region_merge_size());
+	r_cfg.maxVertsPerPoly = (int)p_nav_mesh->get_verts_per_poly();
+	r_cfg.detailSampleDist = p_nav_mesh->get_detail_sample_distance() < 0.9f ? 0 : p_nav_mesh->get_cell_size() * p_nav_mesh->get_detail_sample_distance();
+	r_cfg.detailSampleMaxError = p_nav_mesh->get_cell_height() * p_nav_mesh->get_detail_sample_max_error();
+}
+
 void NavigationMeshGenerator::_build_recast_navigation_mesh(
 		Ref<NavigationMesh> p_nav_mesh,
 #ifdef TOOLS_ENABLED
@@ -329,21 +349,7 @@ void NavigationMeshGenerator::_build_recast_navigation_mesh(
 	rcCalcBounds(verts, nverts, bmin, bmax);
 
 	rcConfig cfg;
-	memset(&cfg, 0, sizeof(cfg));
-
-	cfg.cs = p_nav_mesh->get_cell_size();
-	cfg.ch = p_nav_mesh->get_cell_height();
-	cfg.walkableSlopeAngle = p_nav_mesh->get_agent_max_slope();
-	cfg.walkableHeight = (int)Math::ceil(p_nav_mesh->get_agent_height() / cfg.ch);
-	cfg.walkableClimb = (int)Math::floor(p_nav_mesh->get_agent_max_climb() / cfg.ch);
-	cfg.walkableRadius = (int)Math::ceil(p_nav_mesh->get_agent_radius() / cfg.cs);
-	cfg.maxEdgeLen = (int)(p_nav_mesh->get_edge_max_length() / p_nav_mesh->get_cell_size());
-	cfg.maxSimplificationError = p_nav_mesh->get_edge_max_error();
-	cfg.minRegionArea = (int)(p_nav_mesh->get_region_min_size() * p_nav_mesh->get_region_min_size());
-	cfg.mergeRegionArea = (int)(p_nav_mesh->get_region_merge_size() * p_nav_mesh->get_region_merge_size());
-	cfg.maxVertsPerPoly = (int)p_nav_mesh->get_verts_per_poly();
-	cfg.detailSampleDist = p_nav_mesh->get_detail_sample_distance() < 0.9f ? 0 : p_nav_mesh->get_cell_size() * p_nav_mesh->get_detail_sample_distance();
-	cfg.detailSampleMaxError = p_nav_mesh->get_cell_height() * p_nav_mesh->get_detail_sample_max_error();
+	_init_recast_config(p_nav_mesh, cfg);
 
 	cfg.bmin[0] = bmin[0];
 	cfg.bmin[1] = bmin[1];
@@ -477,6 +483,375 @@ void NavigationMeshGenerator::_build_recast_navigation_mesh(
 	detail_mesh = nullptr;
 }
 
+// Welds the vertices the tiles share on their borders.
+struct NavigationMeshVertexHasher {
+	static _FORCE_INLINE_ uint32_t hash(const Vector3i &p_key) {
+		uint32_t h = hash_djb2_one_32(uint32_t(p_key.x));
+		h = hash_djb2_one_32(uint32_t(p_key.y), h);
+		return hash_djb2_one_32(uint32_t(p_key.z), h);
+	}
+};
+
+void NavigationMeshGenerator::_convert_tiles_to_native_navigation_mesh(const BakeCache &p_cache, float p_cell_size, float p_cell_height, Ref<NavigationMesh> p_nav_mesh) {
+	// The vertices of neighbouring tiles are computed from different
+	// origins, snap them to a grid finer than the cells before merging.
+	const Vector3 snap(p_cell_size * 0.25, p_cell_height * 0.25, p_cell_size * 0.25);
+
+	Vector<Vector3> nav_vertices;
+	HashMap<Vector3i, int, NavigationMeshVertexHasher> vertex_ids;
+	LocalVector<int> tile_vertex_ids;
+
+	p_nav_mesh->clear_polygons();
+
+	for (const Map<Vector2i, BakeTile>::Element *E = p_cache.tiles.front(); E; E = E->next()) {
+		const rcPolyMeshDetail *detail_mesh = E->get().detail_mesh;
+		if (!detail_mesh) {
+			continue;
+		}
+
+		tile_vertex_ids.resize(detail_mesh->nverts);
+		for (int i = 0; i < detail_mesh->nverts; i++) {
+			const float *v = &detail_mesh->verts[i * 3];
+			const Vector3 position(v[0], v[1], v[2]);
+			const Vector3i key(Math::round(position.x / snap.x), Math::round(position.y / snap.y), Math::round(position.z / snap.z));
+
+			const int *id = vertex_ids.getptr(key);
+			if (id) {
+				tile_vertex_ids[i] = *id;
+			} else {
+				tile_vertex_ids[i] = nav_vertices.size();
+				vertex_ids.set(key, nav_vertices.size());
+				nav_vertices.push_back(position);
+			}
+		}
+
+		for (int i = 0; i < detail_mesh->nmeshes; i++) {
+			const unsigned int *m = &detail_mesh->meshes[i * 4];
+			const unsigned int bverts = m[0];
+			const unsigned int btris = m[2];
+			const unsigned int ntris = m[3];
+			const unsigned char *tris = &detail_mesh->tris[btris * 4];
+			for (unsigned int j = 0; j < ntris; j++) {
+				Vector<int> nav_indices;
+				nav_indices.resize(3);
+				// Polygon order in recast is opposite than godot's
+				nav_indices.write[0] = tile_vertex_ids[bverts + tris[j * 4 + 0]];
+				nav_indices.write[1] = tile_vertex_ids[bverts + tris[j * 4 + 2]];
+				nav_indices.write[2] = tile_vertex_ids[bverts + tris[j * 4 + 1]];
+				if (nav_indices[0] == nav_indices[1] || nav_indices[1] == nav_indices[2] || nav_indices[2] == nav_indices[0]) {
+					continue;
+				}
+				p_nav_mesh->add_polygon(nav_indices);
+			}
+		}
+	}
+
+	p_nav_mesh->set_vertices(nav_vertices);
+}
+
+void NavigationMeshGenerator::_free_bake_cache(BakeCache &r_cache) {
+	for (Map<Vector2i, BakeTile>::Element *E = r_cache.tiles.front(); E; E = E->next()) {
+		rcFreePolyMeshDetail(E->get().detail_mesh);
+	}
+	r_cache.tiles.clear();
+}
+
+bool NavigationMeshGenerator::_bake_tile(const TileBuildData *p_data, const TileBuild &p_build, rcHeightfield *&r_hf, rcCompactHeightfield *&r_chf, rcContourSet *&r_cset, rcPolyMesh *&r_poly_mesh, rcPolyMeshDetail *&r_detail_mesh) {
+	Ref<NavigationMesh> nav_mesh = p_data->nav_mesh;
+	rcContext ctx(false);
+
+	rcConfig cfg = p_data->config;
+	for (int i = 0; i < 3; i++) {
+		cfg.bmin[i] = p_build.bmin[i];
+		cfg.bmax[i] = p_build.bmax[i];
+	}
+
+	const int *tris = p_build.triangles.ptr();
+	const int ntris = p_build.triangles.size() / 3;
+
+	// Same steps as for the whole mesh, the border of the tile gives the
+	// same polygons on both sides of the edges between the tiles.
+	r_hf = rcAllocHeightfield();
+	ERR_FAIL_COND_V(!r_hf, false);
+	ERR_FAIL_COND_V(!rcCreateHeightfield(&ctx, *r_hf, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch), false);
+
+	{
+		LocalVector<unsigned char> tri_areas;
+		tri_areas.resize(ntris);
+		memset(tri_areas.ptr(), 0, ntris * sizeof(unsigned char));
+		rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, p_data->vertices, p_data->vertex_count, tris, ntris, tri_areas.ptr());
+		ERR_FAIL_COND_V(!rcRasterizeTriangles(&ctx, p_data->vertices, p_data->vertex_count, tris, tri_areas.ptr(), ntris, *r_hf, cfg.walkableClimb), false);
+	}
+
+	if (nav_mesh->get_filter_low_hanging_obstacles()) {
+		rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *r_hf);
+	}
+	if (nav_mesh->get_filter_ledge_spans()) {
+		rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *r_hf);
+	}
+	if (nav_mesh->get_filter_walkable_low_height_spans()) {
+		rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *r_hf);
+	}
+
+	r_chf = rcAllocCompactHeightfield();
+	ERR_FAIL_COND_V(!r_chf, false);
+	ERR_FAIL_COND_V(!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *r_hf, *r_chf), false);
+	ERR_FAIL_COND_V(!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *r_chf), false);
+
+	if (nav_mesh->get_sample_partition_type() == NavigationMesh::SAMPLE_PARTITION_WATERSHED) {
+		ERR_FAIL_COND_V(!rcBuildDistanceField(&ctx, *r_chf), false);
+		ERR_FAIL_COND_V(!rcBuildRegions(&ctx, *r_chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea), false);
+	} else if (nav_mesh->get_sample_partition_type() == NavigationMesh::SAMPLE_PARTITION_MONOTONE) {
+		ERR_FAIL_COND_V(!rcBuildRegionsMonotone(&ctx, *r_chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea), false);
+	} else {
+		ERR_FAIL_COND_V(!rcBuildLayerRegions(&ctx, *r_chf, cfg.borderSize, cfg.minRegionArea), false);
+	}
+
+	r_cset = rcAllocContourSet();
+	ERR_FAIL_COND_V(!r_cset, false);
+	ERR_FAIL_COND_V(!rcBuildContours(&ctx, *r_chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *r_cset), false);
+
+	r_poly_mesh = rcAllocPolyMesh();
+	ERR_FAIL_COND_V(!r_poly_mesh, false);
+	ERR_FAIL_COND_V(!rcBuildPolyMesh(&ctx, *r_cset, cfg.maxVertsPerPoly, *r_poly_mesh), false);
+
+	r_detail_mesh = rcAllocPolyMeshDetail();
+	ERR_FAIL_COND_V(!r_detail_mesh, false);
+	ERR_FAIL_COND_V(!rcBuildPolyMeshDetail(&ctx, *r_poly_mesh, *r_chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *r_detail_mesh), false);
+
+	return true;
+}
+
+void NavigationMeshGenerator::_build_tile(uint32_t p_index, TileBuildData *p_data) {
+	TileBuild &build = p_data->builds[p_index];
+
+	rcHeightfield *hf = nullptr;
+	rcCompactHeightfield *chf = nullptr;
+	rcContourSet *cset = nullptr;
+	rcPolyMesh *poly_mesh = nullptr;
+	rcPolyMeshDetail *detail_mesh = nullptr;
+
+	const bool baked = _bake_tile(p_data, build, hf, chf, cset, poly_mesh, detail_mesh);
+
+	rcFreeHeightField(hf);
+	rcFreeCompactHeightfield(chf);
+	rcFreeContourSet(cset);
+	rcFreePolyMesh(poly_mesh);
+
+	// Tiles without polygons are cached empty.
+	if (!baked || detail_mesh->nmeshes == 0) {
+		rcFreePolyMeshDetail(detail_mesh);
+		detail_mesh = nullptr;
+	}
+	build.detail_mesh = detail_mesh;
+}
+
+uint32_t NavigationMeshGenerator::_build_recast_navigation_mesh_tiled(
+		Ref<NavigationMesh> p_nav_mesh,
+#ifdef TOOLS_ENABLED
+		EditorProgress *ep,
+#endif
+		ObjectID p_cache_id,
+		const Vector<float> &p_vertices,
+		const Vector<int> &p_indices) {
+#ifdef TOOLS_ENABLED
+	if (ep) {
+		ep->step(TTR("Setting up Configuration..."), 1);
+	}
+#endif
+
+	TileBuildData data;
+	_init_recast_config(p_nav_mesh, data.config);
+	rcConfig &cfg = data.config;
+	cfg.tileSize = p_nav_mesh->get_tile_size();
+	cfg.borderSize = cfg.walkableRadius + 3;
+	cfg.width = cfg.tileSize + cfg.borderSize * 2;
+	cfg.height = cfg.width;
+
+	// Any change of the settings invalidates all the tiles.
+	uint32_t config_hash = hash_djb2_buffer((const uint8_t *)&cfg, sizeof(cfg));
+	config_hash = hash_djb2_one_32(p_nav_mesh->get_sample_partition_type(), config_hash);
+	config_hash = hash_djb2_one_32(p_nav_mesh->get_filter_low_hanging_obstacles(), config_hash);
+	config_hash = hash_djb2_one_32(p_nav_mesh->get_filter_ledge_spans(), config_hash);
+	config_hash = hash_djb2_one_32(p_nav_mesh->get_filter_walkable_low_height_spans(), config_hash);
+
+	data.nav_mesh = p_nav_mesh;
+	data.vertices = p_vertices.ptr();
+	data.vertex_count = p_vertices.size() / 3;
+
+	const int *tris = p_indices.ptr();
+	const int ntris = p_indices.size() / 3;
+
+	// The tiles are aligned to the world origin, so they stay the same when
+	// the geometry grows, and each one gets the triangles overlapping it and its border.
+	const float tile_width = cfg.tileSize * cfg.cs;
+	const float border_width = cfg.borderSize * cfg.cs;
+	Map<Vector2i, int> build_ids;
+	LocalVector<TileBuild> builds;
+	for (int i = 0; i < ntris; i++) {
+		float tri_min[3];
+		float tri_max[3];
+		for (int j = 0; j < 3; j++) {
+			const float *v = &data.vertices[tris[i * 3 + j] * 3];
+			for (int k = 0; k < 3; k++) {
+				tri_min[k] = j == 0 ? v[k] : MIN(tri_min[k], v[k]);
+				tri_max[k] = j == 0 ? v[k] : MAX(tri_max[k], v[k]);
+			}
+		}
+
+		const int begin_x = (int)Math::floor((tri_min[0] - border_width) / tile_width);
+		const int end_x = (int)Math::floor((tri_max[0] + border_width) / tile_width);
+		const int begin_z = (int)Math::floor((tri_min[2] - border_width) / tile_width);
+		const int end_z = (int)Math::floor((tri_max[2] + border_width) / tile_width);
+		for (int z = begin_z; z <= end_z; z++) {
+			for (int x = begin_x; x <= end_x; x++) {
+				const Vector2i coord(x, z);
+				Map<Vector2i, int>::Element *E = build_ids.find(coord);
+				if (!E) {
+					E = build_ids.insert(coord, builds.size());
+					builds.resize(builds.size() + 1);
+					TileBuild &build = builds[builds.size() - 1];
+					build.coord = coord;
+					build.hash = config_hash;
+					build.bmin[0] = x * tile_width - border_width;
+					build.bmin[1] = tri_min[1];
+					build.bmin[2] = z * tile_width - border_width;
+					build.bmax[0] = (x + 1) * tile_width + border_width;
+					build.bmax[1] = tri_max[1];
+					build.bmax[2] = (z + 1) * tile_width + border_width;
+				}
+
+				TileBuild &build = builds[E->get()];
+				build.bmin[1] = MIN(build.bmin[1], tri_min[1]);
+				build.bmax[1] = MAX(build.bmax[1], tri_max[1]);
+				for (int j = 0; j < 3; j++) {
+					build.triangles.push_back(tris[i * 3 + j]);
+					build.hash = hash_djb2_buffer((const uint8_t *)&data.vertices[tris[i * 3 + j] * 3], sizeof(float) * 3, build.hash);
+				}
+			}
+		}
+	}
+
+	// Bake with the cache of the node out of the map, so the other nodes can bake meanwhile.
+	BakeCache cache;
+	{
+		MutexLock lock(bake_cache_mutex);
+
+		// Drop the caches of the freed nodes.
+		for (Map<ObjectID, BakeCache>::Element *E = bake_caches.front(); E;) {
+			Map<ObjectID, BakeCache>::Element *next = E->next();
+			if (!ObjectDB::get_instance(E->key())) {
+				_free_bake_cache(E->get());
+				bake_caches.erase(E);
+			}
+			E = next;
+		}
+
+		Map<ObjectID, BakeCache>::Element *E = bake_caches.find(p_cache_id);
+		if (E) {
+			cache = E->get();
+			bake_caches.erase(E);
+		}
+	}
+
+	if (cache.config_hash != config_hash) {
+		_free_bake_cache(cache);
+		cache.config_hash = config_hash;
+	}
+
+	// Drop the tiles without geometry anymore.
+	for (Map<Vector2i, BakeTile>::Element *E = cache.tiles.front(); E;) {
+		Map<Vector2i, BakeTile>::Element *next = E->next();
+		if (!build_ids.has(E->key())) {
+			rcFreePolyMeshDetail(E->get().detail_mesh);
+			cache.tiles.erase(E);
+		}
+		E = next;
+	}
+
+	// Only bake the tiles whose geometry changed.
+	LocalVector<TileBuild> changed_builds;
+	for (uint32_t i = 0; i < builds.size(); i++) {
+		const Map<Vector2i, BakeTile>::Element *E = cache.tiles.find(builds[i].coord);
+		if (E && E->get().hash == builds[i].hash) {
+			continue;
+		}
+
+		// Align the heights to the cells, the same way in all the tiles.
+		TileBuild &build = builds[i];
+		build.bmin[1] = Math::floor(build.bmin[1] / cfg.ch) * cfg.ch;
+		build.bmax[1] = Math::ceil(build.bmax[1] / cfg.ch) * cfg.ch + cfg.ch;
+		changed_builds.push_back(build);
+	}
+
+#ifdef TOOLS_ENABLED
+	if (ep) {
+		ep->step(TTR("Baking tiles..."), 2);
+	}
+#endif
+
+	data.builds = changed_builds.ptr();
+	if (changed_builds.size() > 1) {
+		MutexLock pool_lock(bake_pool_mutex);
+		if (bake_pool.get_thread_count() == 0) {
+			bake_pool.init();
+		}
+		bake_pool.do_work(changed_builds.size(), this, &NavigationMeshGenerator::_build_tile, &data);
+	} else if (changed_builds.size() == 1) {
+		_build_tile(0, &data);
+	}
+
+	for (uint32_t i = 0; i < changed_builds.size(); i++) {
+		BakeTile &tile = cache.tiles[changed_builds[i].coord];
+		rcFreePolyMeshDetail(tile.detail_mesh);
+		tile.hash = changed_builds[i].hash;
+		tile.detail_mesh = changed_builds[i].detail_mesh;
+	}
+
+#ifdef TOOLS_ENABLED
+	if (ep) {
+		ep->step(TTR("Converting to native navigation mesh..."), 10);
+	}
+#endif
+
+	_convert_tiles_to_native_navigation_mesh(cache, cfg.cs, cfg.ch, p_nav_mesh);
+
+	MutexLock lock(bake_cache_mutex);
+	Map<ObjectID, BakeCache>::Element *E = bake_caches.find(p_cache_id);
+	if (E) {
+		// Another bake of the same node finished meanwhile, keep the tiles of this one.
+		_free_bake_cache(E->get());
+		E->get() = cache;
+	} else {
+		bake_caches.insert(p_cache_id, cache);
+	}
+
+	return changed_builds.size();
+}
+
+void NavigationMeshGenerator::_drop_bake_cache(ObjectID p_cache_id) {
+	MutexLock lock(bake_cache_mutex);
+	Map<ObjectID, BakeCache>::Element *E = bake_caches.find(p_cache_id);
+	if (E) {
+		_free_bake_cache(E->get());
+		bake_caches.erase(E);
+	}
+}
+
+void NavigationMeshGenerator::_watch_baked_node(ObjectID p_node_id) {
+	Node *node = Object::cast_to<Node>(ObjectDB::get_instance(p_node_id));
+	if (!node) {
+		_drop_bake_cache(p_node_id);
+		return;
+	}
+
+	// Free the tiles when the node leaves the tree rather than at the next bake.
+	const Callable drop_callable = callable_mp(this, &NavigationMeshGenerator::_drop_bake_cache);
+	if (!node->is_connected(SNAME("tree_exited"), drop_callable)) {
+		node->connect(SNAME("tree_exited"), drop_callable, varray(p_node_id), CONNECT_ONESHOT);
+	}
+}
+
 NavigationMeshGenerator *NavigationMeshGenerator::get_singleton() {
 	return singleton;
 }
@@ -486,6 +861,9 @@ NavigationMeshGenerator::NavigationMeshGenerator() {
 }
 
 NavigationMeshGenerator::~NavigationMeshGenerator() {
+	for (Map<ObjectID, BakeCache>::Element *E = bake_caches.front(); E; E = E->next()) {
+		_free_bake_cache(E->get());
+	}
 }
 
 void NavigationMeshGenerator::bake(Ref<NavigationMesh> p_nav_mesh, Node *p_node) {
@@ -521,7 +899,22 @@ void NavigationMeshGenerator::bake(Ref<NavigationMesh> p_nav_mesh, Node *p_node)
 		_parse_geometry(navmesh_xform, E, vertices, indices, geometry_type, collision_mask, recurse_children);
 	}
 
-	if (vertices.size() > 0 && indices.size() > 0) {
+	if (vertices.size() > 0 && indices.size() > 0 && p_nav_mesh->get_tile_size() > 0) {
+		_build_recast_navigation_mesh_tiled(
+				p_nav_mesh,
+#ifdef TOOLS_ENABLED
+				ep,
+#endif
+				p_node->get_instance_id(),
+				vertices,
+				indices);
+
+		// Connected on the main thread, as the bake usually runs on its own.
+		MessageQueue::get_singleton()->push_callable(callable_mp(this, &NavigationMeshGenerator::_watch_baked_node), p_node->get_instance_id());
+	} else if (vertices.size() > 0 && indices.size() > 0) {
+		// The tiles of a previous tiled bake are not needed anymore.
+		_drop_bake_cache(p_node->get_instance_id());
+
 		rcHeightfield *hf = nullptr;
 		rcCompactHeightfield *chf = nullptr;
 		rcContourSet *cset = nullptr;
@@ -575,6 +968,20 @@ void NavigationMeshGenerator::clear(Ref<NavigationMesh> p_nav_mesh) {
 	}
 }
 
+#ifdef TESTS_ENABLED
+uint32_t NavigationMeshGenerator::bake_tiles_from(Ref<NavigationMesh> p_nav_mesh, ObjectID p_cache_id, const Vector<float> &p_vertices, const Vector<int> &p_indices) {
+	ERR_FAIL_COND_V(!p_nav_mesh.is_valid() || p_nav_mesh->get_tile_size() <= 0, 0);
+	return _build_recast_navigation_mesh_tiled(
+			p_nav_mesh,
+#ifdef TOOLS_ENABLED
+			nullptr,
+#endif
+			p_cache_id,
+			p_vertices,
+			p_indices);
+}
+#endif
+
 void NavigationMeshGenerator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("bake", "nav_mesh", "root_node"), &NavigationMeshGenerator::bake);
 	ClassDB::bind_method(D_METHOD("clear", "nav_mesh"), &NavigationMeshGenerator::clear);
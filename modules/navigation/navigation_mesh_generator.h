@@ -33,6 +33,10 @@
 
 #ifndef _3D_DISABLED
 
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/map.h"
+#include "core/templates/thread_work_pool.h"
 #include "scene/3d/navigation_region_3d.h"
 
 #include <Recast.h>
@@ -46,6 +50,50 @@ class NavigationMeshGenerator : public Object {
 
 	static NavigationMeshGenerator *singleton;
 
+	/// A baked tile, kept to be reused while its source geometry does not change.
+	struct BakeTile {
+		uint32_t hash = 0;
+		rcPolyMeshDetail *detail_mesh = nullptr;
+	};
+
+	/// The tiles of the last bake from a node. The baked navigation mesh is
+	/// often a copy of the previous one, so the tiles are kept per node.
+	struct BakeCache {
+		uint32_t config_hash = 0;
+		Map<Vector2i, BakeTile> tiles;
+	};
+
+	/// A tile to bake on the worker threads.
+	struct TileBuild {
+		Vector2i coord;
+		uint32_t hash = 0;
+		float bmin[3] = {};
+		float bmax[3] = {};
+		LocalVector<int> triangles;
+		rcPolyMeshDetail *detail_mesh = nullptr;
+	};
+
+	struct TileBuildData {
+		rcConfig config;
+		Ref<NavigationMesh> nav_mesh;
+		const float *vertices = nullptr;
+		int vertex_count = 0;
+		TileBuild *builds = nullptr;
+	};
+
+	Mutex bake_cache_mutex;
+	Map<ObjectID, BakeCache> bake_caches;
+
+	// Started by the first tiled bake, and shared by the next ones one at a time.
+	Mutex bake_pool_mutex;
+	ThreadWorkPool bake_pool;
+
+	static void _free_bake_cache(BakeCache &r_cache);
+	void _drop_bake_cache(ObjectID p_cache_id);
+	void _watch_baked_node(ObjectID p_node_id);
+	static bool _bake_tile(const TileBuildData *p_data, const TileBuild &p_build, rcHeightfield *&r_hf, rcCompactHeightfield *&r_chf, rcContourSet *&r_cset, rcPolyMesh *&r_poly_mesh, rcPolyMeshDetail *&r_detail_mesh);
+	void _build_tile(uint32_t p_index, TileBuildData *p_data);
+
 protected:
 	static void _bind_methods();
 
@@ -54,7 +102,9 @@ protected:
 	static void _add_faces(const PackedVector3Array &p_faces, const Transform3D &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices);
 	static void _parse_geometry(Transform3D p_accumulated_transform, Node *p_node, Vector<float> &p_verticies, Vector<int> &p_indices, int p_generate_from, uint32_t p_collision_mask, bool p_recurse_children);
 
+	static void _init_recast_config(Ref<NavigationMesh> p_nav_mesh, rcConfig &r_cfg);
 	static void _convert_detail_mesh_to_native_navigation_mesh(const rcPolyMeshDetail *p_detail_mesh, Ref<NavigationMesh> p_nav_mesh);
+	static void _convert_tiles_to_native_navigation_mesh(const BakeCache &p_cache, float p_cell_size, float p_cell_height, Ref<NavigationMesh> p_nav_mesh);
 	static void _build_recast_navigation_mesh(
 			Ref<NavigationMesh> p_nav_mesh,
 #ifdef TOOLS_ENABLED
@@ -67,6 +117,14 @@ protected:
 			rcPolyMeshDetail *detail_mesh,
 			Vector<float> &vertices,
 			Vector<int> &indices);
+	uint32_t _build_recast_navigation_mesh_tiled(
+			Ref<NavigationMesh> p_nav_mesh,
+#ifdef TOOLS_ENABLED
+			EditorProgress *ep,
+#endif
+			ObjectID p_cache_id,
+			const Vector<float> &p_vertices,
+			const Vector<int> &p_indices);
 
 public:
 	static NavigationMeshGenerator *get_singleton();
@@ -76,6 +134,11 @@ public:
 
 	void bake(Ref<NavigationMesh> p_nav_mesh, Node *p_node);
 	void clear(Ref<NavigationMesh> p_nav_mesh);
+
+#ifdef TESTS_ENABLED
+	// Bakes the given triangles with the tiles cached under the ID, returns the number of tiles baked again.
+	uint32_t bake_tiles_from(Ref<NavigationMesh> p_nav_mesh, ObjectID p_cache_id, const Vector<float> &p_vertices, const Vector<int> &p_indices);
+#endif
 };
 
 #endif
@@ -0,0 +1,140 @@
+/*************************************************************************/
+/*  test_navigation_avoidance.h                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEST_NAVIGATION_AVOIDANCE_H
+#define TEST_NAVIGATION_AVOIDANCE_H
+
+#include "core/math/random_pcg.h"
+#include "modules/navigation/nav_map.h"
+#include "modules/navigation/rvo_agent.h"
+
+#include "tests/test_macros.h"
+
+#include <algorithm>
+
+namespace TestNavigationAvoidance {
+
+typedef std::vector<std::pair<float, const RVO::Agent *>> AgentNeighbors;
+
+static RvoAgent *_add_agent(NavMap &p_map, const Vector3 &p_position, float p_neighbor_distance, size_t p_max_neighbors) {
+	RvoAgent *agent = memnew(RvoAgent);
+	agent->get_agent()->position_ = RVO::Vector3(p_position.x, p_position.y, p_position.z);
+	agent->get_agent()->neighborDist_ = p_neighbor_distance;
+	agent->get_agent()->maxNeighbors_ = p_max_neighbors;
+	agent->set_map(&p_map);
+	p_map.add_agent(agent);
+	p_map.set_agent_as_controlled(agent);
+	return agent;
+}
+
+// The closest agents in range, tested one by one.
+static void _find_neighbors_brute_force(const NavMap &p_map, const RVO::Agent *p_agent, AgentNeighbors &r_neighbors) {
+	r_neighbors.clear();
+	for (RvoAgent *other : p_map.get_agents()) {
+		const float distance_sq = RVO::absSq(other->get_agent()->position_ - p_agent->position_);
+		if (other->get_agent() != p_agent && distance_sq < p_agent->neighborDist_ * p_agent->neighborDist_) {
+			r_neighbors.push_back(std::make_pair(distance_sq, other->get_agent()));
+		}
+	}
+	std::sort(r_neighbors.begin(), r_neighbors.end());
+}
+
+// Returns the number of agents whose neighbors differ from the brute force ones.
+static int _count_wrong_neighbors(NavMap &p_map, int &r_truncated_count) {
+	p_map.compute_neighbors();
+
+	int wrong_count = 0;
+	r_truncated_count = 0;
+	AgentNeighbors expected;
+	for (RvoAgent *agent : p_map.get_agents()) {
+		const RVO::Agent *rvo_agent = agent->get_agent();
+		_find_neighbors_brute_force(p_map, rvo_agent, expected);
+		if (expected.size() > rvo_agent->maxNeighbors_) {
+			expected.resize(rvo_agent->maxNeighbors_);
+			r_truncated_count++;
+		}
+
+		const AgentNeighbors &neighbors = rvo_agent->agentNeighbors_;
+		bool same = neighbors.size() == expected.size();
+		for (size_t i = 0; same && i < neighbors.size(); i++) {
+			same = neighbors[i].second == expected[i].second && Math::is_equal_approx(neighbors[i].first, expected[i].first);
+		}
+		if (!same) {
+			wrong_count++;
+		}
+	}
+	return wrong_count;
+}
+
+static void _free_agents(NavMap &p_map) {
+	const std::vector<RvoAgent *> agents = p_map.get_agents();
+	for (RvoAgent *agent : agents) {
+		p_map.remove_agent(agent);
+		memdelete(agent);
+	}
+}
+
+TEST_CASE("[Navigation] Avoidance neighbors match a brute force search") {
+	NavMap map;
+
+	SUBCASE("Agents in cells sharing buckets") {
+		// Four agents get four buckets, so the 27 cells searched around each
+		// agent map to the same buckets several times.
+		_add_agent(map, Vector3(0.95, 0.5, 0.95), 1.0, 10);
+		_add_agent(map, Vector3(1.05, 0.5, 0.95), 1.0, 10);
+		_add_agent(map, Vector3(0.95, 0.5, 1.05), 1.0, 10);
+		_add_agent(map, Vector3(1.05, 0.5, 1.05), 1.0, 10);
+
+		int truncated_count = 0;
+		CHECK(_count_wrong_neighbors(map, truncated_count) == 0);
+		for (RvoAgent *agent : map.get_agents()) {
+			CHECK_MESSAGE(agent->get_agent()->agentNeighbors_.size() == 3, "Each agent finds the three others once.");
+		}
+	}
+
+	SUBCASE("Crowd with truncated neighbors") {
+		RandomPCG rng(5);
+		for (int i = 0; i < 500; i++) {
+			const Vector3 position(rng.random(-10.0f, 10.0f), rng.random(0.0f, 4.0f), rng.random(-10.0f, 10.0f));
+			_add_agent(map, position, rng.random(0.5f, 3.0f), rng.rand() % 11);
+		}
+
+		int truncated_count = 0;
+		CHECK(_count_wrong_neighbors(map, truncated_count) == 0);
+		CHECK_MESSAGE(truncated_count > 0, "Some agents have more agents in range than neighbors.");
+	}
+
+	_free_agents(map);
+}
+
+} // namespace TestNavigationAvoidance
+
+#endif // TEST_NAVIGATION_AVOIDANCE_H
@@ -0,0 +1,171 @@
+/*************************************************************************/
+/*  test_navigation_flow_field.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEST_NAVIGATION_FLOW_FIELD_H
+#define TEST_NAVIGATION_FLOW_FIELD_H
+
+#include "core/math/random_pcg.h"
+#include "modules/navigation/godot_navigation_server.h"
+#include "scene/resources/navigation_mesh.h"
+
+#include "tests/test_macros.h"
+
+namespace TestNavigationFlowField {
+
+// A grid of triangles from `p_from_x` to `p_to_x`, crossed along z by a wall
+// at `p_wall_x` with a door every `p_door_spacing` cells, or none if zero.
+static Ref<NavigationMesh> _create_grid_navmesh(int p_from_x, int p_to_x, int p_size_z, int p_wall_x = -1, int p_door_spacing = 0) {
+	const int width = p_to_x - p_from_x;
+
+	Vector<Vector3> vertices;
+	vertices.resize((width + 1) * (p_size_z + 1));
+	for (int z = 0; z <= p_size_z; z++) {
+		for (int x = 0; x <= width; x++) {
+			vertices.write[z * (width + 1) + x] = Vector3(p_from_x + x, 0, z);
+		}
+	}
+
+	Ref<NavigationMesh> navmesh;
+	navmesh.instantiate();
+	navmesh->set_vertices(vertices);
+	for (int z = 0; z < p_size_z; z++) {
+		for (int x = 0; x < width; x++) {
+			if (p_from_x + x == p_wall_x && (p_door_spacing == 0 || z % p_door_spacing != p_door_spacing / 2)) {
+				continue;
+			}
+
+			const int i = z * (width + 1) + x;
+			Vector<int> first;
+			first.push_back(i);
+			first.push_back(i + width + 1);
+			first.push_back(i + 1);
+			navmesh->add_polygon(first);
+
+			Vector<int> second;
+			second.push_back(i + 1);
+			second.push_back(i + width + 1);
+			second.push_back(i + width + 2);
+			navmesh->add_polygon(second);
+		}
+	}
+
+	return navmesh;
+}
+
+static RID _add_region(NavigationServer3D *p_server, RID p_map, const Ref<NavigationMesh> &p_navmesh, uint32_t p_layers = 1) {
+	RID region = p_server->region_create();
+	p_server->region_set_layers(region, p_layers);
+	p_server->region_set_navmesh(region, p_navmesh);
+	p_server->region_set_map(region, p_map);
+	return region;
+}
+
+// Follows the flow field until it stops, returns whether the position ends next to the target.
+static bool _walk_to_target(NavigationServer3D *p_server, RID p_map, const PackedVector3Array &p_targets, Vector3 p_position, uint32_t p_layers) {
+	for (int i = 0; i < 2000; i++) {
+		const Vector3 direction = p_server->map_get_flow_direction(p_map, p_targets, p_position, p_layers);
+		if (direction == Vector3()) {
+			break;
+		}
+		p_position += direction * 0.25;
+	}
+	return p_position.distance_to(p_targets[0]) < 1.0;
+}
+
+TEST_CASE("[Navigation] Flow fields") {
+	NavigationServer3D *server = memnew(GodotNavigationServer);
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	server->map_set_cell_size(map, 0.25);
+
+	PackedVector3Array targets;
+	targets.push_back(Vector3(36.5, 0, 20.5));
+
+	SUBCASE("All the units arrive") {
+		RID region = _add_region(server, map, _create_grid_navmesh(0, 40, 40, 20, 20));
+		server->process(0.0);
+
+		RandomPCG rng(3);
+		int arrived = 0;
+		for (int i = 0; i < 50; i++) {
+			const Vector3 position(rng.random(0.5f, 15.0f), 0, rng.random(0.5f, 39.5f));
+			if (_walk_to_target(server, map, targets, position, 1)) {
+				arrived++;
+			}
+		}
+		CHECK(arrived == 50);
+
+		server->free(region);
+	}
+
+	SUBCASE("Unreachable targets") {
+		RID region = _add_region(server, map, _create_grid_navmesh(0, 40, 40, 20));
+		server->process(0.0);
+
+		CHECK_MESSAGE(server->map_get_flow_direction(map, targets, Vector3(5, 0, 20)) == Vector3(), "The wall has no door.");
+		CHECK(server->map_get_flow_direction(map, targets, Vector3(25, 0, 20)) != Vector3());
+
+		server->free(region);
+	}
+
+	SUBCASE("Layers and map updates") {
+		// The middle region is the only way to the target, and only on the second layer.
+		RID left = _add_region(server, map, _create_grid_navmesh(0, 15, 40));
+		RID middle = _add_region(server, map, _create_grid_navmesh(15, 25, 40), 2);
+		RID right = _add_region(server, map, _create_grid_navmesh(25, 40, 40));
+		server->process(0.0);
+
+		const Vector3 position(5, 0, 20);
+		CHECK(server->map_get_flow_direction(map, targets, position, 1) == Vector3());
+		CHECK(_walk_to_target(server, map, targets, position, 3));
+
+		// The cached field must not be used once the middle region is gone.
+		server->region_set_map(middle, RID());
+		server->process(0.0);
+		CHECK(server->map_get_flow_direction(map, targets, position, 3) == Vector3());
+
+		server->region_set_map(middle, map);
+		server->process(0.0);
+		CHECK(_walk_to_target(server, map, targets, position, 3));
+
+		server->free(left);
+		server->free(middle);
+		server->free(right);
+	}
+
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+} // namespace TestNavigationFlowField
+
+#endif // TEST_NAVIGATION_FLOW_FIELD_H
@@ -0,0 +1,436 @@
+/*************************************************************************/
+/*  test_navigation_map.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_NAVIGATION_MAP_H
+#define TEST_NAVIGATION_MAP_H
+
+#include "core/math/random_pcg.h"
+#include "modules/navigation/godot_navigation_server.h"
+#include "scene/resources/navigation_mesh.h"
+
+#include "tests/test_macros.h"
+
+namespace TestNavigationMap {
+
+// A square grid of `p_size` cells of two triangles, split in rooms of
+// `p_room_size` cells by walls with a door at a random place. Without
+// rooms if `p_room_size` is zero. The inner vertices are moved randomly by
+// up to `p_jitter`, so that fewer paths have the same cost.
+static Ref<NavigationMesh> _create_rooms_navmesh(int p_size, int p_room_size = 0, uint64_t p_seed = 0, real_t p_jitter = 0.0) {
+	RandomPCG rng(p_seed);
+	const int rooms = p_room_size > 0 ? p_size / p_room_size : 0;
+	Vector<int> doors_x;
+	Vector<int> doors_z;
+	for (int i = 0; i < rooms * rooms; i++) {
+		doors_x.push_back(rng.rand() % p_room_size);
+		doors_z.push_back(rng.rand() % p_room_size);
+	}
+
+	Vector<Vector3> vertices;
+	vertices.resize((p_size + 1) * (p_size + 1));
+	for (int z = 0; z <= p_size; z++) {
+		for (int x = 0; x <= p_size; x++) {
+			Vector3 vertex(x, 0, z);
+			if (x > 0 && x < p_size && z > 0 && z < p_size) {
+				vertex += Vector3(rng.random(-p_jitter, p_jitter), 0, rng.random(-p_jitter, p_jitter));
+			}
+			vertices.write[z * (p_size + 1) + x] = vertex;
+		}
+	}
+
+	Ref<NavigationMesh> navmesh;
+	navmesh.instantiate();
+	navmesh->set_vertices(vertices);
+	for (int z = 0; z < p_size; z++) {
+		for (int x = 0; x < p_size; x++) {
+			// The walls are on the last column and row of each room.
+			if (rooms > 0) {
+				const int room = (z / p_room_size) * rooms + x / p_room_size;
+				const bool wall_x = x % p_room_size == p_room_size - 1 && z % p_room_size != doors_x[room];
+				const bool wall_z = z % p_room_size == p_room_size - 1 && x % p_room_size != doors_z[room];
+				if (wall_x || wall_z) {
+					continue;
+				}
+			}
+
+			const int i = z * (p_size + 1) + x;
+			Vector<int> first;
+			first.push_back(i);
+			first.push_back(i + p_size + 1);
+			first.push_back(i + 1);
+			navmesh->add_polygon(first);
+
+			Vector<int> second;
+			second.push_back(i + 1);
+			second.push_back(i + p_size + 1);
+			second.push_back(i + p_size + 2);
+			navmesh->add_polygon(second);
+		}
+	}
+
+	return navmesh;
+}
+
+static Ref<NavigationMesh> _create_triangle_navmesh(const Vector3 &p_a, const Vector3 &p_b, const Vector3 &p_c) {
+	Vector<Vector3> vertices;
+	vertices.push_back(p_a);
+	vertices.push_back(p_b);
+	vertices.push_back(p_c);
+	Ref<NavigationMesh> navmesh;
+	navmesh.instantiate();
+	navmesh->set_vertices(vertices);
+	Vector<int> polygon;
+	polygon.push_back(0);
+	polygon.push_back(1);
+	polygon.push_back(2);
+	navmesh->add_polygon(polygon);
+	return navmesh;
+}
+
+static RID _create_map(NavigationServer3D *p_server) {
+	RID map = p_server->map_create();
+	p_server->map_set_active(map, true);
+	p_server->map_set_cell_size(map, 0.25);
+	return map;
+}
+
+static RID _add_region(NavigationServer3D *p_server, RID p_map, const Ref<NavigationMesh> &p_navmesh, const Vector3 &p_origin = Vector3()) {
+	RID region = p_server->region_create();
+	p_server->region_set_transform(region, Transform3D(Basis(), p_origin));
+	p_server->region_set_navmesh(region, p_navmesh);
+	p_server->region_set_map(region, p_map);
+	return region;
+}
+
+// The connections of the region to the other regions, in a stable order.
+static Vector<Vector3> _get_sorted_connections(NavigationServer3D *p_server, RID p_region) {
+	Vector<Vector3> connections;
+	for (int i = 0; i < p_server->region_get_connections_count(p_region); i++) {
+		connections.push_back(p_server->region_get_connection_pathway_start(p_region, i));
+		connections.push_back(p_server->region_get_connection_pathway_end(p_region, i));
+	}
+	connections.sort();
+	return connections;
+}
+
+static real_t _get_path_length(const Vector<Vector3> &p_path) {
+	real_t length = 0.0;
+	for (int i = 1; i < p_path.size(); i++) {
+		length += p_path[i - 1].distance_to(p_path[i]);
+	}
+	return length;
+}
+
+// Paths found by the search before it used a heap, on the navigation mesh
+// of the test. The sixth path stays in a single polygon, and the destination
+// of the seventh one is unreachable.
+static const int REFERENCE_PATH_COUNT = 8;
+static const Vector3 reference_points[REFERENCE_PATH_COUNT][2] = {
+	{ Vector3(0.683873, 0, 7.170664), Vector3(4.650079, 0, 7.401172) },
+	{ Vector3(0.101782, 0, 4.817661), Vector3(5.8694, 0, 4.471109) },
+	{ Vector3(0.355534, 0, 4.071122), Vector3(3.683317, 0, 4.007911) },
+	{ Vector3(7.039539, 0, 6.219326), Vector3(7.139654, 0, 7.939952) },
+	{ Vector3(0.5, 0, 0.5), Vector3(7.5, 0, 7.5) },
+	{ Vector3(0.2, 0, 0.3), Vector3(0.3, 0, 0.5) },
+	{ Vector3(0.5, 0, 0.5), Vector3(21, 0, 1) },
+	{ Vector3(6.5, 0, 1.5), Vector3(4, 0, -3) },
+};
+static const int reference_path_sizes[REFERENCE_PATH_COUNT] = { 8, 12, 11, 4, 18, 2, 20, 6 };
+static const Vector3 reference_paths[REFERENCE_PATH_COUNT][20] = {
+	{ Vector3(0.649689, 0, 6.913603), Vector3(0.929231, 0, 6.81236), Vector3(1.130344, 0, 6.739522), Vector3(1.948213, 0, 6.443311), Vector3(2.945294, 0, 6.082193), Vector3(3.908102, 0, 5.813848), Vector3(4.410729, 0, 6.553608), Vector3(4.730323, 0, 7.023982) },
+	{ Vector3(0.101782, 0, 4.817661), Vector3(0.308174, 0, 4.757545), Vector3(1.054729, 0, 4.540098), Vector3(1.661422, 0, 4.363389), Vector3(1.982548, 0, 4.269855), Vector3(2.913846, 0, 3.998598), Vector3(1.991407, 0, 4.859661), Vector3(2.969127, 0, 5.158816), Vector3(4.113035, 0, 5.035481), Vector3(4.956675, 0, 4.764395), Vector3(5.179406, 0, 4.692824), Vector3(5.8694, 0, 4.471109) },
+	{ Vector3(0.355534, 0, 4.071122), Vector3(0.86718, 0, 4.31775), Vector3(1.083842, 0, 4.422188), Vector3(1.445961, 0, 4.596739), Vector3(1.991407, 0, 4.859661), Vector3(2.848516, 0, 5.286355), Vector3(2.964347, 0, 5.344019), Vector3(3.481563, 0, 5.601505), Vector3(3.908102, 0, 5.813848), Vector3(4.113035, 0, 5.035481), Vector3(3.848994, 0, 3.96697) },
+	{ Vector3(6.954753, 0, 6.251545), Vector3(6.978123, 0, 6.910008), Vector3(6.983871, 0, 7.071968), Vector3(7.013916, 0, 7.918487) },
+	{ Vector3(0.5, 0, 0.5), Vector3(1.009887, 0, 0.608127), Vector3(1.27547, 0, 0.664446), Vector3(2.018165, 0, 0.821942), Vector3(2.416602, 0, 1.37693), Vector3(2.857913, 0, 1.991639), Vector3(3.492921, 0, 2.574823), Vector3(3.859181, 0, 2.911192), Vector3(4.224396, 0, 3.612504), Vector3(4.438349, 0, 4.023354), Vector3(4.672322, 0, 4.472648), Vector3(4.942829, 0, 4.992098), Vector3(5.528629, 0, 5.508856), Vector3(5.95437, 0, 5.88442), Vector3(6.392001, 0, 6.476797), Vector3(6.740235, 0, 6.948166), Vector3(6.89419, 0, 7.156559), Vector3(7.097101, 0, 7.431218) },
+	{ Vector3(0.2, 0, 0.3), Vector3(0.3, 0, 0.5) },
+	{ Vector3(0.5, 0, 0.5), Vector3(0.407748, 0, 0.961262), Vector3(0.255136, 0, 1.724319), Vector3(0.203302, 0, 1.983491), Vector3(0, 0, 3), Vector3(0.864105, 0, 1.92983), Vector3(1.159082, 0, 3.03971), Vector3(1.987658, 0, 1.879507), Vector3(2.18648, 0, 3.12329), Vector3(2.857913, 0, 1.991639), Vector3(3.015934, 0, 3.11853), Vector3(4.098464, 0, 1.88458), Vector3(3.859181, 0, 2.911192), Vector3(5.146216, 0, 2.071261), Vector3(4.982096, 0, 3.088947), Vector3(6.05653, 0, 2.156404), Vector3(6.172026, 0, 2.815716), Vector3(6.854042, 0, 2.105479), Vector3(6.978642, 0, 2.923957), Vector3(8, 0, 2) },
+	{ Vector3(6.5, 0, 1.5), Vector3(6.023054, 0, 1.049821), Vector3(5.321951, 0, 0.685998), Vector3(4.98199, 0, 0.509583), Vector3(4.691054, 0, 0.358608), Vector3(4, 0, 0) },
+};
+static const real_t reference_unoptimized_lengths[REFERENCE_PATH_COUNT] = { 5.3938, 6.9985, 6.2257, 1.7008, 11.2098, 0.2236, 9.4327, 3.2274 };
+
+TEST_CASE("[Navigation] Paths match the reference search") {
+	NavigationServer3D *server = memnew(GodotNavigationServer);
+	RID map = _create_map(server);
+	RID rooms = _add_region(server, map, _create_rooms_navmesh(8, 4, 2, 0.2));
+	RID island = _add_region(server, map, _create_triangle_navmesh(Vector3(20, 0, 0), Vector3(20, 0, 4), Vector3(24, 0, 0)));
+	server->process(0.0);
+
+	for (int i = 0; i < REFERENCE_PATH_COUNT; i++) {
+		const Vector<Vector3> path = server->map_get_path(map, reference_points[i][0], reference_points[i][1], true);
+		REQUIRE(path.size() == reference_path_sizes[i]);
+		for (int j = 0; j < path.size(); j++) {
+			CHECK(path[j].is_equal_approx(reference_paths[i][j]));
+		}
+
+		// The polygons reached again with a lower cost are visited again,
+		// which the reference search didn't do, so the entries may differ.
+		const Vector<Vector3> unoptimized_path = server->map_get_path(map, reference_points[i][0], reference_points[i][1], false);
+		REQUIRE(unoptimized_path.size() >= 2);
+		CHECK(unoptimized_path[0].is_equal_approx(path[0]));
+		CHECK(unoptimized_path[unoptimized_path.size() - 1].is_equal_approx(path[path.size() - 1]));
+		CHECK(Math::abs(_get_path_length(unoptimized_path) - reference_unoptimized_lengths[i]) < reference_unoptimized_lengths[i] * 0.1);
+	}
+
+	// Without any polygon.
+	server->region_set_map(rooms, RID());
+	server->region_set_map(island, RID());
+	server->process(0.0);
+	CHECK(server->map_get_path(map, Vector3(0.5, 0, 0.5), Vector3(7.5, 0, 7.5), true).is_empty());
+
+	server->free(rooms);
+	server->free(island);
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+TEST_CASE("[Navigation] Hierarchical paths match the flat ones") {
+	NavigationServer3D *server = memnew(GodotNavigationServer);
+	RID flat_map = _create_map(server);
+	RID hierarchical_map = _create_map(server);
+	server->map_set_use_hierarchical_paths(hierarchical_map, true);
+
+	Ref<NavigationMesh> navmesh = _create_rooms_navmesh(96, 12, 7);
+	RID flat_region = _add_region(server, flat_map, navmesh);
+	RID hierarchical_region = _add_region(server, hierarchical_map, navmesh);
+	server->process(0.0);
+
+	CHECK(server->map_get_use_hierarchical_paths(hierarchical_map));
+	CHECK_FALSE(server->map_get_use_hierarchical_paths(flat_map));
+
+	// The unoptimized paths go through the polygons found by the searches.
+	RandomPCG rng(11);
+	int reached = 0;
+	real_t worst_ratio = 1.0;
+	for (int i = 0; i < 200; i++) {
+		const Vector3 from(rng.random(0.0f, 96.0f), 0, rng.random(0.0f, 96.0f));
+		const Vector3 to(rng.random(0.0f, 96.0f), 0, rng.random(0.0f, 96.0f));
+		const Vector<Vector3> flat_path = server->map_get_path(flat_map, from, to, false);
+		const Vector<Vector3> hierarchical_path = server->map_get_path(hierarchical_map, from, to, false);
+
+		REQUIRE(flat_path.size() >= 2);
+		REQUIRE(hierarchical_path.size() >= 2);
+		CHECK(hierarchical_path[0].is_equal_approx(flat_path[0]));
+		CHECK(hierarchical_path[hierarchical_path.size() - 1].is_equal_approx(flat_path[flat_path.size() - 1]));
+		if (flat_path[flat_path.size() - 1].distance_to(to) < 1.5) {
+			reached++;
+		}
+
+		const real_t flat_length = _get_path_length(flat_path);
+		if (flat_length > 0.0) {
+			worst_ratio = MAX(worst_ratio, _get_path_length(hierarchical_path) / flat_length);
+		}
+	}
+	CHECK_MESSAGE(reached == 200, "All the rooms are connected.");
+	CHECK_MESSAGE(worst_ratio < 1.25, "The hierarchical paths are at most slightly longer.");
+
+	// Enabling the hierarchy of a synced map builds it on the next sync.
+	const Vector3 from(2, 0, 2);
+	const Vector3 to(94, 0, 94);
+	server->map_set_use_hierarchical_paths(flat_map, true);
+	server->process(0.0);
+	CHECK(server->map_get_path(flat_map, from, to, false) == server->map_get_path(hierarchical_map, from, to, false));
+	server->map_set_use_hierarchical_paths(flat_map, false);
+	server->process(0.0);
+
+	// Unreachable destinations end as close as possible, on both maps.
+	Ref<NavigationMesh> island = _create_triangle_navmesh(Vector3(200, 0, 0), Vector3(200, 0, 4), Vector3(204, 0, 0));
+	RID flat_island = _add_region(server, flat_map, island);
+	RID hierarchical_island = _add_region(server, hierarchical_map, island);
+	server->process(0.0);
+
+	const Vector<Vector3> flat_path = server->map_get_path(flat_map, Vector3(5, 0, 5), Vector3(201, 0, 1), true);
+	const Vector<Vector3> hierarchical_path = server->map_get_path(hierarchical_map, Vector3(5, 0, 5), Vector3(201, 0, 1), true);
+	REQUIRE(flat_path.size() >= 2);
+	REQUIRE(hierarchical_path.size() >= 2);
+	CHECK(flat_path[flat_path.size() - 1].x < 100);
+	CHECK(hierarchical_path[hierarchical_path.size() - 1].is_equal_approx(flat_path[flat_path.size() - 1]));
+
+	server->free(flat_island);
+	server->free(hierarchical_island);
+	server->free(flat_region);
+	server->free(hierarchical_region);
+	server->free(flat_map);
+	server->free(hierarchical_map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+TEST_CASE("[Navigation] Syncing the changed regions matches a full sync") {
+	NavigationServer3D *server = memnew(GodotNavigationServer);
+	RID map = _create_map(server);
+	Ref<NavigationMesh> navmesh = _create_rooms_navmesh(8);
+	RID a = _add_region(server, map, navmesh);
+	RID b = _add_region(server, map, navmesh, Vector3(8, 0, 0));
+	RID c = _add_region(server, map, navmesh, Vector3(16, 0, 0));
+	server->process(0.0);
+	CHECK(server->region_get_connections_count(b) > 0);
+
+	// Add a region, then move one and remove another, syncing in between.
+	RID d = _add_region(server, map, navmesh, Vector3(0, 0, 8));
+	server->process(0.0);
+	server->region_set_transform(c, Transform3D(Basis(), Vector3(8, 0, 8)));
+	server->process(0.0);
+	server->region_set_map(b, RID());
+	server->process(0.0);
+
+	// The same regions, in the same order, synced at once.
+	RID full_map = _create_map(server);
+	RID full_a = _add_region(server, full_map, navmesh);
+	RID full_c = _add_region(server, full_map, navmesh, Vector3(8, 0, 8));
+	RID full_d = _add_region(server, full_map, navmesh, Vector3(0, 0, 8));
+	server->process(0.0);
+
+	CHECK(server->region_get_connections_count(a) > 0);
+	CHECK(_get_sorted_connections(server, a) == _get_sorted_connections(server, full_a));
+	CHECK(_get_sorted_connections(server, c) == _get_sorted_connections(server, full_c));
+	CHECK(_get_sorted_connections(server, d) == _get_sorted_connections(server, full_d));
+
+	RandomPCG rng(5);
+	for (int i = 0; i < 100; i++) {
+		const Vector3 from(rng.random(0.0f, 16.0f), 0, rng.random(0.0f, 16.0f));
+		const Vector3 to(rng.random(0.0f, 16.0f), 0, rng.random(0.0f, 16.0f));
+		const Vector<Vector3> path = server->map_get_path(map, from, to, false);
+		const Vector<Vector3> full_path = server->map_get_path(full_map, from, to, false);
+
+		REQUIRE(path.size() >= 2);
+		REQUIRE(full_path.size() >= 2);
+		CHECK(path[0].is_equal_approx(full_path[0]));
+		CHECK(path[path.size() - 1].is_equal_approx(full_path[full_path.size() - 1]));
+		CHECK(Math::is_equal_approx(_get_path_length(path), _get_path_length(full_path), (real_t)1e-3));
+	}
+
+	server->free(a);
+	server->free(b);
+	server->free(c);
+	server->free(d);
+	server->free(full_a);
+	server->free(full_c);
+	server->free(full_d);
+	server->free(map);
+	server->free(full_map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+// The polygons of the navigation mesh, placed like a region.
+static void _add_faces(Ref<NavigationMesh> p_navmesh, const Transform3D &p_transform, int p_region, Vector<Face3> &r_faces, Vector<int> &r_regions) {
+	const Vector<Vector3> vertices = p_navmesh->get_vertices();
+	for (int i = 0; i < p_navmesh->get_polygon_count(); i++) {
+		const Vector<int> polygon = p_navmesh->get_polygon(i);
+		for (int j = 2; j < polygon.size(); j++) {
+			r_faces.push_back(Face3(p_transform.xform(vertices[polygon[0]]), p_transform.xform(vertices[polygon[j - 1]]), p_transform.xform(vertices[polygon[j]])));
+			r_regions.push_back(p_region);
+		}
+	}
+}
+
+TEST_CASE("[Navigation] Closest point queries match brute force") {
+	NavigationServer3D *server = memnew(GodotNavigationServer);
+	RID map = _create_map(server);
+
+	// Flat regions tilted differently, so that each has its own normal.
+	Transform3D transforms[3] = {
+		Transform3D(),
+		Transform3D(Basis(Vector3(1, 0, 0), 0.3), Vector3(10, 1, 0)),
+		Transform3D(Basis(Vector3(0, 0, 1), -0.2), Vector3(0, -2, 10)),
+	};
+	RID regions[3];
+	Vector<Face3> faces;
+	Vector<int> face_regions;
+	for (int i = 0; i < 3; i++) {
+		Ref<NavigationMesh> navmesh = _create_rooms_navmesh(8, 4, i, 0.3);
+		regions[i] = _add_region(server, map, navmesh);
+		server->region_set_transform(regions[i], transforms[i]);
+		_add_faces(navmesh, transforms[i], i, faces, face_regions);
+	}
+	server->process(0.0);
+
+	RandomPCG rng(17);
+	for (int i = 0; i < 300; i++) {
+		const Vector3 point(rng.random(-2.0f, 20.0f), rng.random(-4.0f, 4.0f), rng.random(-2.0f, 20.0f));
+
+		real_t closest_distance = 1e20;
+		int closest_face = -1;
+		for (int j = 0; j < faces.size(); j++) {
+			const real_t distance = faces[j].get_closest_point_to(point).distance_to(point);
+			if (distance < closest_distance) {
+				closest_distance = distance;
+				closest_face = j;
+			}
+		}
+
+		const Vector3 closest_point = server->map_get_closest_point(map, point);
+		CHECK(Math::is_equal_approx(closest_point.distance_to(point), closest_distance, (real_t)1e-4));
+		CHECK(server->map_get_closest_point_normal(map, point).is_equal_approx(faces[closest_face].get_plane().normal));
+		CHECK(server->map_get_closest_point_owner(map, point) == regions[face_regions[closest_face]]);
+	}
+
+	for (int i = 0; i < 300; i++) {
+		const Vector3 from(rng.random(-2.0f, 20.0f), rng.random(-4.0f, 4.0f), rng.random(-2.0f, 20.0f));
+		const Vector3 to = from + Vector3(rng.random(-4.0f, 4.0f), rng.random(-4.0f, 4.0f), rng.random(-4.0f, 4.0f));
+
+		real_t intersection_distance = 1e20;
+		real_t edge_distance = 1e20;
+		Vector3 edge_point;
+		for (int j = 0; j < faces.size(); j++) {
+			Vector3 intersection;
+			if (faces[j].intersects_segment(from, to, &intersection)) {
+				intersection_distance = MIN(intersection_distance, from.distance_to(intersection));
+			}
+			for (int k = 0; k < 3; k++) {
+				Vector3 a, b;
+				Geometry3D::get_closest_points_between_segments(from, to, faces[j].vertex[k], faces[j].vertex[(k + 1) % 3], a, b);
+				if (a.distance_to(b) < edge_distance) {
+					edge_distance = a.distance_to(b);
+					edge_point = b;
+				}
+			}
+		}
+
+		const Vector3 closest_point = server->map_get_closest_point_to_segment(map, from, to, false);
+		if (intersection_distance < 1e20) {
+			CHECK(Math::is_equal_approx(closest_point.distance_to(from), intersection_distance, (real_t)1e-4));
+			CHECK(server->map_get_closest_point_to_segment(map, from, to, true).is_equal_approx(closest_point));
+		} else {
+			CHECK(closest_point.is_equal_approx(edge_point));
+		}
+	}
+
+	for (int i = 0; i < 3; i++) {
+		server->free(regions[i]);
+	}
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+} // namespace TestNavigationMap
+
+#endif // TEST_NAVIGATION_MAP_H
@@ -0,0 +1,138 @@
+/*************************************************************************/
+/*  test_navigation_mesh_generator.h                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEST_NAVIGATION_MESH_GENERATOR_H
+#define TEST_NAVIGATION_MESH_GENERATOR_H
+
+#include "modules/navigation/godot_navigation_server.h"
+#include "modules/navigation/navigation_mesh_generator.h"
+#include "scene/resources/navigation_mesh.h"
+
+#include "tests/test_macros.h"
+
+namespace TestNavigationMeshGenerator {
+
+static void _add_box(const Vector3 &p_min, const Vector3 &p_max, Vector<float> &r_vertices, Vector<int> &r_indices) {
+	static const int faces[12][3] = {
+		{ 0, 2, 1 }, { 1, 2, 3 }, { 4, 5, 6 }, { 5, 7, 6 }, { 0, 1, 4 }, { 1, 5, 4 },
+		{ 2, 6, 3 }, { 3, 6, 7 }, { 0, 4, 2 }, { 2, 4, 6 }, { 1, 3, 5 }, { 3, 7, 5 }
+	};
+
+	const int base = r_vertices.size() / 3;
+	for (int i = 0; i < 8; i++) {
+		r_vertices.push_back((i & 1) ? p_max.x : p_min.x);
+		r_vertices.push_back((i & 2) ? p_max.y : p_min.y);
+		r_vertices.push_back((i & 4) ? p_max.z : p_min.z);
+	}
+	for (int i = 0; i < 12; i++) {
+		for (int j = 0; j < 3; j++) {
+			r_indices.push_back(base + faces[i][j]);
+		}
+	}
+}
+
+// A flat ground spanning 4x4 tiles of the default size, with a box standing on it.
+static void _create_ground(const Vector3 &p_obstacle, Vector<float> &r_vertices, Vector<int> &r_indices) {
+	const int cells = 24;
+	const float cell_size = 3.2;
+	for (int z = 0; z <= cells; z++) {
+		for (int x = 0; x <= cells; x++) {
+			r_vertices.push_back(x * cell_size);
+			r_vertices.push_back(0);
+			r_vertices.push_back(z * cell_size);
+		}
+	}
+	for (int z = 0; z < cells; z++) {
+		for (int x = 0; x < cells; x++) {
+			const int i = z * (cells + 1) + x;
+			r_indices.push_back(i);
+			r_indices.push_back(i + cells + 1);
+			r_indices.push_back(i + 1);
+			r_indices.push_back(i + 1);
+			r_indices.push_back(i + cells + 1);
+			r_indices.push_back(i + cells + 2);
+		}
+	}
+
+	_add_box(p_obstacle - Vector3(0.5, 0, 0.5), p_obstacle + Vector3(0.5, 2, 0.5), r_vertices, r_indices);
+}
+
+TEST_CASE("[NavigationMeshGenerator] Tiled bakes only rebake the changed tiles") {
+	NavigationMeshGenerator *generator = memnew(NavigationMeshGenerator);
+
+	Ref<NavigationMesh> nav_mesh;
+	nav_mesh.instantiate();
+	nav_mesh->set_tile_size(64);
+	const float tile_width = nav_mesh->get_tile_size() * nav_mesh->get_cell_size();
+
+	// The obstacle stays far enough from the borders to only overlap the tile it is in.
+	Vector<float> vertices;
+	Vector<int> indices;
+	_create_ground(Vector3(1.5, 0, 1.5) * tile_width, vertices, indices);
+
+	const uint32_t tile_count = generator->bake_tiles_from(nav_mesh, nav_mesh->get_instance_id(), vertices, indices);
+	CHECK_MESSAGE(tile_count > 2, "All the tiles are baked the first time.");
+	CHECK(nav_mesh->get_polygon_count() > 0);
+
+	CHECK_MESSAGE(generator->bake_tiles_from(nav_mesh, nav_mesh->get_instance_id(), vertices, indices) == 0, "No tile is baked again when nothing changed.");
+
+	vertices.clear();
+	indices.clear();
+	_create_ground(Vector3(2.5, 0, 1.5) * tile_width, vertices, indices);
+	CHECK_MESSAGE(generator->bake_tiles_from(nav_mesh, nav_mesh->get_instance_id(), vertices, indices) == 2, "Only the tiles the obstacle left and entered are baked again.");
+
+	// The path crosses several tile seams, and must reach the destination.
+	NavigationServer3D *server = memnew(GodotNavigationServer);
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	RID region = server->region_create();
+	server->region_set_navmesh(region, nav_mesh);
+	server->region_set_map(region, map);
+	server->process(0.0);
+
+	const Vector3 origin = Vector3(0.1, 0, 0.5) * tile_width;
+	const Vector3 destination = Vector3(3.9, 0, 3.5) * tile_width;
+	Vector<Vector3> path = server->map_get_path(map, origin, destination, true);
+	REQUIRE(path.size() >= 2);
+	CHECK(Vector2(path[0].x, path[0].z).distance_to(Vector2(origin.x, origin.z)) < 0.5);
+	CHECK(Vector2(path[path.size() - 1].x, path[path.size() - 1].z).distance_to(Vector2(destination.x, destination.z)) < 0.5);
+
+	server->free(region);
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+
+	memdelete(generator);
+}
+
+} // namespace TestNavigationMeshGenerator
+
+#endif // TEST_NAVIGATION_MESH_GENERATOR_H
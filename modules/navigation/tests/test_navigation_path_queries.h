@@ -0,0 +1,203 @@
+/*************************************************************************/
+/*  test_navigation_path_queries.h                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_NAVIGATION_PATH_QUERIES_H
+#define TEST_NAVIGATION_PATH_QUERIES_H
+
+#include "core/math/random_pcg.h"
+#include "modules/navigation/godot_navigation_server.h"
+#include "scene/resources/navigation_mesh.h"
+
+#include "tests/test_macros.h"
+
+namespace TestNavigationPathQueries {
+
+// A grid of triangles from `p_from_x` to `p_to_x`, with a wall along z at
+// `p_wall_x` crossed by a single door.
+static Ref<NavigationMesh> _create_grid_navmesh(int p_from_x, int p_to_x, int p_size_z, int p_wall_x = -1) {
+	const int width = p_to_x - p_from_x;
+
+	Vector<Vector3> vertices;
+	vertices.resize((width + 1) * (p_size_z + 1));
+	for (int z = 0; z <= p_size_z; z++) {
+		for (int x = 0; x <= width; x++) {
+			vertices.write[z * (width + 1) + x] = Vector3(p_from_x + x, 0, z);
+		}
+	}
+
+	Ref<NavigationMesh> navmesh;
+	navmesh.instantiate();
+	navmesh->set_vertices(vertices);
+	for (int z = 0; z < p_size_z; z++) {
+		for (int x = 0; x < width; x++) {
+			if (p_from_x + x == p_wall_x && z != p_size_z - 2) {
+				continue;
+			}
+
+			const int i = z * (width + 1) + x;
+			Vector<int> first;
+			first.push_back(i);
+			first.push_back(i + width + 1);
+			first.push_back(i + 1);
+			navmesh->add_polygon(first);
+
+			Vector<int> second;
+			second.push_back(i + 1);
+			second.push_back(i + width + 1);
+			second.push_back(i + width + 2);
+			navmesh->add_polygon(second);
+		}
+	}
+
+	return navmesh;
+}
+
+static RID _add_region(NavigationServer3D *p_server, RID p_map, const Ref<NavigationMesh> &p_navmesh, uint32_t p_layers = 1) {
+	RID region = p_server->region_create();
+	p_server->region_set_layers(region, p_layers);
+	p_server->region_set_navmesh(region, p_navmesh);
+	p_server->region_set_map(region, p_map);
+	return region;
+}
+
+class PathQueryListener : public Object {
+public:
+	LocalVector<RID> done_queries;
+
+	void _on_query_done(RID p_query) {
+		done_queries.push_back(p_query);
+	}
+};
+
+TEST_CASE("[Navigation] Path queries") {
+	NavigationServer3D *server = memnew(GodotNavigationServer);
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	server->map_set_cell_size(map, 0.25);
+
+	// The right region is only on the second layer.
+	RID left = _add_region(server, map, _create_grid_navmesh(0, 20, 20, 10));
+	RID right = _add_region(server, map, _create_grid_navmesh(20, 30, 20), 2);
+	server->process(0.0);
+
+	RandomPCG rng(21);
+	PackedVector3Array origins;
+	PackedVector3Array destinations;
+	PackedInt32Array layers;
+	for (int i = 0; i < 40; i++) {
+		origins.push_back(Vector3(rng.random(0.0f, 10.0f), 0, rng.random(0.0f, 20.0f)));
+		destinations.push_back(Vector3(rng.random(10.0f, 30.0f), 0, rng.random(0.0f, 20.0f)));
+		layers.push_back(i % 2 ? 3 : 1);
+	}
+
+	SUBCASE("The paths match map_get_path") {
+		PathQueryListener listener;
+		RID query = server->map_query_paths(map, origins, destinations, true, layers, callable_mp(&listener, &PathQueryListener::_on_query_done));
+		CHECK_FALSE(server->path_query_is_done(query));
+
+		// The paths are computed between two calls to process.
+		server->process(0.0);
+		server->process(0.0);
+		REQUIRE(server->path_query_is_done(query));
+		REQUIRE(listener.done_queries.size() == 1);
+		CHECK(listener.done_queries[0] == query);
+
+		const Array paths = server->path_query_get_paths(query);
+		REQUIRE(paths.size() == origins.size());
+		for (int i = 0; i < origins.size(); i++) {
+			CHECK(PackedVector3Array(paths[i]) == server->map_get_path(map, origins[i], destinations[i], true, layers[i]));
+		}
+
+		// Without layers, the paths use the first one.
+		RID unoptimized_query = server->map_query_paths(map, origins, destinations, false);
+		server->process(0.0);
+		server->process(0.0);
+		REQUIRE(server->path_query_is_done(unoptimized_query));
+		const Array unoptimized_paths = server->path_query_get_paths(unoptimized_query);
+		REQUIRE(unoptimized_paths.size() == origins.size());
+		for (int i = 0; i < origins.size(); i++) {
+			CHECK(PackedVector3Array(unoptimized_paths[i]) == server->map_get_path(map, origins[i], destinations[i], false, 1));
+		}
+
+		server->free(query);
+		server->free(unoptimized_query);
+	}
+
+	SUBCASE("Freeing the map") {
+		// While the query is running, it is finished before the map is freed.
+		RID running_query = server->map_query_paths(map, origins, destinations, true);
+		server->process(0.0);
+		server->free(left);
+		server->free(right);
+		server->free(map);
+		server->process(0.0);
+		REQUIRE(server->path_query_is_done(running_query));
+		const Array paths = server->path_query_get_paths(running_query);
+		REQUIRE(paths.size() == origins.size());
+		CHECK(PackedVector3Array(paths[0]).size() >= 2);
+
+		// Before the query runs, it gets no paths.
+		RID other_map = server->map_create();
+		server->map_set_active(other_map, true);
+		server->process(0.0);
+		RID pending_query = server->map_query_paths(other_map, origins, destinations, true);
+		server->free(other_map);
+		server->process(0.0);
+		server->process(0.0);
+		REQUIRE(server->path_query_is_done(pending_query));
+		const Array pending_paths = server->path_query_get_paths(pending_query);
+		REQUIRE(pending_paths.size() == origins.size());
+		CHECK(PackedVector3Array(pending_paths[0]).is_empty());
+
+		server->free(running_query);
+		server->free(pending_query);
+		map = RID();
+	}
+
+	SUBCASE("Freeing a running query") {
+		RID query = server->map_query_paths(map, origins, destinations, true);
+		server->process(0.0);
+		server->free(query);
+		server->process(0.0);
+		server->process(0.0);
+		CHECK(server->map_get_path(map, origins[0], destinations[0], true).size() >= 2);
+	}
+
+	if (map.is_valid()) {
+		server->free(left);
+		server->free(right);
+		server->free(map);
+	}
+	server->process(0.0);
+	memdelete(server);
+}
+
+} // namespace TestNavigationPathQueries
+
+#endif // TEST_NAVIGATION_PATH_QUERIES_H
@@ -0,0 +1,125 @@
+/*************************************************************************/
+/*  dir_watcher_inotify.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "dir_watcher_inotify.h"
+
+#ifdef __linux__
+
+#include "core/config/project_settings.h"
+
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+Error DirWatcherInotify::add_dir(const String &p_path) {
+	ERR_FAIL_COND_V(fd < 0, ERR_UNAVAILABLE);
+
+	if (watched_paths.has(p_path)) {
+		return OK;
+	}
+
+	String global_path = ProjectSettings::get_singleton()->globalize_path(p_path);
+	int wd = inotify_add_watch(fd, global_path.utf8().get_data(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+	if (wd < 0) {
+		// ENOSPC when out of watches, see fs.inotify.max_user_watches.
+		return errno == ENOSPC ? ERR_OUT_OF_MEMORY : ERR_CANT_OPEN;
+	}
+
+	watched_dirs[wd] = p_path;
+	watched_paths.insert(p_path);
+	return OK;
+}
+
+bool DirWatcherInotify::is_watching(const String &p_path) const {
+	return watched_paths.has(p_path);
+}
+
+bool DirWatcherInotify::get_changes(Set<String> &r_changed) {
+	bool complete = true;
+
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	while (true) {
+		ssize_t len = read(fd, buffer, sizeof(buffer));
+		if (len <= 0) {
+			break; // EAGAIN, nothing left.
+		}
+
+		for (char *ptr = buffer; ptr < buffer + len;) {
+			const struct inotify_event *event = (const struct inotify_event *)ptr;
+			ptr += sizeof(struct inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				complete = false;
+				continue;
+			}
+
+			const String *path = watched_dirs.getptr(event->wd);
+			if (!path) {
+				continue;
+			}
+
+			r_changed.insert(*path);
+
+			if (event->mask & IN_IGNORED) {
+				// The watch was removed along with the directory.
+				watched_paths.erase(*path);
+				watched_dirs.erase(event->wd);
+			}
+		}
+	}
+
+	return complete;
+}
+
+DirWatcher *DirWatcherInotify::_create_inotify() {
+	DirWatcherInotify *watcher = memnew(DirWatcherInotify);
+	if (watcher->fd >= 0) {
+		return watcher;
+	}
+
+	memdelete(watcher);
+	return nullptr;
+}
+
+void DirWatcherInotify::make_default() {
+	_create = _create_inotify;
+}
+
+DirWatcherInotify::DirWatcherInotify() {
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+DirWatcherInotify::~DirWatcherInotify() {
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+#endif // __linux__
@@ -0,0 +1,59 @@
+/*************************************************************************/
+/*  dir_watcher_inotify.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef DIR_WATCHER_INOTIFY_H
+#define DIR_WATCHER_INOTIFY_H
+
+#ifdef __linux__
+
+#include "core/io/dir_watcher.h"
+#include "core/templates/hash_map.h"
+
+class DirWatcherInotify : public DirWatcher {
+	int fd = -1;
+	HashMap<int, String> watched_dirs;
+	Set<String> watched_paths;
+
+	static DirWatcher *_create_inotify();
+
+public:
+	virtual Error add_dir(const String &p_path) override;
+	virtual bool is_watching(const String &p_path) const override;
+	virtual bool get_changes(Set<String> &r_changed) override;
+
+	static void make_default();
+
+	DirWatcherInotify();
+	virtual ~DirWatcherInotify();
+};
+
+#endif // __linux__
+
+#endif // DIR_WATCHER_INOTIFY_H
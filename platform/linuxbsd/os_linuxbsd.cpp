@@ -31,6 +31,7 @@
 #include "os_linuxbsd.h"
 
 #include "core/io/dir_access.h"
+#include "dir_watcher_inotify.h"
 #include "main/main.h"
 
 #ifdef X11_ENABLED
@@ -119,6 +120,10 @@ void OS_LinuxBSD::initialize() {
 	crash_handler.initialize();
 
 	OS_Unix::initialize_core();
+
+#ifdef __linux__
+	DirWatcherInotify::make_default();
+#endif
 }
 
 void OS_LinuxBSD::initialize_joypads() {
@@ -477,6 +477,10 @@ float AudioStreamSample::get_length() const {
 	return float(len) / mix_rate;
 }
 
+uint64_t AudioStreamSample::get_cache_cost() const {
+	return data_bytes;
+}
+
 void AudioStreamSample::set_data(const Vector<uint8_t> &p_data) {
 	AudioServer::get_singleton()->lock();
 	if (data) {
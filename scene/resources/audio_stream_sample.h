@@ -135,6 +135,7 @@ public:
 	bool is_stereo() const;
 
 	virtual float get_length() const override; //if supported, otherwise return 0
+	virtual uint64_t get_cache_cost() const override;
 
 	void set_data(const Vector<uint8_t> &p_data);
 	Vector<uint8_t> get_data() const;
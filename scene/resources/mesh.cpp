@@ -1585,6 +1585,19 @@ RID ArrayMesh::get_rid() const {
 	return mesh;
 }
 
+uint64_t ArrayMesh::get_cache_cost() const {
+	uint64_t cost = 0;
+	for (int i = 0; i < surfaces.size(); i++) {
+		const Surface &s = surfaces[i];
+		uint32_t stride = RS::get_singleton()->mesh_surface_get_format_vertex_stride(s.format, s.array_length);
+		stride += RS::get_singleton()->mesh_surface_get_format_attribute_stride(s.format, s.array_length);
+		stride += RS::get_singleton()->mesh_surface_get_format_skin_stride(s.format, s.array_length);
+		cost += uint64_t(stride) * s.array_length;
+		cost += uint64_t(s.index_array_length) * (s.array_length <= 65536 ? 2 : 4);
+	}
+	return cost;
+}
+
 AABB ArrayMesh::get_aabb() const {
 	return aabb;
 }
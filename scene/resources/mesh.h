@@ -261,6 +261,7 @@ public:
 
 	AABB get_aabb() const override;
 	virtual RID get_rid() const override;
+	virtual uint64_t get_cache_cost() const override;
 
 	void regen_normal_maps();
 
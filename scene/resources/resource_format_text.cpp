@@ -33,6 +33,7 @@
 #include "core/config/project_settings.h"
 #include "core/io/dir_access.h"
 #include "core/io/resource_format_binary.h"
+#include "core/os/thread.h"
 #include "core/version.h"
 
 // Version 2: changed names for Basis, AABB, Vectors, etc.
@@ -791,6 +792,8 @@ void ResourceLoaderText::get_dependencies(FileAccess *p_f, List<String> *p_depen
 }
 
 Error ResourceLoaderText::rename_dependencies(FileAccess *p_f, const String &p_path, const Map<String, String> &p_map) {
+	// The file position is used below to copy everything after the external resources verbatim.
+	stream.readahead_enabled = false;
 	open(p_f, true);
 	ERR_FAIL_COND_V(error != OK, error);
 	ignore_resource_parsing = true;
@@ -1111,7 +1114,7 @@ Error ResourceLoaderText::save_as_binary(FileAccess *p_f, const String &p_path)
 
 	while (next_tag.name == "sub_resource" || next_tag.name == "resource") {
 		String type;
-		int id = -1;
+		String id;
 		bool main_res;
 
 		if (next_tag.name == "sub_resource") {
@@ -1134,13 +1137,13 @@ Error ResourceLoaderText::save_as_binary(FileAccess *p_f, const String &p_path)
 			main_res = false;
 		} else {
 			type = res_type;
-			id = 0; //used for last anyway
+			id = "0"; //used for last anyway
 			main_res = true;
 		}
 
 		local_offsets.push_back(wf2->get_position());
 
-		bs_save_unicode_string(wf, "local://" + itos(id));
+		bs_save_unicode_string(wf, "local://" + id);
 		local_pointers_pos.push_back(wf->get_position());
 		wf->store_64(0); //temp local offset
 
@@ -1338,6 +1341,143 @@ ResourceUID::ID ResourceLoaderText::get_uid(FileAccess *p_f) {
 
 /////////////////////
 
+#ifdef TOOLS_ENABLED
+String ResourceFormatLoaderText::text_cache_path;
+
+void ResourceFormatLoaderText::set_text_cache_path(const String &p_path) {
+	text_cache_path = p_path;
+}
+
+String ResourceFormatLoaderText::get_text_cache_path() {
+	return text_cache_path;
+}
+
+String ResourceFormatLoaderText::get_text_cache_file_name(const String &p_path, uint64_t p_modified_time) {
+	return p_path.md5_text().plus_file(itos(p_modified_time) + ".res");
+}
+
+void ResourceFormatLoaderText::prune_text_cache(const Set<String> &p_keep_files) {
+	if (text_cache_path.is_empty()) {
+		return;
+	}
+
+	DirAccessRef da = DirAccess::open(text_cache_path);
+	if (!da) {
+		return;
+	}
+
+	List<String> dirs;
+	List<String> to_remove;
+	List<String> dirs_to_remove;
+	da->list_dir_begin();
+	String file = da->get_next();
+	while (!file.is_empty()) {
+		if (da->current_is_dir()) {
+			if (file != "." && file != "..") {
+				dirs.push_back(file);
+			}
+		} else {
+			to_remove.push_back(file);
+		}
+		file = da->get_next();
+	}
+	da->list_dir_end();
+
+	// Each directory holds the entries of a single source path.
+	for (const String &dir : dirs) {
+		if (da->change_dir(text_cache_path.plus_file(dir)) != OK) {
+			continue;
+		}
+		bool keep_dir = false;
+		da->list_dir_begin();
+		file = da->get_next();
+		while (!file.is_empty()) {
+			if (!da->current_is_dir()) {
+				if (p_keep_files.has(dir.plus_file(file))) {
+					keep_dir = true;
+				} else {
+					to_remove.push_back(dir.plus_file(file));
+				}
+			}
+			file = da->get_next();
+		}
+		da->list_dir_end();
+
+		if (!keep_dir) {
+			dirs_to_remove.push_back(dir);
+		}
+	}
+
+	da->change_dir(text_cache_path);
+	for (const String &E : to_remove) {
+		da->remove(E);
+	}
+	for (const String &E : dirs_to_remove) {
+		da->remove(E);
+	}
+}
+
+String ResourceFormatLoaderText::_get_text_cache_file(const String &p_path, uint64_t &r_modified_time) const {
+	if (text_cache_path.is_empty()) {
+		return String();
+	}
+
+	r_modified_time = FileAccess::get_modified_time(p_path);
+	if (r_modified_time == 0) {
+		return String();
+	}
+
+	return text_cache_path.plus_file(get_text_cache_file_name(p_path, r_modified_time));
+}
+
+bool ResourceFormatLoaderText::_is_text_cache_file_valid(const String &p_cache_file, uint64_t p_modified_time) const {
+	if (!FileAccess::exists(p_cache_file)) {
+		return false;
+	}
+
+	// Modification times are in seconds. An entry written in the same second as the
+	// last save of the source may have converted the content before that save.
+	return FileAccess::get_modified_time(p_cache_file) > p_modified_time;
+}
+
+bool ResourceFormatLoaderText::_store_in_text_cache(const String &p_path, const String &p_cache_file) const {
+	const String cache_dir = p_cache_file.get_base_dir();
+	DirAccessRef da = DirAccess::create_for_path(cache_dir);
+	if (!da->dir_exists(cache_dir) && da->make_dir_recursive(cache_dir) != OK) {
+		return false;
+	}
+
+	// Convert to a temporary file first, so a concurrent load never sees a partially written entry.
+	String temp_file = p_cache_file + ".tmp" + itos(Thread::get_caller_id());
+	if (convert_file_to_binary(p_path, temp_file) != OK || da->rename(temp_file, p_cache_file) != OK) {
+		if (da->file_exists(temp_file)) {
+			da->remove(temp_file);
+		}
+		return false;
+	}
+
+	// The entries of the previous modification times are not used anymore.
+	if (da->change_dir(cache_dir) == OK) {
+		const String cache_file_name = p_cache_file.get_file();
+		List<String> to_remove;
+		da->list_dir_begin();
+		String file = da->get_next();
+		while (!file.is_empty()) {
+			if (!da->current_is_dir() && file != cache_file_name && file.get_extension() == "res") {
+				to_remove.push_back(file);
+			}
+			file = da->get_next();
+		}
+		da->list_dir_end();
+
+		for (const String &E : to_remove) {
+			da->remove(E);
+		}
+	}
+	return true;
+}
+#endif
+
 RES ResourceFormatLoaderText::load(const String &p_path, const String &p_original_path, Error *r_error, bool p_use_sub_threads, float *r_progress, CacheMode p_cache_mode) {
 	if (r_error) {
 		*r_error = ERR_CANT_OPEN;
@@ -1345,6 +1485,28 @@ RES ResourceFormatLoaderText::load(const String &p_path, const String &p_origina
 
 	Error err;
 
+#ifdef TOOLS_ENABLED
+	// Load the binary conversion of the file made since its last modification, it is much faster. Without
+	// one, convert the file first and load the result, so the text is still parsed only once.
+	uint64_t modified_time = 0;
+	String cache_file = _get_text_cache_file(p_path, modified_time);
+	if (!cache_file.is_empty() && (_is_text_cache_file_valid(cache_file, modified_time) || _store_in_text_cache(p_path, cache_file))) {
+		Ref<ResourceFormatLoaderBinary> binary_loader;
+		binary_loader.instantiate();
+		RES res = binary_loader->load(cache_file, p_original_path != "" ? p_original_path : p_path, &err, p_use_sub_threads, r_progress, p_cache_mode);
+		if (err == OK) {
+			if (r_error) {
+				*r_error = OK;
+			}
+			return res;
+		}
+
+		// Unusable entry (e.g. written by an incompatible version), parse the text file instead.
+		DirAccessRef da = DirAccess::create_for_path(cache_file);
+		da->remove(cache_file);
+	}
+#endif
+
 	FileAccess *f = FileAccess::open(p_path, FileAccess::READ, &err);
 
 	ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot open file '" + p_path + "'.");
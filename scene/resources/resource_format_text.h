@@ -34,6 +34,8 @@
 #include "core/io/file_access.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
 #include "core/variant/variant_parser.h"
 #include "scene/resources/packed_scene.h"
 
@@ -132,6 +134,15 @@ public:
 };
 
 class ResourceFormatLoaderText : public ResourceFormatLoader {
+#ifdef TOOLS_ENABLED
+	static String text_cache_path;
+
+	String _get_text_cache_file(const String &p_path, uint64_t &r_modified_time) const;
+	bool _is_text_cache_file_valid(const String &p_cache_file, uint64_t p_modified_time) const;
+	// Also removes the other entries of the path, there is one directory per path.
+	bool _store_in_text_cache(const String &p_path, const String &p_cache_file) const;
+#endif
+
 public:
 	static ResourceFormatLoaderText *singleton;
 	virtual RES load(const String &p_path, const String &p_original_path = "", Error *r_error = nullptr, bool p_use_sub_threads = false, float *r_progress = nullptr, CacheMode p_cache_mode = CACHE_MODE_REUSE);
@@ -145,6 +156,17 @@ public:
 
 	static Error convert_file_to_binary(const String &p_src_path, const String &p_dst_path);
 
+#ifdef TOOLS_ENABLED
+	// Directory where binary versions of loaded text resources are kept, keyed by
+	// the path and modification time of the text file. An entry written in the same
+	// second as the text file is converted again. An empty path disables the cache.
+	static void set_text_cache_path(const String &p_path);
+	static String get_text_cache_path();
+	static String get_text_cache_file_name(const String &p_path, uint64_t p_modified_time);
+	// Removes the entries not in the given list of file names, e.g. those of deleted or modified files.
+	static void prune_text_cache(const Set<String> &p_keep_files);
+#endif
+
 	ResourceFormatLoaderText() { singleton = this; }
 };
 
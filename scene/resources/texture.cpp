@@ -220,6 +220,10 @@ RID ImageTexture::get_rid() const {
 	return texture;
 }
 
+uint64_t ImageTexture::get_cache_cost() const {
+	return Image::get_image_data_size(w, h, format, mipmaps);
+}
+
 bool ImageTexture::has_alpha() const {
 	return (format == Image::FORMAT_LA8 || format == Image::FORMAT_RGBA8);
 }
@@ -632,6 +636,14 @@ RID StreamTexture2D::get_rid() const {
 	return texture;
 }
 
+uint64_t StreamTexture2D::get_cache_cost() const {
+	if (format == Image::FORMAT_MAX) {
+		return Texture2D::get_cache_cost();
+	}
+	// Whether mipmaps were stored is not kept around, assume they were.
+	return Image::get_image_data_size(w, h, format, true);
+}
+
 void StreamTexture2D::draw(RID p_canvas_item, const Point2 &p_pos, const Color &p_modulate, bool p_transpose) const {
 	if ((w | h) == 0) {
 		return;
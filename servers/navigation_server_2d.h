@@ -78,6 +78,12 @@ public:
 	/// Returns the edge connection margin of this map.
 	virtual real_t map_get_edge_connection_margin(RID p_map) const;
 
+	/// Set if the map paths are planned over clusters of polygons first.
+	virtual void map_set_use_hierarchical_paths(RID p_map, bool p_enabled) const;
+
+	/// Returns true if the map paths are planned over clusters of polygons first.
+	virtual bool map_get_use_hierarchical_paths(RID p_map) const;
+
 	/// Returns the navigation path to reach the destination from the origin.
 	virtual Vector<Vector2> map_get_path(RID p_map, Vector2 p_origin, Vector2 p_destination, bool p_optimize, uint32_t p_layers = 1) const;
 
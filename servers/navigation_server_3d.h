@@ -87,6 +87,12 @@ public:
 	/// Returns the edge connection margin of this map.
 	virtual real_t map_get_edge_connection_margin(RID p_map) const = 0;
 
+	/// Set if the map paths are planned over clusters of polygons first.
+	virtual void map_set_use_hierarchical_paths(RID p_map, bool p_enabled) const = 0;
+
+	/// Returns true if the map paths are planned over clusters of polygons first.
+	virtual bool map_get_use_hierarchical_paths(RID p_map) const = 0;
+
 	/// Returns the navigation path to reach the destination from the origin.
 	virtual Vector<Vector3> map_get_path(RID p_map, Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_navigable_layers = 1) const = 0;
 
@@ -95,6 +101,22 @@ public:
 	virtual Vector3 map_get_closest_point_normal(RID p_map, const Vector3 &p_point) const = 0;
 	virtual RID map_get_closest_point_owner(RID p_map, const Vector3 &p_point) const = 0;
 
+	/// Returns the direction to follow from the position to reach the nearest
+	/// target. The distances to the targets are shared by all the positions,
+	/// until the map changes.
+	virtual Vector3 map_get_flow_direction(RID p_map, const PackedVector3Array &p_targets, const Vector3 &p_position, uint32_t p_navigable_layers = 1) const = 0;
+
+	/// Queues the navigation paths between each origin and destination.
+	/// The paths are computed in parallel after the next sync, the returned
+	/// query can be polled and must be freed.
+	virtual RID map_query_paths(RID p_map, const PackedVector3Array &p_origins, const PackedVector3Array &p_destinations, bool p_optimize, const PackedInt32Array &p_navigable_layers = PackedInt32Array(), const Callable &p_callback = Callable()) const = 0;
+
+	/// Returns true once the paths of the query are computed.
+	virtual bool path_query_is_done(RID p_query) const = 0;
+
+	/// Returns the paths of a finished query, in the order they were queued.
+	virtual Array path_query_get_paths(RID p_query) const = 0;
+
 	/// Creates a new region.
 	virtual RID region_create() const = 0;
 
@@ -86,6 +86,7 @@ AreaPair2DSW::AreaPair2DSW(Body2DSW *p_body, int p_body_shape, Area2DSW *p_area,
 	area = p_area;
 	body_shape = p_body_shape;
 	area_shape = p_area_shape;
+	set_order_key(area->get_stable_id(), body->get_stable_id(), (uint64_t(uint32_t(area_shape)) << 32) | uint32_t(body_shape));
 	body->add_constraint(this, 0);
 	area->add_constraint(this);
 	if (p_body->get_mode() == PhysicsServer2D::BODY_MODE_KINEMATIC) { //need to be active to process pair
@@ -163,6 +164,7 @@ Area2Pair2DSW::Area2Pair2DSW(Area2DSW *p_area_a, int p_shape_a, Area2DSW *p_area
 	area_b = p_area_b;
 	shape_a = p_shape_a;
 	shape_b = p_shape_b;
+	set_order_key(area_a->get_stable_id(), area_b->get_stable_id(), (uint64_t(uint32_t(shape_a)) << 32) | uint32_t(shape_b));
 	area_a->add_constraint(this);
 	area_b->add_constraint(this);
 }
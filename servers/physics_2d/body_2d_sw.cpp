@@ -117,6 +117,36 @@ void Body2DSW::set_active(bool p_active) {
 	}
 }
 
+void Body2DSW::save_state(State &r_state) const {
+	r_state.transform = get_transform();
+	r_state.inv_transform = get_inv_transform();
+	r_state.new_transform = new_transform;
+	r_state.linear_velocity = linear_velocity;
+	r_state.biased_linear_velocity = biased_linear_velocity;
+	r_state.applied_force = applied_force;
+	r_state.angular_velocity = angular_velocity;
+	r_state.biased_angular_velocity = biased_angular_velocity;
+	r_state.applied_torque = applied_torque;
+	r_state.still_time = still_time;
+	r_state.active = active;
+}
+
+void Body2DSW::restore_state(const State &p_state) {
+	if (get_transform() != p_state.transform) {
+		_set_transform(p_state.transform);
+	}
+	_set_inv_transform(p_state.inv_transform);
+	new_transform = p_state.new_transform;
+	linear_velocity = p_state.linear_velocity;
+	biased_linear_velocity = p_state.biased_linear_velocity;
+	applied_force = p_state.applied_force;
+	angular_velocity = p_state.angular_velocity;
+	biased_angular_velocity = p_state.biased_angular_velocity;
+	applied_torque = p_state.applied_torque;
+	still_time = p_state.still_time;
+	set_active(p_state.active);
+}
+
 void Body2DSW::set_param(PhysicsServer2D::BodyParameter p_param, real_t p_value) {
 	switch (p_param) {
 		case PhysicsServer2D::BODY_PARAM_BOUNCE: {
@@ -91,7 +91,13 @@ class Body2DSW : public CollisionObject2DSW {
 		Area2DSW *area;
 		int refCount;
 		_FORCE_INLINE_ bool operator==(const AreaCMP &p_cmp) const { return area->get_self() == p_cmp.area->get_self(); }
-		_FORCE_INLINE_ bool operator<(const AreaCMP &p_cmp) const { return area->get_priority() < p_cmp.area->get_priority(); }
+		_FORCE_INLINE_ bool operator<(const AreaCMP &p_cmp) const {
+			if (area->get_priority() == p_cmp.area->get_priority()) {
+				// Keep the order of areas with the same priority independent of when they were entered.
+				return area->get_stable_id() < p_cmp.area->get_stable_id();
+			}
+			return area->get_priority() < p_cmp.area->get_priority();
+		}
 		_FORCE_INLINE_ AreaCMP() {}
 		_FORCE_INLINE_ AreaCMP(Area2DSW *p_area) {
 			area = p_area;
@@ -130,6 +136,24 @@ class Body2DSW : public CollisionObject2DSW {
 	friend class PhysicsDirectBodyState2DSW; // i give up, too many functions to expose
 
 public:
+	// Simulation state saved in space snapshots, anything not here is considered a setting.
+	struct State {
+		Transform2D transform;
+		Transform2D inv_transform;
+		Transform2D new_transform;
+		Vector2 linear_velocity;
+		Vector2 biased_linear_velocity;
+		Vector2 applied_force;
+		real_t angular_velocity;
+		real_t biased_angular_velocity;
+		real_t applied_torque;
+		real_t still_time;
+		bool active;
+	};
+
+	void save_state(State &r_state) const;
+	void restore_state(const State &p_state);
+
 	void set_force_integration_callback(const Callable &p_callable, const Variant &p_udata = Variant());
 
 	_FORCE_INLINE_ void add_area(Area2DSW *p_area) {
@@ -528,13 +528,45 @@ void BodyPair2DSW::solve(real_t p_step) {
 	}
 }
 
+void BodyPair2DSW::save_state(State &r_state) const {
+	r_state.offset_B = offset_B;
+	r_state.sep_axis = sep_axis;
+	for (int i = 0; i < contact_count; i++) {
+		r_state.contacts[i] = contacts[i];
+	}
+	r_state.contact_count = contact_count;
+	r_state.collided = collided;
+	r_state.oneway_disabled = oneway_disabled;
+}
+
+void BodyPair2DSW::restore_state(const State &p_state) {
+	offset_B = p_state.offset_B;
+	sep_axis = p_state.sep_axis;
+	contact_count = CLAMP(p_state.contact_count, 0, (int)MAX_CONTACTS);
+	for (int i = 0; i < contact_count; i++) {
+		contacts[i] = p_state.contacts[i];
+	}
+	collided = p_state.collided;
+	oneway_disabled = p_state.oneway_disabled;
+}
+
+void BodyPair2DSW::clear_state() {
+	sep_axis = Vector2();
+	contact_count = 0;
+	collided = false;
+	oneway_disabled = false;
+}
+
 BodyPair2DSW::BodyPair2DSW(Body2DSW *p_A, int p_shape_A, Body2DSW *p_B, int p_shape_B) :
-		Constraint2DSW(_arr, 2) {
+		Constraint2DSW(_arr, 2),
+		pair_list(this) {
 	A = p_A;
 	B = p_B;
 	shape_A = p_shape_A;
 	shape_B = p_shape_B;
 	space = A->get_space();
+	set_order_key(A->get_stable_id(), B->get_stable_id(), (uint64_t(uint32_t(shape_A)) << 32) | uint32_t(shape_B));
+	space->body_pair_add_to_list(&pair_list);
 	A->add_constraint(this, 0);
 	B->add_constraint(this, 1);
 }
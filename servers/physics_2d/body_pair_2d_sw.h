@@ -33,6 +33,7 @@
 
 #include "body_2d_sw.h"
 #include "constraint_2d_sw.h"
+#include "core/templates/self_list.h"
 
 class BodyPair2DSW : public Constraint2DSW {
 	enum {
@@ -81,16 +82,34 @@ class BodyPair2DSW : public Constraint2DSW {
 	bool oneway_disabled = false;
 	bool report_contacts_only = false;
 
+	SelfList<BodyPair2DSW> pair_list;
+
 	bool _test_ccd(real_t p_step, Body2DSW *p_A, int p_shape_A, const Transform2D &p_xform_A, Body2DSW *p_B, int p_shape_B, const Transform2D &p_xform_B, bool p_swap_result = false);
 	void _validate_contacts();
 	static void _add_contact(const Vector2 &p_point_A, const Vector2 &p_point_B, void *p_self);
 	_FORCE_INLINE_ void _contact_added_callback(const Vector2 &p_point_A, const Vector2 &p_point_B);
 
 public:
+	// Persistent contact data, saved in space snapshots so warm starting matches after a restore.
+	struct State {
+		Vector2 offset_B;
+		Vector2 sep_axis;
+		Contact contacts[MAX_CONTACTS];
+		int contact_count;
+		bool collided;
+		bool oneway_disabled;
+	};
+
 	virtual bool setup(real_t p_step) override;
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
+	// Snapshots leave out pairs without contacts, the broadphase creates them again on restore.
+	_FORCE_INLINE_ bool has_state() const { return collided || contact_count > 0; }
+	void save_state(State &r_state) const;
+	void restore_state(const State &p_state);
+	void clear_state();
+
 	BodyPair2DSW(Body2DSW *p_A, int p_shape_A, Body2DSW *p_B, int p_shape_B);
 	~BodyPair2DSW();
 };
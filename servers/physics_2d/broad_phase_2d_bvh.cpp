@@ -103,6 +103,10 @@ void BroadPhase2DBVH::update() {
 	bvh.update();
 }
 
+void BroadPhase2DBVH::set_pairing_expansion(real_t p_expansion) {
+	bvh.params_set_pairing_expansion(p_expansion);
+}
+
 BroadPhase2DSW *BroadPhase2DBVH::_create() {
 	return memnew(BroadPhase2DBVH);
 }
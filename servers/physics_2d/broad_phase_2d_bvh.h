@@ -66,6 +66,8 @@ public:
 
 	virtual void update();
 
+	virtual void set_pairing_expansion(real_t p_expansion);
+
 	static BroadPhase2DSW *_create();
 	BroadPhase2DBVH();
 };
@@ -65,6 +65,9 @@ public:
 
 	virtual void update() = 0;
 
+	// Margin added to the bounds when finding pairs, a negative value lets the broadphase choose.
+	virtual void set_pairing_expansion(real_t p_expansion) = 0;
+
 	virtual ~BroadPhase2DSW();
 };
 
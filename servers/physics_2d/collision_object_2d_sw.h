@@ -48,6 +48,7 @@ public:
 private:
 	Type type;
 	RID self;
+	uint64_t stable_id = 0;
 	ObjectID instance_id;
 	ObjectID canvas_instance_id;
 	bool pickable;
@@ -103,6 +104,14 @@ public:
 	_FORCE_INLINE_ void set_self(const RID &p_self) { self = p_self; }
 	_FORCE_INLINE_ RID get_self() const { return self; }
 
+	// Creation order of the object, which unlike the RID only depends on the physics API calls.
+	_FORCE_INLINE_ void set_stable_id(uint64_t p_stable_id) { stable_id = p_stable_id; }
+	_FORCE_INLINE_ uint64_t get_stable_id() const { return stable_id; }
+
+	struct StableIDComparator {
+		_FORCE_INLINE_ bool operator()(const CollisionObject2DSW *p_a, const CollisionObject2DSW *p_b) const { return p_a->stable_id < p_b->stable_id; }
+	};
+
 	_FORCE_INLINE_ void set_instance_id(const ObjectID &p_instance_id) { instance_id = p_instance_id; }
 	_FORCE_INLINE_ ObjectID get_instance_id() const { return instance_id; }
 
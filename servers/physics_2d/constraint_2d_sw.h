@@ -32,6 +32,7 @@
 #define CONSTRAINT_2D_SW_H
 
 #include "body_2d_sw.h"
+#include "servers/physics_state_snapshot.h"
 
 class Constraint2DSW {
 	Body2DSW **_body_ptr;
@@ -41,6 +42,9 @@ class Constraint2DSW {
 
 	RID self;
 
+	// Sorts constraints in deterministic mode, built from the stable IDs of the objects involved.
+	uint64_t order_key[PhysicsStateSnapshot::PAIR_KEY_SIZE] = {};
+
 protected:
 	Constraint2DSW(Body2DSW **p_body_ptr = nullptr, int p_body_count = 0) {
 		_body_ptr = p_body_ptr;
@@ -53,6 +57,18 @@ public:
 	_FORCE_INLINE_ void set_self(const RID &p_self) { self = p_self; }
 	_FORCE_INLINE_ RID get_self() const { return self; }
 
+	_FORCE_INLINE_ void set_order_key(uint64_t p_first, uint64_t p_second, uint64_t p_third) {
+		order_key[0] = p_first;
+		order_key[1] = p_second;
+		order_key[2] = p_third;
+	}
+	_FORCE_INLINE_ const uint64_t *get_order_key() const { return order_key; }
+	_FORCE_INLINE_ bool is_ordered_before(const Constraint2DSW *p_other) const { return PhysicsStateSnapshot::compare_pair_keys(order_key, p_other->order_key) < 0; }
+
+	struct OrderComparator {
+		_FORCE_INLINE_ bool operator()(const Constraint2DSW *p_a, const Constraint2DSW *p_b) const { return p_a->is_ordered_before(p_b); }
+	};
+
 	_FORCE_INLINE_ uint64_t get_island_step() const { return island_step; }
 	_FORCE_INLINE_ void set_island_step(uint64_t p_step) { island_step = p_step; }
 
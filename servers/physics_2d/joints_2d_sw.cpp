@@ -57,6 +57,8 @@
 
 void Joint2DSW::copy_settings_from(Joint2DSW *p_joint) {
 	set_self(p_joint->get_self());
+	const uint64_t *order_key = p_joint->get_order_key();
+	set_order_key(order_key[0], order_key[1], order_key[2]);
 	set_max_force(p_joint->get_max_force());
 	set_bias(p_joint->get_bias());
 	set_max_bias(p_joint->get_max_bias());
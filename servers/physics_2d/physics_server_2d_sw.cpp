@@ -274,6 +274,18 @@ int PhysicsServer2DSW::space_get_contact_count(RID p_space) const {
 	return space->get_debug_contact_count();
 }
 
+PackedByteArray PhysicsServer2DSW::space_save_state(RID p_space) const {
+	const Space2DSW *space = space_owner.getornull(p_space);
+	ERR_FAIL_COND_V(!space, PackedByteArray());
+	return space->save_state();
+}
+
+Error PhysicsServer2DSW::space_restore_state(RID p_space, const PackedByteArray &p_state) {
+	Space2DSW *space = space_owner.getornull(p_space);
+	ERR_FAIL_COND_V(!space, ERR_INVALID_PARAMETER);
+	return space->restore_state(p_state);
+}
+
 PhysicsDirectSpaceState2D *PhysicsServer2DSW::space_get_direct_state(RID p_space) {
 	Space2DSW *space = space_owner.getornull(p_space);
 	ERR_FAIL_COND_V(!space, nullptr);
@@ -286,6 +298,7 @@ RID PhysicsServer2DSW::area_create() {
 	Area2DSW *area = memnew(Area2DSW);
 	RID rid = area_owner.make_rid(area);
 	area->set_self(rid);
+	area->set_stable_id(++last_stable_id);
 	return rid;
 };
 
@@ -531,6 +544,7 @@ RID PhysicsServer2DSW::body_create() {
 	Body2DSW *body = memnew(Body2DSW);
 	RID rid = body_owner.make_rid(body);
 	body->set_self(rid);
+	body->set_stable_id(++last_stable_id);
 	return rid;
 }
 
@@ -988,6 +1002,7 @@ RID PhysicsServer2DSW::joint_create() {
 	Joint2DSW *joint = memnew(Joint2DSW);
 	RID joint_rid = joint_owner.make_rid(joint);
 	joint->set_self(joint_rid);
+	joint->set_order_key(++last_stable_id, 0, 0);
 	return joint_rid;
 }
 
@@ -1367,4 +1382,5 @@ PhysicsServer2DSW::PhysicsServer2DSW(bool p_using_threads) {
 	collision_pairs = 0;
 	using_threads = p_using_threads;
 	flushing_queries = false;
+	last_stable_id = 0;
 };
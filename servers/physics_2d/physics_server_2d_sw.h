@@ -56,6 +56,9 @@ class PhysicsServer2DSW : public PhysicsServer2D {
 
 	bool flushing_queries;
 
+	// Source of the stable IDs used to order objects and joints in deterministic mode.
+	uint64_t last_stable_id;
+
 	Step2DSW *stepper;
 	Set<const Space2DSW *> active_spaces;
 
@@ -120,6 +123,9 @@ public:
 	virtual Vector<Vector2> space_get_contacts(RID p_space) const override;
 	virtual int space_get_contact_count(RID p_space) const override;
 
+	virtual PackedByteArray space_save_state(RID p_space) const override;
+	virtual Error space_restore_state(RID p_space, const PackedByteArray &p_state) override;
+
 	// this function only works on physics process, errors and returns null otherwise
 	virtual PhysicsDirectSpaceState2D *space_get_direct_state(RID p_space) override;
 
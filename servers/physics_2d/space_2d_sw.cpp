@@ -34,6 +34,7 @@
 #include "core/os/os.h"
 #include "core/templates/pair.h"
 #include "physics_server_2d_sw.h"
+#include "servers/physics_state_snapshot.h"
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObject2DSW *p_object, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 	if (!(p_object->get_collision_layer() & p_collision_mask)) {
 		return false;
@@ -1216,6 +1217,11 @@ void *Space2DSW::_broadphase_pair(CollisionObject2DSW *A, int p_subindex_A, Coll
 		}
 
 	} else {
+		if (self->deterministic && A->get_stable_id() > B->get_stable_id()) {
+			// The order the broadphase reports the pair in is not stable.
+			SWAP(A, B);
+			SWAP(p_subindex_A, p_subindex_B);
+		}
 		BodyPair2DSW *b = memnew(BodyPair2DSW((Body2DSW *)A, p_subindex_A, (Body2DSW *)B, p_subindex_B));
 		return b;
 	}
@@ -1238,6 +1244,10 @@ const SelfList<Body2DSW>::List &Space2DSW::get_active_body_list() const {
 	return active_list;
 }
 
+void Space2DSW::body_pair_add_to_list(SelfList<BodyPair2DSW> *p_pair) {
+	body_pair_list.add(p_pair);
+}
+
 void Space2DSW::body_add_to_active_list(SelfList<Body2DSW> *p_body) {
 	active_list.add(p_body);
 }
@@ -1323,6 +1333,104 @@ void Space2DSW::setup() {
 	}
 }
 
+#define SPACE_STATE_MAGIC 0x53443253 // "S2DS"
+
+typedef PhysicsStateSnapshot::Writer<Body2DSW, BodyPair2DSW> SpaceStateWriter2DSW;
+typedef PhysicsStateSnapshot::Reader<Body2DSW, BodyPair2DSW> SpaceStateReader2DSW;
+
+PackedByteArray Space2DSW::save_state() const {
+	ERR_FAIL_COND_V(locked, PackedByteArray());
+
+	LocalVector<Body2DSW *> bodies;
+	for (Set<CollisionObject2DSW *>::Element *E = objects.front(); E; E = E->next()) {
+		if (E->get()->get_type() == CollisionObject2DSW::TYPE_BODY) {
+			bodies.push_back(static_cast<Body2DSW *>(E->get()));
+		}
+	}
+	bodies.sort_custom<CollisionObject2DSW::StableIDComparator>();
+
+	LocalVector<BodyPair2DSW *> pairs;
+	for (const SelfList<BodyPair2DSW> *E = body_pair_list.first(); E; E = E->next()) {
+		if (E->self()->has_state()) {
+			pairs.push_back(E->self());
+		}
+	}
+	pairs.sort_custom<Constraint2DSW::OrderComparator>();
+
+	SpaceStateWriter2DSW writer(SPACE_STATE_MAGIC, bodies.size(), pairs.size());
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		writer.write_body(bodies[i]->get_stable_id(), bodies[i]);
+	}
+	for (uint32_t i = 0; i < pairs.size(); i++) {
+		writer.write_pair(pairs[i]->get_order_key(), pairs[i]);
+	}
+
+	return writer.get_data();
+}
+
+Error Space2DSW::restore_state(const PackedByteArray &p_state) {
+	ERR_FAIL_COND_V(locked, ERR_BUSY);
+
+	SpaceStateReader2DSW reader;
+	Error err = reader.open(p_state, SPACE_STATE_MAGIC);
+	if (err != OK) {
+		return err;
+	}
+
+	LocalVector<Body2DSW *> bodies;
+	for (Set<CollisionObject2DSW *>::Element *E = objects.front(); E; E = E->next()) {
+		if (E->get()->get_type() == CollisionObject2DSW::TYPE_BODY) {
+			bodies.push_back(static_cast<Body2DSW *>(E->get()));
+		}
+	}
+	bodies.sort_custom<CollisionObject2DSW::StableIDComparator>();
+
+	// Both lists are sorted by stable ID, so they can be matched in a single pass.
+	// Bodies created after the snapshot was taken are left untouched.
+	uint32_t body_index = 0;
+	for (uint32_t i = 0; i < reader.get_body_count(); i++) {
+		PhysicsStateSnapshot::BodyEntry<Body2DSW> entry;
+		reader.read_body(entry);
+
+		while (body_index < bodies.size() && bodies[body_index]->get_stable_id() < entry.id) {
+			body_index++;
+		}
+		if (body_index < bodies.size() && bodies[body_index]->get_stable_id() == entry.id) {
+			bodies[body_index]->restore_state(entry.state);
+		}
+	}
+
+	// Create and remove the pairs for the restored transforms before matching them.
+	broadphase->update();
+
+	LocalVector<BodyPair2DSW *> pairs;
+	for (const SelfList<BodyPair2DSW> *E = body_pair_list.first(); E; E = E->next()) {
+		pairs.push_back(E->self());
+	}
+	pairs.sort_custom<Constraint2DSW::OrderComparator>();
+
+	// Pairs the broadphase found but that didn't touch when the snapshot was taken start over.
+	uint32_t pair_index = 0;
+	for (uint32_t i = 0; i < reader.get_pair_count(); i++) {
+		PhysicsStateSnapshot::PairEntry<BodyPair2DSW> entry;
+		reader.read_pair(entry);
+
+		while (pair_index < pairs.size() && PhysicsStateSnapshot::compare_pair_keys(pairs[pair_index]->get_order_key(), entry.key) < 0) {
+			pairs[pair_index]->clear_state();
+			pair_index++;
+		}
+		if (pair_index < pairs.size() && PhysicsStateSnapshot::compare_pair_keys(pairs[pair_index]->get_order_key(), entry.key) == 0) {
+			pairs[pair_index]->restore_state(entry.state);
+			pair_index++;
+		}
+	}
+	for (; pair_index < pairs.size(); pair_index++) {
+		pairs[pair_index]->clear_state();
+	}
+
+	return OK;
+}
+
 void Space2DSW::update() {
 	broadphase->update();
 }
@@ -1413,9 +1521,15 @@ Space2DSW::Space2DSW() {
 	body_time_to_sleep = GLOBAL_DEF("physics/2d/time_before_sleep", 0.5);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/time_before_sleep", PropertyInfo(Variant::FLOAT, "physics/2d/time_before_sleep", PROPERTY_HINT_RANGE, "0,5,0.01,or_greater"));
 
+	deterministic = GLOBAL_DEF("physics/2d/deterministic", false);
+
 	broadphase = BroadPhase2DSW::create_func();
 	broadphase->set_pair_callback(_broadphase_pair, this);
 	broadphase->set_unpair_callback(_broadphase_unpair, this);
+	if (deterministic) {
+		// Pairs then only depend on the current bounds, not on how the objects moved to get there.
+		broadphase->set_pairing_expansion(0.0);
+	}
 	area = nullptr;
 
 	direct_access = memnew(PhysicsDirectSpaceState2DSW);
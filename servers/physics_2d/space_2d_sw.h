@@ -90,6 +90,7 @@ private:
 	SelfList<Body2DSW>::List state_query_list;
 	SelfList<Area2DSW>::List monitor_query_list;
 	SelfList<Area2DSW>::List area_moved_list;
+	SelfList<BodyPair2DSW>::List body_pair_list;
 
 	static void *_broadphase_pair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_self);
 	static void _broadphase_unpair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_data, void *p_self);
@@ -116,6 +117,7 @@ private:
 	real_t body_time_to_sleep;
 
 	bool locked;
+	bool deterministic;
 
 	int island_count;
 	int active_objects;
@@ -150,6 +152,8 @@ public:
 	void area_add_to_monitor_query_list(SelfList<Area2DSW> *p_area);
 	void area_remove_from_monitor_query_list(SelfList<Area2DSW> *p_area);
 
+	void body_pair_add_to_list(SelfList<BodyPair2DSW> *p_pair);
+
 	BroadPhase2DSW *get_broadphase();
 
 	void add_object(CollisionObject2DSW *p_object);
@@ -172,6 +176,11 @@ public:
 	void lock();
 	void unlock();
 
+	_FORCE_INLINE_ bool is_deterministic() const { return deterministic; }
+
+	PackedByteArray save_state() const;
+	Error restore_state(const PackedByteArray &p_state);
+
 	void set_param(PhysicsServer2D::SpaceParameter p_param, real_t p_value);
 	real_t get_param(PhysicsServer2D::SpaceParameter p_param) const;
 
@@ -212,6 +212,12 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 			_populate_island(body, body_island, constraint_island);
 
+			if (p_space->is_deterministic()) {
+				// The traversal above follows the activation and pairing order, which depends on history.
+				body_island.sort_custom<CollisionObject2DSW::StableIDComparator>();
+				constraint_island.sort_custom<Constraint2DSW::OrderComparator>();
+			}
+
 			if (body_island.is_empty()) {
 				--body_island_count;
 			}
@@ -144,6 +144,38 @@ void Body3DSW::update_inertias() {
 	_update_transform_dependant();
 }
 
+void Body3DSW::save_state(State &r_state) const {
+	r_state.transform = get_transform();
+	r_state.inv_transform = get_inv_transform();
+	r_state.new_transform = new_transform;
+	r_state.linear_velocity = linear_velocity;
+	r_state.angular_velocity = angular_velocity;
+	r_state.biased_linear_velocity = biased_linear_velocity;
+	r_state.biased_angular_velocity = biased_angular_velocity;
+	r_state.applied_force = applied_force;
+	r_state.applied_torque = applied_torque;
+	r_state.still_time = still_time;
+	r_state.active = active;
+}
+
+void Body3DSW::restore_state(const State &p_state) {
+	if (get_transform() != p_state.transform) {
+		_set_transform(p_state.transform);
+	}
+	_set_inv_transform(p_state.inv_transform);
+	_update_transform_dependant();
+	broadphase_motion_pending = false;
+	new_transform = p_state.new_transform;
+	linear_velocity = p_state.linear_velocity;
+	angular_velocity = p_state.angular_velocity;
+	biased_linear_velocity = p_state.biased_linear_velocity;
+	biased_angular_velocity = p_state.biased_angular_velocity;
+	applied_force = p_state.applied_force;
+	applied_torque = p_state.applied_torque;
+	still_time = p_state.still_time;
+	set_active(p_state.active);
+}
+
 void Body3DSW::set_active(bool p_active) {
 	if (active == p_active) {
 		return;
@@ -530,23 +562,26 @@ void Body3DSW::integrate_forces(real_t p_step) {
 	biased_angular_velocity = Vector3();
 	biased_linear_velocity = Vector3();
 
-	if (do_motion) { //shapes temporarily extend for raycast
-		_update_shapes_with_motion(motion);
-	}
+	//shapes temporarily extend for raycast
+	broadphase_motion_pending = do_motion;
+	broadphase_motion = motion;
 
 	def_area = nullptr; // clear the area, so it is set in the next frame
 	contact_count = 0;
 }
 
+void Body3DSW::integrate_forces_sync() {
+	if (broadphase_motion_pending) {
+		_update_shapes_with_motion(broadphase_motion);
+		broadphase_motion_pending = false;
+	}
+}
+
 void Body3DSW::integrate_velocities(real_t p_step) {
 	if (mode == PhysicsServer3D::BODY_MODE_STATIC) {
 		return;
 	}
 
-	if (fi_callback) {
-		get_space()->body_add_to_state_query_list(&direct_state_query_list);
-	}
-
 	//apply axis lock linear
 	for (int i = 0; i < 3; i++) {
 		if (is_axis_locked((PhysicsServer3D::BodyAxis)(1 << i))) {
@@ -566,10 +601,6 @@ void Body3DSW::integrate_velocities(real_t p_step) {
 	if (mode == PhysicsServer3D::BODY_MODE_KINEMATIC) {
 		_set_transform(new_transform, false);
 		_set_inv_transform(new_transform.affine_inverse());
-		if (contacts.size() == 0 && linear_velocity == Vector3() && angular_velocity == Vector3()) {
-			set_active(false); //stopped moving, deactivate
-		}
-
 		return;
 	}
 
@@ -596,15 +627,34 @@ void Body3DSW::integrate_velocities(real_t p_step) {
 
 	transform.origin += total_linear_velocity * p_step;
 
-	_set_transform(transform);
+	if (ccd_deferred_velocity != Vector3()) {
+		linear_velocity += ccd_deferred_velocity;
+		ccd_deferred_velocity = Vector3();
+	}
+
+	_set_transform(transform, false);
 	_set_inv_transform(get_transform().inverse());
 
 	_update_transform_dependant();
+}
+
+void Body3DSW::integrate_velocities_sync() {
+	if (mode == PhysicsServer3D::BODY_MODE_STATIC) {
+		return;
+	}
 
-	/*
 	if (fi_callback) {
 		get_space()->body_add_to_state_query_list(&direct_state_query_list);
-	*/
+	}
+
+	if (mode == PhysicsServer3D::BODY_MODE_KINEMATIC) {
+		if (contacts.size() == 0 && linear_velocity == Vector3() && angular_velocity == Vector3()) {
+			set_active(false); //stopped moving, deactivate
+		}
+		return;
+	}
+
+	_set_transform(get_transform()); // Update the shapes in the broadphase.
 }
 
 /*
@@ -90,6 +90,11 @@ class Body3DSW : public CollisionObject3DSW {
 	bool continuous_cd;
 	bool can_sleep;
 	bool first_time_kinematic;
+	bool broadphase_motion_pending = false;
+
+	// Velocity removed by CCD to stop at an impact, given back once the step is integrated.
+	Vector3 ccd_deferred_velocity;
+	Vector3 broadphase_motion;
 	void _update_inertia();
 	virtual void _shapes_changed();
 	Transform3D new_transform;
@@ -141,6 +146,24 @@ class Body3DSW : public CollisionObject3DSW {
 	friend class PhysicsDirectBodyState3DSW; // i give up, too many functions to expose
 
 public:
+	// Simulation state saved in space snapshots, anything not here is considered a setting.
+	struct State {
+		Transform3D transform;
+		Transform3D inv_transform;
+		Transform3D new_transform;
+		Vector3 linear_velocity;
+		Vector3 angular_velocity;
+		Vector3 biased_linear_velocity;
+		Vector3 biased_angular_velocity;
+		Vector3 applied_force;
+		Vector3 applied_torque;
+		real_t still_time;
+		bool active;
+	};
+
+	void save_state(State &r_state) const;
+	void restore_state(const State &p_state);
+
 	void set_force_integration_callback(const Callable &p_callable, const Variant &p_udata = Variant());
 
 	_FORCE_INLINE_ void add_area(Area3DSW *p_area) {
@@ -272,6 +295,14 @@ public:
 	_FORCE_INLINE_ void set_continuous_collision_detection(bool p_enable) { continuous_cd = p_enable; }
 	_FORCE_INLINE_ bool is_continuous_collision_detection_enabled() const { return continuous_cd; }
 
+	_FORCE_INLINE_ void clamp_ccd_velocity(const Vector3 &p_velocity) {
+		// Other pairs may have shortened it already, keep the slowest.
+		if (p_velocity.length_squared() < linear_velocity.length_squared()) {
+			ccd_deferred_velocity += linear_velocity - p_velocity;
+			linear_velocity = p_velocity;
+		}
+	}
+
 	void set_space(Space3DSW *p_space);
 
 	void update_inertias();
@@ -286,8 +317,12 @@ public:
 	void set_axis_lock(PhysicsServer3D::BodyAxis p_axis, bool lock);
 	bool is_axis_locked(PhysicsServer3D::BodyAxis p_axis) const;
 
+	// Integration only touches the body itself and can run on any thread,
+	// the space and broadphase are updated by the _sync() calls afterwards.
 	void integrate_forces(real_t p_step);
+	void integrate_forces_sync();
 	void integrate_velocities(real_t p_step);
+	void integrate_velocities_sync();
 
 	_FORCE_INLINE_ Vector3 get_velocity_in_local_point(const Vector3 &rel_pos) const {
 		return linear_velocity + angular_velocity.cross(rel_pos - center_of_mass);
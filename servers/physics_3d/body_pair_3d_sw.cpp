@@ -48,6 +48,7 @@
 #define RELAXATION_TIMESTEPS 3
 #define MIN_VELOCITY 0.0001
 #define MAX_BIAS_ROTATION (Math_PI / 8)
+#define MIN_RECYCLE_NORMAL_DOT 0.95
 
 void BodyPair3DSW::_contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B, void *p_userdata) {
 	BodyPair3DSW *pair = (BodyPair3DSW *)p_userdata;
@@ -79,20 +80,45 @@ void BodyPair3DSW::contact_added_callback(const Vector3 &p_point_A, int p_index_
 	contact.local_B = local_B;
 	contact.normal = (p_point_A - p_point_B).normalized();
 	contact.mass_normal = 0; // will be computed in setup()
+	contact.speculative_velocity = 0;
 
-	// attempt to determine if the contact will be reused
+	// attempt to determine if the contact will be reused, use the closest one, preferring the same features.
+	// Features can change when corners lie on edges of the other shape, as in aligned stacks, so the closest
+	// contact on other features is still reused.
 	real_t contact_recycle_radius = space->get_contact_recycle_radius();
+	real_t recycle_radius_sq = contact_recycle_radius * contact_recycle_radius;
+	real_t min_distance_sq = 1e10;
+	bool same_features = false;
 
 	for (int i = 0; i < contact_count; i++) {
 		Contact &c = contacts[i];
-		if (c.local_A.distance_squared_to(local_A) < (contact_recycle_radius * contact_recycle_radius) &&
-				c.local_B.distance_squared_to(local_B) < (contact_recycle_radius * contact_recycle_radius)) {
+		bool features_match = c.index_A == p_index_A && c.index_B == p_index_B;
+		if (same_features && !features_match) {
+			continue;
+		}
+
+		real_t distance_sq_A = c.local_A.distance_squared_to(local_A);
+		real_t distance_sq_B = c.local_B.distance_squared_to(local_B);
+		if (distance_sq_A >= recycle_radius_sq || distance_sq_B >= recycle_radius_sq) {
+			continue;
+		}
+
+		if ((features_match && !same_features) || (distance_sq_A + distance_sq_B) < min_distance_sq) {
+			min_distance_sq = distance_sq_A + distance_sq_B;
+			same_features = features_match;
+			new_index = i;
+		}
+	}
+
+	if (new_index < contact_count) {
+		// Warm start with the impulses of the previous step, unless the normal changed too much for them to make sense.
+		const Contact &c = contacts[new_index];
+		if (c.normal.dot(contact.normal) > MIN_RECYCLE_NORMAL_DOT) {
 			contact.acc_normal_impulse = c.acc_normal_impulse;
 			contact.acc_bias_impulse = c.acc_bias_impulse;
 			contact.acc_bias_impulse_center_of_mass = c.acc_bias_impulse_center_of_mass;
-			contact.acc_tangent_impulse = c.acc_tangent_impulse;
-			new_index = i;
-			break;
+			// Friction must stay in the contact plane.
+			contact.acc_tangent_impulse = c.acc_tangent_impulse - contact.normal * contact.normal.dot(c.acc_tangent_impulse);
 		}
 	}
 
@@ -161,8 +187,9 @@ void BodyPair3DSW::validate_contacts() {
 	}
 }
 
-bool BodyPair3DSW::_test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const Transform3D &p_xform_A, Body3DSW *p_B, int p_shape_B, const Transform3D &p_xform_B) {
-	Vector3 motion = p_A->get_linear_velocity() * p_step;
+bool BodyPair3DSW::_test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const Transform3D &p_xform_A, Body3DSW *p_B, int p_shape_B, const Transform3D &p_xform_B, Vector3 &r_linear_velocity) {
+	// Motion relative to B, so fast bodies moving towards each other are caught too.
+	Vector3 motion = (p_A->get_linear_velocity() - p_B->get_linear_velocity()) * p_step;
 	real_t mlen = motion.length();
 	if (mlen < CMP_EPSILON) {
 		return false;
@@ -174,35 +201,38 @@ bool BodyPair3DSW::_test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const
 	p_A->get_shape(p_shape_A)->project_range(mnormal, p_xform_A, min, max);
 	bool fast_object = mlen > (max - min) * 0.3; //going too fast in that direction
 
-	if (!fast_object) { //did it move enough in this direction to even attempt raycast? let's say it should move more than 1/3 the size of the object in that axis
+	if (!fast_object) { //did it move enough in this direction to even attempt a shape cast? let's say it should move more than 1/3 the size of the object in that axis
 		return false;
 	}
 
-	//cast a segment from support in motion normal, in the same direction of motion by motion length
-	//support is the worst case collision point, so real collision happened before
-	Vector3 s = p_A->get_shape(p_shape_A)->get_support(p_xform_A.basis.xform(mnormal).normalized());
-	Vector3 from = p_xform_A.xform(s);
-	Vector3 to = from + motion;
-
-	Transform3D from_inv = p_xform_B.affine_inverse();
-
-	Vector3 local_from = from_inv.xform(from - mnormal * mlen * 0.1); //start from a little inside the bounding box
-	Vector3 local_to = from_inv.xform(to);
+	// Sweep the shape along the motion to find the time of impact.
+	real_t toi;
+	Vector3 normal;
+	if (!CollisionSolver3DSW::solve_toi(p_A->get_shape(p_shape_A), p_xform_A, motion, p_B->get_shape(p_shape_B), p_xform_B, (max - min) * 0.01, toi, normal)) {
+		return false;
+	}
 
-	Vector3 rpos, rnorm;
-	if (!p_B->get_shape(p_shape_B)->intersect_segment(local_from, local_to, rpos, rnorm)) {
+	real_t approach = -motion.dot(normal);
+	if (approach <= CMP_EPSILON) {
 		return false;
 	}
 
-	//shorten the linear velocity so it does not hit, but gets close enough, next frame will hit softly or soft enough
-	Vector3 hitpos = p_xform_B.xform(rpos);
+	// Stop the step slightly past the impact, so contacts are generated next step.
+	// The body keeps the rest of its velocity for the solver to resolve the impact then.
+	toi += space->get_contact_max_allowed_penetration() / approach;
+	if (toi >= 1.0) {
+		return false;
+	}
 
-	real_t newlen = hitpos.distance_to(from) - (max - min) * 0.01;
-	p_A->set_linear_velocity((mnormal * newlen) / p_step);
+	r_linear_velocity = p_A->get_linear_velocity() - motion * ((1.0 - toi) / p_step);
 
 	return true;
 }
 
+void BodyPair3DSW::_apply_ccd(Body3DSW *p_body, const Vector3 &p_linear_velocity) {
+	p_body->clamp_ccd_velocity(p_linear_velocity);
+}
+
 real_t combine_bounce(Body3DSW *A, Body3DSW *B) {
 	return CLAMP(A->get_bounce() + B->get_bounce(), 0, 1);
 }
@@ -212,6 +242,9 @@ real_t combine_friction(Body3DSW *A, Body3DSW *B) {
 }
 
 bool BodyPair3DSW::setup(real_t p_step) {
+	ccd_A = false;
+	ccd_B = false;
+
 	if (!A->interacts_with(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self())) {
 		collided = false;
 		return false;
@@ -248,24 +281,43 @@ bool BodyPair3DSW::setup(real_t p_step) {
 	collided = CollisionSolver3DSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
 
 	if (!collided) {
-		//test ccd (currently just a raycast)
+		//test ccd (shape cast along the relative motion)
 
 		if (A->is_continuous_collision_detection_enabled() && collide_A) {
-			_test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B);
+			ccd_A = _test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B, ccd_linear_velocity_A);
 		}
 
 		if (B->is_continuous_collision_detection_enabled() && collide_B) {
-			_test_ccd(p_step, B, shape_B, xform_B, A, shape_A, xform_A);
+			ccd_B = _test_ccd(p_step, B, shape_B, xform_B, A, shape_A, xform_A, ccd_linear_velocity_B);
 		}
 
-		return false;
+		if (ccd_A && ccd_B) {
+			// Both were slowed down for the same impact, each one takes half of it.
+			ccd_linear_velocity_A = (A->get_linear_velocity() + ccd_linear_velocity_A) * 0.5;
+			ccd_linear_velocity_B = (B->get_linear_velocity() + ccd_linear_velocity_B) * 0.5;
+		}
+
+		// Contacts that were just separated are kept while close enough, as speculative ones.
+		// The shapes don't touch though, so collided stays false.
+		return _keeps_speculative_contacts();
 	}
 
 	return true;
 }
 
+bool BodyPair3DSW::_keeps_speculative_contacts() const {
+	return contact_count > 0 && !report_contacts_only && space->is_using_speculative_contacts();
+}
+
 bool BodyPair3DSW::pre_solve(real_t p_step) {
-	if (!collided) {
+	if (ccd_A) {
+		_apply_ccd(A, ccd_linear_velocity_A);
+	}
+	if (ccd_B) {
+		_apply_ccd(B, ccd_linear_velocity_B);
+	}
+
+	if (!collided && !_keeps_speculative_contacts()) {
 		return false;
 	}
 
@@ -302,6 +354,8 @@ bool BodyPair3DSW::pre_solve(real_t p_step) {
 	real_t inv_mass_A = collide_A ? A->get_inv_mass() : 0.0;
 	real_t inv_mass_B = collide_B ? B->get_inv_mass() : 0.0;
 
+	bool use_speculative_contacts = space->is_using_speculative_contacts();
+
 	for (int i = 0; i < contact_count; i++) {
 		Contact &c = contacts[i];
 		c.active = false;
@@ -312,36 +366,40 @@ bool BodyPair3DSW::pre_solve(real_t p_step) {
 		Vector3 axis = global_A - global_B;
 		real_t depth = axis.dot(c.normal);
 
-		if (depth <= 0.0) {
+		// Without a collision this step, every contact left is a speculative one.
+		bool speculative = !collided || depth <= 0.0;
+		if (speculative && (!use_speculative_contacts || report_contacts_only)) {
 			continue;
 		}
 
-#ifdef DEBUG_ENABLED
-		if (space->is_debugging_contacts()) {
-			const Vector3 &offset_A = A->get_transform().get_origin();
-			space->add_debug_contact(global_A + offset_A);
-			space->add_debug_contact(global_B + offset_A);
-		}
-#endif
-
 		c.rA = global_A - A->get_center_of_mass();
 		c.rB = global_B - B->get_center_of_mass() - offset_B;
 
-		// contact query reporting...
+		if (!speculative) {
+#ifdef DEBUG_ENABLED
+			if (space->is_debugging_contacts()) {
+				const Vector3 &offset_A = A->get_transform().get_origin();
+				space->add_debug_contact(global_A + offset_A);
+				space->add_debug_contact(global_B + offset_A);
+			}
+#endif
 
-		if (A->can_report_contacts()) {
-			Vector3 crA = A->get_angular_velocity().cross(c.rA) + A->get_linear_velocity();
-			A->add_contact(global_A, -c.normal, depth, shape_A, global_B, shape_B, B->get_instance_id(), B->get_self(), crA);
-		}
+			// contact query reporting...
 
-		if (B->can_report_contacts()) {
-			Vector3 crB = B->get_angular_velocity().cross(c.rB) + B->get_linear_velocity();
-			B->add_contact(global_B, c.normal, depth, shape_B, global_A, shape_A, A->get_instance_id(), A->get_self(), crB);
-		}
+			if (A->can_report_contacts()) {
+				Vector3 crA = A->get_angular_velocity().cross(c.rA) + A->get_linear_velocity();
+				A->add_contact(global_A, -c.normal, depth, shape_A, global_B, shape_B, B->get_instance_id(), B->get_self(), crA);
+			}
 
-		if (report_contacts_only) {
-			collided = false;
-			continue;
+			if (B->can_report_contacts()) {
+				Vector3 crB = B->get_angular_velocity().cross(c.rB) + B->get_linear_velocity();
+				B->add_contact(global_B, c.normal, depth, shape_B, global_A, shape_A, A->get_instance_id(), A->get_self(), crB);
+			}
+
+			if (report_contacts_only) {
+				collided = false;
+				continue;
+			}
 		}
 
 		c.active = true;
@@ -353,9 +411,22 @@ bool BodyPair3DSW::pre_solve(real_t p_step) {
 		real_t kNormal = inv_mass_A + inv_mass_B;
 		kNormal += c.normal.dot(inertia_A.cross(c.rA)) + c.normal.dot(inertia_B.cross(c.rB));
 		c.mass_normal = 1.0f / kNormal;
+		c.depth = depth;
+
+		if (speculative) {
+			// The bodies are not touching here yet, only keep them from closing the gap within this step.
+			c.speculative_velocity = -depth * inv_dt;
+			c.bias = 0;
+			c.bounce = 0;
+			c.acc_normal_impulse = 0;
+			c.acc_tangent_impulse = Vector3();
+			c.acc_bias_impulse = 0;
+			c.acc_bias_impulse_center_of_mass = 0;
+			continue;
+		}
 
+		c.speculative_velocity = 0;
 		c.bias = -bias * inv_dt * MIN(0.0f, -depth + max_penetration);
-		c.depth = depth;
 
 		Vector3 j_vec = c.normal * c.acc_normal_impulse + c.acc_tangent_impulse;
 		if (collide_A) {
@@ -381,7 +452,7 @@ bool BodyPair3DSW::pre_solve(real_t p_step) {
 }
 
 void BodyPair3DSW::solve(real_t p_step) {
-	if (!collided) {
+	if (!collided && !_keeps_speculative_contacts()) {
 		return;
 	}
 
@@ -404,7 +475,7 @@ void BodyPair3DSW::solve(real_t p_step) {
 
 		c.active = false; //try to deactivate, will activate itself if still needed
 
-		//bias impulse
+		//bias impulse, not needed for speculative contacts
 
 		Vector3 crbA = A->get_biased_angular_velocity().cross(c.rA);
 		Vector3 crbB = B->get_biased_angular_velocity().cross(c.rB);
@@ -412,7 +483,7 @@ void BodyPair3DSW::solve(real_t p_step) {
 
 		real_t vbn = dbv.dot(c.normal);
 
-		if (Math::abs(-vbn + c.bias) > MIN_VELOCITY) {
+		if (c.depth > 0.0 && Math::abs(-vbn + c.bias) > MIN_VELOCITY) {
 			real_t jbn = (-vbn + c.bias) * c.mass_normal;
 			real_t jbnOld = c.acc_bias_impulse;
 			c.acc_bias_impulse = MAX(jbnOld + jbn, 0.0f);
@@ -454,8 +525,8 @@ void BodyPair3DSW::solve(real_t p_step) {
 		Vector3 crB = B->get_angular_velocity().cross(c.rB);
 		Vector3 dv = B->get_linear_velocity() + crB - A->get_linear_velocity() - crA;
 
-		//normal impulse
-		real_t vn = dv.dot(c.normal);
+		//normal impulse, speculative contacts may still approach by their separation
+		real_t vn = dv.dot(c.normal) + c.speculative_velocity;
 
 		if (Math::abs(vn) > MIN_VELOCITY) {
 			real_t jn = -(c.bounce + vn) * c.mass_normal;
@@ -523,13 +594,47 @@ void BodyPair3DSW::solve(real_t p_step) {
 	}
 }
 
+void BodyPair3DSW::get_key(uint64_t r_key[3]) const {
+	r_key[0] = A->get_self().get_id();
+	r_key[1] = B->get_self().get_id();
+	r_key[2] = (uint64_t(uint32_t(shape_A)) << 32) | uint32_t(shape_B);
+}
+
+void BodyPair3DSW::save_state(State &r_state) const {
+	r_state.offset_B = offset_B;
+	r_state.sep_axis = sep_axis;
+	for (int i = 0; i < contact_count; i++) {
+		r_state.contacts[i] = contacts[i];
+	}
+	r_state.contact_count = contact_count;
+	r_state.collided = collided;
+}
+
+void BodyPair3DSW::restore_state(const State &p_state) {
+	offset_B = p_state.offset_B;
+	sep_axis = p_state.sep_axis;
+	contact_count = CLAMP(p_state.contact_count, 0, (int)MAX_CONTACTS);
+	for (int i = 0; i < contact_count; i++) {
+		contacts[i] = p_state.contacts[i];
+	}
+	collided = p_state.collided;
+}
+
+void BodyPair3DSW::clear_state() {
+	sep_axis = Vector3();
+	contact_count = 0;
+	collided = false;
+}
+
 BodyPair3DSW::BodyPair3DSW(Body3DSW *p_A, int p_shape_A, Body3DSW *p_B, int p_shape_B) :
-		BodyContact3DSW(_arr, 2) {
+		BodyContact3DSW(_arr, 2),
+		pair_list(this) {
 	A = p_A;
 	B = p_B;
 	shape_A = p_shape_A;
 	shape_B = p_shape_B;
 	space = A->get_space();
+	space->body_pair_add_to_list(&pair_list);
 	A->add_constraint(this, 0);
 	B->add_constraint(this, 1);
 }
@@ -559,6 +664,7 @@ void BodySoftBodyPair3DSW::contact_added_callback(const Vector3 &p_point_A, int
 	contact.local_B = local_B;
 	contact.normal = (p_point_A - p_point_B).normalized();
 	contact.mass_normal = 0;
+	contact.speculative_velocity = 0;
 
 	// Attempt to determine if the contact will be reused.
 	real_t contact_recycle_radius = space->get_contact_recycle_radius();
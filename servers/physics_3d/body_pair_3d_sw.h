@@ -34,6 +34,7 @@
 #include "body_3d_sw.h"
 #include "constraint_3d_sw.h"
 #include "core/templates/local_vector.h"
+#include "core/templates/self_list.h"
 #include "soft_body_3d_sw.h"
 
 class BodyContact3DSW : public Constraint3DSW {
@@ -50,6 +51,7 @@ protected:
 		real_t mass_normal;
 		real_t bias;
 		real_t bounce;
+		real_t speculative_velocity; // closing velocity still allowed for separated contacts
 
 		real_t depth;
 		bool active;
@@ -93,18 +95,45 @@ class BodyPair3DSW : public BodyContact3DSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count = 0;
 
+	// setup() runs on multiple threads, velocities shortened by CCD are applied in pre_solve().
+	bool ccd_A = false;
+	bool ccd_B = false;
+	Vector3 ccd_linear_velocity_A;
+	Vector3 ccd_linear_velocity_B;
+
+	SelfList<BodyPair3DSW> pair_list;
+
 	static void _contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B, void *p_userdata);
 
 	void contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B);
 
 	void validate_contacts();
-	bool _test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const Transform3D &p_xform_A, Body3DSW *p_B, int p_shape_B, const Transform3D &p_xform_B);
+	bool _keeps_speculative_contacts() const;
+	bool _test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const Transform3D &p_xform_A, Body3DSW *p_B, int p_shape_B, const Transform3D &p_xform_B, Vector3 &r_linear_velocity);
+	void _apply_ccd(Body3DSW *p_body, const Vector3 &p_linear_velocity);
 
 public:
+	// Persistent contact data, saved in space snapshots so warm starting matches after a restore.
+	struct State {
+		Vector3 offset_B;
+		Vector3 sep_axis;
+		Contact contacts[MAX_CONTACTS];
+		int contact_count;
+		bool collided;
+	};
+
 	virtual bool setup(real_t p_step) override;
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
+	// Identifies the pair across snapshots, from the bodies and shapes involved.
+	void get_key(uint64_t r_key[3]) const;
+	// Also true when only speculative contacts are left, so they are saved in snapshots too.
+	_FORCE_INLINE_ bool has_state() const { return collided || contact_count > 0; }
+	void save_state(State &r_state) const;
+	void restore_state(const State &p_state);
+	void clear_state();
+
 	BodyPair3DSW(Body3DSW *p_A, int p_shape_A, Body3DSW *p_B, int p_shape_B);
 	~BodyPair3DSW();
 };
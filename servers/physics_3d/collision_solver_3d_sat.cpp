@@ -32,6 +32,7 @@
 #include "core/math/geometry_3d.h"
 
 #include "gjk_epa.h"
+#include "sat_kernels_3d_sw.h"
 
 #define fallback_collision_solver gjk_epa_calculate_penetration
 
@@ -64,6 +65,16 @@
  *                                                                       *
  *************************************************************************/
 
+// Contacts are reported with the features of each shape they come from: the
+// kind of feature in the high bits and its index among the supports of the
+// shape in the low bits. They stay the same while the same features touch,
+// so body pairs can match contacts between steps.
+enum {
+	FEATURE_ID_VERTEX = 1 << 16,
+	FEATURE_ID_EDGE = 2 << 16,
+	FEATURE_ID_FACE = 3 << 16,
+};
+
 struct _CollectorCallback {
 	CollisionSolver3DSW::CallbackResult callback;
 	void *userdata;
@@ -72,11 +83,11 @@ struct _CollectorCallback {
 	Vector3 normal;
 	Vector3 *prev_axis;
 
-	_FORCE_INLINE_ void call(const Vector3 &p_point_A, const Vector3 &p_point_B) {
+	_FORCE_INLINE_ void call(const Vector3 &p_point_A, int p_feature_A, const Vector3 &p_point_B, int p_feature_B) {
 		if (swap) {
-			callback(p_point_B, 0, p_point_A, 0, userdata);
+			callback(p_point_B, p_feature_B, p_point_A, p_feature_A, userdata);
 		} else {
-			callback(p_point_A, 0, p_point_B, 0, userdata);
+			callback(p_point_A, p_feature_A, p_point_B, p_feature_B, userdata);
 		}
 	}
 };
@@ -89,7 +100,7 @@ static void _generate_contacts_point_point(const Vector3 *p_points_A, int p_poin
 	ERR_FAIL_COND(p_point_count_B != 1);
 #endif
 
-	p_callback->call(*p_points_A, *p_points_B);
+	p_callback->call(*p_points_A, FEATURE_ID_VERTEX, *p_points_B, FEATURE_ID_VERTEX);
 }
 
 static void _generate_contacts_point_edge(const Vector3 *p_points_A, int p_point_count_A, const Vector3 *p_points_B, int p_point_count_B, _CollectorCallback *p_callback) {
@@ -99,7 +110,7 @@ static void _generate_contacts_point_edge(const Vector3 *p_points_A, int p_point
 #endif
 
 	Vector3 closest_B = Geometry3D::get_closest_point_to_segment_uncapped(*p_points_A, p_points_B);
-	p_callback->call(*p_points_A, closest_B);
+	p_callback->call(*p_points_A, FEATURE_ID_VERTEX, closest_B, FEATURE_ID_EDGE);
 }
 
 static void _generate_contacts_point_face(const Vector3 *p_points_A, int p_point_count_A, const Vector3 *p_points_B, int p_point_count_B, _CollectorCallback *p_callback) {
@@ -110,7 +121,7 @@ static void _generate_contacts_point_face(const Vector3 *p_points_A, int p_point
 
 	Vector3 closest_B = Plane(p_points_B[0], p_points_B[1], p_points_B[2]).project(*p_points_A);
 
-	p_callback->call(*p_points_A, closest_B);
+	p_callback->call(*p_points_A, FEATURE_ID_VERTEX, closest_B, FEATURE_ID_FACE);
 }
 
 static void _generate_contacts_point_circle(const Vector3 *p_points_A, int p_point_count_A, const Vector3 *p_points_B, int p_point_count_B, _CollectorCallback *p_callback) {
@@ -121,7 +132,7 @@ static void _generate_contacts_point_circle(const Vector3 *p_points_A, int p_poi
 
 	Vector3 closest_B = Plane(p_points_B[0], p_points_B[1], p_points_B[2]).project(*p_points_A);
 
-	p_callback->call(*p_points_A, closest_B);
+	p_callback->call(*p_points_A, FEATURE_ID_VERTEX, closest_B, FEATURE_ID_FACE);
 }
 
 static void _generate_contacts_edge_edge(const Vector3 *p_points_A, int p_point_count_A, const Vector3 *p_points_B, int p_point_count_B, _CollectorCallback *p_callback) {
@@ -144,15 +155,23 @@ static void _generate_contacts_edge_edge(const Vector3 *p_points_A, int p_point_
 		Vector3 base_A = p_points_A[0] - axis * axis.dot(p_points_A[0]);
 		Vector3 base_B = p_points_B[0] - axis * axis.dot(p_points_B[0]);
 
-		//sort all 4 points in axis
+		//sort all 4 points in axis, remembering which vertex each one is
 		real_t dvec[4] = { axis.dot(p_points_A[0]), axis.dot(p_points_A[1]), axis.dot(p_points_B[0]), axis.dot(p_points_B[1]) };
+		int vertices[4] = { 0, 1, 2, 3 };
 
-		SortArray<real_t> sa;
-		sa.sort(dvec, 4);
+		for (int i = 1; i < 4; i++) {
+			for (int j = i; j > 0 && dvec[j] < dvec[j - 1]; j--) {
+				SWAP(dvec[j], dvec[j - 1]);
+				SWAP(vertices[j], vertices[j - 1]);
+			}
+		}
 
-		//use the middle ones as contacts
-		p_callback->call(base_A + axis * dvec[1], base_B + axis * dvec[1]);
-		p_callback->call(base_A + axis * dvec[2], base_B + axis * dvec[2]);
+		//use the middle ones as contacts, on a vertex of one edge and along the other
+		for (int i = 1; i <= 2; i++) {
+			int feature_A = vertices[i] < 2 ? (FEATURE_ID_VERTEX | vertices[i]) : FEATURE_ID_EDGE;
+			int feature_B = vertices[i] < 2 ? FEATURE_ID_EDGE : (FEATURE_ID_VERTEX | (vertices[i] - 2));
+			p_callback->call(base_A + axis * dvec[i], feature_A, base_B + axis * dvec[i], feature_B);
+		}
 
 		return;
 	}
@@ -167,7 +186,7 @@ static void _generate_contacts_edge_edge(const Vector3 *p_points_A, int p_point_
 
 	Vector3 closest_A = p_points_A[0] + rel_A * d;
 	Vector3 closest_B = Geometry3D::get_closest_point_to_segment_uncapped(closest_A, p_points_B);
-	p_callback->call(closest_A, closest_B);
+	p_callback->call(closest_A, FEATURE_ID_EDGE, closest_B, FEATURE_ID_EDGE);
 }
 
 static void _generate_contacts_edge_circle(const Vector3 *p_points_A, int p_point_count_A, const Vector3 *p_points_B, int p_point_count_B, _CollectorCallback *p_callback) {
@@ -187,6 +206,8 @@ static void _generate_contacts_edge_circle(const Vector3 *p_points_A, int p_poin
 
 	static const int max_clip = 2;
 	Vector3 contact_points[max_clip];
+	int contact_features_A[max_clip];
+	int contact_features_B[max_clip];
 	int num_points = 0;
 
 	// Project edge point in circle plane.
@@ -199,6 +220,8 @@ static void _generate_contacts_edge_circle(const Vector3 *p_points_A, int p_poin
 	// Point 1 is inside disk, add as contact point.
 	if (dist_sq <= circle_B_radius * circle_B_radius) {
 		contact_points[num_points] = edge_A_1;
+		contact_features_A[num_points] = FEATURE_ID_VERTEX;
+		contact_features_B[num_points] = FEATURE_ID_FACE;
 		++num_points;
 	}
 
@@ -211,6 +234,8 @@ static void _generate_contacts_edge_circle(const Vector3 *p_points_A, int p_poin
 	// Point 2 is inside disk, add as contact point.
 	if (dist_sq_2 <= circle_B_radius * circle_B_radius) {
 		contact_points[num_points] = edge_A_2;
+		contact_features_A[num_points] = FEATURE_ID_VERTEX | 1;
+		contact_features_B[num_points] = FEATURE_ID_FACE;
 		++num_points;
 	}
 
@@ -240,6 +265,8 @@ static void _generate_contacts_edge_circle(const Vector3 *p_points_A, int p_poin
 				Vector3 face_point_1 = edge_A_1 + fraction_1 * edge_dir;
 				ERR_FAIL_COND(num_points >= max_clip);
 				contact_points[num_points] = face_point_1;
+				contact_features_A[num_points] = FEATURE_ID_EDGE;
+				contact_features_B[num_points] = FEATURE_ID_EDGE;
 				++num_points;
 			}
 
@@ -248,6 +275,8 @@ static void _generate_contacts_edge_circle(const Vector3 *p_points_A, int p_poin
 				Vector3 face_point_2 = edge_A_1 + fraction_2 * edge_dir;
 				ERR_FAIL_COND(num_points >= max_clip);
 				contact_points[num_points] = face_point_2;
+				contact_features_A[num_points] = FEATURE_ID_EDGE;
+				contact_features_B[num_points] = FEATURE_ID_EDGE | 1;
 				++num_points;
 			}
 		}
@@ -264,7 +293,7 @@ static void _generate_contacts_edge_circle(const Vector3 *p_points_A, int p_poin
 			continue;
 		}
 
-		p_callback->call(contact_point_A, closest_B);
+		p_callback->call(contact_point_A, contact_features_A[i], closest_B, contact_features_B[i]);
 	}
 }
 
@@ -276,15 +305,25 @@ static void _generate_contacts_face_face(const Vector3 *p_points_A, int p_point_
 
 	static const int max_clip = 32;
 
-	Vector3 _clipbuf1[max_clip];
-	Vector3 _clipbuf2[max_clip];
-	Vector3 *clipbuf_src = _clipbuf1;
-	Vector3 *clipbuf_dst = _clipbuf2;
+	struct ClipVertex {
+		Vector3 point;
+		int feature_A;
+		int feature_B;
+		int edge_A; // Edge of A towards the next vertex, -1 when it follows an edge of B.
+	};
+
+	ClipVertex _clipbuf1[max_clip];
+	ClipVertex _clipbuf2[max_clip];
+	ClipVertex *clipbuf_src = _clipbuf1;
+	ClipVertex *clipbuf_dst = _clipbuf2;
 	int clipbuf_len = p_point_count_A;
 
 	// copy A points to clipbuf_src
 	for (int i = 0; i < p_point_count_A; i++) {
-		clipbuf_src[i] = p_points_A[i];
+		clipbuf_src[i].point = p_points_A[i];
+		clipbuf_src[i].feature_A = FEATURE_ID_VERTEX | i;
+		clipbuf_src[i].feature_B = FEATURE_ID_FACE;
+		clipbuf_src[i].edge_A = p_point_count_A == 2 ? 0 : i;
 	}
 
 	Plane plane_B(p_points_B[0], p_points_B[1], p_points_B[2]);
@@ -306,8 +345,8 @@ static void _generate_contacts_face_face(const Vector3 *p_points_A, int p_point_
 		for (int j = 0; j < clipbuf_len; j++) {
 			int j_n = (j + 1) % clipbuf_len;
 
-			Vector3 edge0_A = clipbuf_src[j];
-			Vector3 edge1_A = clipbuf_src[j_n];
+			Vector3 edge0_A = clipbuf_src[j].point;
+			Vector3 edge1_A = clipbuf_src[j_n].point;
 
 			real_t dist0 = clip.distance_to(edge0_A);
 			real_t dist1 = clip.distance_to(edge1_A);
@@ -327,8 +366,21 @@ static void _generate_contacts_face_face(const Vector3 *p_points_A, int p_point_
 				real_t dist = -(clip.normal.dot(edge0_A) - clip.d) / den;
 				Vector3 inters = edge0_A + rel * dist;
 
+				// crossing an edge of A gives an edge-edge contact, crossing the previous
+				// edge of B a vertex of B
 				ERR_FAIL_COND(dst_idx >= max_clip);
-				clipbuf_dst[dst_idx] = inters;
+				ClipVertex &vertex = clipbuf_dst[dst_idx];
+				vertex.point = inters;
+				int edge_A = clipbuf_src[j].edge_A;
+				if (edge_A >= 0) {
+					vertex.feature_A = FEATURE_ID_EDGE | edge_A;
+					vertex.feature_B = FEATURE_ID_EDGE | i;
+				} else {
+					vertex.feature_A = FEATURE_ID_FACE;
+					vertex.feature_B = FEATURE_ID_VERTEX | i;
+				}
+				// leaving the clip plane, the next edge follows this edge of B
+				vertex.edge_A = (dist0 <= 0 && !edge) ? -1 : edge_A;
 				dst_idx++;
 			}
 		}
@@ -341,19 +393,20 @@ static void _generate_contacts_face_face(const Vector3 *p_points_A, int p_point_
 	//Plane plane_A(p_points_A[0],p_points_A[1],p_points_A[2]);
 
 	for (int i = 0; i < clipbuf_len; i++) {
-		real_t d = plane_B.distance_to(clipbuf_src[i]);
+		const ClipVertex &vertex = clipbuf_src[i];
+		real_t d = plane_B.distance_to(vertex.point);
 		/*
 		if (d>CMP_EPSILON)
 			continue;
 		*/
 
-		Vector3 closest_B = clipbuf_src[i] - plane_B.normal * d;
+		Vector3 closest_B = vertex.point - plane_B.normal * d;
 
-		if (p_callback->normal.dot(clipbuf_src[i]) >= p_callback->normal.dot(closest_B)) {
+		if (p_callback->normal.dot(vertex.point) >= p_callback->normal.dot(closest_B)) {
 			continue;
 		}
 
-		p_callback->call(clipbuf_src[i], closest_B);
+		p_callback->call(vertex.point, vertex.feature_A, closest_B, vertex.feature_B);
 	}
 }
 
@@ -389,6 +442,7 @@ static void _generate_contacts_face_circle(const Vector3 *p_points_A, int p_poin
 
 	static const int max_clip = 32;
 	Vector3 contact_points[max_clip];
+	int contact_features_A[max_clip];
 	int num_points = 0;
 
 	for (int i = 0; i < p_point_count_A; i++) {
@@ -404,6 +458,7 @@ static void _generate_contacts_face_circle(const Vector3 *p_points_A, int p_poin
 		if (dist0 * circle_plane.d >= 0) {
 			ERR_FAIL_COND(num_points >= max_clip);
 			contact_points[num_points] = edge0_A;
+			contact_features_A[num_points] = FEATURE_ID_VERTEX | i;
 			++num_points;
 		}
 
@@ -417,6 +472,7 @@ static void _generate_contacts_face_circle(const Vector3 *p_points_A, int p_poin
 
 			ERR_FAIL_COND(num_points >= max_clip);
 			contact_points[num_points] = inters;
+			contact_features_A[num_points] = FEATURE_ID_EDGE | i;
 			++num_points;
 		}
 	}
@@ -432,7 +488,8 @@ static void _generate_contacts_face_circle(const Vector3 *p_points_A, int p_poin
 			continue;
 		}
 
-		p_callback->call(contact_point_A, closest_B);
+		// Told apart from the contacts clipped by the circle segments above.
+		p_callback->call(contact_point_A, contact_features_A[i], closest_B, FEATURE_ID_FACE | 1);
 	}
 }
 
@@ -458,6 +515,8 @@ static void _generate_contacts_circle_circle(const Vector3 *p_points_A, int p_po
 
 	static const int max_clip = 4;
 	Vector3 contact_points[max_clip];
+	int contact_features_A[max_clip];
+	int contact_features_B[max_clip];
 	int num_points = 0;
 
 	Vector3 centers_diff = circle_B_pos - circle_A_pos;
@@ -478,19 +537,27 @@ static void _generate_contacts_circle_circle(const Vector3 *p_points_A, int p_po
 
 			Vector3 point_A = midpoint + h_vec;
 			contact_points[num_points] = point_A;
+			contact_features_A[num_points] = FEATURE_ID_EDGE;
+			contact_features_B[num_points] = FEATURE_ID_EDGE;
 			++num_points;
 
 			point_A = midpoint - h_vec;
 			contact_points[num_points] = point_A;
+			contact_features_A[num_points] = FEATURE_ID_EDGE | 1;
+			contact_features_B[num_points] = FEATURE_ID_EDGE | 1;
 			++num_points;
 
 			// Add 2 points from circle A and B along the line between the centers.
 			point_A = circle_A_pos + comp_proj * circle_A_radius;
 			contact_points[num_points] = point_A;
+			contact_features_A[num_points] = FEATURE_ID_EDGE | 2;
+			contact_features_B[num_points] = FEATURE_ID_FACE;
 			++num_points;
 
 			point_A = circle_B_pos - comp_proj * circle_B_radius - norm_proj;
 			contact_points[num_points] = point_A;
+			contact_features_A[num_points] = FEATURE_ID_FACE;
+			contact_features_B[num_points] = FEATURE_ID_EDGE | 2;
 			++num_points;
 		} // Otherwise one circle is inside the other one, use 3 arbitrary equidistant points.
 	} // Otherwise circles are concentric, use 3 arbitrary equidistant points.
@@ -505,6 +572,8 @@ static void _generate_contacts_circle_circle(const Vector3 *p_points_A, int p_po
 				circle_A_point += circle_A_line_2 * Math::sin(2.0 * Math_PI * i / 3.0);
 
 				contact_points[num_points] = circle_A_point;
+				contact_features_A[num_points] = FEATURE_ID_EDGE | i;
+				contact_features_B[num_points] = FEATURE_ID_FACE;
 				++num_points;
 			}
 		} else {
@@ -517,6 +586,8 @@ static void _generate_contacts_circle_circle(const Vector3 *p_points_A, int p_po
 				Vector3 circle_A_point = circle_B_point - norm_proj;
 
 				contact_points[num_points] = circle_A_point;
+				contact_features_A[num_points] = FEATURE_ID_FACE;
+				contact_features_B[num_points] = FEATURE_ID_EDGE | i;
 				++num_points;
 			}
 		}
@@ -535,7 +606,7 @@ static void _generate_contacts_circle_circle(const Vector3 *p_points_A, int p_po
 			continue;
 		}
 
-		p_callback->call(contact_point_A, closest_B);
+		p_callback->call(contact_point_A, contact_features_A[i], closest_B, contact_features_B[i]);
 	}
 }
 
@@ -604,6 +675,26 @@ static void _generate_contacts_from_supports(const Vector3 *p_points_A, int p_po
 	contacts_func(points_A, pointcount_A, points_B, pointcount_B, p_callback);
 }
 
+template <class ShapeT>
+static _FORCE_INLINE_ void _project_range_batch(const ShapeT *p_shape, const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t *r_min, real_t *r_max) {
+	for (int i = 0; i < p_count; i++) {
+		p_shape->project_range(Vector3(p_axes_x[i], p_axes_y[i], p_axes_z[i]), p_transform, r_min[i], r_max[i]);
+	}
+}
+
+static _FORCE_INLINE_ void _project_range_batch(const BoxShape3DSW *p_shape, const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t *r_min, real_t *r_max) {
+	SATKernels3DSW::project_box(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_shape->get_half_extents(), r_min, r_max);
+}
+
+static _FORCE_INLINE_ void _project_range_batch(const CapsuleShape3DSW *p_shape, const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t *r_min, real_t *r_max) {
+	SATKernels3DSW::project_capsule(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_shape->get_radius(), p_shape->get_height(), r_min, r_max);
+}
+
+static _FORCE_INLINE_ void _project_range_batch(const ConvexPolygonShape3DSW *p_shape, const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t *r_min, real_t *r_max) {
+	const Geometry3D::MeshData &mesh = p_shape->get_mesh();
+	SATKernels3DSW::project_points(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, mesh.vertices.ptr(), mesh.vertices.size(), r_min, r_max);
+}
+
 template <class ShapeA, class ShapeB, bool withMargin = false>
 class SeparatorAxisTest {
 	const ShapeA *shape_A;
@@ -617,6 +708,11 @@ class SeparatorAxisTest {
 	real_t margin_B;
 	Vector3 separator_axis;
 
+	real_t queued_axes_x[SATKernels3DSW::AXIS_BATCH];
+	real_t queued_axes_y[SATKernels3DSW::AXIS_BATCH];
+	real_t queued_axes_z[SATKernels3DSW::AXIS_BATCH];
+	int queued_count = 0;
+
 public:
 	_FORCE_INLINE_ bool test_previous_axis() {
 		if (callback && callback->prev_axis && *callback->prev_axis != Vector3()) {
@@ -639,6 +735,66 @@ public:
 		shape_A->project_range(axis, *transform_A, min_A, max_A);
 		shape_B->project_range(axis, *transform_B, min_B, max_B);
 
+		return _test_axis_range(axis, min_A, max_A, min_B, max_B, p_directional);
+	}
+
+	// Queued axes are projected in batches with the SIMD kernels, and tested in the
+	// same order as test_axis() would. Flush before testing any axis directly.
+	_FORCE_INLINE_ bool queue_axis(const Vector3 &p_axis) {
+		Vector3 axis = p_axis;
+
+		if (axis.is_equal_approx(Vector3())) {
+			// strange case, try an upwards separator
+			axis = Vector3(0.0, 1.0, 0.0);
+		}
+
+		queued_axes_x[queued_count] = axis.x;
+		queued_axes_y[queued_count] = axis.y;
+		queued_axes_z[queued_count] = axis.z;
+		queued_count++;
+
+		if (queued_count == SATKernels3DSW::AXIS_BATCH) {
+			return flush_axes();
+		}
+		return true;
+	}
+
+	bool flush_axes() {
+		if (queued_count == 0) {
+			return true;
+		}
+
+		int count = queued_count;
+		queued_count = 0;
+
+		for (int i = count; i < SATKernels3DSW::AXIS_BATCH; i++) {
+			queued_axes_x[i] = 0;
+			queued_axes_y[i] = 0;
+			queued_axes_z[i] = 0;
+		}
+
+		real_t min_A[SATKernels3DSW::AXIS_BATCH], max_A[SATKernels3DSW::AXIS_BATCH];
+		real_t min_B[SATKernels3DSW::AXIS_BATCH], max_B[SATKernels3DSW::AXIS_BATCH];
+
+		_project_range_batch(shape_A, queued_axes_x, queued_axes_y, queued_axes_z, count, *transform_A, min_A, max_A);
+		_project_range_batch(shape_B, queued_axes_x, queued_axes_y, queued_axes_z, count, *transform_B, min_B, max_B);
+
+		for (int i = 0; i < count; i++) {
+			if (!_test_axis_range(Vector3(queued_axes_x[i], queued_axes_y[i], queued_axes_z[i]), min_A[i], max_A[i], min_B[i], max_B[i], false)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	_FORCE_INLINE_ bool _test_axis_range(const Vector3 &p_axis, real_t p_min_A, real_t p_max_A, real_t p_min_B, real_t p_max_B, bool p_directional) {
+		Vector3 axis = p_axis;
+		real_t min_A = p_min_A;
+		real_t max_A = p_max_A;
+		real_t min_B = p_min_B;
+		real_t max_B = p_max_B;
+
 		if (withMargin) {
 			min_A -= margin_A;
 			max_A += margin_A;
@@ -1060,7 +1216,7 @@ static void _collision_box_box(const Shape3DSW *p_a, const Transform3D &p_transf
 	for (int i = 0; i < 3; i++) {
 		Vector3 axis = p_transform_a.basis.get_axis(i).normalized();
 
-		if (!separator.test_axis(axis)) {
+		if (!separator.queue_axis(axis)) {
 			return;
 		}
 	}
@@ -1070,7 +1226,7 @@ static void _collision_box_box(const Shape3DSW *p_a, const Transform3D &p_transf
 	for (int i = 0; i < 3; i++) {
 		Vector3 axis = p_transform_b.basis.get_axis(i).normalized();
 
-		if (!separator.test_axis(axis)) {
+		if (!separator.queue_axis(axis)) {
 			return;
 		}
 	}
@@ -1085,7 +1241,7 @@ static void _collision_box_box(const Shape3DSW *p_a, const Transform3D &p_transf
 			}
 			axis.normalize();
 
-			if (!separator.test_axis(axis)) {
+			if (!separator.queue_axis(axis)) {
 				return;
 			}
 		}
@@ -1116,7 +1272,7 @@ static void _collision_box_box(const Shape3DSW *p_a, const Transform3D &p_transf
 
 		Vector3 axis_ab = (support_a - support_b);
 
-		if (!separator.test_axis(axis_ab.normalized())) {
+		if (!separator.queue_axis(axis_ab.normalized())) {
 			return;
 		}
 
@@ -1126,19 +1282,23 @@ static void _collision_box_box(const Shape3DSW *p_a, const Transform3D &p_transf
 			//a ->b
 			Vector3 axis_a = p_transform_a.basis.get_axis(i);
 
-			if (!separator.test_axis(axis_ab.cross(axis_a).cross(axis_a).normalized())) {
+			if (!separator.queue_axis(axis_ab.cross(axis_a).cross(axis_a).normalized())) {
 				return;
 			}
 
 			//b ->a
 			Vector3 axis_b = p_transform_b.basis.get_axis(i);
 
-			if (!separator.test_axis(axis_ab.cross(axis_b).cross(axis_b).normalized())) {
+			if (!separator.queue_axis(axis_ab.cross(axis_b).cross(axis_b).normalized())) {
 				return;
 			}
 		}
 	}
 
+	if (!separator.flush_axes()) {
+		return;
+	}
+
 	separator.generate_contacts();
 }
 
@@ -1157,7 +1317,7 @@ static void _collision_box_capsule(const Shape3DSW *p_a, const Transform3D &p_tr
 	for (int i = 0; i < 3; i++) {
 		Vector3 axis = p_transform_a.basis.get_axis(i).normalized();
 
-		if (!separator.test_axis(axis)) {
+		if (!separator.queue_axis(axis)) {
 			return;
 		}
 	}
@@ -1174,7 +1334,7 @@ static void _collision_box_capsule(const Shape3DSW *p_a, const Transform3D &p_tr
 			continue;
 		}
 
-		if (!separator.test_axis(axis.normalized())) {
+		if (!separator.queue_axis(axis.normalized())) {
 			return;
 		}
 	}
@@ -1197,7 +1357,7 @@ static void _collision_box_capsule(const Shape3DSW *p_a, const Transform3D &p_tr
 				//Vector3 axis = (point - cyl_axis * cyl_axis.dot(point)).normalized();
 				Vector3 axis = Plane(cyl_axis, 0).project(point).normalized();
 
-				if (!separator.test_axis(axis)) {
+				if (!separator.queue_axis(axis)) {
 					return;
 				}
 			}
@@ -1222,7 +1382,7 @@ static void _collision_box_capsule(const Shape3DSW *p_a, const Transform3D &p_tr
 		// use point to test axis
 		Vector3 point_axis = (sphere_pos - cpoint).normalized();
 
-		if (!separator.test_axis(point_axis)) {
+		if (!separator.queue_axis(point_axis)) {
 			return;
 		}
 
@@ -1231,12 +1391,16 @@ static void _collision_box_capsule(const Shape3DSW *p_a, const Transform3D &p_tr
 		for (int j = 0; j < 3; j++) {
 			Vector3 axis = point_axis.cross(p_transform_a.basis.get_axis(j)).cross(p_transform_a.basis.get_axis(j)).normalized();
 
-			if (!separator.test_axis(axis)) {
+			if (!separator.queue_axis(axis)) {
 				return;
 			}
 		}
 	}
 
+	if (!separator.flush_axes()) {
+		return;
+	}
+
 	separator.generate_contacts();
 }
 
@@ -1617,41 +1781,45 @@ static void _collision_capsule_capsule(const Shape3DSW *p_a, const Transform3D &
 
 	//balls-balls
 
-	if (!separator.test_axis((capsule_A_ball_1 - capsule_B_ball_1).normalized())) {
+	if (!separator.queue_axis((capsule_A_ball_1 - capsule_B_ball_1).normalized())) {
 		return;
 	}
-	if (!separator.test_axis((capsule_A_ball_1 - capsule_B_ball_2).normalized())) {
+	if (!separator.queue_axis((capsule_A_ball_1 - capsule_B_ball_2).normalized())) {
 		return;
 	}
 
-	if (!separator.test_axis((capsule_A_ball_2 - capsule_B_ball_1).normalized())) {
+	if (!separator.queue_axis((capsule_A_ball_2 - capsule_B_ball_1).normalized())) {
 		return;
 	}
-	if (!separator.test_axis((capsule_A_ball_2 - capsule_B_ball_2).normalized())) {
+	if (!separator.queue_axis((capsule_A_ball_2 - capsule_B_ball_2).normalized())) {
 		return;
 	}
 
 	// edges-balls
 
-	if (!separator.test_axis((capsule_A_ball_1 - capsule_B_ball_1).cross(capsule_A_axis).cross(capsule_A_axis).normalized())) {
+	if (!separator.queue_axis((capsule_A_ball_1 - capsule_B_ball_1).cross(capsule_A_axis).cross(capsule_A_axis).normalized())) {
 		return;
 	}
 
-	if (!separator.test_axis((capsule_A_ball_1 - capsule_B_ball_2).cross(capsule_A_axis).cross(capsule_A_axis).normalized())) {
+	if (!separator.queue_axis((capsule_A_ball_1 - capsule_B_ball_2).cross(capsule_A_axis).cross(capsule_A_axis).normalized())) {
 		return;
 	}
 
-	if (!separator.test_axis((capsule_B_ball_1 - capsule_A_ball_1).cross(capsule_B_axis).cross(capsule_B_axis).normalized())) {
+	if (!separator.queue_axis((capsule_B_ball_1 - capsule_A_ball_1).cross(capsule_B_axis).cross(capsule_B_axis).normalized())) {
 		return;
 	}
 
-	if (!separator.test_axis((capsule_B_ball_1 - capsule_A_ball_2).cross(capsule_B_axis).cross(capsule_B_axis).normalized())) {
+	if (!separator.queue_axis((capsule_B_ball_1 - capsule_A_ball_2).cross(capsule_B_axis).cross(capsule_B_axis).normalized())) {
 		return;
 	}
 
 	// edges
 
-	if (!separator.test_axis(capsule_A_axis.cross(capsule_B_axis).normalized())) {
+	if (!separator.queue_axis(capsule_A_axis.cross(capsule_B_axis).normalized())) {
+		return;
+	}
+
+	if (!separator.flush_axes()) {
 		return;
 	}
 
@@ -2073,7 +2241,7 @@ static void _collision_convex_polygon_convex_polygon(const Shape3DSW *p_a, const
 	for (int i = 0; i < face_count_A; i++) {
 		Vector3 axis = a_xform_normal.xform(faces_A[i].plane.normal).normalized();
 
-		if (!separator.test_axis(axis)) {
+		if (!separator.queue_axis(axis)) {
 			return;
 		}
 	}
@@ -2085,7 +2253,7 @@ static void _collision_convex_polygon_convex_polygon(const Shape3DSW *p_a, const
 	for (int i = 0; i < face_count_B; i++) {
 		Vector3 axis = b_xform_normal.xform(faces_B[i].plane.normal).normalized();
 
-		if (!separator.test_axis(axis)) {
+		if (!separator.queue_axis(axis)) {
 			return;
 		}
 	}
@@ -2099,7 +2267,7 @@ static void _collision_convex_polygon_convex_polygon(const Shape3DSW *p_a, const
 
 			Vector3 axis = e1.cross(e2).normalized();
 
-			if (!separator.test_axis(axis)) {
+			if (!separator.queue_axis(axis)) {
 				return;
 			}
 		}
@@ -2111,7 +2279,7 @@ static void _collision_convex_polygon_convex_polygon(const Shape3DSW *p_a, const
 			Vector3 va = p_transform_a.xform(vertices_A[i]);
 
 			for (int j = 0; j < vertex_count_B; j++) {
-				if (!separator.test_axis((va - p_transform_b.xform(vertices_B[j])).normalized())) {
+				if (!separator.queue_axis((va - p_transform_b.xform(vertices_B[j])).normalized())) {
 					return;
 				}
 			}
@@ -2126,7 +2294,7 @@ static void _collision_convex_polygon_convex_polygon(const Shape3DSW *p_a, const
 			for (int j = 0; j < vertex_count_B; j++) {
 				Vector3 e3 = p_transform_b.xform(vertices_B[j]);
 
-				if (!separator.test_axis((e1 - e3).cross(n).cross(n).normalized())) {
+				if (!separator.queue_axis((e1 - e3).cross(n).cross(n).normalized())) {
 					return;
 				}
 			}
@@ -2140,13 +2308,17 @@ static void _collision_convex_polygon_convex_polygon(const Shape3DSW *p_a, const
 			for (int j = 0; j < vertex_count_A; j++) {
 				Vector3 e3 = p_transform_a.xform(vertices_A[j]);
 
-				if (!separator.test_axis((e1 - e3).cross(n).cross(n).normalized())) {
+				if (!separator.queue_axis((e1 - e3).cross(n).cross(n).normalized())) {
 					return;
 				}
 			}
 		}
 	}
 
+	if (!separator.flush_axes()) {
+		return;
+	}
+
 	separator.generate_contacts();
 }
 
@@ -548,3 +548,100 @@ bool CollisionSolver3DSW::solve_distance(const Shape3DSW *p_shape_A, const Trans
 		return gjk_epa_calculate_distance(p_shape_A, p_transform_A, p_shape_B, p_transform_B, r_point_A, r_point_B); //should pass sepaxis..
 	}
 }
+
+struct _ConcaveTOIInfo {
+	const Shape3DSW *shape_A;
+	const Transform3D *transform_A;
+	const Transform3D *transform_B;
+	Vector3 motion;
+	real_t tolerance;
+	bool hit;
+	real_t toi;
+	Vector3 normal;
+};
+
+void CollisionSolver3DSW::concave_toi_callback(void *p_userdata, Shape3DSW *p_convex) {
+	_ConcaveTOIInfo &tinfo = *(_ConcaveTOIInfo *)(p_userdata);
+
+	real_t toi;
+	Vector3 normal;
+	if (!gjk_epa_calculate_toi(tinfo.shape_A, *tinfo.transform_A, tinfo.motion, p_convex, *tinfo.transform_B, tinfo.tolerance, toi, normal)) {
+		return;
+	}
+
+	if (!tinfo.hit || toi < tinfo.toi) {
+		tinfo.toi = toi;
+		tinfo.normal = normal;
+		tinfo.hit = true;
+	}
+}
+
+bool CollisionSolver3DSW::solve_toi_plane(const Shape3DSW *p_shape_A, const Transform3D &p_transform_A, const Vector3 &p_motion, const Shape3DSW *p_shape_B, const Transform3D &p_transform_B, real_t &r_toi, Vector3 &r_normal) {
+	const PlaneShape3DSW *plane = static_cast<const PlaneShape3DSW *>(p_shape_B);
+	Plane p = p_transform_B.xform(plane->get_plane());
+
+	real_t approach = -p_motion.dot(p.normal);
+	if (approach <= CMP_EPSILON) {
+		return false;
+	}
+
+	Vector3 support = p_transform_A.xform(p_shape_A->get_support(p_transform_A.basis.xform_inv(-p.normal).normalized()));
+	real_t distance = p.distance_to(support);
+	if (distance <= 0.0) {
+		return false; // Already touching, regular contacts handle it.
+	}
+
+	real_t toi = distance / approach;
+	if (toi > 1.0) {
+		return false;
+	}
+
+	r_toi = toi;
+	r_normal = p.normal;
+	return true;
+}
+
+bool CollisionSolver3DSW::solve_toi(const Shape3DSW *p_shape_A, const Transform3D &p_transform_A, const Vector3 &p_motion, const Shape3DSW *p_shape_B, const Transform3D &p_transform_B, real_t p_tolerance, real_t &r_toi, Vector3 &r_normal) {
+	PhysicsServer3D::ShapeType type_A = p_shape_A->get_type();
+	if (p_shape_A->is_concave() || type_A == PhysicsServer3D::SHAPE_PLANE || type_A == PhysicsServer3D::SHAPE_RAY) {
+		return false;
+	}
+
+	PhysicsServer3D::ShapeType type_B = p_shape_B->get_type();
+	if (type_B == PhysicsServer3D::SHAPE_PLANE) {
+		return solve_toi_plane(p_shape_A, p_transform_A, p_motion, p_shape_B, p_transform_B, r_toi, r_normal);
+	}
+	if (type_B == PhysicsServer3D::SHAPE_RAY || type_B == PhysicsServer3D::SHAPE_SOFT_BODY) {
+		return false;
+	}
+
+	if (!p_shape_B->is_concave()) {
+		return gjk_epa_calculate_toi(p_shape_A, p_transform_A, p_motion, p_shape_B, p_transform_B, p_tolerance, r_toi, r_normal);
+	}
+
+	const ConcaveShape3DSW *concave_B = static_cast<const ConcaveShape3DSW *>(p_shape_B);
+
+	_ConcaveTOIInfo tinfo;
+	tinfo.shape_A = p_shape_A;
+	tinfo.transform_A = &p_transform_A;
+	tinfo.transform_B = &p_transform_B;
+	tinfo.motion = p_motion;
+	tinfo.tolerance = p_tolerance;
+	tinfo.hit = false;
+	tinfo.toi = 1.0;
+
+	// Only the faces touched by the swept shape can be hit.
+	Transform3D rel_transform = p_transform_B.affine_inverse() * p_transform_A;
+	AABB local_aabb = rel_transform.xform(p_shape_A->get_aabb());
+	local_aabb = local_aabb.merge(AABB(local_aabb.position + p_transform_B.basis.xform_inv(p_motion), local_aabb.size));
+	local_aabb = local_aabb.grow(p_tolerance);
+
+	concave_B->cull(local_aabb, concave_toi_callback, &tinfo);
+	if (!tinfo.hit) {
+		return false;
+	}
+
+	r_toi = tinfo.toi;
+	r_normal = tinfo.normal;
+	return true;
+}
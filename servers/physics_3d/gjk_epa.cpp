@@ -1005,6 +1005,67 @@ bool gjk_epa_calculate_distance(const Shape3DSW *p_shape_A, const Transform3D &p
 	return false;
 }
 
+// Conservative advancement of A along p_motion, with B fixed.
+// A cannot get closer to B faster than the motion along the closest
+// direction, so advancing by the distance over that speed never steps
+// past the first contact. Iterates until A is within p_tolerance of B.
+bool gjk_epa_calculate_toi(const Shape3DSW *p_shape_A, const Transform3D &p_transform_A, const Vector3 &p_motion, const Shape3DSW *p_shape_B, const Transform3D &p_transform_B, real_t p_tolerance, real_t &r_toi, Vector3 &r_normal) {
+	static const int max_iterations = 32;
+
+	Transform3D transform_A = p_transform_A;
+	real_t toi = 0.0;
+	bool reached = false;
+
+	for (int i = 0; i < max_iterations; i++) {
+		GjkEpa2::sResults res;
+		if (!GjkEpa2::Distance(p_shape_A, transform_A, 0.0, p_shape_B, p_transform_B, 0.0, p_transform_B.origin - transform_A.origin, res)) {
+			return false; // Already overlapping, left to the regular contacts.
+		}
+
+		Vector3 separation = res.witnesses[1] - res.witnesses[0];
+		real_t distance = separation.length();
+		if (distance <= CMP_EPSILON) {
+			if (i == 0) {
+				return false; // Already touching.
+			}
+			reached = true;
+			break;
+		}
+
+		Vector3 direction = separation / distance;
+		r_normal = -direction;
+
+		real_t approach = p_motion.dot(direction);
+		if (approach <= CMP_EPSILON) {
+			return false; // Moving away or parallel, never touches.
+		}
+
+		if (distance <= p_tolerance) {
+			// Close enough, the rest of the way is a straight line.
+			toi += distance / approach;
+			reached = true;
+			break;
+		}
+
+		// Stop short of the tolerance so A never ends up inside B.
+		toi += (distance - p_tolerance * 0.5) / approach;
+		if (toi > 1.0) {
+			return false;
+		}
+
+		transform_A.origin = p_transform_A.origin + p_motion * toi;
+	}
+
+	// Running out of iterations means A is still far from B, as when
+	// grazing past it, so there is no hit to report.
+	if (!reached || toi > 1.0) {
+		return false;
+	}
+
+	r_toi = toi;
+	return true;
+}
+
 bool gjk_epa_calculate_penetration(const Shape3DSW *p_shape_A, const Transform3D &p_transform_A, const Shape3DSW *p_shape_B, const Transform3D &p_transform_B, CollisionSolver3DSW::CallbackResult p_result_callback, void *p_userdata, bool p_swap, real_t p_margin_A, real_t p_margin_B) {
 	GjkEpa2::sResults res;
 
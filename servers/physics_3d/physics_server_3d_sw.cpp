@@ -38,6 +38,7 @@
 #include "joints/hinge_joint_3d_sw.h"
 #include "joints/pin_joint_3d_sw.h"
 #include "joints/slider_joint_3d_sw.h"
+#include "sat_kernels_3d_sw.h"
 
 #define FLUSH_QUERY_CHECK(m_object) \
 	ERR_FAIL_COND_MSG(m_object->get_space() && flushing_queries, "Can't change this state while flushing queries. Use call_deferred() or set_deferred() to change monitoring state instead.");
@@ -212,6 +213,18 @@ int PhysicsServer3DSW::space_get_contact_count(RID p_space) const {
 	return space->get_debug_contact_count();
 }
 
+PackedByteArray PhysicsServer3DSW::space_save_state(RID p_space) const {
+	const Space3DSW *space = space_owner.getornull(p_space);
+	ERR_FAIL_COND_V(!space, PackedByteArray());
+	return space->save_state();
+}
+
+Error PhysicsServer3DSW::space_restore_state(RID p_space, const PackedByteArray &p_state) {
+	Space3DSW *space = space_owner.getornull(p_space);
+	ERR_FAIL_COND_V(!space, ERR_INVALID_PARAMETER);
+	return space->restore_state(p_state);
+}
+
 RID PhysicsServer3DSW::area_create() {
 	Area3DSW *area = memnew(Area3DSW);
 	RID rid = area_owner.make_rid(area);
@@ -1593,6 +1606,7 @@ void PhysicsServer3DSW::init() {
 	iterations = 8; // 8?
 	stepper = memnew(Step3DSW);
 	direct_state = memnew(PhysicsDirectBodyState3DSW);
+	SATKernels3DSW::init();
 };
 
 void PhysicsServer3DSW::step(real_t p_step) {
@@ -0,0 +1,548 @@
+/*************************************************************************/
+/*  sat_kernels_3d_sw.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "sat_kernels_3d_sw.h"
+
+#include "core/error/error_macros.h"
+
+#ifndef REAL_T_IS_DOUBLE
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAT_KERNELS_SSE2
+#define SAT_KERNELS_AVX
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define SAT_TARGET_AVX __attribute__((target("avx")))
+#else
+#define SAT_TARGET_AVX
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SAT_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+#endif // REAL_T_IS_DOUBLE
+
+// The SIMD versions do the same operations in the same order as the scalar ones,
+// which in turn match the project_range() implementations of the shapes.
+
+/* SCALAR */
+
+static void _project_box_scalar(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 &p_half_extents, real_t *r_min, real_t *r_max) {
+	for (int i = 0; i < p_count; i++) {
+		Vector3 axis(p_axes_x[i], p_axes_y[i], p_axes_z[i]);
+		Vector3 local_axis = p_transform.basis.xform_inv(axis);
+
+		real_t length = local_axis.abs().dot(p_half_extents);
+		real_t distance = axis.dot(p_transform.origin);
+
+		r_min[i] = distance - length;
+		r_max[i] = distance + length;
+	}
+}
+
+static void _project_capsule_scalar(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t p_radius, real_t p_height, real_t *r_min, real_t *r_max) {
+	for (int i = 0; i < p_count; i++) {
+		Vector3 axis(p_axes_x[i], p_axes_y[i], p_axes_z[i]);
+		Vector3 n = p_transform.basis.xform_inv(axis).normalized();
+		real_t h = (n.y > 0) ? p_height : -p_height;
+
+		n *= p_radius;
+		n.y += h * 0.5;
+
+		r_max[i] = axis.dot(p_transform.xform(n));
+		r_min[i] = axis.dot(p_transform.xform(-n));
+	}
+}
+
+static void _project_points_scalar(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 *p_points, int p_point_count, real_t *r_min, real_t *r_max) {
+	if (p_point_count == 0) {
+		for (int i = 0; i < p_count; i++) {
+			r_min[i] = 0;
+			r_max[i] = 0;
+		}
+		return;
+	}
+
+	for (int j = 0; j < p_point_count; j++) {
+		Vector3 point = p_transform.xform(p_points[j]);
+
+		for (int i = 0; i < p_count; i++) {
+			real_t d = p_axes_x[i] * point.x + p_axes_y[i] * point.y + p_axes_z[i] * point.z;
+
+			if (j == 0 || d > r_max[i]) {
+				r_max[i] = d;
+			}
+			if (j == 0 || d < r_min[i]) {
+				r_min[i] = d;
+			}
+		}
+	}
+}
+
+/* SSE2 */
+
+#ifdef SAT_KERNELS_SSE2
+
+static _FORCE_INLINE_ __m128 _dot3_sse2(__m128 p_a0, __m128 p_b0, __m128 p_a1, __m128 p_b1, __m128 p_a2, __m128 p_b2) {
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(p_a0, p_b0), _mm_mul_ps(p_a1, p_b1)), _mm_mul_ps(p_a2, p_b2));
+}
+
+static _FORCE_INLINE_ __m128 _select_sse2(__m128 p_mask, __m128 p_a, __m128 p_b) {
+	return _mm_or_ps(_mm_and_ps(p_mask, p_a), _mm_andnot_ps(p_mask, p_b));
+}
+
+static void _project_box_sse2(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 &p_half_extents, real_t *r_min, real_t *r_max) {
+	const Basis &b = p_transform.basis;
+	const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+	for (int i = 0; i < SATKernels3DSW::AXIS_BATCH; i += 4) {
+		__m128 x = _mm_loadu_ps(p_axes_x + i);
+		__m128 y = _mm_loadu_ps(p_axes_y + i);
+		__m128 z = _mm_loadu_ps(p_axes_z + i);
+
+		__m128 lx = _dot3_sse2(_mm_set1_ps(b.elements[0][0]), x, _mm_set1_ps(b.elements[1][0]), y, _mm_set1_ps(b.elements[2][0]), z);
+		__m128 ly = _dot3_sse2(_mm_set1_ps(b.elements[0][1]), x, _mm_set1_ps(b.elements[1][1]), y, _mm_set1_ps(b.elements[2][1]), z);
+		__m128 lz = _dot3_sse2(_mm_set1_ps(b.elements[0][2]), x, _mm_set1_ps(b.elements[1][2]), y, _mm_set1_ps(b.elements[2][2]), z);
+
+		__m128 length = _dot3_sse2(_mm_andnot_ps(sign_mask, lx), _mm_set1_ps(p_half_extents.x), _mm_andnot_ps(sign_mask, ly), _mm_set1_ps(p_half_extents.y), _mm_andnot_ps(sign_mask, lz), _mm_set1_ps(p_half_extents.z));
+		__m128 distance = _dot3_sse2(x, _mm_set1_ps(p_transform.origin.x), y, _mm_set1_ps(p_transform.origin.y), z, _mm_set1_ps(p_transform.origin.z));
+
+		_mm_storeu_ps(r_min + i, _mm_sub_ps(distance, length));
+		_mm_storeu_ps(r_max + i, _mm_add_ps(distance, length));
+	}
+}
+
+static void _project_capsule_sse2(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t p_radius, real_t p_height, real_t *r_min, real_t *r_max) {
+	const Basis &b = p_transform.basis;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 sign_mask = _mm_set1_ps(-0.0f);
+	const __m128 radius = _mm_set1_ps(p_radius);
+	const __m128 height = _mm_set1_ps(p_height);
+	const __m128 neg_height = _mm_set1_ps(-p_height);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (int i = 0; i < SATKernels3DSW::AXIS_BATCH; i += 4) {
+		__m128 x = _mm_loadu_ps(p_axes_x + i);
+		__m128 y = _mm_loadu_ps(p_axes_y + i);
+		__m128 z = _mm_loadu_ps(p_axes_z + i);
+
+		__m128 nx = _dot3_sse2(_mm_set1_ps(b.elements[0][0]), x, _mm_set1_ps(b.elements[1][0]), y, _mm_set1_ps(b.elements[2][0]), z);
+		__m128 ny = _dot3_sse2(_mm_set1_ps(b.elements[0][1]), x, _mm_set1_ps(b.elements[1][1]), y, _mm_set1_ps(b.elements[2][1]), z);
+		__m128 nz = _dot3_sse2(_mm_set1_ps(b.elements[0][2]), x, _mm_set1_ps(b.elements[1][2]), y, _mm_set1_ps(b.elements[2][2]), z);
+
+		// Normalize, zero length vectors become zero like Vector3::normalize() does.
+		__m128 length_sq = _dot3_sse2(nx, nx, ny, ny, nz, nz);
+		__m128 is_zero = _mm_cmpeq_ps(length_sq, zero);
+		__m128 length = _select_sse2(is_zero, one, _mm_sqrt_ps(length_sq));
+		nx = _mm_andnot_ps(is_zero, _mm_div_ps(nx, length));
+		ny = _mm_andnot_ps(is_zero, _mm_div_ps(ny, length));
+		nz = _mm_andnot_ps(is_zero, _mm_div_ps(nz, length));
+
+		__m128 h = _select_sse2(_mm_cmpgt_ps(ny, zero), height, neg_height);
+
+		nx = _mm_mul_ps(nx, radius);
+		ny = _mm_add_ps(_mm_mul_ps(ny, radius), _mm_mul_ps(h, half));
+		nz = _mm_mul_ps(nz, radius);
+
+		__m128 wx = _mm_add_ps(_dot3_sse2(_mm_set1_ps(b.elements[0][0]), nx, _mm_set1_ps(b.elements[0][1]), ny, _mm_set1_ps(b.elements[0][2]), nz), _mm_set1_ps(p_transform.origin.x));
+		__m128 wy = _mm_add_ps(_dot3_sse2(_mm_set1_ps(b.elements[1][0]), nx, _mm_set1_ps(b.elements[1][1]), ny, _mm_set1_ps(b.elements[1][2]), nz), _mm_set1_ps(p_transform.origin.y));
+		__m128 wz = _mm_add_ps(_dot3_sse2(_mm_set1_ps(b.elements[2][0]), nx, _mm_set1_ps(b.elements[2][1]), ny, _mm_set1_ps(b.elements[2][2]), nz), _mm_set1_ps(p_transform.origin.z));
+		_mm_storeu_ps(r_max + i, _dot3_sse2(x, wx, y, wy, z, wz));
+
+		nx = _mm_xor_ps(nx, sign_mask);
+		ny = _mm_xor_ps(ny, sign_mask);
+		nz = _mm_xor_ps(nz, sign_mask);
+
+		wx = _mm_add_ps(_dot3_sse2(_mm_set1_ps(b.elements[0][0]), nx, _mm_set1_ps(b.elements[0][1]), ny, _mm_set1_ps(b.elements[0][2]), nz), _mm_set1_ps(p_transform.origin.x));
+		wy = _mm_add_ps(_dot3_sse2(_mm_set1_ps(b.elements[1][0]), nx, _mm_set1_ps(b.elements[1][1]), ny, _mm_set1_ps(b.elements[1][2]), nz), _mm_set1_ps(p_transform.origin.y));
+		wz = _mm_add_ps(_dot3_sse2(_mm_set1_ps(b.elements[2][0]), nx, _mm_set1_ps(b.elements[2][1]), ny, _mm_set1_ps(b.elements[2][2]), nz), _mm_set1_ps(p_transform.origin.z));
+		_mm_storeu_ps(r_min + i, _dot3_sse2(x, wx, y, wy, z, wz));
+	}
+}
+
+static void _project_points_sse2(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 *p_points, int p_point_count, real_t *r_min, real_t *r_max) {
+	if (p_point_count == 0) {
+		_project_points_scalar(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_points, p_point_count, r_min, r_max);
+		return;
+	}
+
+	__m128 x0 = _mm_loadu_ps(p_axes_x);
+	__m128 y0 = _mm_loadu_ps(p_axes_y);
+	__m128 z0 = _mm_loadu_ps(p_axes_z);
+	__m128 x1 = _mm_loadu_ps(p_axes_x + 4);
+	__m128 y1 = _mm_loadu_ps(p_axes_y + 4);
+	__m128 z1 = _mm_loadu_ps(p_axes_z + 4);
+
+	Vector3 point = p_transform.xform(p_points[0]);
+	__m128 min0 = _dot3_sse2(x0, _mm_set1_ps(point.x), y0, _mm_set1_ps(point.y), z0, _mm_set1_ps(point.z));
+	__m128 min1 = _dot3_sse2(x1, _mm_set1_ps(point.x), y1, _mm_set1_ps(point.y), z1, _mm_set1_ps(point.z));
+	__m128 max0 = min0;
+	__m128 max1 = min1;
+
+	for (int j = 1; j < p_point_count; j++) {
+		point = p_transform.xform(p_points[j]);
+		__m128 px = _mm_set1_ps(point.x);
+		__m128 py = _mm_set1_ps(point.y);
+		__m128 pz = _mm_set1_ps(point.z);
+
+		__m128 d0 = _dot3_sse2(x0, px, y0, py, z0, pz);
+		__m128 d1 = _dot3_sse2(x1, px, y1, py, z1, pz);
+		min0 = _mm_min_ps(min0, d0);
+		max0 = _mm_max_ps(max0, d0);
+		min1 = _mm_min_ps(min1, d1);
+		max1 = _mm_max_ps(max1, d1);
+	}
+
+	_mm_storeu_ps(r_min, min0);
+	_mm_storeu_ps(r_min + 4, min1);
+	_mm_storeu_ps(r_max, max0);
+	_mm_storeu_ps(r_max + 4, max1);
+}
+
+#endif // SAT_KERNELS_SSE2
+
+/* AVX */
+
+#ifdef SAT_KERNELS_AVX
+
+static bool _cpu_has_avx() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	bool avx = (info[2] & (1 << 28)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	// The OS must also save the AVX registers on context switches.
+	return avx && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+	return __builtin_cpu_supports("avx");
+#endif
+}
+
+static SAT_TARGET_AVX _FORCE_INLINE_ __m256 _dot3_avx(__m256 p_a0, __m256 p_b0, __m256 p_a1, __m256 p_b1, __m256 p_a2, __m256 p_b2) {
+	return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p_a0, p_b0), _mm256_mul_ps(p_a1, p_b1)), _mm256_mul_ps(p_a2, p_b2));
+}
+
+static SAT_TARGET_AVX void _project_box_avx(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 &p_half_extents, real_t *r_min, real_t *r_max) {
+	const Basis &b = p_transform.basis;
+	const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+
+	__m256 x = _mm256_loadu_ps(p_axes_x);
+	__m256 y = _mm256_loadu_ps(p_axes_y);
+	__m256 z = _mm256_loadu_ps(p_axes_z);
+
+	__m256 lx = _dot3_avx(_mm256_set1_ps(b.elements[0][0]), x, _mm256_set1_ps(b.elements[1][0]), y, _mm256_set1_ps(b.elements[2][0]), z);
+	__m256 ly = _dot3_avx(_mm256_set1_ps(b.elements[0][1]), x, _mm256_set1_ps(b.elements[1][1]), y, _mm256_set1_ps(b.elements[2][1]), z);
+	__m256 lz = _dot3_avx(_mm256_set1_ps(b.elements[0][2]), x, _mm256_set1_ps(b.elements[1][2]), y, _mm256_set1_ps(b.elements[2][2]), z);
+
+	__m256 length = _dot3_avx(_mm256_andnot_ps(sign_mask, lx), _mm256_set1_ps(p_half_extents.x), _mm256_andnot_ps(sign_mask, ly), _mm256_set1_ps(p_half_extents.y), _mm256_andnot_ps(sign_mask, lz), _mm256_set1_ps(p_half_extents.z));
+	__m256 distance = _dot3_avx(x, _mm256_set1_ps(p_transform.origin.x), y, _mm256_set1_ps(p_transform.origin.y), z, _mm256_set1_ps(p_transform.origin.z));
+
+	_mm256_storeu_ps(r_min, _mm256_sub_ps(distance, length));
+	_mm256_storeu_ps(r_max, _mm256_add_ps(distance, length));
+}
+
+static SAT_TARGET_AVX void _project_capsule_avx(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t p_radius, real_t p_height, real_t *r_min, real_t *r_max) {
+	const Basis &b = p_transform.basis;
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+	const __m256 radius = _mm256_set1_ps(p_radius);
+
+	__m256 x = _mm256_loadu_ps(p_axes_x);
+	__m256 y = _mm256_loadu_ps(p_axes_y);
+	__m256 z = _mm256_loadu_ps(p_axes_z);
+
+	__m256 nx = _dot3_avx(_mm256_set1_ps(b.elements[0][0]), x, _mm256_set1_ps(b.elements[1][0]), y, _mm256_set1_ps(b.elements[2][0]), z);
+	__m256 ny = _dot3_avx(_mm256_set1_ps(b.elements[0][1]), x, _mm256_set1_ps(b.elements[1][1]), y, _mm256_set1_ps(b.elements[2][1]), z);
+	__m256 nz = _dot3_avx(_mm256_set1_ps(b.elements[0][2]), x, _mm256_set1_ps(b.elements[1][2]), y, _mm256_set1_ps(b.elements[2][2]), z);
+
+	// Normalize, zero length vectors become zero like Vector3::normalize() does.
+	__m256 length_sq = _dot3_avx(nx, nx, ny, ny, nz, nz);
+	__m256 is_zero = _mm256_cmp_ps(length_sq, zero, _CMP_EQ_OQ);
+	__m256 length = _mm256_blendv_ps(_mm256_sqrt_ps(length_sq), one, is_zero);
+	nx = _mm256_andnot_ps(is_zero, _mm256_div_ps(nx, length));
+	ny = _mm256_andnot_ps(is_zero, _mm256_div_ps(ny, length));
+	nz = _mm256_andnot_ps(is_zero, _mm256_div_ps(nz, length));
+
+	__m256 h = _mm256_blendv_ps(_mm256_set1_ps(-p_height), _mm256_set1_ps(p_height), _mm256_cmp_ps(ny, zero, _CMP_GT_OQ));
+
+	nx = _mm256_mul_ps(nx, radius);
+	ny = _mm256_add_ps(_mm256_mul_ps(ny, radius), _mm256_mul_ps(h, _mm256_set1_ps(0.5f)));
+	nz = _mm256_mul_ps(nz, radius);
+
+	__m256 wx = _mm256_add_ps(_dot3_avx(_mm256_set1_ps(b.elements[0][0]), nx, _mm256_set1_ps(b.elements[0][1]), ny, _mm256_set1_ps(b.elements[0][2]), nz), _mm256_set1_ps(p_transform.origin.x));
+	__m256 wy = _mm256_add_ps(_dot3_avx(_mm256_set1_ps(b.elements[1][0]), nx, _mm256_set1_ps(b.elements[1][1]), ny, _mm256_set1_ps(b.elements[1][2]), nz), _mm256_set1_ps(p_transform.origin.y));
+	__m256 wz = _mm256_add_ps(_dot3_avx(_mm256_set1_ps(b.elements[2][0]), nx, _mm256_set1_ps(b.elements[2][1]), ny, _mm256_set1_ps(b.elements[2][2]), nz), _mm256_set1_ps(p_transform.origin.z));
+	_mm256_storeu_ps(r_max, _dot3_avx(x, wx, y, wy, z, wz));
+
+	nx = _mm256_xor_ps(nx, sign_mask);
+	ny = _mm256_xor_ps(ny, sign_mask);
+	nz = _mm256_xor_ps(nz, sign_mask);
+
+	wx = _mm256_add_ps(_dot3_avx(_mm256_set1_ps(b.elements[0][0]), nx, _mm256_set1_ps(b.elements[0][1]), ny, _mm256_set1_ps(b.elements[0][2]), nz), _mm256_set1_ps(p_transform.origin.x));
+	wy = _mm256_add_ps(_dot3_avx(_mm256_set1_ps(b.elements[1][0]), nx, _mm256_set1_ps(b.elements[1][1]), ny, _mm256_set1_ps(b.elements[1][2]), nz), _mm256_set1_ps(p_transform.origin.y));
+	wz = _mm256_add_ps(_dot3_avx(_mm256_set1_ps(b.elements[2][0]), nx, _mm256_set1_ps(b.elements[2][1]), ny, _mm256_set1_ps(b.elements[2][2]), nz), _mm256_set1_ps(p_transform.origin.z));
+	_mm256_storeu_ps(r_min, _dot3_avx(x, wx, y, wy, z, wz));
+}
+
+static SAT_TARGET_AVX void _project_points_avx(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 *p_points, int p_point_count, real_t *r_min, real_t *r_max) {
+	if (p_point_count == 0) {
+		_project_points_scalar(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_points, p_point_count, r_min, r_max);
+		return;
+	}
+
+	__m256 x = _mm256_loadu_ps(p_axes_x);
+	__m256 y = _mm256_loadu_ps(p_axes_y);
+	__m256 z = _mm256_loadu_ps(p_axes_z);
+
+	Vector3 point = p_transform.xform(p_points[0]);
+	__m256 min = _dot3_avx(x, _mm256_set1_ps(point.x), y, _mm256_set1_ps(point.y), z, _mm256_set1_ps(point.z));
+	__m256 max = min;
+
+	for (int j = 1; j < p_point_count; j++) {
+		point = p_transform.xform(p_points[j]);
+
+		__m256 d = _dot3_avx(x, _mm256_set1_ps(point.x), y, _mm256_set1_ps(point.y), z, _mm256_set1_ps(point.z));
+		min = _mm256_min_ps(min, d);
+		max = _mm256_max_ps(max, d);
+	}
+
+	_mm256_storeu_ps(r_min, min);
+	_mm256_storeu_ps(r_max, max);
+}
+
+#endif // SAT_KERNELS_AVX
+
+/* NEON */
+
+#ifdef SAT_KERNELS_NEON
+
+static _FORCE_INLINE_ float32x4_t _dot3_neon(float32x4_t p_a0, float32x4_t p_b0, float32x4_t p_a1, float32x4_t p_b1, float32x4_t p_a2, float32x4_t p_b2) {
+	return vaddq_f32(vaddq_f32(vmulq_f32(p_a0, p_b0), vmulq_f32(p_a1, p_b1)), vmulq_f32(p_a2, p_b2));
+}
+
+static void _project_box_neon(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 &p_half_extents, real_t *r_min, real_t *r_max) {
+	const Basis &b = p_transform.basis;
+
+	for (int i = 0; i < SATKernels3DSW::AXIS_BATCH; i += 4) {
+		float32x4_t x = vld1q_f32(p_axes_x + i);
+		float32x4_t y = vld1q_f32(p_axes_y + i);
+		float32x4_t z = vld1q_f32(p_axes_z + i);
+
+		float32x4_t lx = _dot3_neon(vdupq_n_f32(b.elements[0][0]), x, vdupq_n_f32(b.elements[1][0]), y, vdupq_n_f32(b.elements[2][0]), z);
+		float32x4_t ly = _dot3_neon(vdupq_n_f32(b.elements[0][1]), x, vdupq_n_f32(b.elements[1][1]), y, vdupq_n_f32(b.elements[2][1]), z);
+		float32x4_t lz = _dot3_neon(vdupq_n_f32(b.elements[0][2]), x, vdupq_n_f32(b.elements[1][2]), y, vdupq_n_f32(b.elements[2][2]), z);
+
+		float32x4_t length = _dot3_neon(vabsq_f32(lx), vdupq_n_f32(p_half_extents.x), vabsq_f32(ly), vdupq_n_f32(p_half_extents.y), vabsq_f32(lz), vdupq_n_f32(p_half_extents.z));
+		float32x4_t distance = _dot3_neon(x, vdupq_n_f32(p_transform.origin.x), y, vdupq_n_f32(p_transform.origin.y), z, vdupq_n_f32(p_transform.origin.z));
+
+		vst1q_f32(r_min + i, vsubq_f32(distance, length));
+		vst1q_f32(r_max + i, vaddq_f32(distance, length));
+	}
+}
+
+static void _project_capsule_neon(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t p_radius, real_t p_height, real_t *r_min, real_t *r_max) {
+	const Basis &b = p_transform.basis;
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t radius = vdupq_n_f32(p_radius);
+
+	for (int i = 0; i < SATKernels3DSW::AXIS_BATCH; i += 4) {
+		float32x4_t x = vld1q_f32(p_axes_x + i);
+		float32x4_t y = vld1q_f32(p_axes_y + i);
+		float32x4_t z = vld1q_f32(p_axes_z + i);
+
+		float32x4_t nx = _dot3_neon(vdupq_n_f32(b.elements[0][0]), x, vdupq_n_f32(b.elements[1][0]), y, vdupq_n_f32(b.elements[2][0]), z);
+		float32x4_t ny = _dot3_neon(vdupq_n_f32(b.elements[0][1]), x, vdupq_n_f32(b.elements[1][1]), y, vdupq_n_f32(b.elements[2][1]), z);
+		float32x4_t nz = _dot3_neon(vdupq_n_f32(b.elements[0][2]), x, vdupq_n_f32(b.elements[1][2]), y, vdupq_n_f32(b.elements[2][2]), z);
+
+		// Normalize, zero length vectors become zero like Vector3::normalize() does.
+		float32x4_t length_sq = _dot3_neon(nx, nx, ny, ny, nz, nz);
+		uint32x4_t is_zero = vceqq_f32(length_sq, zero);
+		float32x4_t length = vbslq_f32(is_zero, one, vsqrtq_f32(length_sq));
+		nx = vbslq_f32(is_zero, zero, vdivq_f32(nx, length));
+		ny = vbslq_f32(is_zero, zero, vdivq_f32(ny, length));
+		nz = vbslq_f32(is_zero, zero, vdivq_f32(nz, length));
+
+		float32x4_t h = vbslq_f32(vcgtq_f32(ny, zero), vdupq_n_f32(p_height), vdupq_n_f32(-p_height));
+
+		nx = vmulq_f32(nx, radius);
+		ny = vaddq_f32(vmulq_f32(ny, radius), vmulq_f32(h, vdupq_n_f32(0.5f)));
+		nz = vmulq_f32(nz, radius);
+
+		float32x4_t wx = vaddq_f32(_dot3_neon(vdupq_n_f32(b.elements[0][0]), nx, vdupq_n_f32(b.elements[0][1]), ny, vdupq_n_f32(b.elements[0][2]), nz), vdupq_n_f32(p_transform.origin.x));
+		float32x4_t wy = vaddq_f32(_dot3_neon(vdupq_n_f32(b.elements[1][0]), nx, vdupq_n_f32(b.elements[1][1]), ny, vdupq_n_f32(b.elements[1][2]), nz), vdupq_n_f32(p_transform.origin.y));
+		float32x4_t wz = vaddq_f32(_dot3_neon(vdupq_n_f32(b.elements[2][0]), nx, vdupq_n_f32(b.elements[2][1]), ny, vdupq_n_f32(b.elements[2][2]), nz), vdupq_n_f32(p_transform.origin.z));
+		vst1q_f32(r_max + i, _dot3_neon(x, wx, y, wy, z, wz));
+
+		nx = vnegq_f32(nx);
+		ny = vnegq_f32(ny);
+		nz = vnegq_f32(nz);
+
+		wx = vaddq_f32(_dot3_neon(vdupq_n_f32(b.elements[0][0]), nx, vdupq_n_f32(b.elements[0][1]), ny, vdupq_n_f32(b.elements[0][2]), nz), vdupq_n_f32(p_transform.origin.x));
+		wy = vaddq_f32(_dot3_neon(vdupq_n_f32(b.elements[1][0]), nx, vdupq_n_f32(b.elements[1][1]), ny, vdupq_n_f32(b.elements[1][2]), nz), vdupq_n_f32(p_transform.origin.y));
+		wz = vaddq_f32(_dot3_neon(vdupq_n_f32(b.elements[2][0]), nx, vdupq_n_f32(b.elements[2][1]), ny, vdupq_n_f32(b.elements[2][2]), nz), vdupq_n_f32(p_transform.origin.z));
+		vst1q_f32(r_min + i, _dot3_neon(x, wx, y, wy, z, wz));
+	}
+}
+
+static void _project_points_neon(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 *p_points, int p_point_count, real_t *r_min, real_t *r_max) {
+	if (p_point_count == 0) {
+		_project_points_scalar(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_points, p_point_count, r_min, r_max);
+		return;
+	}
+
+	float32x4_t x0 = vld1q_f32(p_axes_x);
+	float32x4_t y0 = vld1q_f32(p_axes_y);
+	float32x4_t z0 = vld1q_f32(p_axes_z);
+	float32x4_t x1 = vld1q_f32(p_axes_x + 4);
+	float32x4_t y1 = vld1q_f32(p_axes_y + 4);
+	float32x4_t z1 = vld1q_f32(p_axes_z + 4);
+
+	Vector3 point = p_transform.xform(p_points[0]);
+	float32x4_t min0 = _dot3_neon(x0, vdupq_n_f32(point.x), y0, vdupq_n_f32(point.y), z0, vdupq_n_f32(point.z));
+	float32x4_t min1 = _dot3_neon(x1, vdupq_n_f32(point.x), y1, vdupq_n_f32(point.y), z1, vdupq_n_f32(point.z));
+	float32x4_t max0 = min0;
+	float32x4_t max1 = min1;
+
+	for (int j = 1; j < p_point_count; j++) {
+		point = p_transform.xform(p_points[j]);
+		float32x4_t px = vdupq_n_f32(point.x);
+		float32x4_t py = vdupq_n_f32(point.y);
+		float32x4_t pz = vdupq_n_f32(point.z);
+
+		float32x4_t d0 = _dot3_neon(x0, px, y0, py, z0, pz);
+		float32x4_t d1 = _dot3_neon(x1, px, y1, py, z1, pz);
+		min0 = vminq_f32(min0, d0);
+		max0 = vmaxq_f32(max0, d0);
+		min1 = vminq_f32(min1, d1);
+		max1 = vmaxq_f32(max1, d1);
+	}
+
+	vst1q_f32(r_min, min0);
+	vst1q_f32(r_min + 4, min1);
+	vst1q_f32(r_max, max0);
+	vst1q_f32(r_max + 4, max1);
+}
+
+#endif // SAT_KERNELS_NEON
+
+SATKernels3DSW::Level SATKernels3DSW::level = SATKernels3DSW::LEVEL_SCALAR;
+SATKernels3DSW::ProjectBoxFunc SATKernels3DSW::project_box_func = _project_box_scalar;
+SATKernels3DSW::ProjectCapsuleFunc SATKernels3DSW::project_capsule_func = _project_capsule_scalar;
+SATKernels3DSW::ProjectPointsFunc SATKernels3DSW::project_points_func = _project_points_scalar;
+
+bool SATKernels3DSW::is_level_supported(Level p_level) {
+	switch (p_level) {
+		case LEVEL_SCALAR:
+			return true;
+		case LEVEL_SSE2:
+#ifdef SAT_KERNELS_SSE2
+			return true;
+#else
+			return false;
+#endif
+		case LEVEL_AVX:
+#ifdef SAT_KERNELS_AVX
+			return _cpu_has_avx();
+#else
+			return false;
+#endif
+		case LEVEL_NEON:
+#ifdef SAT_KERNELS_NEON
+			return true;
+#else
+			return false;
+#endif
+		default:
+			return false;
+	}
+}
+
+SATKernels3DSW::Level SATKernels3DSW::get_best_level() {
+	for (int i = LEVEL_MAX - 1; i > LEVEL_SCALAR; i--) {
+		if (is_level_supported(Level(i))) {
+			return Level(i);
+		}
+	}
+	return LEVEL_SCALAR;
+}
+
+void SATKernels3DSW::set_level(Level p_level) {
+	ERR_FAIL_COND_MSG(!is_level_supported(p_level), "SAT kernels for " + String(get_level_name(p_level)) + " are not supported on this CPU.");
+
+	level = p_level;
+
+	switch (p_level) {
+#ifdef SAT_KERNELS_SSE2
+		case LEVEL_SSE2: {
+			project_box_func = _project_box_sse2;
+			project_capsule_func = _project_capsule_sse2;
+			project_points_func = _project_points_sse2;
+		} break;
+#endif
+#ifdef SAT_KERNELS_AVX
+		case LEVEL_AVX: {
+			project_box_func = _project_box_avx;
+			project_capsule_func = _project_capsule_avx;
+			project_points_func = _project_points_avx;
+		} break;
+#endif
+#ifdef SAT_KERNELS_NEON
+		case LEVEL_NEON: {
+			project_box_func = _project_box_neon;
+			project_capsule_func = _project_capsule_neon;
+			project_points_func = _project_points_neon;
+		} break;
+#endif
+		default: {
+			project_box_func = _project_box_scalar;
+			project_capsule_func = _project_capsule_scalar;
+			project_points_func = _project_points_scalar;
+		} break;
+	}
+}
+
+const char *SATKernels3DSW::get_level_name(Level p_level) {
+	static const char *names[LEVEL_MAX] = { "Scalar", "SSE2", "AVX", "NEON" };
+	ERR_FAIL_INDEX_V(p_level, LEVEL_MAX, "");
+	return names[p_level];
+}
+
+void SATKernels3DSW::init() {
+	set_level(get_best_level());
+}
@@ -0,0 +1,85 @@
+/*************************************************************************/
+/*  sat_kernels_3d_sw.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SAT_KERNELS_3D_SW_H
+#define SAT_KERNELS_3D_SW_H
+
+#include "core/math/transform_3d.h"
+
+// Projects shapes on several separating axes at once. Axes are passed as
+// separate x, y and z arrays of AXIS_BATCH elements, unused ones padded with
+// zeros, so the SIMD versions never need to handle a remainder.
+// The implementation is picked at runtime for the CPU, see init().
+class SATKernels3DSW {
+public:
+	enum {
+		AXIS_BATCH = 8,
+	};
+
+	enum Level {
+		LEVEL_SCALAR,
+		LEVEL_SSE2,
+		LEVEL_AVX,
+		LEVEL_NEON,
+		LEVEL_MAX
+	};
+
+	typedef void (*ProjectBoxFunc)(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 &p_half_extents, real_t *r_min, real_t *r_max);
+	typedef void (*ProjectCapsuleFunc)(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t p_radius, real_t p_height, real_t *r_min, real_t *r_max);
+	typedef void (*ProjectPointsFunc)(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 *p_points, int p_point_count, real_t *r_min, real_t *r_max);
+
+private:
+	static Level level;
+	static ProjectBoxFunc project_box_func;
+	static ProjectCapsuleFunc project_capsule_func;
+	static ProjectPointsFunc project_points_func;
+
+public:
+	static void init();
+
+	static bool is_level_supported(Level p_level);
+	static Level get_best_level();
+	static Level get_level() { return level; }
+	static void set_level(Level p_level);
+	static const char *get_level_name(Level p_level);
+
+	// Same results as BoxShape3DSW, CapsuleShape3DSW and ConvexPolygonShape3DSW::project_range() for each axis.
+	_FORCE_INLINE_ static void project_box(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 &p_half_extents, real_t *r_min, real_t *r_max) {
+		project_box_func(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_half_extents, r_min, r_max);
+	}
+	_FORCE_INLINE_ static void project_capsule(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, real_t p_radius, real_t p_height, real_t *r_min, real_t *r_max) {
+		project_capsule_func(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_radius, p_height, r_min, r_max);
+	}
+	_FORCE_INLINE_ static void project_points(const real_t *p_axes_x, const real_t *p_axes_y, const real_t *p_axes_z, int p_count, const Transform3D &p_transform, const Vector3 *p_points, int p_point_count, real_t *r_min, real_t *r_max) {
+		project_points_func(p_axes_x, p_axes_y, p_axes_z, p_count, p_transform, p_points, p_point_count, r_min, r_max);
+	}
+};
+
+#endif // SAT_KERNELS_3D_SW_H
@@ -1648,210 +1648,269 @@ int HeightMapShape3DSW::get_depth() const {
 }
 
 void HeightMapShape3DSW::project_range(const Vector3 &p_normal, const Transform3D &p_transform, real_t &r_min, real_t &r_max) const {
-	//not very useful, but not very used either
-	p_transform.xform(get_aabb()).project_range_in_plane(Plane(p_normal, 0), r_min, r_max);
-}
+	if (min_max_levels.is_empty()) {
+		p_transform.xform(get_aabb()).project_range_in_plane(Plane(p_normal, 0), r_min, r_max);
+		return;
+	}
 
-Vector3 HeightMapShape3DSW::get_support(const Vector3 &p_normal) const {
-	//not very useful, but not very used either
-	return get_aabb().get_support(p_normal);
-}
+	_ProjectParams params;
+	_project(p_transform.basis.xform_inv(p_normal), &params);
 
-struct _HeightmapSegmentCullParams {
-	Vector3 from;
-	Vector3 to;
-	Vector3 dir;
+	real_t offset = p_normal.dot(p_transform.origin);
+	r_min = params.min + offset;
+	r_max = params.max + offset;
+}
 
-	Vector3 result;
-	Vector3 normal;
+Vector3 HeightMapShape3DSW::get_support(const Vector3 &p_normal) const {
+	if (min_max_levels.is_empty()) {
+		return get_aabb().get_support(p_normal);
+	}
 
-	const HeightMapShape3DSW *heightmap = nullptr;
-	FaceShape3DSW *face = nullptr;
-};
+	_ProjectParams params;
+	_project(p_normal, &params);
 
-_FORCE_INLINE_ bool _heightmap_face_cull_segment(_HeightmapSegmentCullParams &p_params) {
-	Vector3 res;
-	Vector3 normal;
-	if (p_params.face->intersect_segment(p_params.from, p_params.to, res, normal)) {
-		p_params.result = res;
-		p_params.normal = normal;
-		return true;
-	}
+	Vector3 support;
+	_get_point(params.max_x, params.max_z, support);
+	return support;
+}
 
-	return false;
+void HeightMapShape3DSW::_get_block_range(int p_level, int p_x, int p_z, int &r_start_x, int &r_end_x, int &r_start_z, int &r_end_z) const {
+	int size = MIN_MAX_BLOCK_SIZE << p_level;
+	r_start_x = p_x * size;
+	r_end_x = MIN(r_start_x + size, width - 1);
+	r_start_z = p_z * size;
+	r_end_z = MIN(r_start_z + size, depth - 1);
 }
 
-_FORCE_INLINE_ bool _heightmap_cell_cull_segment(_HeightmapSegmentCullParams &p_params, int p_x, int p_z) {
-	// First triangle.
-	p_params.heightmap->_get_point(p_x, p_z, p_params.face->vertex[0]);
-	p_params.heightmap->_get_point(p_x + 1, p_z, p_params.face->vertex[1]);
-	p_params.heightmap->_get_point(p_x, p_z + 1, p_params.face->vertex[2]);
-	p_params.face->normal = Plane(p_params.face->vertex[0], p_params.face->vertex[1], p_params.face->vertex[2]).normal;
-	if (_heightmap_face_cull_segment(p_params)) {
-		return true;
+void HeightMapShape3DSW::_project_block(int p_level, int p_x, int p_z, _ProjectParams *p_params) const {
+	int start_x, end_x, start_z, end_z;
+	_get_block_range(p_level, p_x, p_z, start_x, end_x, start_z, end_z);
+
+	// Skip blocks that can't extend the range found so far.
+	const MinMax &block = _get_block(p_level, p_x, p_z);
+	Vector3 center((start_x + end_x) * 0.5, (block.min + block.max) * 0.5, (start_z + end_z) * 0.5);
+	Vector3 extents((end_x - start_x) * 0.5, (block.max - block.min) * 0.5, (end_z - start_z) * 0.5);
+	real_t distance = p_params->normal.dot(center);
+	real_t length = p_params->normal.abs().dot(extents);
+	if (distance - length >= p_params->min && distance + length <= p_params->max) {
+		return;
 	}
 
-	// Second triangle.
-	p_params.face->vertex[0] = p_params.face->vertex[1];
-	p_params.heightmap->_get_point(p_x + 1, p_z + 1, p_params.face->vertex[1]);
-	p_params.face->normal = Plane(p_params.face->vertex[0], p_params.face->vertex[1], p_params.face->vertex[2]).normal;
-	if (_heightmap_face_cull_segment(p_params)) {
-		return true;
+	if (p_level > 0) {
+		const MinMaxLevel &child_level = min_max_levels[p_level - 1];
+		int child_end_x = MIN(p_x * 2 + 2, child_level.width);
+		int child_end_z = MIN(p_z * 2 + 2, child_level.depth);
+		for (int z = p_z * 2; z < child_end_z; z++) {
+			for (int x = p_x * 2; x < child_end_x; x++) {
+				_project_block(p_level - 1, x, z, p_params);
+			}
+		}
+		return;
 	}
 
-	return false;
+	const Vector3 &normal = p_params->normal;
+	for (int z = start_z; z <= end_z; z++) {
+		for (int x = start_x; x <= end_x; x++) {
+			real_t d = normal.x * x + normal.y * _get_height(x, z) + normal.z * z;
+			if (d > p_params->max) {
+				p_params->max = d;
+				p_params->max_x = x;
+				p_params->max_z = z;
+			}
+			if (d < p_params->min) {
+				p_params->min = d;
+			}
+		}
+	}
 }
 
-bool HeightMapShape3DSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
-	if (heights.is_empty()) {
-		return false;
-	}
+void HeightMapShape3DSW::_project(const Vector3 &p_normal, _ProjectParams *p_params) const {
+	p_params->normal = p_normal;
+	p_params->min = 1e20;
+	p_params->max = -1e20;
 
-	Vector3 local_begin = p_begin + local_origin;
-	Vector3 local_end = p_end + local_origin;
+	_project_block(min_max_levels.size() - 1, 0, 0, p_params);
 
-	FaceShape3DSW face;
-	face.backface_collision = false;
+	// From grid space back to shape space.
+	real_t offset = p_normal.dot(local_origin);
+	p_params->min -= offset;
+	p_params->max -= offset;
+}
 
-	_HeightmapSegmentCullParams params;
-	params.from = p_begin;
-	params.to = p_end;
-	params.dir = (p_end - p_begin).normalized();
-	params.heightmap = this;
-	params.face = &face;
+// Clips the segment from p_from to p_from + p_dir against a box, in segment parameter space.
+static _FORCE_INLINE_ bool _heightmap_clip_segment(const Vector3 &p_from, const Vector3 &p_dir, const Vector3 &p_min, const Vector3 &p_max, real_t &r_t0, real_t &r_t1) {
+	real_t t0 = 0.0;
+	real_t t1 = 1.0;
 
-	// Quantize the ray begin/end.
-	int begin_x = floor(local_begin.x);
-	int begin_z = floor(local_begin.z);
-	int end_x = floor(local_end.x);
-	int end_z = floor(local_end.z);
-
-	if ((begin_x == end_x) && (begin_z == end_z)) {
-		// Simple case for rays that don't traverse the grid horizontally.
-		// Just perform a test on the given cell.
-		int x = CLAMP(begin_x, 0, width - 2);
-		int z = CLAMP(begin_z, 0, depth - 2);
-		if (_heightmap_cell_cull_segment(params, x, z)) {
-			r_point = params.result;
-			r_normal = params.normal;
-			return true;
+	for (int i = 0; i < 3; i++) {
+		if (Math::abs(p_dir[i]) < CMP_EPSILON) {
+			if (p_from[i] < p_min[i] || p_from[i] > p_max[i]) {
+				return false;
+			}
+			continue;
 		}
-	} else {
-		// Perform grid query from projected ray.
-		Vector2 ray_dir_proj(local_end.x - local_begin.x, local_end.z - local_begin.z);
-		real_t ray_dist_proj = ray_dir_proj.length();
 
-		if (ray_dist_proj < CMP_EPSILON) {
-			ray_dir_proj = Vector2();
-		} else {
-			ray_dir_proj /= ray_dist_proj;
+		real_t inv_dir = 1.0 / p_dir[i];
+		real_t ta = (p_min[i] - p_from[i]) * inv_dir;
+		real_t tb = (p_max[i] - p_from[i]) * inv_dir;
+		if (ta > tb) {
+			SWAP(ta, tb);
 		}
 
-		const int x_step = (ray_dir_proj.x > CMP_EPSILON) ? 1 : ((ray_dir_proj.x < -CMP_EPSILON) ? -1 : 0);
-		const int z_step = (ray_dir_proj.y > CMP_EPSILON) ? 1 : ((ray_dir_proj.y < -CMP_EPSILON) ? -1 : 0);
+		t0 = MAX(t0, ta);
+		t1 = MIN(t1, tb);
+		if (t0 > t1) {
+			return false;
+		}
+	}
+
+	r_t0 = t0;
+	r_t1 = t1;
+	return true;
+}
 
-		const real_t infinite = 1e20;
-		const real_t delta_x = (x_step != 0) ? 1.f / Math::abs(ray_dir_proj.x) : infinite;
-		const real_t delta_z = (z_step != 0) ? 1.f / Math::abs(ray_dir_proj.y) : infinite;
+// Boxes are grown a bit so segments along their sides are not missed.
+#define HEIGHTMAP_CLIP_MARGIN 0.001
 
-		real_t cross_x; // At which value of `param` we will cross a x-axis lane?
-		real_t cross_z; // At which value of `param` we will cross a z-axis lane?
+void HeightMapShape3DSW::_cull_segment_cell(int p_x, int p_z, _SegmentCullParams *p_params) const {
+	FaceShape3DSW &face = *p_params->face;
+	Vector3 segment = p_params->to - p_params->from;
 
-		// X initialization.
-		if (x_step != 0) {
-			if (x_step == 1) {
-				cross_x = (ceil(local_begin.x) - local_begin.x) * delta_x;
-			} else {
-				cross_x = (local_begin.x - floor(local_begin.x)) * delta_x;
-			}
+	for (int i = 0; i < 2; i++) {
+		if (i == 0) {
+			// First triangle.
+			_get_point(p_x, p_z, face.vertex[0]);
+			_get_point(p_x + 1, p_z, face.vertex[1]);
+			_get_point(p_x, p_z + 1, face.vertex[2]);
 		} else {
-			cross_x = infinite; // Will never cross on X.
+			// Second triangle.
+			face.vertex[0] = face.vertex[1];
+			_get_point(p_x + 1, p_z + 1, face.vertex[1]);
 		}
+		face.normal = Plane(face.vertex[0], face.vertex[1], face.vertex[2]).normal;
 
-		// Z initialization.
-		if (z_step != 0) {
-			if (z_step == 1) {
-				cross_z = (ceil(local_begin.z) - local_begin.z) * delta_z;
-			} else {
-				cross_z = (local_begin.z - floor(local_begin.z)) * delta_z;
+		Vector3 result;
+		Vector3 normal;
+		if (face.intersect_segment(p_params->from, p_params->to, result, normal)) {
+			real_t t = segment.dot(result - p_params->from) / segment.length_squared();
+			if (!p_params->collided || t < p_params->min_t) {
+				p_params->result = result;
+				p_params->normal = normal;
+				p_params->min_t = t;
+				p_params->collided = true;
 			}
-		} else {
-			cross_z = infinite; // Will never cross on Z.
 		}
+	}
+}
 
-		int x = floor(local_begin.x);
-		int z = floor(local_begin.z);
+void HeightMapShape3DSW::_cull_segment_block(int p_level, int p_x, int p_z, _SegmentCullParams *p_params) const {
+	int start_x, end_x, start_z, end_z;
+	_get_block_range(p_level, p_x, p_z, start_x, end_x, start_z, end_z);
 
-		// Workaround cases where the ray starts at an integer position.
-		if (Math::is_zero_approx(cross_x)) {
-			cross_x += delta_x;
-			// If going backwards, we should ignore the position we would get by the above flooring,
-			// because the ray is not heading in that direction.
-			if (x_step == -1) {
-				x -= 1;
+	if (p_level == 0) {
+		for (int z = start_z; z < end_z; z++) {
+			for (int x = start_x; x < end_x; x++) {
+				float h00 = _get_height(x, z);
+				float h10 = _get_height(x + 1, z);
+				float h01 = _get_height(x, z + 1);
+				float h11 = _get_height(x + 1, z + 1);
+				Vector3 cell_min(x - HEIGHTMAP_CLIP_MARGIN, MIN(MIN(h00, h10), MIN(h01, h11)) - HEIGHTMAP_CLIP_MARGIN, z - HEIGHTMAP_CLIP_MARGIN);
+				Vector3 cell_max(x + 1 + HEIGHTMAP_CLIP_MARGIN, MAX(MAX(h00, h10), MAX(h01, h11)) + HEIGHTMAP_CLIP_MARGIN, z + 1 + HEIGHTMAP_CLIP_MARGIN);
+
+				real_t t0, t1;
+				if (_heightmap_clip_segment(p_params->grid_from, p_params->grid_dir, cell_min, cell_max, t0, t1) && t0 <= p_params->min_t) {
+					_cull_segment_cell(x, z, p_params);
+				}
 			}
 		}
+		return;
+	}
 
-		if (Math::is_zero_approx(cross_z)) {
-			cross_z += delta_z;
-			if (z_step == -1) {
-				z -= 1;
+	// Visit the children in the order the segment enters them,
+	// so the farther ones can be skipped once something was hit.
+	struct Child {
+		int x = 0;
+		int z = 0;
+		real_t t = 0.0;
+	};
+	Child children[4];
+	int child_count = 0;
+
+	const MinMaxLevel &child_level = min_max_levels[p_level - 1];
+	int child_end_x = MIN(p_x * 2 + 2, child_level.width);
+	int child_end_z = MIN(p_z * 2 + 2, child_level.depth);
+	for (int z = p_z * 2; z < child_end_z; z++) {
+		for (int x = p_x * 2; x < child_end_x; x++) {
+			int child_start_x, child_end_x_cell, child_start_z, child_end_z_cell;
+			_get_block_range(p_level - 1, x, z, child_start_x, child_end_x_cell, child_start_z, child_end_z_cell);
+
+			const MinMax &block = _get_block(p_level - 1, x, z);
+			Vector3 block_min(child_start_x - HEIGHTMAP_CLIP_MARGIN, block.min - HEIGHTMAP_CLIP_MARGIN, child_start_z - HEIGHTMAP_CLIP_MARGIN);
+			Vector3 block_max(child_end_x_cell + HEIGHTMAP_CLIP_MARGIN, block.max + HEIGHTMAP_CLIP_MARGIN, child_end_z_cell + HEIGHTMAP_CLIP_MARGIN);
+
+			real_t t0, t1;
+			if (!_heightmap_clip_segment(p_params->grid_from, p_params->grid_dir, block_min, block_max, t0, t1)) {
+				continue;
 			}
-		}
 
-		// Start inside the grid.
-		int x_start = CLAMP(x, 0, width - 2);
-		int z_start = CLAMP(z, 0, depth - 2);
+			int i = child_count++;
+			for (; i > 0 && children[i - 1].t > t0; i--) {
+				children[i] = children[i - 1];
+			}
+			children[i].x = x;
+			children[i].z = z;
+			children[i].t = t0;
+		}
+	}
 
-		// Adjust initial cross values.
-		cross_x += delta_x * x_step * (x_start - x);
-		cross_z += delta_z * z_step * (z_start - z);
+	for (int i = 0; i < child_count; i++) {
+		if (p_params->collided && children[i].t > p_params->min_t) {
+			break;
+		}
+		_cull_segment_block(p_level - 1, children[i].x, children[i].z, p_params);
+	}
+}
 
-		x = x_start;
-		z = z_start;
+bool HeightMapShape3DSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
+	if (heights.is_empty() || min_max_levels.is_empty()) {
+		return false;
+	}
 
-		if (_heightmap_cell_cull_segment(params, x, z)) {
-			r_point = params.result;
-			r_normal = params.normal;
-			return true;
-		}
+	FaceShape3DSW face;
+	face.backface_collision = false;
 
-		real_t dist = 0.0;
-		while (true) {
-			if (cross_x < cross_z) {
-				// X lane.
-				x += x_step;
-				// Assign before advancing the param,
-				// to be in sync with the initialization step.
-				dist = cross_x;
-				cross_x += delta_x;
-			} else {
-				// Z lane.
-				z += z_step;
-				dist = cross_z;
-				cross_z += delta_z;
-			}
+	_SegmentCullParams params;
+	params.grid_from = p_begin + local_origin;
+	params.grid_dir = p_end - p_begin;
+	params.from = p_begin;
+	params.to = p_end;
+	params.face = &face;
 
-			// Stop when outside the grid.
-			if ((x < 0) || (z < 0) || (x >= width - 1) || (z >= depth - 1)) {
-				break;
-			}
+	// The root block is not clipped by its parent.
+	int start_x, end_x, start_z, end_z;
+	int root_level = min_max_levels.size() - 1;
+	_get_block_range(root_level, 0, 0, start_x, end_x, start_z, end_z);
+	const MinMax &root = _get_block(root_level, 0, 0);
+	Vector3 root_min(start_x - HEIGHTMAP_CLIP_MARGIN, root.min - HEIGHTMAP_CLIP_MARGIN, start_z - HEIGHTMAP_CLIP_MARGIN);
+	Vector3 root_max(end_x + HEIGHTMAP_CLIP_MARGIN, root.max + HEIGHTMAP_CLIP_MARGIN, end_z + HEIGHTMAP_CLIP_MARGIN);
+	real_t t0, t1;
+	if (!_heightmap_clip_segment(params.grid_from, params.grid_dir, root_min, root_max, t0, t1)) {
+		return false;
+	}
 
-			if (_heightmap_cell_cull_segment(params, x, z)) {
-				r_point = params.result;
-				r_normal = params.normal;
-				return true;
-			}
+	_cull_segment_block(root_level, 0, 0, &params);
 
-			if (dist > ray_dist_proj) {
-				break;
-			}
-		}
+	if (params.collided) {
+		r_point = params.result;
+		r_normal = params.normal;
+		return true;
 	}
 
 	return false;
 }
 
+#undef HEIGHTMAP_CLIP_MARGIN
+
 bool HeightMapShape3DSW::intersect_point(const Vector3 &p_point) const {
 	return false;
 }
@@ -1868,15 +1927,74 @@ void HeightMapShape3DSW::_get_cell(const Vector3 &p_point, int &r_x, int &r_y, i
 	Vector3 clamped_point(p_point);
 	clamped_point.x = CLAMP(p_point.x, pos_local.x, pos_local.x + aabb.size.x);
 	clamped_point.y = CLAMP(p_point.y, pos_local.y, pos_local.y + aabb.size.y);
-	clamped_point.z = CLAMP(p_point.z, pos_local.z, pos_local.x + aabb.size.z);
+	clamped_point.z = CLAMP(p_point.z, pos_local.z, pos_local.z + aabb.size.z);
 
 	r_x = (clamped_point.x < 0.0) ? (clamped_point.x - 0.5) : (clamped_point.x + 0.5);
 	r_y = (clamped_point.y < 0.0) ? (clamped_point.y - 0.5) : (clamped_point.y + 0.5);
 	r_z = (clamped_point.z < 0.0) ? (clamped_point.z - 0.5) : (clamped_point.z + 0.5);
 }
 
+void HeightMapShape3DSW::_cull_block(int p_level, int p_x, int p_z, _CullParams *p_params) const {
+	int start_x, end_x, start_z, end_z;
+	_get_block_range(p_level, p_x, p_z, start_x, end_x, start_z, end_z);
+
+	if (end_x <= p_params->start_x || start_x >= p_params->end_x || end_z <= p_params->start_z || start_z >= p_params->end_z) {
+		return;
+	}
+
+	const MinMax &block = _get_block(p_level, p_x, p_z);
+	if (block.min > p_params->max_y || block.max < p_params->min_y) {
+		return;
+	}
+
+	if (p_level > 0) {
+		const MinMaxLevel &child_level = min_max_levels[p_level - 1];
+		int child_end_x = MIN(p_x * 2 + 2, child_level.width);
+		int child_end_z = MIN(p_z * 2 + 2, child_level.depth);
+		for (int z = p_z * 2; z < child_end_z; z++) {
+			for (int x = p_x * 2; x < child_end_x; x++) {
+				_cull_block(p_level - 1, x, z, p_params);
+			}
+		}
+		return;
+	}
+
+	start_x = MAX(start_x, p_params->start_x);
+	end_x = MIN(end_x, p_params->end_x);
+	start_z = MAX(start_z, p_params->start_z);
+	end_z = MIN(end_z, p_params->end_z);
+
+	FaceShape3DSW &face = *p_params->face;
+
+	for (int z = start_z; z < end_z; z++) {
+		for (int x = start_x; x < end_x; x++) {
+			// Skip cells entirely above or below the query.
+			float h00 = _get_height(x, z);
+			float h10 = _get_height(x + 1, z);
+			float h01 = _get_height(x, z + 1);
+			float h11 = _get_height(x + 1, z + 1);
+			if (MIN(MIN(h00, h10), MIN(h01, h11)) > p_params->max_y || MAX(MAX(h00, h10), MAX(h01, h11)) < p_params->min_y) {
+				continue;
+			}
+
+			// First triangle.
+			_get_point(x, z, face.vertex[0]);
+			_get_point(x + 1, z, face.vertex[1]);
+			_get_point(x, z + 1, face.vertex[2]);
+			face.normal = Plane(face.vertex[0], face.vertex[2], face.vertex[1]).normal;
+			p_params->callback(p_params->userdata, &face);
+
+			// Second triangle.
+			face.vertex[0] = face.vertex[1];
+			_get_point(x + 1, z + 1, face.vertex[1]);
+			face.normal = Plane(face.vertex[0], face.vertex[2], face.vertex[1]).normal;
+			p_params->callback(p_params->userdata, &face);
+		}
+	}
+}
+
 void HeightMapShape3DSW::cull(const AABB &p_local_aabb, Callback p_callback, void *p_userdata) const {
-	if (heights.is_empty()) {
+	if (heights.is_empty() || min_max_levels.is_empty()) {
 		return;
 	}
 
@@ -1896,30 +2014,21 @@ void HeightMapShape3DSW::cull(const AABB &p_local_aabb, Callback p_callback, voi
 		aabb_max[i]++;
 	}
 
-	int start_x = MAX(0, aabb_min[0]);
-	int end_x = MIN(width - 1, aabb_max[0]);
-	int start_z = MAX(0, aabb_min[2]);
-	int end_z = MIN(depth - 1, aabb_max[2]);
-
 	FaceShape3DSW face;
 	face.backface_collision = true;
 
-	for (int z = start_z; z < end_z; z++) {
-		for (int x = start_x; x < end_x; x++) {
-			// First triangle.
-			_get_point(x, z, face.vertex[0]);
-			_get_point(x + 1, z, face.vertex[1]);
-			_get_point(x, z + 1, face.vertex[2]);
-			face.normal = Plane(face.vertex[0], face.vertex[2], face.vertex[1]).normal;
-			p_callback(p_userdata, &face);
+	_CullParams params;
+	params.start_x = MAX(0, aabb_min[0]);
+	params.end_x = MIN(width - 1, aabb_max[0]);
+	params.start_z = MAX(0, aabb_min[2]);
+	params.end_z = MIN(depth - 1, aabb_max[2]);
+	params.min_y = local_aabb.position.y;
+	params.max_y = local_aabb.position.y + local_aabb.size.y;
+	params.callback = p_callback;
+	params.userdata = p_userdata;
+	params.face = &face;
 
-			// Second triangle.
-			face.vertex[0] = face.vertex[1];
-			_get_point(x + 1, z + 1, face.vertex[1]);
-			face.normal = Plane(face.vertex[0], face.vertex[2], face.vertex[1]).normal;
-			p_callback(p_userdata, &face);
-		}
-	}
+	_cull_block(min_max_levels.size() - 1, 0, 0, &params);
 }
 
 Vector3 HeightMapShape3DSW::get_moment_of_inertia(real_t p_mass) const {
@@ -1949,6 +2058,72 @@ void HeightMapShape3DSW::_setup(const Vector<float> &p_heights, int p_width, int
 	aabb.position -= local_origin;
 
 	configure(aabb);
+
+	_build_min_max_levels();
+}
+
+void HeightMapShape3DSW::_build_min_max_levels() {
+	min_max_levels.clear();
+
+	const int cells_x = width - 1;
+	const int cells_z = depth - 1;
+	if (cells_x <= 0 || cells_z <= 0) {
+		return;
+	}
+
+	// First level, from the heights.
+	min_max_levels.resize(1);
+	MinMaxLevel &first_level = min_max_levels[0];
+	first_level.width = (cells_x + MIN_MAX_BLOCK_SIZE - 1) / MIN_MAX_BLOCK_SIZE;
+	first_level.depth = (cells_z + MIN_MAX_BLOCK_SIZE - 1) / MIN_MAX_BLOCK_SIZE;
+	first_level.blocks.resize(first_level.width * first_level.depth);
+
+	for (int block_z = 0; block_z < first_level.depth; block_z++) {
+		for (int block_x = 0; block_x < first_level.width; block_x++) {
+			int start_x, end_x, start_z, end_z;
+			_get_block_range(0, block_x, block_z, start_x, end_x, start_z, end_z);
+
+			MinMax &block = first_level.blocks[block_z * first_level.width + block_x];
+			block.min = _get_height(start_x, start_z);
+			block.max = block.min;
+			for (int z = start_z; z <= end_z; z++) {
+				for (int x = start_x; x <= end_x; x++) {
+					float h = _get_height(x, z);
+					block.min = MIN(block.min, h);
+					block.max = MAX(block.max, h);
+				}
+			}
+		}
+	}
+
+	// Merge 2x2 blocks until a single one is left.
+	while (min_max_levels[min_max_levels.size() - 1].width > 1 || min_max_levels[min_max_levels.size() - 1].depth > 1) {
+		int level_index = min_max_levels.size();
+		min_max_levels.resize(level_index + 1);
+
+		const MinMaxLevel &child_level = min_max_levels[level_index - 1];
+		MinMaxLevel &level = min_max_levels[level_index];
+		level.width = (child_level.width + 1) / 2;
+		level.depth = (child_level.depth + 1) / 2;
+		level.blocks.resize(level.width * level.depth);
+
+		for (int block_z = 0; block_z < level.depth; block_z++) {
+			for (int block_x = 0; block_x < level.width; block_x++) {
+				MinMax &block = level.blocks[block_z * level.width + block_x];
+				block = child_level.blocks[(block_z * 2) * child_level.width + block_x * 2];
+
+				int child_end_x = MIN(block_x * 2 + 2, child_level.width);
+				int child_end_z = MIN(block_z * 2 + 2, child_level.depth);
+				for (int z = block_z * 2; z < child_end_z; z++) {
+					for (int x = block_x * 2; x < child_end_x; x++) {
+						const MinMax &child = child_level.blocks[z * child_level.width + x];
+						block.min = MIN(block.min, child.min);
+						block.max = MAX(block.max, child.max);
+					}
+				}
+			}
+		}
+	}
 }
 
 void HeightMapShape3DSW::set_data(const Variant &p_data) {
@@ -1996,9 +2171,9 @@ void HeightMapShape3DSW::set_data(const Variant &p_data) {
 		min_height = d["min_height"];
 		max_height = d["max_height"];
 	} else {
-		int heights_size = heights.size();
+		int heights_size = heights_buffer.size();
 		for (int i = 0; i < heights_size; ++i) {
-			float h = heights[i];
+			float h = heights_buffer[i];
 			if (h < min_height) {
 				min_height = h;
 			} else if (h > max_height) {
@@ -32,6 +32,7 @@
 #define SHAPE_SW_H
 
 #include "core/math/geometry_3d.h"
+#include "core/templates/local_vector.h"
 #include "servers/physics_server_3d.h"
 /*
 
@@ -404,8 +405,75 @@ struct HeightMapShape3DSW : public ConcaveShape3DSW {
 		r_point.z = p_z - 0.5 * (depth - 1.0);
 	}
 
+	enum {
+		MIN_MAX_BLOCK_SIZE = 4, // Cells per side in the blocks of the first min/max level.
+	};
+
+	struct MinMax {
+		float min = 0.0;
+		float max = 0.0;
+	};
+
+	// Min/max pyramid: the first level stores the height range of blocks of
+	// MIN_MAX_BLOCK_SIZE cells per side, each next level merges 2x2 blocks,
+	// up to a single block covering the whole map.
+	struct MinMaxLevel {
+		int width = 0;
+		int depth = 0;
+		LocalVector<MinMax> blocks;
+	};
+
+	LocalVector<MinMaxLevel> min_max_levels;
+
+	// Queries are done in grid space, where point (x, z) is at (x, height, z).
+	struct _CullParams {
+		int start_x = 0;
+		int end_x = 0;
+		int start_z = 0;
+		int end_z = 0;
+		real_t min_y = 0.0;
+		real_t max_y = 0.0;
+		Callback callback = nullptr;
+		void *userdata = nullptr;
+		FaceShape3DSW *face = nullptr;
+	};
+
+	struct _SegmentCullParams {
+		Vector3 grid_from;
+		Vector3 grid_dir;
+		Vector3 from;
+		Vector3 to;
+		FaceShape3DSW *face = nullptr;
+
+		Vector3 result;
+		Vector3 normal;
+		real_t min_t = 1.0;
+		bool collided = false;
+	};
+
+	struct _ProjectParams {
+		Vector3 normal;
+		real_t min = 0.0;
+		real_t max = 0.0;
+		int max_x = 0;
+		int max_z = 0;
+	};
+
+	_FORCE_INLINE_ const MinMax &_get_block(int p_level, int p_x, int p_z) const {
+		const MinMaxLevel &level = min_max_levels[p_level];
+		return level.blocks[p_z * level.width + p_x];
+	}
+
 	void _get_cell(const Vector3 &p_point, int &r_x, int &r_y, int &r_z) const;
+	void _get_block_range(int p_level, int p_x, int p_z, int &r_start_x, int &r_end_x, int &r_start_z, int &r_end_z) const;
+
+	void _cull_block(int p_level, int p_x, int p_z, _CullParams *p_params) const;
+	void _cull_segment_cell(int p_x, int p_z, _SegmentCullParams *p_params) const;
+	void _cull_segment_block(int p_level, int p_x, int p_z, _SegmentCullParams *p_params) const;
+	void _project_block(int p_level, int p_x, int p_z, _ProjectParams *p_params) const;
+	void _project(const Vector3 &p_normal, _ProjectParams *p_params) const;
 
+	void _build_min_max_levels();
 	void _setup(const Vector<float> &p_heights, int p_width, int p_depth, real_t p_min_height, real_t p_max_height);
 
 public:
@@ -34,6 +34,11 @@
 #include "core/math/geometry_3d.h"
 #include "core/templates/map.h"
 
+#if !defined(REAL_T_IS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SOFT_BODY_SSE2
+#include <emmintrin.h>
+#endif
+
 // Based on Bullet soft body.
 
 /*
@@ -287,6 +292,8 @@ void SoftBody3DSW::update_link_constants() {
 		Link &link = links[i];
 		link.c0 = (link.n[0]->im + link.n[1]->im) * inv_linear_stiffness;
 	}
+
+	update_link_solver_data();
 }
 
 void SoftBody3DSW::apply_nodes_transform(const Transform3D &p_transform) {
@@ -571,9 +578,9 @@ bool SoftBody3DSW::create_from_trimesh(const Vector<int> &p_indices, const Vecto
 	}
 
 	generate_bending_constraints(2);
-	reoptimize_link_order();
 
 	update_constants();
+	update_link_colors();
 	update_normals();
 	update_bounds();
 
@@ -679,133 +686,80 @@ void SoftBody3DSW::generate_bending_constraints(int p_distance) {
 	}
 }
 
-//===================================================================
-//
-//
-// This function takes in a list of interdependent Links and tries
-// to maximize the distance between calculation
-// of dependent links. This increases the amount of parallelism that can
-// be exploited by out-of-order instruction processors with large but
-// (inevitably) finite instruction windows.
-//
-//===================================================================
-
-// A small structure to track lists of dependent link calculations.
-class LinkDeps {
-public:
-	int value; // A link calculation that is dependent on this one
-			// Positive values = "input A" while negative values = "input B"
-	LinkDeps *next; // Next dependence in the list
-};
-typedef LinkDeps *LinkDepsPtr;
-
-void SoftBody3DSW::reoptimize_link_order() {
-	const int reop_not_dependent = -1;
-	const int reop_node_complete = -2;
-
-	uint32_t i, link_count = links.size(), node_count = nodes.size();
-	Link *lr;
-	int ar, br;
-	Node *node0 = &(nodes[0]);
-	Node *node1 = &(nodes[1]);
-	LinkDepsPtr link_dep;
-	int ready_list_head, ready_list_tail, link_num, link_dep_frees, dep_link;
-
-	// Allocate temporary buffers.
-	int *node_written_at = memnew_arr(int, node_count + 1); // What link calculation produced this node's current values?
-	int *link_dep_A = memnew_arr(int, link_count); // Link calculation input is dependent upon prior calculation #N
-	int *link_dep_B = memnew_arr(int, link_count);
-	int *ready_list = memnew_arr(int, link_count); // List of ready-to-process link calculations (# of links, maximum)
-	LinkDeps *link_dep_free_list = memnew_arr(LinkDeps, 2 * link_count); // Dependent-on-me list elements (2x# of links, maximum)
-	LinkDepsPtr *link_dep_list_starts = memnew_arr(LinkDepsPtr, link_count); // Start nodes of dependent-on-me lists, one for each link
-
-	// Copy the original, unsorted links to a side buffer.
-	Link *link_buffer = memnew_arr(Link, link_count);
-	memcpy(link_buffer, &(links[0]), sizeof(Link) * link_count);
-
-	// Clear out the node setup and ready list.
-	for (i = 0; i < node_count + 1; i++) {
-		node_written_at[i] = reop_not_dependent;
-	}
-	for (i = 0; i < link_count; i++) {
-		link_dep_list_starts[i] = nullptr;
-	}
-	ready_list_head = ready_list_tail = link_dep_frees = 0;
-
-	// Initial link analysis to set up data structures.
-	for (i = 0; i < link_count; i++) {
-		// Note which prior link calculations we are dependent upon & build up dependence lists.
-		lr = &(links[i]);
-		ar = (lr->n[0] - node0) / (node1 - node0);
-		br = (lr->n[1] - node0) / (node1 - node0);
-		if (node_written_at[ar] > reop_not_dependent) {
-			link_dep_A[i] = node_written_at[ar];
-			link_dep = &link_dep_free_list[link_dep_frees++];
-			link_dep->value = i;
-			link_dep->next = link_dep_list_starts[node_written_at[ar]];
-			link_dep_list_starts[node_written_at[ar]] = link_dep;
-		} else {
-			link_dep_A[i] = reop_not_dependent;
-		}
-		if (node_written_at[br] > reop_not_dependent) {
-			link_dep_B[i] = node_written_at[br];
-			link_dep = &link_dep_free_list[link_dep_frees++];
-			link_dep->value = -(int)(i + 1);
-			link_dep->next = link_dep_list_starts[node_written_at[br]];
-			link_dep_list_starts[node_written_at[br]] = link_dep;
-		} else {
-			link_dep_B[i] = reop_not_dependent;
+// Greedy coloring of the links, so that links of the same color never share a node.
+// Links of a color can then be solved in any order: on several threads, and
+// several at once with SIMD. Links are sorted by color.
+void SoftBody3DSW::update_link_colors() {
+	const uint32_t link_count = links.size();
+
+	// Colors used by the links of each node, as a bit mask.
+	LocalVector<uint64_t> node_colors;
+	node_colors.resize(nodes.size());
+	memset(node_colors.ptr(), 0, node_colors.size() * sizeof(uint64_t));
+
+	LocalVector<uint32_t> link_color;
+	link_color.resize(link_count);
+
+	uint32_t color_counts[MAX_LINK_COLORS] = {};
+	for (uint32_t i = 0; i < link_count; ++i) {
+		const Link &link = links[i];
+		uint32_t node_a = link.n[0]->index;
+		uint32_t node_b = link.n[1]->index;
+
+		// The last color is shared by all links that could not be colored, and solved serially.
+		uint64_t used = node_colors[node_a] | node_colors[node_b];
+		uint32_t color = 0;
+		while (color < MAX_LINK_COLORS - 1 && (used & (uint64_t(1) << color))) {
+			++color;
 		}
 
-		// Add this link to the initial ready list, if it is not dependent on any other links.
-		if ((link_dep_A[i] == reop_not_dependent) && (link_dep_B[i] == reop_not_dependent)) {
-			ready_list[ready_list_tail++] = i;
-			link_dep_A[i] = link_dep_B[i] = reop_node_complete; // Probably not needed now.
-		}
+		node_colors[node_a] |= uint64_t(1) << color;
+		node_colors[node_b] |= uint64_t(1) << color;
+		link_color[i] = color;
+		color_counts[color]++;
+	}
 
-		// Update the nodes to mark which ones are calculated by this link.
-		node_written_at[ar] = node_written_at[br] = i;
-	}
-
-	// Process the ready list and create the sorted list of links:
-	// -- By treating the ready list as a queue, we maximize the distance between any
-	//    inter-dependent node calculations.
-	// -- All other (non-related) nodes in the ready list will automatically be inserted
-	//    in between each set of inter-dependent link calculations by this loop.
-	i = 0;
-	while (ready_list_head != ready_list_tail) {
-		// Use ready list to select the next link to process.
-		link_num = ready_list[ready_list_head++];
-		// Copy the next-to-calculate link back into the original link array.
-		links[i++] = link_buffer[link_num];
-
-		// Free up any link inputs that are dependent on this one.
-		link_dep = link_dep_list_starts[link_num];
-		while (link_dep) {
-			dep_link = link_dep->value;
-			if (dep_link >= 0) {
-				link_dep_A[dep_link] = reop_not_dependent;
-			} else {
-				dep_link = -dep_link - 1;
-				link_dep_B[dep_link] = reop_not_dependent;
-			}
-			// Add this dependent link calculation to the ready list if *both* inputs are clear.
-			if ((link_dep_A[dep_link] == reop_not_dependent) && (link_dep_B[dep_link] == reop_not_dependent)) {
-				ready_list[ready_list_tail++] = dep_link;
-				link_dep_A[dep_link] = link_dep_B[dep_link] = reop_node_complete; // Probably not needed now.
-			}
-			link_dep = link_dep->next;
+	uint32_t color_count = 0;
+	for (uint32_t color = 0; color < MAX_LINK_COLORS; ++color) {
+		if (color_counts[color] > 0) {
+			color_count = color + 1;
 		}
 	}
 
-	// Delete the temporary buffers.
-	memdelete_arr(node_written_at);
-	memdelete_arr(link_dep_A);
-	memdelete_arr(link_dep_B);
-	memdelete_arr(ready_list);
-	memdelete_arr(link_dep_free_list);
-	memdelete_arr(link_dep_list_starts);
-	memdelete_arr(link_buffer);
+	link_color_offsets.resize(color_count + 1);
+	uint32_t offset = 0;
+	for (uint32_t color = 0; color < color_count; ++color) {
+		link_color_offsets[color] = offset;
+		offset += color_counts[color];
+	}
+	link_color_offsets[color_count] = offset;
+
+	LocalVector<Link> sorted_links;
+	sorted_links.resize(link_count);
+	for (uint32_t i = 0; i < link_count; ++i) {
+		uint32_t color = link_color[i];
+		sorted_links[link_color_offsets[color] + (--color_counts[color])] = links[i];
+	}
+	links = sorted_links;
+
+	update_link_solver_data();
+}
+
+void SoftBody3DSW::update_link_solver_data() {
+	const uint32_t link_count = links.size();
+
+	solver_link_a.resize(link_count);
+	solver_link_b.resize(link_count);
+	solver_link_c0.resize(link_count);
+	solver_link_c1.resize(link_count);
+
+	for (uint32_t i = 0; i < link_count; ++i) {
+		const Link &link = links[i];
+		solver_link_a[i] = link.n[0]->index;
+		solver_link_b[i] = link.n[1]->index;
+		solver_link_c0[i] = link.c0;
+		solver_link_c1[i] = link.c1;
+	}
 }
 
 void SoftBody3DSW::append_link(uint32_t p_node1, uint32_t p_node2) {
@@ -984,7 +938,7 @@ void SoftBody3DSW::predict_motion(real_t p_delta) {
 	face_tree.optimize_incremental(1);
 }
 
-void SoftBody3DSW::solve_constraints(real_t p_delta) {
+void SoftBody3DSW::solve_constraints(real_t p_delta, ThreadWorkPool *p_work_pool) {
 	const real_t inv_delta = 1.0 / p_delta;
 
 	uint32_t i, ni;
@@ -996,20 +950,32 @@ void SoftBody3DSW::solve_constraints(real_t p_delta) {
 	}
 
 	// Solve velocities.
-	for (i = 0, ni = nodes.size(); i < ni; ++i) {
+	const uint32_t node_count = nodes.size();
+	solver_x.resize(node_count);
+	solver_y.resize(node_count);
+	solver_z.resize(node_count);
+	solver_im.resize(node_count);
+	for (i = 0; i < node_count; ++i) {
 		Node &node = nodes[i];
 		node.x = node.q + node.v * p_delta;
+
+		solver_x[i] = node.x.x;
+		solver_y[i] = node.x.y;
+		solver_z[i] = node.x.z;
+		solver_im[i] = node.im;
 	}
 
 	// Solve positions.
 	for (int isolve = 0; isolve < iteration_count; ++isolve) {
-		const real_t ti = isolve / (real_t)iteration_count;
-		solve_links(1.0, ti);
+		solve_links(1.0, p_work_pool);
 	}
+
 	const real_t vc = (1.0 - damping_coefficient) * inv_delta;
-	for (i = 0, ni = nodes.size(); i < ni; ++i) {
+	for (i = 0; i < node_count; ++i) {
 		Node &node = nodes[i];
 
+		node.x = Vector3(solver_x[i], solver_y[i], solver_z[i]);
+
 		node.x += node.bv * p_delta;
 		node.bv = Vector3();
 
@@ -1021,23 +987,155 @@ void SoftBody3DSW::solve_constraints(real_t p_delta) {
 	update_normals();
 }
 
-void SoftBody3DSW::solve_links(real_t kst, real_t ti) {
-	for (uint32_t i = 0, ni = links.size(); i < ni; ++i) {
-		Link &link = links[i];
-		if (link.c0 > 0) {
-			Node &node_a = *link.n[0];
-			Node &node_b = *link.n[1];
-			const Vector3 del = node_b.x - node_a.x;
+static void _solve_links_scalar(const uint32_t *p_node_a, const uint32_t *p_node_b, const real_t *p_c0, const real_t *p_c1, uint32_t p_begin, uint32_t p_end, real_t p_kst, real_t *r_x, real_t *r_y, real_t *r_z, const real_t *p_im) {
+	for (uint32_t i = p_begin; i < p_end; ++i) {
+		const real_t c0 = p_c0[i];
+		if (c0 > 0) {
+			const uint32_t a = p_node_a[i];
+			const uint32_t b = p_node_b[i];
+			const Vector3 del(r_x[b] - r_x[a], r_y[b] - r_y[a], r_z[b] - r_z[a]);
 			const real_t len = del.length_squared();
-			if (link.c1 + len > CMP_EPSILON) {
-				const real_t k = ((link.c1 - len) / (link.c0 * (link.c1 + len))) * kst;
-				node_a.x -= del * (k * node_a.im);
-				node_b.x += del * (k * node_b.im);
+			const real_t c1 = p_c1[i];
+			if (c1 + len > CMP_EPSILON) {
+				const real_t k = ((c1 - len) / (c0 * (c1 + len))) * p_kst;
+				const real_t ka = k * p_im[a];
+				const real_t kb = k * p_im[b];
+				r_x[a] -= del.x * ka;
+				r_y[a] -= del.y * ka;
+				r_z[a] -= del.z * ka;
+				r_x[b] += del.x * kb;
+				r_y[b] += del.y * kb;
+				r_z[b] += del.z * kb;
 			}
 		}
 	}
 }
 
+#ifdef SOFT_BODY_SSE2
+// Four links at once, only valid for links that don't share any node.
+// Same operations as the scalar version, skipped links get a zero correction.
+static void _solve_links_sse2(const uint32_t *p_node_a, const uint32_t *p_node_b, const real_t *p_c0, const real_t *p_c1, uint32_t p_begin, uint32_t p_end, real_t p_kst, real_t *r_x, real_t *r_y, real_t *r_z, const real_t *p_im) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 epsilon = _mm_set1_ps(CMP_EPSILON);
+	const __m128 kst = _mm_set1_ps(p_kst);
+
+	uint32_t i = p_begin;
+	for (; i + 4 <= p_end; i += 4) {
+		const uint32_t *a = p_node_a + i;
+		const uint32_t *b = p_node_b + i;
+
+		__m128 ax = _mm_setr_ps(r_x[a[0]], r_x[a[1]], r_x[a[2]], r_x[a[3]]);
+		__m128 ay = _mm_setr_ps(r_y[a[0]], r_y[a[1]], r_y[a[2]], r_y[a[3]]);
+		__m128 az = _mm_setr_ps(r_z[a[0]], r_z[a[1]], r_z[a[2]], r_z[a[3]]);
+		__m128 bx = _mm_setr_ps(r_x[b[0]], r_x[b[1]], r_x[b[2]], r_x[b[3]]);
+		__m128 by = _mm_setr_ps(r_y[b[0]], r_y[b[1]], r_y[b[2]], r_y[b[3]]);
+		__m128 bz = _mm_setr_ps(r_z[b[0]], r_z[b[1]], r_z[b[2]], r_z[b[3]]);
+
+		__m128 dx = _mm_sub_ps(bx, ax);
+		__m128 dy = _mm_sub_ps(by, ay);
+		__m128 dz = _mm_sub_ps(bz, az);
+		__m128 len = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+		__m128 c0 = _mm_loadu_ps(p_c0 + i);
+		__m128 c1 = _mm_loadu_ps(p_c1 + i);
+		__m128 sum = _mm_add_ps(c1, len);
+		__m128 valid = _mm_and_ps(_mm_cmpgt_ps(c0, zero), _mm_cmpgt_ps(sum, epsilon));
+
+		// Invalid lanes may divide by zero, they are masked out right after.
+		__m128 k = _mm_mul_ps(_mm_div_ps(_mm_sub_ps(c1, len), _mm_mul_ps(c0, sum)), kst);
+		k = _mm_and_ps(valid, k);
+
+		__m128 ka = _mm_mul_ps(k, _mm_setr_ps(p_im[a[0]], p_im[a[1]], p_im[a[2]], p_im[a[3]]));
+		__m128 kb = _mm_mul_ps(k, _mm_setr_ps(p_im[b[0]], p_im[b[1]], p_im[b[2]], p_im[b[3]]));
+
+		float out[6][4];
+		_mm_storeu_ps(out[0], _mm_sub_ps(ax, _mm_mul_ps(dx, ka)));
+		_mm_storeu_ps(out[1], _mm_sub_ps(ay, _mm_mul_ps(dy, ka)));
+		_mm_storeu_ps(out[2], _mm_sub_ps(az, _mm_mul_ps(dz, ka)));
+		_mm_storeu_ps(out[3], _mm_add_ps(bx, _mm_mul_ps(dx, kb)));
+		_mm_storeu_ps(out[4], _mm_add_ps(by, _mm_mul_ps(dy, kb)));
+		_mm_storeu_ps(out[5], _mm_add_ps(bz, _mm_mul_ps(dz, kb)));
+
+		for (int j = 0; j < 4; ++j) {
+			r_x[a[j]] = out[0][j];
+			r_y[a[j]] = out[1][j];
+			r_z[a[j]] = out[2][j];
+			r_x[b[j]] = out[3][j];
+			r_y[b[j]] = out[4][j];
+			r_z[b[j]] = out[5][j];
+		}
+	}
+
+	_solve_links_scalar(p_node_a, p_node_b, p_c0, p_c1, i, p_end, p_kst, r_x, r_y, r_z, p_im);
+}
+#endif
+
+void SoftBody3DSW::_solve_link_range(uint32_t p_begin, uint32_t p_end, real_t p_kst, bool p_independent) {
+#ifdef SOFT_BODY_SSE2
+	if (p_independent) {
+		_solve_links_sse2(solver_link_a.ptr(), solver_link_b.ptr(), solver_link_c0.ptr(), solver_link_c1.ptr(), p_begin, p_end, p_kst, solver_x.ptr(), solver_y.ptr(), solver_z.ptr(), solver_im.ptr());
+		return;
+	}
+#endif
+	_solve_links_scalar(solver_link_a.ptr(), solver_link_b.ptr(), solver_link_c0.ptr(), solver_link_c1.ptr(), p_begin, p_end, p_kst, solver_x.ptr(), solver_y.ptr(), solver_z.ptr(), solver_im.ptr());
+}
+
+void SoftBody3DSW::_solve_link_batch(uint32_t p_batch_index, const LinkBatch *p_batch) {
+	uint32_t begin = p_batch->begin + p_batch_index * LINK_BATCH_SIZE;
+	uint32_t end = MIN(begin + LINK_BATCH_SIZE, p_batch->end);
+	_solve_link_range(begin, end, p_batch->kst, true);
+}
+
+void SoftBody3DSW::solve_links(real_t kst, ThreadWorkPool *p_work_pool) {
+	const uint32_t color_count = link_color_offsets.size() > 0 ? link_color_offsets.size() - 1 : 0;
+	for (uint32_t color = 0; color < color_count; ++color) {
+		LinkBatch batch;
+		batch.begin = link_color_offsets[color];
+		batch.end = link_color_offsets[color + 1];
+		batch.kst = kst;
+
+		// The last color holds the links that could not be colored, they may share nodes.
+		bool independent = (color < MAX_LINK_COLORS - 1);
+		uint32_t link_count = batch.end - batch.begin;
+
+		if (independent && p_work_pool && link_count >= LINK_BATCH_SIZE * LINK_PARALLEL_MIN_BATCHES) {
+			uint32_t batch_count = (link_count + LINK_BATCH_SIZE - 1) / LINK_BATCH_SIZE;
+			p_work_pool->do_work(batch_count, this, &SoftBody3DSW::_solve_link_batch, (const LinkBatch *)&batch);
+		} else {
+			_solve_link_range(batch.begin, batch.end, kst, independent);
+		}
+	}
+}
+
+#ifdef TESTS_ENABLED
+void SoftBody3DSW::solve_links_from(const Vector<Vector3> &p_positions, bool p_colored, ThreadWorkPool *p_work_pool, Vector<Vector3> &r_positions) {
+	const uint32_t node_count = nodes.size();
+	ERR_FAIL_COND(uint32_t(p_positions.size()) != node_count);
+
+	solver_x.resize(node_count);
+	solver_y.resize(node_count);
+	solver_z.resize(node_count);
+	solver_im.resize(node_count);
+	for (uint32_t i = 0; i < node_count; ++i) {
+		solver_x[i] = p_positions[i].x;
+		solver_y[i] = p_positions[i].y;
+		solver_z[i] = p_positions[i].z;
+		solver_im[i] = nodes[i].im;
+	}
+
+	if (p_colored) {
+		solve_links(1.0, p_work_pool);
+	} else {
+		_solve_links_scalar(solver_link_a.ptr(), solver_link_b.ptr(), solver_link_c0.ptr(), solver_link_c1.ptr(), 0, links.size(), 1.0, solver_x.ptr(), solver_y.ptr(), solver_z.ptr(), solver_im.ptr());
+	}
+
+	r_positions.resize(node_count);
+	for (uint32_t i = 0; i < node_count; ++i) {
+		r_positions.write[i] = Vector3(solver_x[i], solver_y[i], solver_z[i]);
+	}
+}
+#endif
+
 struct AABBQueryResult {
 	const SoftBody3DSW *soft_body = nullptr;
 	void *userdata = nullptr;
@@ -1149,6 +1247,9 @@ void SoftBody3DSW::destroy() {
 	links.clear();
 	faces.clear();
 
+	link_color_offsets.clear();
+	update_link_solver_data();
+
 	bounds = AABB();
 	deinitialize_shape();
 }
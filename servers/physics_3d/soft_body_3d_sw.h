@@ -38,12 +38,19 @@
 #include "core/math/vector3.h"
 #include "core/templates/local_vector.h"
 #include "core/templates/set.h"
+#include "core/templates/thread_work_pool.h"
 #include "core/templates/vset.h"
 #include "scene/resources/mesh.h"
 
 class Constraint3DSW;
 
 class SoftBody3DSW : public CollisionObject3DSW {
+	enum {
+		MAX_LINK_COLORS = 64,
+		LINK_BATCH_SIZE = 2048, // Links of a color solved by each thread.
+		LINK_PARALLEL_MIN_BATCHES = 4, // Smaller colors are faster to solve than to dispatch.
+	};
+
 	Ref<Mesh> soft_mesh;
 
 	struct Node {
@@ -81,6 +88,26 @@ class SoftBody3DSW : public CollisionObject3DSW {
 	LocalVector<Link> links;
 	LocalVector<Face> faces;
 
+	// Links are sorted by color, links of the same color share no node.
+	// Color i is links [link_color_offsets[i], link_color_offsets[i + 1]).
+	LocalVector<uint32_t> link_color_offsets;
+
+	// Link constants and node positions as separate arrays, for the link solver.
+	LocalVector<uint32_t> solver_link_a;
+	LocalVector<uint32_t> solver_link_b;
+	LocalVector<real_t> solver_link_c0;
+	LocalVector<real_t> solver_link_c1;
+	LocalVector<real_t> solver_x;
+	LocalVector<real_t> solver_y;
+	LocalVector<real_t> solver_z;
+	LocalVector<real_t> solver_im;
+
+	struct LinkBatch {
+		uint32_t begin = 0;
+		uint32_t end = 0;
+		real_t kst = 1.0;
+	};
+
 	DynamicBVH node_tree;
 	DynamicBVH face_tree;
 
@@ -178,7 +205,8 @@ public:
 	_FORCE_INLINE_ real_t get_drag_coefficient() const { return drag_coefficient; }
 
 	void predict_motion(real_t p_delta);
-	void solve_constraints(real_t p_delta);
+	// Links are solved on p_work_pool when given, it must not be already working.
+	void solve_constraints(real_t p_delta, ThreadWorkPool *p_work_pool = nullptr);
 
 	_FORCE_INLINE_ uint32_t get_node_index(void *p_node) const { return ((Node *)p_node)->index; }
 	_FORCE_INLINE_ uint32_t get_face_index(void *p_face) const { return ((Face *)p_face)->index; }
@@ -190,6 +218,11 @@ public:
 	void query_aabb(const AABB &p_aabb, QueryResultCallback p_result_callback, void *p_userdata);
 	void query_ray(const Vector3 &p_from, const Vector3 &p_to, QueryResultCallback p_result_callback, void *p_userdata);
 
+#ifdef TESTS_ENABLED
+	// One iteration of the link solver from p_positions, either colored or a plain scalar pass over the same links.
+	void solve_links_from(const Vector<Vector3> &p_positions, bool p_colored, ThreadWorkPool *p_work_pool, Vector<Vector3> &r_positions);
+#endif
+
 protected:
 	virtual void _shapes_changed();
 
@@ -209,11 +242,14 @@ private:
 
 	bool create_from_trimesh(const Vector<int> &p_indices, const Vector<Vector3> &p_vertices);
 	void generate_bending_constraints(int p_distance);
-	void reoptimize_link_order();
+	void update_link_colors();
+	void update_link_solver_data();
 	void append_link(uint32_t p_node1, uint32_t p_node2);
 	void append_face(uint32_t p_node1, uint32_t p_node2, uint32_t p_node3);
 
-	void solve_links(real_t kst, real_t ti);
+	void solve_links(real_t kst, ThreadWorkPool *p_work_pool);
+	void _solve_link_range(uint32_t p_begin, uint32_t p_end, real_t p_kst, bool p_independent);
+	void _solve_link_batch(uint32_t p_batch_index, const LinkBatch *p_batch);
 
 	void initialize_face_tree();
 	void update_face_tree(real_t p_delta);
@@ -33,6 +33,7 @@
 #include "collision_solver_3d_sw.h"
 #include "core/config/project_settings.h"
 #include "physics_server_3d_sw.h"
+#include "servers/physics_state_snapshot.h"
 
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObject3DSW *p_object, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 	if (!(p_object->get_collision_layer() & p_collision_mask)) {
@@ -54,6 +55,98 @@ _FORCE_INLINE_ static bool _can_collide_with(CollisionObject3DSW *p_object, uint
 	return true;
 }
 
+// Tests a segment against one shape of an object, the result is in world space.
+static bool _intersect_ray_shape(const CollisionObject3DSW *p_col_obj, int p_shape_idx, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) {
+	Transform3D inv_xform = p_col_obj->get_shape_inv_transform(p_shape_idx) * p_col_obj->get_inv_transform();
+
+	Vector3 local_from = inv_xform.xform(p_begin);
+	Vector3 local_to = inv_xform.xform(p_end);
+
+	const Shape3DSW *shape = p_col_obj->get_shape(p_shape_idx);
+
+	Vector3 shape_point, shape_normal;
+
+	if (!shape->intersect_segment(local_from, local_to, shape_point, shape_normal)) {
+		return false;
+	}
+
+	Transform3D xform = p_col_obj->get_transform() * p_col_obj->get_shape_transform(p_shape_idx);
+	r_point = xform.xform(shape_point);
+	r_normal = inv_xform.basis.xform_inv(shape_normal).normalized();
+	return true;
+}
+
+// Finds the safe and unsafe fractions of a motion against one shape of an object.
+// Returns false if the shape is not hit, or if the motion starts inside it.
+static bool _cast_motion_shape(const Shape3DSW *p_shape, const Transform3D &p_xform, const Transform3D &p_xform_inv, const Vector3 &p_motion, const AABB &p_aabb, const CollisionObject3DSW *p_col_obj, int p_shape_idx, real_t &r_low, real_t &r_hi, Vector3 &r_point_A, Vector3 &r_point_B) {
+	MotionShape3DSW mshape;
+	mshape.shape = const_cast<Shape3DSW *>(p_shape);
+	mshape.motion = p_xform_inv.basis.xform(p_motion);
+
+	Vector3 motion_normal = p_motion.normalized();
+
+	Vector3 point_A, point_B;
+	Vector3 sep_axis = motion_normal;
+
+	const Shape3DSW *col_shape = p_col_obj->get_shape(p_shape_idx);
+	Transform3D col_obj_xform = p_col_obj->get_transform() * p_col_obj->get_shape_transform(p_shape_idx);
+	//test initial overlap, does it collide if going all the way?
+	if (CollisionSolver3DSW::solve_distance(&mshape, p_xform, col_shape, col_obj_xform, point_A, point_B, p_aabb, &sep_axis)) {
+		return false;
+	}
+
+	//test initial overlap, ignore objects it's inside of.
+	sep_axis = motion_normal;
+
+	if (!CollisionSolver3DSW::solve_distance(p_shape, p_xform, col_shape, col_obj_xform, point_A, point_B, p_aabb, &sep_axis)) {
+		return false;
+	}
+
+	//just do kinematic solving
+	real_t low = 0.0;
+	real_t hi = 1.0;
+	real_t fraction_coeff = 0.5;
+	for (int j = 0; j < 8; j++) { //steps should be customizable..
+		real_t fraction = low + (hi - low) * fraction_coeff;
+
+		mshape.motion = p_xform_inv.basis.xform(p_motion * fraction);
+
+		Vector3 lA, lB;
+		Vector3 sep = motion_normal; //important optimization for this to work fast enough
+		bool collided = !CollisionSolver3DSW::solve_distance(&mshape, p_xform, col_shape, col_obj_xform, lA, lB, p_aabb, &sep);
+
+		if (collided) {
+			hi = fraction;
+			if ((j == 0) || (low > 0.0)) { // Did it not collide before?
+				// When alternating or first iteration, use dichotomy.
+				fraction_coeff = 0.5;
+			} else {
+				// When colliding again, converge faster towards low fraction
+				// for more accurate results with long motions that collide near the start.
+				fraction_coeff = 0.25;
+			}
+		} else {
+			point_A = lA;
+			point_B = lB;
+			low = fraction;
+			if ((j == 0) || (hi < 1.0)) { // Did it collide before?
+				// When alternating or first iteration, use dichotomy.
+				fraction_coeff = 0.5;
+			} else {
+				// When not colliding again, converge faster towards high fraction
+				// for more accurate results with long motions that collide near the end.
+				fraction_coeff = 0.75;
+			}
+		}
+	}
+
+	r_low = low;
+	r_hi = hi;
+	r_point_A = point_A;
+	r_point_B = point_B;
+	return true;
+}
+
 int PhysicsDirectSpaceState3DSW::intersect_point(const Vector3 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 	ERR_FAIL_COND_V(space->locked, false);
 	int amount = space->broadphase->cull_point(p_point, space->intersection_query_results, Space3DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
@@ -136,25 +229,16 @@ bool PhysicsDirectSpaceState3DSW::intersect_ray(const Vector3 &p_from, const Vec
 		const CollisionObject3DSW *col_obj = space->intersection_query_results[i];
 
 		int shape_idx = space->intersection_query_subindex_results[i];
-		Transform3D inv_xform = col_obj->get_shape_inv_transform(shape_idx) * col_obj->get_inv_transform();
-
-		Vector3 local_from = inv_xform.xform(begin);
-		Vector3 local_to = inv_xform.xform(end);
-
-		const Shape3DSW *shape = col_obj->get_shape(shape_idx);
 
 		Vector3 shape_point, shape_normal;
 
-		if (shape->intersect_segment(local_from, local_to, shape_point, shape_normal)) {
-			Transform3D xform = col_obj->get_transform() * col_obj->get_shape_transform(shape_idx);
-			shape_point = xform.xform(shape_point);
-
+		if (_intersect_ray_shape(col_obj, shape_idx, begin, end, shape_point, shape_normal)) {
 			real_t ld = normal.dot(shape_point);
 
 			if (ld < min_d) {
 				min_d = ld;
 				res_point = shape_point;
-				res_normal = inv_xform.basis.xform_inv(shape_normal).normalized();
+				res_normal = shape_normal;
 				res_shape = shape_idx;
 				res_obj = col_obj;
 				collided = true;
@@ -249,14 +333,9 @@ bool PhysicsDirectSpaceState3DSW::cast_motion(const RID &p_shape, const Transfor
 	real_t best_unsafe = 1;
 
 	Transform3D xform_inv = p_xform.affine_inverse();
-	MotionShape3DSW mshape;
-	mshape.shape = shape;
-	mshape.motion = xform_inv.basis.xform(p_motion);
 
 	bool best_first = true;
 
-	Vector3 motion_normal = p_motion.normalized();
-
 	Vector3 closest_A, closest_B;
 
 	for (int i = 0; i < amount; i++) {
@@ -272,59 +351,11 @@ bool PhysicsDirectSpaceState3DSW::cast_motion(const RID &p_shape, const Transfor
 		int shape_idx = space->intersection_query_subindex_results[i];
 
 		Vector3 point_A, point_B;
-		Vector3 sep_axis = motion_normal;
-
-		Transform3D col_obj_xform = col_obj->get_transform() * col_obj->get_shape_transform(shape_idx);
-		//test initial overlap, does it collide if going all the way?
-		if (CollisionSolver3DSW::solve_distance(&mshape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, aabb, &sep_axis)) {
+		real_t low, hi;
+		if (!_cast_motion_shape(shape, p_xform, xform_inv, p_motion, aabb, col_obj, shape_idx, low, hi, point_A, point_B)) {
 			continue;
 		}
 
-		//test initial overlap, ignore objects it's inside of.
-		sep_axis = motion_normal;
-
-		if (!CollisionSolver3DSW::solve_distance(shape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, aabb, &sep_axis)) {
-			continue;
-		}
-
-		//just do kinematic solving
-		real_t low = 0.0;
-		real_t hi = 1.0;
-		real_t fraction_coeff = 0.5;
-		for (int j = 0; j < 8; j++) { //steps should be customizable..
-			real_t fraction = low + (hi - low) * fraction_coeff;
-
-			mshape.motion = xform_inv.basis.xform(p_motion * fraction);
-
-			Vector3 lA, lB;
-			Vector3 sep = motion_normal; //important optimization for this to work fast enough
-			bool collided = !CollisionSolver3DSW::solve_distance(&mshape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, lA, lB, aabb, &sep);
-
-			if (collided) {
-				hi = fraction;
-				if ((j == 0) || (low > 0.0)) { // Did it not collide before?
-					// When alternating or first iteration, use dichotomy.
-					fraction_coeff = 0.5;
-				} else {
-					// When colliding again, converge faster towards low fraction
-					// for more accurate results with long motions that collide near the start.
-					fraction_coeff = 0.25;
-				}
-			} else {
-				point_A = lA;
-				point_B = lB;
-				low = fraction;
-				if ((j == 0) || (hi < 1.0)) { // Did it collide before?
-					// When alternating or first iteration, use dichotomy.
-					fraction_coeff = 0.5;
-				} else {
-					// When not colliding again, converge faster towards high fraction
-					// for more accurate results with long motions that collide near the end.
-					fraction_coeff = 0.75;
-				}
-			}
-		}
-
 		if (low < best_safe) {
 			best_first = true; //force reset
 			best_safe = low;
@@ -354,6 +385,216 @@ bool PhysicsDirectSpaceState3DSW::cast_motion(const RID &p_shape, const Transfor
 	return true;
 }
 
+void PhysicsDirectSpaceState3DSW::_collect_batch_candidates(QueryBatch &r_batch, const AABB *p_aabbs, int p_count, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	// The broadphase and the shared result buffers are not thread safe, so all culling happens here.
+	// Queries issued close to each other (a fan of rays, a group of agents) usually share most of their
+	// candidates, in that case the tree is traversed once for the whole batch.
+	AABB merged = p_aabbs[0];
+	for (int i = 1; i < p_count; i++) {
+		merged.merge_with(p_aabbs[i]);
+	}
+
+	int amount = space->broadphase->cull_aabb(merged, space->intersection_query_results, Space3DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+	r_batch.shared = amount <= BATCH_SHARED_CULL_MAX;
+
+	int query_count = r_batch.shared ? 1 : p_count;
+	r_batch.offsets.resize(query_count + 1);
+
+	for (int q = 0; q < query_count; q++) {
+		r_batch.offsets[q] = r_batch.objects.size();
+
+		if (!r_batch.shared) {
+			if (r_batch.from) {
+				amount = space->broadphase->cull_segment(r_batch.from[q], r_batch.to[q], space->intersection_query_results, Space3DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+			} else {
+				amount = space->broadphase->cull_aabb(p_aabbs[q], space->intersection_query_results, Space3DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+			}
+		}
+
+		for (int i = 0; i < amount; i++) {
+			CollisionObject3DSW *col_obj = space->intersection_query_results[i];
+			if (!_can_collide_with(col_obj, p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
+				continue;
+			}
+
+			if (p_exclude.has(col_obj->get_self())) {
+				continue;
+			}
+
+			r_batch.objects.push_back(col_obj);
+			r_batch.shapes.push_back(space->intersection_query_subindex_results[i]);
+		}
+	}
+
+	r_batch.offsets[query_count] = r_batch.objects.size();
+}
+
+void PhysicsDirectSpaceState3DSW::_run_batch(QueryBatch *p_batch, int p_count, void (PhysicsDirectSpaceState3DSW::*p_method)(uint32_t, QueryBatch *)) {
+	// The space is unlocked, so no step is using the pool right now.
+	if (p_count >= BATCH_MIN_PARALLEL_QUERIES) {
+		PhysicsServer3DSW::singletonsw->stepper->get_work_pool().do_work(p_count, this, p_method, p_batch);
+		return;
+	}
+
+	for (int i = 0; i < p_count; i++) {
+		(this->*p_method)(i, p_batch);
+	}
+}
+
+void PhysicsDirectSpaceState3DSW::_intersect_ray_batch(uint32_t p_index, QueryBatch *p_batch) {
+	const Vector3 &begin = p_batch->from[p_index];
+	const Vector3 &end = p_batch->to[p_index];
+	Vector3 normal = (end - begin).normalized();
+
+	uint32_t range = p_batch->shared ? 0 : p_index;
+	uint32_t from = p_batch->offsets[range];
+	uint32_t to = p_batch->offsets[range + 1];
+
+	bool collided = false;
+	Vector3 res_point, res_normal;
+	int res_shape = 0;
+	const CollisionObject3DSW *res_obj = nullptr;
+	real_t min_d = 1e10;
+
+	for (uint32_t i = from; i < to; i++) {
+		const CollisionObject3DSW *col_obj = p_batch->objects[i];
+		int shape_idx = p_batch->shapes[i];
+
+		if (p_batch->shared && !col_obj->get_shape_aabb(shape_idx).intersects_segment(begin, end)) {
+			continue;
+		}
+
+		Vector3 shape_point, shape_normal;
+
+		if (_intersect_ray_shape(col_obj, shape_idx, begin, end, shape_point, shape_normal)) {
+			real_t ld = normal.dot(shape_point);
+
+			if (ld < min_d) {
+				min_d = ld;
+				res_point = shape_point;
+				res_normal = shape_normal;
+				res_shape = shape_idx;
+				res_obj = col_obj;
+				collided = true;
+			}
+		}
+	}
+
+	p_batch->ray_hits[p_index] = collided;
+	if (!collided) {
+		return;
+	}
+
+	RayResult &r_result = p_batch->ray_results[p_index];
+	r_result.collider_id = res_obj->get_instance_id();
+	if (r_result.collider_id.is_valid()) {
+		r_result.collider = ObjectDB::get_instance(r_result.collider_id);
+	} else {
+		r_result.collider = nullptr;
+	}
+	r_result.normal = res_normal;
+	r_result.position = res_point;
+	r_result.rid = res_obj->get_self();
+	r_result.shape = res_shape;
+}
+
+void PhysicsDirectSpaceState3DSW::_cast_motion_batch(uint32_t p_index, QueryBatch *p_batch) {
+	const Transform3D &xform = p_batch->xforms[p_index];
+	const Vector3 &motion = p_batch->motions[p_index];
+	const AABB &aabb = p_batch->aabbs[p_index];
+	Transform3D xform_inv = xform.affine_inverse();
+
+	uint32_t range = p_batch->shared ? 0 : p_index;
+	uint32_t from = p_batch->offsets[range];
+	uint32_t to = p_batch->offsets[range + 1];
+
+	real_t best_safe = 1;
+	real_t best_unsafe = 1;
+
+	for (uint32_t i = from; i < to; i++) {
+		const CollisionObject3DSW *col_obj = p_batch->objects[i];
+		int shape_idx = p_batch->shapes[i];
+
+		if (p_batch->shared && !col_obj->get_shape_aabb(shape_idx).intersects(aabb)) {
+			continue;
+		}
+
+		Vector3 point_A, point_B;
+		real_t low, hi;
+		if (!_cast_motion_shape(p_batch->shape, xform, xform_inv, motion, aabb, col_obj, shape_idx, low, hi, point_A, point_B)) {
+			continue;
+		}
+
+		if (low < best_safe) {
+			best_safe = low;
+			best_unsafe = hi;
+		}
+	}
+
+	p_batch->closest_safe[p_index] = best_safe;
+	p_batch->closest_unsafe[p_index] = best_unsafe;
+}
+
+int PhysicsDirectSpaceState3DSW::intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND_V(space->locked, 0);
+	if (p_count <= 0) {
+		return 0;
+	}
+
+	LocalVector<AABB> aabbs;
+	aabbs.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		AABB &aabb = aabbs[i];
+		aabb.position = p_from[i];
+		aabb.expand_to(p_to[i]);
+	}
+
+	QueryBatch batch;
+	batch.from = p_from;
+	batch.to = p_to;
+	batch.ray_results = r_results;
+	batch.ray_hits = r_hits;
+
+	_collect_batch_candidates(batch, aabbs.ptr(), p_count, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+	_run_batch(&batch, p_count, &PhysicsDirectSpaceState3DSW::_intersect_ray_batch);
+
+	int hits = 0;
+	for (int i = 0; i < p_count; i++) {
+		if (r_hits[i]) {
+			hits++;
+		}
+	}
+	return hits;
+}
+
+void PhysicsDirectSpaceState3DSW::cast_motions(const RID &p_shape, const Transform3D *p_xforms, const Vector3 *p_motions, int p_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND(space->locked);
+	Shape3DSW *shape = PhysicsServer3DSW::singletonsw->shape_owner.getornull(p_shape);
+	ERR_FAIL_COND(!shape);
+	if (p_count <= 0) {
+		return;
+	}
+
+	LocalVector<AABB> aabbs;
+	aabbs.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		AABB aabb = p_xforms[i].xform(shape->get_aabb());
+		aabb = aabb.merge(AABB(aabb.position + p_motions[i], aabb.size)); //motion
+		aabbs[i] = aabb.grow(p_margin);
+	}
+
+	QueryBatch batch;
+	batch.shape = shape;
+	batch.xforms = p_xforms;
+	batch.motions = p_motions;
+	batch.aabbs = aabbs.ptr();
+	batch.closest_safe = r_closest_safe;
+	batch.closest_unsafe = r_closest_unsafe;
+
+	_collect_batch_candidates(batch, aabbs.ptr(), p_count, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+	_run_batch(&batch, p_count, &PhysicsDirectSpaceState3DSW::_cast_motion_batch);
+}
+
 bool PhysicsDirectSpaceState3DSW::collide_shape(RID p_shape, const Transform3D &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 	if (p_result_max <= 0) {
 		return false;
@@ -1104,6 +1345,11 @@ void *Space3DSW::_broadphase_pair(CollisionObject3DSW *A, int p_subindex_A, Coll
 			BodySoftBodyPair3DSW *soft_pair = memnew(BodySoftBodyPair3DSW((Body3DSW *)A, p_subindex_A, (SoftBody3DSW *)B));
 			return soft_pair;
 		} else {
+			if (self->deterministic && A->get_self().get_id() > B->get_self().get_id()) {
+				// Put the older body first, so the pair gets the same key whenever it's created again.
+				SWAP(A, B);
+				SWAP(p_subindex_A, p_subindex_B);
+			}
 			BodyPair3DSW *b = memnew(BodyPair3DSW((Body3DSW *)A, p_subindex_A, (Body3DSW *)B, p_subindex_B));
 			return b;
 		}
@@ -1129,6 +1375,10 @@ const SelfList<Body3DSW>::List &Space3DSW::get_active_body_list() const {
 	return active_list;
 }
 
+void Space3DSW::body_pair_add_to_list(SelfList<BodyPair3DSW> *p_pair) {
+	body_pair_list.add(p_pair);
+}
+
 void Space3DSW::body_add_to_active_list(SelfList<Body3DSW> *p_body) {
 	active_list.add(p_body);
 }
@@ -1225,6 +1475,122 @@ void Space3DSW::setup() {
 	}
 }
 
+// Objects are identified by RID, so snapshots can only be restored in the session that saved them.
+#define SPACE_STATE_MAGIC 0x53443353 // "S3DS"
+
+typedef PhysicsStateSnapshot::Writer<Body3DSW, BodyPair3DSW> SpaceStateWriter3DSW;
+typedef PhysicsStateSnapshot::Reader<Body3DSW, BodyPair3DSW> SpaceStateReader3DSW;
+
+struct PairSortEntry3DSW {
+	uint64_t key[PhysicsStateSnapshot::PAIR_KEY_SIZE];
+	BodyPair3DSW *pair;
+};
+
+struct PairSortEntry3DSWComparator {
+	_FORCE_INLINE_ bool operator()(const PairSortEntry3DSW &p_a, const PairSortEntry3DSW &p_b) const { return PhysicsStateSnapshot::compare_pair_keys(p_a.key, p_b.key) < 0; }
+};
+
+struct BodyIDComparator3DSW {
+	_FORCE_INLINE_ bool operator()(const Body3DSW *p_a, const Body3DSW *p_b) const { return p_a->get_self().get_id() < p_b->get_self().get_id(); }
+};
+
+static void _get_sorted_bodies(const Set<CollisionObject3DSW *> &p_objects, LocalVector<Body3DSW *> &r_bodies) {
+	for (const Set<CollisionObject3DSW *>::Element *E = p_objects.front(); E; E = E->next()) {
+		if (E->get()->get_type() == CollisionObject3DSW::TYPE_BODY) {
+			r_bodies.push_back(static_cast<Body3DSW *>(E->get()));
+		}
+	}
+	r_bodies.sort_custom<BodyIDComparator3DSW>();
+}
+
+// Pair keys are not stored in 3D pairs, they are gathered once per save or restore.
+static void _get_sorted_pairs(const SelfList<BodyPair3DSW>::List &p_list, bool p_touching_only, LocalVector<PairSortEntry3DSW> &r_pairs) {
+	for (const SelfList<BodyPair3DSW> *E = p_list.first(); E; E = E->next()) {
+		if (p_touching_only && !E->self()->has_state()) {
+			continue;
+		}
+		PairSortEntry3DSW entry;
+		E->self()->get_key(entry.key);
+		entry.pair = E->self();
+		r_pairs.push_back(entry);
+	}
+	r_pairs.sort_custom<PairSortEntry3DSWComparator>();
+}
+
+PackedByteArray Space3DSW::save_state() const {
+	ERR_FAIL_COND_V(locked, PackedByteArray());
+
+	LocalVector<Body3DSW *> bodies;
+	_get_sorted_bodies(objects, bodies);
+
+	LocalVector<PairSortEntry3DSW> pairs;
+	_get_sorted_pairs(body_pair_list, true, pairs);
+
+	SpaceStateWriter3DSW writer(SPACE_STATE_MAGIC, bodies.size(), pairs.size());
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		writer.write_body(bodies[i]->get_self().get_id(), bodies[i]);
+	}
+	for (uint32_t i = 0; i < pairs.size(); i++) {
+		writer.write_pair(pairs[i].key, pairs[i].pair);
+	}
+
+	return writer.get_data();
+}
+
+Error Space3DSW::restore_state(const PackedByteArray &p_state) {
+	ERR_FAIL_COND_V(locked, ERR_BUSY);
+
+	SpaceStateReader3DSW reader;
+	Error err = reader.open(p_state, SPACE_STATE_MAGIC);
+	if (err != OK) {
+		return err;
+	}
+
+	LocalVector<Body3DSW *> bodies;
+	_get_sorted_bodies(objects, bodies);
+
+	// Freed bodies are skipped, their RIDs are never handed out again.
+	uint32_t body_index = 0;
+	for (uint32_t i = 0; i < reader.get_body_count(); i++) {
+		PhysicsStateSnapshot::BodyEntry<Body3DSW> entry;
+		reader.read_body(entry);
+
+		while (body_index < bodies.size() && bodies[body_index]->get_self().get_id() < entry.id) {
+			body_index++;
+		}
+		if (body_index < bodies.size() && bodies[body_index]->get_self().get_id() == entry.id) {
+			bodies[body_index]->restore_state(entry.state);
+		}
+	}
+
+	// Create and remove the pairs for the restored transforms before matching them.
+	broadphase->update();
+
+	LocalVector<PairSortEntry3DSW> pairs;
+	_get_sorted_pairs(body_pair_list, false, pairs);
+
+	// Outside of deterministic mode, a pair created again in the other order gets a different key and starts over.
+	uint32_t pair_index = 0;
+	for (uint32_t i = 0; i < reader.get_pair_count(); i++) {
+		PhysicsStateSnapshot::PairEntry<BodyPair3DSW> entry;
+		reader.read_pair(entry);
+
+		while (pair_index < pairs.size() && PhysicsStateSnapshot::compare_pair_keys(pairs[pair_index].key, entry.key) < 0) {
+			pairs[pair_index].pair->clear_state();
+			pair_index++;
+		}
+		if (pair_index < pairs.size() && PhysicsStateSnapshot::compare_pair_keys(pairs[pair_index].key, entry.key) == 0) {
+			pairs[pair_index].pair->restore_state(entry.state);
+			pair_index++;
+		}
+	}
+	for (; pair_index < pairs.size(); pair_index++) {
+		pairs[pair_index].pair->clear_state();
+	}
+
+	return OK;
+}
+
 void Space3DSW::update() {
 	broadphase->update();
 }
@@ -1319,6 +1685,8 @@ Space3DSW::Space3DSW() {
 	body_time_to_sleep = GLOBAL_DEF("physics/3d/time_before_sleep", 0.5);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/time_before_sleep", PropertyInfo(Variant::FLOAT, "physics/3d/time_before_sleep", PROPERTY_HINT_RANGE, "0,5,0.01,or_greater"));
 	body_angular_velocity_damp_ratio = 10;
+	use_speculative_contacts = GLOBAL_DEF("physics/3d/use_speculative_contacts", false);
+	deterministic = GLOBAL_DEF("physics/3d/deterministic", false);
 
 	broadphase = BroadPhase3DSW::create_func();
 	broadphase->set_pair_callback(_broadphase_pair, this);
@@ -39,12 +39,46 @@
 #include "collision_object_3d_sw.h"
 #include "core/config/project_settings.h"
 #include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/typedefs.h"
 #include "soft_body_3d_sw.h"
 
 class PhysicsDirectSpaceState3DSW : public PhysicsDirectSpaceState3D {
 	GDCLASS(PhysicsDirectSpaceState3DSW, PhysicsDirectSpaceState3D);
 
+	enum {
+		// Batches with fewer queries run on the calling thread.
+		BATCH_MIN_PARALLEL_QUERIES = 32,
+		// When the merged bounds of a batch contain more shapes, each query is culled separately.
+		BATCH_SHARED_CULL_MAX = 64,
+	};
+
+	// Broadphase candidates of a batch of queries, either shared by all of them
+	// or in a range per query given by offsets.
+	struct QueryBatch {
+		LocalVector<CollisionObject3DSW *> objects;
+		LocalVector<int> shapes;
+		LocalVector<uint32_t> offsets;
+		bool shared = false;
+
+		const Vector3 *from = nullptr;
+		const Vector3 *to = nullptr;
+		RayResult *ray_results = nullptr;
+		bool *ray_hits = nullptr;
+
+		const Shape3DSW *shape = nullptr;
+		const Transform3D *xforms = nullptr;
+		const Vector3 *motions = nullptr;
+		const AABB *aabbs = nullptr;
+		real_t *closest_safe = nullptr;
+		real_t *closest_unsafe = nullptr;
+	};
+
+	void _collect_batch_candidates(QueryBatch &r_batch, const AABB *p_aabbs, int p_count, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas);
+	void _run_batch(QueryBatch *p_batch, int p_count, void (PhysicsDirectSpaceState3DSW::*p_method)(uint32_t, QueryBatch *));
+	void _intersect_ray_batch(uint32_t p_index, QueryBatch *p_batch);
+	void _cast_motion_batch(uint32_t p_index, QueryBatch *p_batch);
+
 public:
 	Space3DSW *space;
 
@@ -56,6 +90,9 @@ public:
 	virtual bool rest_info(RID p_shape, const Transform3D &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
 	virtual Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const override;
 
+	virtual int intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
+	virtual void cast_motions(const RID &p_shape, const Transform3D *p_xforms, const Vector3 *p_motions, int p_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
+
 	PhysicsDirectSpaceState3DSW();
 };
 
@@ -84,6 +121,7 @@ private:
 	SelfList<Area3DSW>::List monitor_query_list;
 	SelfList<Area3DSW>::List area_moved_list;
 	SelfList<SoftBody3DSW>::List active_soft_body_list;
+	SelfList<BodyPair3DSW>::List body_pair_list;
 
 	static void *_broadphase_pair(CollisionObject3DSW *A, int p_subindex_A, CollisionObject3DSW *B, int p_subindex_B, void *p_self);
 	static void _broadphase_unpair(CollisionObject3DSW *A, int p_subindex_A, CollisionObject3DSW *B, int p_subindex_B, void *p_data, void *p_self);
@@ -95,6 +133,8 @@ private:
 	real_t contact_recycle_radius;
 	real_t contact_max_separation;
 	real_t contact_max_allowed_penetration;
+	bool use_speculative_contacts;
+	bool deterministic;
 	real_t constraint_bias;
 	real_t test_motion_min_contact_depth;
 
@@ -151,6 +191,8 @@ public:
 	void soft_body_add_to_active_list(SelfList<SoftBody3DSW> *p_soft_body);
 	void soft_body_remove_from_active_list(SelfList<SoftBody3DSW> *p_soft_body);
 
+	void body_pair_add_to_list(SelfList<BodyPair3DSW> *p_pair);
+
 	BroadPhase3DSW *get_broadphase();
 
 	void add_object(CollisionObject3DSW *p_object);
@@ -160,6 +202,8 @@ public:
 	_FORCE_INLINE_ real_t get_contact_recycle_radius() const { return contact_recycle_radius; }
 	_FORCE_INLINE_ real_t get_contact_max_separation() const { return contact_max_separation; }
 	_FORCE_INLINE_ real_t get_contact_max_allowed_penetration() const { return contact_max_allowed_penetration; }
+	_FORCE_INLINE_ bool is_using_speculative_contacts() const { return use_speculative_contacts; }
+	_FORCE_INLINE_ bool is_deterministic() const { return deterministic; }
 	_FORCE_INLINE_ real_t get_constraint_bias() const { return constraint_bias; }
 	_FORCE_INLINE_ real_t get_body_linear_velocity_sleep_threshold() const { return body_linear_velocity_sleep_threshold; }
 	_FORCE_INLINE_ real_t get_body_angular_velocity_sleep_threshold() const { return body_angular_velocity_sleep_threshold; }
@@ -174,6 +218,9 @@ public:
 	void lock();
 	void unlock();
 
+	PackedByteArray save_state() const;
+	Error restore_state(const PackedByteArray &p_state);
+
 	void set_param(PhysicsServer3D::SpaceParameter p_param, real_t p_value);
 	real_t get_param(PhysicsServer3D::SpaceParameter p_param) const;
 
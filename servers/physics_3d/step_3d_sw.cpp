@@ -38,6 +38,19 @@
 #define ISLAND_COUNT_RESERVE 128
 #define ISLAND_SIZE_RESERVE 512
 #define CONSTRAINT_COUNT_RESERVE 1024
+#define ACTIVE_BODY_COUNT_RESERVE 1024
+
+void Step3DSW::_integrate_forces(uint32_t p_body_index, void *p_userdata) {
+	active_bodies[p_body_index]->integrate_forces(delta);
+}
+
+void Step3DSW::_integrate_velocities(uint32_t p_body_index, void *p_userdata) {
+	active_bodies[p_body_index]->integrate_velocities(delta);
+}
+
+void Step3DSW::_solve_soft_body_constraints(uint32_t p_soft_body_index, void *p_userdata) {
+	active_soft_bodies[p_soft_body_index]->solve_constraints(delta);
+}
 
 void Step3DSW::_populate_island(Body3DSW *p_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island) {
 	p_body->set_island_step(_step);
@@ -197,15 +210,30 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
 	uint64_t profile_endtime = 0;
 
-	int active_count = 0;
-
 	const SelfList<Body3DSW> *b = body_list->first();
 	while (b) {
-		b->self()->integrate_forces(p_delta);
+		active_bodies.push_back(b->self());
 		b = b->next();
-		active_count++;
 	}
 
+	uint32_t active_body_count = active_bodies.size();
+	work_pool.do_work(active_body_count, this, &Step3DSW::_integrate_forces, nullptr);
+
+	// Broadphase updates can't run on threads.
+	bool ccd_motion = false;
+	for (uint32_t body_index = 0; body_index < active_body_count; ++body_index) {
+		Body3DSW *body = active_bodies[body_index];
+		body->integrate_forces_sync();
+		ccd_motion = ccd_motion || body->is_continuous_collision_detection_enabled();
+	}
+
+	// CCD needs the pairs along the motion of this step, not the last one.
+	if (ccd_motion) {
+		p_space->update();
+	}
+
+	int active_count = active_body_count;
+
 	/* UPDATE SOFT BODY MOTION */
 
 	const SelfList<SoftBody3DSW> *sb = soft_body_list->first();
@@ -370,11 +398,20 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* INTEGRATE VELOCITIES */
 
+	// Contacts wake sleeping bodies up during pre-solve, gather the list again so they move in this step too.
+	active_bodies.clear();
 	b = body_list->first();
 	while (b) {
-		const SelfList<Body3DSW> *n = b->next();
-		b->self()->integrate_velocities(p_delta);
-		b = n;
+		active_bodies.push_back(b->self());
+		b = b->next();
+	}
+
+	active_body_count = active_bodies.size();
+	work_pool.do_work(active_body_count, this, &Step3DSW::_integrate_velocities, nullptr);
+
+	// Bodies may leave the active list here, which is why the list gathered before integration is used.
+	for (uint32_t body_index = 0; body_index < active_body_count; ++body_index) {
+		active_bodies[body_index]->integrate_velocities_sync();
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
@@ -387,10 +424,18 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	sb = soft_body_list->first();
 	while (sb) {
-		sb->self()->solve_constraints(p_delta);
+		active_soft_bodies.push_back(sb->self());
 		sb = sb->next();
 	}
 
+	// Soft bodies are solved in parallel, a single one splits its own links across the threads instead.
+	uint32_t active_soft_body_count = active_soft_bodies.size();
+	if (active_soft_body_count > 1) {
+		work_pool.do_work(active_soft_body_count, this, &Step3DSW::_solve_soft_body_constraints, nullptr);
+	} else if (active_soft_body_count > 0) {
+		active_soft_bodies[0]->solve_constraints(p_delta, &work_pool);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space3DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
@@ -398,6 +443,8 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 	}
 
 	all_constraints.clear();
+	active_bodies.clear();
+	active_soft_bodies.clear();
 
 	p_space->update();
 	p_space->unlock();
@@ -410,6 +457,7 @@ Step3DSW::Step3DSW() {
 	body_islands.reserve(BODY_ISLAND_COUNT_RESERVE);
 	constraint_islands.reserve(ISLAND_COUNT_RESERVE);
 	all_constraints.reserve(CONSTRAINT_COUNT_RESERVE);
+	active_bodies.reserve(ACTIVE_BODY_COUNT_RESERVE);
 
 	work_pool.init();
 }
@@ -47,7 +47,12 @@ class Step3DSW {
 	LocalVector<LocalVector<Body3DSW *>> body_islands;
 	LocalVector<LocalVector<Constraint3DSW *>> constraint_islands;
 	LocalVector<Constraint3DSW *> all_constraints;
+	LocalVector<Body3DSW *> active_bodies;
+	LocalVector<SoftBody3DSW *> active_soft_bodies;
 
+	void _integrate_forces(uint32_t p_body_index, void *p_userdata = nullptr);
+	void _integrate_velocities(uint32_t p_body_index, void *p_userdata = nullptr);
+	void _solve_soft_body_constraints(uint32_t p_soft_body_index, void *p_userdata = nullptr);
 	void _populate_island(Body3DSW *p_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island);
 	void _populate_island_soft_body(SoftBody3DSW *p_soft_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island);
 	void _setup_contraint(uint32_t p_constraint_index, void *p_userdata = nullptr);
@@ -56,6 +61,8 @@ class Step3DSW {
 	void _check_suspend(const LocalVector<Body3DSW *> &p_body_island) const;
 
 public:
+	_FORCE_INLINE_ ThreadWorkPool &get_work_pool() { return work_pool; }
+
 	void step(Space3DSW *p_space, real_t p_delta, int p_iterations);
 	Step3DSW();
 	~Step3DSW();
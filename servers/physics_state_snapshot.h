@@ -0,0 +1,157 @@
+/*************************************************************************/
+/*  physics_state_snapshot.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PHYSICS_STATE_SNAPSHOT_H
+#define PHYSICS_STATE_SNAPSHOT_H
+
+#include "core/error/error_list.h"
+#include "core/error/error_macros.h"
+#include "core/variant/variant.h"
+
+// Space state snapshots of the 2D and 3D physics servers.
+// Layout: the header, then the bodies sorted by ID, then the body pairs sorted by key.
+// Values are stored in native format, snapshots are meant to be restored by the same build.
+class PhysicsStateSnapshot {
+public:
+	enum {
+		VERSION = 1,
+		PAIR_KEY_SIZE = 3,
+	};
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t real_size;
+		uint32_t body_count;
+		uint32_t pair_count;
+	};
+
+	template <class T>
+	struct BodyEntry {
+		uint64_t id;
+		typename T::State state;
+	};
+
+	template <class T>
+	struct PairEntry {
+		uint64_t key[PAIR_KEY_SIZE];
+		typename T::State state;
+	};
+
+	// Pair keys are made of object IDs and shape indices, compared in order.
+	_FORCE_INLINE_ static int compare_pair_keys(const uint64_t *p_a, const uint64_t *p_b) {
+		for (int i = 0; i < PAIR_KEY_SIZE; i++) {
+			if (p_a[i] != p_b[i]) {
+				return p_a[i] < p_b[i] ? -1 : 1;
+			}
+		}
+		return 0;
+	}
+
+	template <class TBody, class TPair>
+	class Writer {
+		PackedByteArray data;
+		uint8_t *w = nullptr;
+
+	public:
+		void write_body(uint64_t p_id, const TBody *p_body) {
+			BodyEntry<TBody> entry;
+			// Records are compared byte by byte, so the padding must not hold leftovers.
+			memset(&entry, 0, sizeof(BodyEntry<TBody>));
+			entry.id = p_id;
+			p_body->save_state(entry.state);
+			memcpy(w, &entry, sizeof(BodyEntry<TBody>));
+			w += sizeof(BodyEntry<TBody>);
+		}
+
+		void write_pair(const uint64_t *p_key, const TPair *p_pair) {
+			PairEntry<TPair> entry;
+			memset(&entry, 0, sizeof(PairEntry<TPair>));
+			memcpy(entry.key, p_key, sizeof(entry.key));
+			p_pair->save_state(entry.state);
+			memcpy(w, &entry, sizeof(PairEntry<TPair>));
+			w += sizeof(PairEntry<TPair>);
+		}
+
+		const PackedByteArray &get_data() const { return data; }
+
+		Writer(uint32_t p_magic, uint32_t p_body_count, uint32_t p_pair_count) {
+			data.resize(sizeof(Header) + p_body_count * sizeof(BodyEntry<TBody>) + p_pair_count * sizeof(PairEntry<TPair>));
+			w = data.ptrw();
+
+			Header header;
+			header.magic = p_magic;
+			header.version = VERSION;
+			header.real_size = sizeof(real_t);
+			header.body_count = p_body_count;
+			header.pair_count = p_pair_count;
+			memcpy(w, &header, sizeof(Header));
+			w += sizeof(Header);
+		}
+	};
+
+	template <class TBody, class TPair>
+	class Reader {
+		const uint8_t *r = nullptr;
+		Header header;
+
+	public:
+		Error open(const PackedByteArray &p_data, uint32_t p_magic) {
+			ERR_FAIL_COND_V(p_data.size() < (int)sizeof(Header), ERR_INVALID_DATA);
+
+			r = p_data.ptr();
+			memcpy(&header, r, sizeof(Header));
+			r += sizeof(Header);
+
+			ERR_FAIL_COND_V_MSG(header.magic != p_magic, ERR_INVALID_DATA, "Invalid physics space state.");
+			ERR_FAIL_COND_V_MSG(header.version != VERSION || header.real_size != sizeof(real_t), ERR_INVALID_DATA, "Physics space state was saved by an incompatible build.");
+			uint64_t expected_size = sizeof(Header) + uint64_t(header.body_count) * sizeof(BodyEntry<TBody>) + uint64_t(header.pair_count) * sizeof(PairEntry<TPair>);
+			ERR_FAIL_COND_V(uint64_t(p_data.size()) != expected_size, ERR_INVALID_DATA);
+
+			return OK;
+		}
+
+		uint32_t get_body_count() const { return header.body_count; }
+		uint32_t get_pair_count() const { return header.pair_count; }
+
+		// Bodies must be read first, then the pairs.
+		void read_body(BodyEntry<TBody> &r_entry) {
+			memcpy(&r_entry, r, sizeof(BodyEntry<TBody>));
+			r += sizeof(BodyEntry<TBody>);
+		}
+
+		void read_pair(PairEntry<TPair> &r_entry) {
+			memcpy(&r_entry, r, sizeof(PairEntry<TPair>));
+			r += sizeof(PairEntry<TPair>);
+		}
+	};
+};
+
+#endif // PHYSICS_STATE_SNAPSHOT_H
@@ -34,6 +34,7 @@
 #include "core/math/a_star.h"
 #include "core/math/math_funcs.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
 
 #include <math.h>
 #include <stdio.h>
@@ -218,6 +219,72 @@ TEST_CASE("[AStar] Add/Remove") {
 	// It's been great work, cheers. \(^ ^)/
 }
 
+struct ConcurrentPaths {
+	AStar2D *astar = nullptr;
+	int size = 0;
+	int offset = 0;
+	Vector<Vector<int>> paths;
+
+	static void find_paths(void *p_userdata) {
+		ConcurrentPaths *self = static_cast<ConcurrentPaths *>(p_userdata);
+		const int count = self->size * self->size;
+		for (int i = 0; i < count; i++) {
+			self->paths.push_back(self->astar->get_id_path(i, (i * 7 + self->offset) % count));
+		}
+	}
+};
+
+TEST_CASE("[AStar2D] Concurrent paths") {
+	// A grid with walls, searched from several threads at once.
+	const int size = 16;
+	AStar2D a;
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			a.add_point(y * size + x, Vector2(x, y));
+			if (x > 0) {
+				a.connect_points(y * size + x, y * size + x - 1);
+			}
+			if (y > 0) {
+				a.connect_points(y * size + x, (y - 1) * size + x);
+			}
+			if (x == size / 2 && y != 0) {
+				a.set_point_disabled(y * size + x);
+			}
+		}
+	}
+
+	const int thread_count = 4;
+	ConcurrentPaths expected[thread_count];
+	ConcurrentPaths concurrent[thread_count];
+	Thread threads[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		expected[i].astar = &a;
+		expected[i].size = size;
+		expected[i].offset = i;
+		ConcurrentPaths::find_paths(&expected[i]);
+
+		concurrent[i].astar = &a;
+		concurrent[i].size = size;
+		concurrent[i].offset = i;
+	}
+
+	// Change the connections back and forth, so the threads also race to
+	// update the graph.
+	a.connect_points(0, size + 1);
+	a.disconnect_points(0, size + 1);
+
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].start(&ConcurrentPaths::find_paths, &concurrent[i]);
+	}
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].wait_to_finish();
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		CHECK(concurrent[i].paths == expected[i].paths);
+	}
+}
+
 TEST_CASE("[Stress][AStar] Find paths") {
 	// Random stress tests with Floyd-Warshall.
 	const int N = 30;
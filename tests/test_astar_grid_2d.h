@@ -0,0 +1,226 @@
+/*************************************************************************/
+/*  test_astar_grid_2d.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_ASTAR_GRID_2D_H
+#define TEST_ASTAR_GRID_2D_H
+
+#include "core/math/a_star_grid_2d.h"
+#include "core/math/math_funcs.h"
+
+#include "tests/test_macros.h"
+
+namespace TestAStarGrid2D {
+
+// Checks the path moves one cell at a time over walkable cells, without
+// cutting corners, and returns its length.
+static real_t path_length(AStarGrid2D &p_grid, const TypedArray<Vector2i> &p_path) {
+	real_t length = 0;
+	for (int i = 0; i < p_path.size(); i++) {
+		const Vector2i cell = p_path[i];
+		if (p_grid.is_point_solid(cell)) {
+			return -1;
+		}
+		if (i == 0) {
+			continue;
+		}
+		const Vector2i prev = p_path[i - 1];
+		const Vector2i step = cell - prev;
+		if (ABS(step.x) > 1 || ABS(step.y) > 1 || step == Vector2i()) {
+			return -1;
+		}
+		if (step.x != 0 && step.y != 0) {
+			if (p_grid.is_point_solid(Vector2i(cell.x, prev.y)) || p_grid.is_point_solid(Vector2i(prev.x, cell.y))) {
+				return -1;
+			}
+			length += Math_SQRT2;
+		} else {
+			length += 1;
+		}
+	}
+	return length;
+}
+
+TEST_CASE("[AStarGrid2D] Open grid") {
+	AStarGrid2D grid;
+	grid.set_size(Vector2i(5, 5));
+	grid.set_cell_size(Vector2(2, 3));
+
+	TypedArray<Vector2i> path = grid.get_id_path(Vector2i(0, 0), Vector2i(4, 4));
+	CHECK(path.size() == 5);
+	CHECK(Vector2i(path[0]) == Vector2i(0, 0));
+	CHECK(Vector2i(path[4]) == Vector2i(4, 4));
+	CHECK(Math::is_equal_approx(path_length(grid, path), real_t(4 * Math_SQRT2)));
+
+	path = grid.get_id_path(Vector2i(4, 1), Vector2i(0, 1));
+	CHECK(path.size() == 5);
+	CHECK(Math::is_equal_approx(path_length(grid, path), real_t(4)));
+
+	path = grid.get_id_path(Vector2i(2, 2), Vector2i(2, 2));
+	CHECK(path.size() == 1);
+
+	Vector<Vector2> points = grid.get_point_path(Vector2i(0, 0), Vector2i(2, 0));
+	CHECK(points.size() == 3);
+	CHECK(points[1] == Vector2(2, 0));
+	CHECK(points[2] == Vector2(4, 0));
+}
+
+TEST_CASE("[AStarGrid2D] Walls") {
+	AStarGrid2D grid;
+	grid.set_size(Vector2i(5, 5));
+
+	// A wall with a gap at the bottom.
+	for (int y = 0; y < 4; y++) {
+		grid.set_point_solid(Vector2i(2, y));
+	}
+	TypedArray<Vector2i> path = grid.get_id_path(Vector2i(0, 0), Vector2i(4, 0));
+	CHECK(path.size() > 0);
+	CHECK(Math::is_equal_approx(path_length(grid, path), real_t(8 + 2 * Math_SQRT2)));
+
+	// Closing the gap after the jump distances are built.
+	grid.set_point_solid(Vector2i(2, 4));
+	CHECK(grid.get_id_path(Vector2i(0, 0), Vector2i(4, 0)).size() == 0);
+	CHECK(grid.get_id_path(Vector2i(0, 0), Vector2i(2, 2)).size() == 0);
+
+	// Diagonal moves can't squeeze between two solid cells.
+	grid.set_point_solid(Vector2i(2, 4), false);
+	grid.set_point_solid(Vector2i(1, 4));
+	grid.set_point_solid(Vector2i(3, 3), false);
+	CHECK(grid.get_id_path(Vector2i(1, 3), Vector2i(3, 3)).size() == 0);
+	path = grid.get_id_path(Vector2i(3, 3), Vector2i(2, 4));
+	CHECK(Math::is_equal_approx(path_length(grid, path), real_t(2)));
+
+	// The same walls as packed data.
+	AStarGrid2D copy;
+	copy.set_size(grid.get_size());
+	copy.set_walkable_data(grid.get_walkable_data());
+	for (int y = 0; y < 5; y++) {
+		for (int x = 0; x < 5; x++) {
+			CHECK(copy.is_point_solid(Vector2i(x, y)) == grid.is_point_solid(Vector2i(x, y)));
+		}
+	}
+	CHECK(copy.get_id_path(Vector2i(3, 3), Vector2i(2, 4)).size() == path.size());
+}
+
+TEST_CASE("[Stress][AStarGrid2D] Find paths") {
+	// Random grids compared with Dijkstra over all the cells.
+	const int W = 16;
+	const int H = 12;
+	const int N = W * H;
+	Math::seed(0);
+
+	for (int test = 0; test < 200; test++) {
+		AStarGrid2D grid;
+		grid.set_size(Vector2i(W, H));
+		const int solid_percent = Math::rand() % 50;
+		for (int i = 0; i < N; i++) {
+			if (int(Math::rand() % 100) < solid_percent) {
+				grid.set_point_solid(Vector2i(i % W, i / W));
+			}
+		}
+		if (test % 2 == 1) {
+			// Build the jump distances first, then change a few cells.
+			grid.get_id_path(Vector2i(0, 0), Vector2i(W - 1, H - 1));
+			for (int i = 0; i < 10; i++) {
+				const Vector2i cell(Math::rand() % W, Math::rand() % H);
+				grid.set_point_solid(cell, !grid.is_point_solid(cell));
+			}
+		}
+
+		const int from = Math::rand() % N;
+		const Vector2i from_cell(from % W, from / W);
+
+		real_t d[N];
+		bool done[N] = { false };
+		for (int i = 0; i < N; i++) {
+			d[i] = FLT_MAX;
+		}
+		if (!grid.is_point_solid(from_cell)) {
+			d[from] = 0;
+		}
+		for (int iteration = 0; iteration < N; iteration++) {
+			int u = -1;
+			for (int i = 0; i < N; i++) {
+				if (!done[i] && d[i] < FLT_MAX && (u < 0 || d[i] < d[u])) {
+					u = i;
+				}
+			}
+			if (u < 0) {
+				break;
+			}
+			done[u] = true;
+			const Vector2i cell(u % W, u / W);
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					const Vector2i next(cell.x + dx, cell.y + dy);
+					if ((dx == 0 && dy == 0) || !grid.is_in_bounds(next) || grid.is_point_solid(next)) {
+						continue;
+					}
+					if (dx != 0 && dy != 0 && (grid.is_point_solid(Vector2i(next.x, cell.y)) || grid.is_point_solid(Vector2i(cell.x, next.y)))) {
+						continue;
+					}
+					const real_t cost = d[u] + (dx != 0 && dy != 0 ? Math_SQRT2 : 1);
+					const int v = next.y * W + next.x;
+					if (cost < d[v]) {
+						d[v] = cost;
+					}
+				}
+			}
+		}
+
+		bool match = true;
+		for (int to = 0; to < N; to++) {
+			const Vector2i to_cell(to % W, to / W);
+			TypedArray<Vector2i> path = grid.get_id_path(from_cell, to_cell);
+			if (d[to] == FLT_MAX) {
+				if (path.size() > 0) {
+					print_verbose(vformat("From %s to %s: found a nonexistent path\n", from_cell, to_cell));
+					match = false;
+					break;
+				}
+				continue;
+			}
+			if (path.size() == 0 || Vector2i(path[0]) != from_cell || Vector2i(path[path.size() - 1]) != to_cell) {
+				print_verbose(vformat("From %s to %s: path not found\n", from_cell, to_cell));
+				match = false;
+				break;
+			}
+			const real_t length = path_length(grid, path);
+			if (!Math::is_equal_approx(length, d[to])) {
+				print_verbose(vformat("From %s to %s: Dijkstra gives %.6f, JPS gives %.6f\n", from_cell, to_cell, d[to], length));
+				match = false;
+				break;
+			}
+		}
+		CHECK_MESSAGE(match, "Found all paths.");
+	}
+}
+} // namespace TestAStarGrid2D
+
+#endif // TEST_ASTAR_GRID_2D_H
@@ -0,0 +1,113 @@
+/*************************************************************************/
+/*  test_dir_watcher.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_DIR_WATCHER_H
+#define TEST_DIR_WATCHER_H
+
+#include "core/io/dir_access.h"
+#include "core/io/dir_watcher.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+
+#include "tests/test_macros.h"
+
+namespace TestDirWatcher {
+
+static void _write_file(const String &p_path) {
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE);
+	REQUIRE(f);
+	f->store_line("changed");
+}
+
+TEST_CASE("[DirWatcher] Directories with changes are reported") {
+	DirWatcher *watcher = DirWatcher::create();
+	if (!watcher) {
+		MESSAGE("Directory watching is not available on this platform.");
+		return;
+	}
+
+	const String root = OS::get_singleton()->get_cache_path().plus_file("dir_watcher");
+	const String sub = root.plus_file("sub");
+	const String other = root.plus_file("other");
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->make_dir_recursive(sub);
+	da->make_dir_recursive(other);
+
+	CHECK(watcher->add_dir(root) == OK);
+	CHECK(watcher->add_dir(sub) == OK);
+	CHECK(watcher->add_dir(other) == OK);
+	CHECK(watcher->is_watching(root));
+	CHECK_FALSE(watcher->is_watching(root.plus_file("missing")));
+	CHECK(watcher->add_dir(root.plus_file("missing")) != OK);
+
+	Set<String> changed;
+	CHECK(watcher->get_changes(changed));
+	CHECK(changed.is_empty());
+
+	SUBCASE("Files created or modified mark only their own directory") {
+		_write_file(sub.plus_file("file.txt"));
+
+		CHECK(watcher->get_changes(changed));
+		CHECK(changed.size() == 1);
+		CHECK(changed.has(sub));
+
+		changed.clear();
+		CHECK(watcher->get_changes(changed));
+		CHECK_MESSAGE(changed.is_empty(), "Changes should be reported only once.");
+
+		_write_file(sub.plus_file("file.txt"));
+		CHECK(watcher->get_changes(changed));
+		CHECK(changed.size() == 1);
+		CHECK(changed.has(sub));
+	}
+
+	SUBCASE("Removed directories are reported and no longer watched") {
+		CHECK(da->remove(other) == OK);
+
+		CHECK(watcher->get_changes(changed));
+		CHECK(changed.has(root));
+		CHECK(changed.has(other));
+		CHECK_FALSE(changed.has(sub));
+		CHECK_FALSE(watcher->is_watching(other));
+		CHECK(watcher->is_watching(sub));
+	}
+
+	memdelete(watcher);
+
+	da->remove(sub.plus_file("file.txt"));
+	da->remove(sub);
+	da->remove(other);
+	da->remove(root);
+}
+
+} // namespace TestDirWatcher
+
+#endif // TEST_DIR_WATCHER_H
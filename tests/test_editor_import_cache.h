@@ -0,0 +1,189 @@
+/*************************************************************************/
+/*  test_editor_import_cache.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_EDITOR_IMPORT_CACHE_H
+#define TEST_EDITOR_IMPORT_CACHE_H
+
+#ifdef TOOLS_ENABLED
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "editor/editor_import_cache.h"
+
+#include "tests/test_macros.h"
+
+namespace TestEditorImportCache {
+
+class CacheTestImporter : public ResourceImporter {
+public:
+	int format_version = 1;
+
+	virtual String get_importer_name() const override { return "cache_test"; }
+	virtual String get_visible_name() const override { return "Cache Test"; }
+	virtual void get_recognized_extensions(List<String> *p_extensions) const override { p_extensions->push_back("src"); }
+	virtual String get_save_extension() const override { return "res"; }
+	virtual String get_resource_type() const override { return "Resource"; }
+	virtual int get_format_version() const override { return format_version; }
+
+	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const override {
+		r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "scale"), 1));
+		r_options->push_back(ImportOption(PropertyInfo(Variant::STRING, "palette", PROPERTY_HINT_FILE, "*.pal"), ""));
+	}
+	virtual bool get_option_visibility(const String &p_option, const Map<StringName, Variant> &p_options) const override { return true; }
+
+	virtual Error import(const String &p_source_file, const String &p_save_path, const Map<StringName, Variant> &p_options, List<String> *r_platform_variants, List<String> *r_gen_files = nullptr, Variant *r_metadata = nullptr) override {
+		return ERR_UNAVAILABLE;
+	}
+};
+
+static void _write_file(const String &p_path, const String &p_contents) {
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE);
+	REQUIRE(f);
+	f->store_string(p_contents);
+}
+
+static String _read_file(const String &p_path) {
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f) {
+		return String();
+	}
+	return f->get_as_utf8_string();
+}
+
+TEST_CASE("[EditorImportCache] Keys change with everything that affects the import") {
+	const String palette_path = OS::get_singleton()->get_cache_path().plus_file("import_cache_test.pal");
+	_write_file(palette_path, "red");
+
+	Ref<CacheTestImporter> importer;
+	importer.instantiate();
+
+	List<ResourceImporter::ImportOption> options;
+	importer->get_import_options(&options);
+
+	Map<StringName, Variant> params;
+	params["scale"] = 1;
+	params["palette"] = palette_path;
+
+	const String key = EditorImportCache::get_key("res://a.src", "0123", importer, options, params);
+	CHECK(key == EditorImportCache::get_key("res://b.src", "0123", importer, options, params));
+
+	CHECK(key != EditorImportCache::get_key("res://a.src", "4567", importer, options, params));
+	CHECK_MESSAGE(key != EditorImportCache::get_key("res://a.other", "0123", importer, options, params), "The extension can change how the source is read.");
+
+	params["scale"] = 2;
+	CHECK(key != EditorImportCache::get_key("res://a.src", "0123", importer, options, params));
+	params["scale"] = 1;
+
+	importer->format_version = 2;
+	CHECK(key != EditorImportCache::get_key("res://a.src", "0123", importer, options, params));
+	importer->format_version = 1;
+
+	_write_file(palette_path, "green");
+	CHECK_MESSAGE(key != EditorImportCache::get_key("res://a.src", "0123", importer, options, params), "Files named by the options are part of the key.");
+
+	_write_file(palette_path, "red");
+	CHECK(key == EditorImportCache::get_key("res://a.src", "0123", importer, options, params));
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(palette_path);
+}
+
+TEST_CASE("[EditorImportCache] Stored imports are fetched by key") {
+	const String root = OS::get_singleton()->get_cache_path().plus_file("import_cache_test");
+	const String cache_path = root.plus_file("cache");
+	const String save_path = root.plus_file("project/a.src-0123");
+	const String other_save_path = root.plus_file("other/a.src-4567");
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->make_dir_recursive(save_path.get_base_dir());
+	da->make_dir_recursive(other_save_path.get_base_dir());
+
+	const String key = String("stored key").md5_text();
+	List<String> variants;
+	Variant metadata;
+
+	CHECK_MESSAGE(!EditorImportCache::fetch(cache_path, key, other_save_path, "res", &variants, &metadata), "Nothing should be found in an empty cache.");
+
+	SUBCASE("Single artifact") {
+		_write_file(save_path + ".res", "imported");
+		Dictionary stored_metadata;
+		stored_metadata["width"] = 16;
+		EditorImportCache::store(cache_path, key, save_path, "res", List<String>(), stored_metadata);
+
+		REQUIRE(EditorImportCache::fetch(cache_path, key, other_save_path, "res", &variants, &metadata));
+		CHECK(_read_file(other_save_path + ".res") == "imported");
+		CHECK(variants.is_empty());
+		CHECK(Dictionary(metadata)["width"] == Variant(16));
+
+		CHECK_MESSAGE(!EditorImportCache::fetch(cache_path, String("other key").md5_text(), other_save_path, "res", &variants, &metadata), "Other keys should miss.");
+
+		// Entries are never replaced, the first import of a key stays.
+		_write_file(save_path + ".res", "imported again");
+		EditorImportCache::store(cache_path, key, save_path, "res", List<String>(), stored_metadata);
+		REQUIRE(EditorImportCache::fetch(cache_path, key, other_save_path, "res", &variants, &metadata));
+		CHECK(_read_file(other_save_path + ".res") == "imported");
+	}
+
+	SUBCASE("Platform variants") {
+		List<String> stored_variants;
+		stored_variants.push_back("s3tc");
+		stored_variants.push_back("etc2");
+		_write_file(save_path + ".s3tc.res", "s3tc");
+		_write_file(save_path + ".etc2.res", "etc2");
+		EditorImportCache::store(cache_path, key, save_path, "res", stored_variants, Variant());
+
+		REQUIRE(EditorImportCache::fetch(cache_path, key, other_save_path, "res", &variants, &metadata));
+		CHECK(variants.size() == 2);
+		CHECK(variants.find("s3tc") != nullptr);
+		CHECK(variants.find("etc2") != nullptr);
+		CHECK(_read_file(other_save_path + ".s3tc.res") == "s3tc");
+		CHECK(_read_file(other_save_path + ".etc2.res") == "etc2");
+	}
+
+	SUBCASE("Incomplete entries miss") {
+		_write_file(save_path + ".res", "imported");
+		EditorImportCache::store(cache_path, key, save_path, "res", List<String>(), Variant());
+		da->remove(cache_path.plus_file(key.substr(0, 2)).plus_file(key).plus_file("artifact.res"));
+
+		CHECK(!EditorImportCache::fetch(cache_path, key, other_save_path, "res", &variants, &metadata));
+	}
+
+	if (da->change_dir(root) == OK) {
+		da->erase_contents_recursive();
+	}
+	da->remove(root);
+}
+
+} // namespace TestEditorImportCache
+
+#endif // TOOLS_ENABLED
+
+#endif // TEST_EDITOR_IMPORT_CACHE_H
@@ -32,6 +32,8 @@
 #define TEST_FILE_ACCESS_H
 
 #include "core/io/file_access.h"
+#include "core/io/file_access_async.h"
+#include "core/os/os.h"
 #include "test_utils.h"
 
 namespace TestFileAccess {
@@ -79,6 +81,79 @@ TEST_CASE("[FileAccess] CSV read") {
 
 	f->close();
 }
+
+static SafeNumeric<int> async_completed;
+
+static void _async_read_completed(void *p_userdata, FileAccessAsync::RequestID p_id, Error p_error) {
+	async_completed.increment();
+}
+
+TEST_CASE("[FileAccess] Asynchronous reads") {
+	FileAccessAsync *faa = FileAccessAsync::get_singleton();
+	REQUIRE(faa);
+
+	const String path = TestUtils::get_data_path("translations.csv");
+	Vector<uint8_t> expected = FileAccess::get_file_as_array(path);
+	REQUIRE(expected.size() > 16);
+
+	async_completed.set(0);
+	FileAccessAsync::RequestID whole = faa->read_request(path, 0, -1, _async_read_completed);
+	FileAccessAsync::RequestID part = faa->read_request(path, 4, 8, _async_read_completed);
+	FileAccessAsync::RequestID past_end = faa->read_request(path, expected.size() - 2, 100, _async_read_completed);
+	FileAccessAsync::RequestID missing = faa->read_request(TestUtils::get_data_path("missing_file.bin"), 0, -1, _async_read_completed);
+
+	CHECK(faa->wait(whole) == OK);
+	CHECK(faa->wait(part) == OK);
+	CHECK(faa->wait(past_end) == OK);
+	CHECK_MESSAGE(faa->wait(missing) != OK, "Reading a file that doesn't exist should fail.");
+
+	CHECK(faa->get_request_status(whole) == FileAccessAsync::REQUEST_STATUS_DONE);
+	CHECK(faa->get_request_status(missing) == FileAccessAsync::REQUEST_STATUS_ERROR);
+	CHECK_MESSAGE(faa->get_request_data(whole) == expected, "The whole file should be read.");
+	CHECK_MESSAGE(faa->get_request_data(part) == expected.subarray(4, 11), "Only the requested range should be read.");
+	CHECK_MESSAGE(faa->get_request_data(past_end).size() == 2, "Reads should stop at the end of the file.");
+
+	faa->erase_request(whole);
+	faa->erase_request(part);
+	faa->erase_request(past_end);
+	faa->erase_request(missing);
+	CHECK(faa->get_request_status(whole) == FileAccessAsync::REQUEST_STATUS_NONE);
+
+	// Callbacks may still be running right after the status changes, but not for long.
+	for (int i = 0; i < 1000 && async_completed.get() < 4; i++) {
+		OS::get_singleton()->delay_usec(1000);
+	}
+	CHECK(async_completed.get() == 4);
+}
+
+// Lets a test create its own reader, and put the global one back afterwards.
+class AsyncReaderSingleton : public FileAccessAsync {
+public:
+	static void set(FileAccessAsync *p_singleton) { singleton = p_singleton; }
+};
+
+TEST_CASE("[FileAccess] Destroying the asynchronous reader finishes or cancels its reads") {
+	FileAccessAsync *global = FileAccessAsync::get_singleton();
+	const String path = TestUtils::get_data_path("translations.csv");
+	const int count = 64;
+
+	// The native backend of the platform, and the worker pool.
+	for (int i = 0; i < 2; i++) {
+		AsyncReaderSingleton::set(nullptr);
+		FileAccessAsync *faa = i == 0 ? FileAccessAsync::create() : memnew(FileAccessAsync);
+		REQUIRE(faa);
+
+		async_completed.set(0);
+		for (int j = 0; j < count; j++) {
+			faa->read_request(path, 0, -1, _async_read_completed);
+		}
+		faa->prefetch(path);
+		memdelete(faa);
+		CHECK_MESSAGE(async_completed.get() == count, "Every read should be completed or cancelled before the reader is gone.");
+	}
+
+	AsyncReaderSingleton::set(global);
+}
 } // namespace TestFileAccess
 
 #endif // TEST_FILE_ACCESS_H
@@ -95,6 +95,43 @@ TEST_CASE("[LRU] Resize and clear") {
 	CHECK(!lru.has(3));
 	CHECK(!lru.has(4));
 }
+
+static int evicted_sum = 0;
+static void _count_evicted(int &p_key, int &p_value) {
+	evicted_sum += p_value;
+}
+
+TEST_CASE("[LRU] Erase and evict") {
+	LRUCache<int, int, _count_evicted> lru;
+	evicted_sum = 0;
+
+	lru.set_capacity(3);
+	lru.insert(1, 10);
+	lru.insert(2, 20);
+	lru.insert(3, 30);
+	CHECK(lru.get_size() == 3);
+
+	CHECK(lru.erase(2));
+	CHECK(!lru.erase(2));
+	CHECK(!lru.has(2));
+	CHECK(lru.get_size() == 2);
+	CHECK_MESSAGE(evicted_sum == 0, "Erasing should not count as an eviction.");
+
+	lru.get(1); // <3> is now the least recently used.
+	CHECK(lru.evict_least_recent());
+	CHECK(!lru.has(3));
+	CHECK(evicted_sum == 30);
+
+	lru.insert(4, 40);
+	lru.insert(5, 50);
+	lru.insert(6, 60); // Over capacity, evicts <1>.
+	CHECK(!lru.has(1));
+	CHECK(evicted_sum == 40);
+
+	lru.clear();
+	CHECK(!lru.evict_least_recent());
+	CHECK(evicted_sum == 40);
+}
 } // namespace TestLRU
 
 #endif // TEST_LRU_H
@@ -35,6 +35,7 @@
 #include "test_aabb.h"
 #include "test_array.h"
 #include "test_astar.h"
+#include "test_astar_grid_2d.h"
 #include "test_basis.h"
 #include "test_class_db.h"
 #include "test_color.h"
@@ -43,6 +44,8 @@
 #include "test_crypto.h"
 #include "test_curve.h"
 #include "test_dictionary.h"
+#include "test_dir_watcher.h"
+#include "test_editor_import_cache.h"
 #include "test_expression.h"
 #include "test_file_access.h"
 #include "test_geometry_2d.h"
@@ -0,0 +1,387 @@
+/*************************************************************************/
+/*  test_navigation_3d.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+#include "scene/resources/navigation_mesh.h"
+#include "servers/navigation_server_3d.h"
+
+#include "tests/test_macros.h"
+
+namespace TestNavigation3D {
+
+// A grid of triangles crossed by walls, each with a few doors.
+static Ref<NavigationMesh> _create_maze_navmesh(int p_size) {
+	const int wall_spacing = 50;
+	const int door_spacing = 40;
+
+	Vector<Vector3> vertices;
+	vertices.resize((p_size + 1) * (p_size + 1));
+	for (int z = 0; z <= p_size; z++) {
+		for (int x = 0; x <= p_size; x++) {
+			vertices.write[z * (p_size + 1) + x] = Vector3(x, 0, z);
+		}
+	}
+
+	Ref<NavigationMesh> navmesh;
+	navmesh.instantiate();
+	navmesh->set_vertices(vertices);
+	for (int z = 0; z < p_size; z++) {
+		for (int x = 0; x < p_size; x++) {
+			bool wall = (x % wall_spacing == wall_spacing / 2 && z % door_spacing != 0) || (z % wall_spacing == wall_spacing / 2 && x % door_spacing != 0);
+			if (wall) {
+				continue;
+			}
+
+			int i = z * (p_size + 1) + x;
+			Vector<int> first;
+			first.push_back(i);
+			first.push_back(i + p_size + 1);
+			first.push_back(i + 1);
+			navmesh->add_polygon(first);
+
+			Vector<int> second;
+			second.push_back(i + 1);
+			second.push_back(i + p_size + 1);
+			second.push_back(i + p_size + 2);
+			navmesh->add_polygon(second);
+		}
+	}
+
+	return navmesh;
+}
+
+static void test_path_benchmark() {
+	const float size = 300;
+	const int iterations = 100;
+
+	NavigationServer3D *server = NavigationServer3DManager::new_default_server();
+	ERR_FAIL_COND_MSG(!server, "No navigation server is available.");
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	server->map_set_cell_size(map, 0.25);
+
+	Ref<NavigationMesh> navmesh = _create_maze_navmesh(int(size));
+	RID region = server->region_create();
+	server->region_set_navmesh(region, navmesh);
+	server->region_set_map(region, map);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Navigation map: %d polygons, synced in %d usec.", navmesh->get_polygon_count(), elapsed));
+
+	RandomPCG rng(1234);
+	int path_points = 0;
+
+	// Paths from one side of the maze to the other.
+	PackedVector3Array origins;
+	PackedVector3Array destinations;
+	for (int i = 0; i < iterations; i++) {
+		origins.push_back(Vector3(rng.random(0.0f, 20.0f), 0, rng.random(0.0f, size)));
+		destinations.push_back(Vector3(rng.random(size - 20.0f, size), 0, rng.random(0.0f, size)));
+	}
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		path_points += server->map_get_path(map, origins[i], destinations[i], true).size();
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("map_get_path (long): %d usec per path, %d points in total.", elapsed / iterations, path_points));
+
+	// The same paths as a single batch, computed by the worker threads between two `process` calls.
+	path_points = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	RID query = server->map_query_paths(map, origins, destinations, true);
+	server->process(0.0);
+	server->process(0.0);
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	if (server->path_query_is_done(query)) {
+		Array paths = server->path_query_get_paths(query);
+		for (int i = 0; i < paths.size(); i++) {
+			path_points += PackedVector3Array(paths[i]).size();
+		}
+	}
+	server->free(query);
+	print_line(vformat("map_query_paths (long): %d usec per path, %d points in total.", elapsed / iterations, path_points));
+
+	path_points = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations * 10; i++) {
+		Vector3 from(rng.random(0.0f, size), 0, rng.random(0.0f, size));
+		Vector3 to = from + Vector3(rng.random(-10.0f, 10.0f), 0, rng.random(-10.0f, 10.0f));
+		path_points += server->map_get_path(map, from, to, true).size();
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("map_get_path (short): %d usec per path, %d points in total.", elapsed / (iterations * 10), path_points));
+
+	// The long paths again, planned over the clusters of polygons first.
+	server->map_set_use_hierarchical_paths(map, true);
+	begin = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Navigation map hierarchy built in %d usec.", elapsed));
+
+	path_points = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		path_points += server->map_get_path(map, origins[i], destinations[i], true).size();
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("map_get_path (long, hierarchical): %d usec per path, %d points in total.", elapsed / iterations, path_points));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations * 10; i++) {
+		server->map_get_closest_point(map, Vector3(rng.random(0.0f, size), rng.random(-1.0f, 1.0f), rng.random(0.0f, size)));
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("map_get_closest_point: %d usec per query.", elapsed / (iterations * 10)));
+
+	server->free(region);
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+static int _get_paths_point_count(NavigationServer3D *p_server, RID p_map, const PackedVector3Array &p_origins, const PackedVector3Array &p_destinations) {
+	int path_points = 0;
+	for (int i = 0; i < p_origins.size(); i++) {
+		path_points += p_server->map_get_path(p_map, p_origins[i], p_destinations[i], true).size();
+	}
+	return path_points;
+}
+
+static void test_streaming_benchmark() {
+	const int tiles = 6;
+	const int tile_size = 50;
+	const int iterations = 100;
+
+	NavigationServer3D *server = NavigationServer3DManager::new_default_server();
+	ERR_FAIL_COND_MSG(!server, "No navigation server is available.");
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	server->map_set_cell_size(map, 0.25);
+
+	// Neighbouring tiles share the vertices of their borders.
+	Ref<NavigationMesh> navmesh = _create_maze_navmesh(tile_size);
+	Vector<RID> regions;
+	for (int z = 0; z < tiles; z++) {
+		for (int x = 0; x < tiles; x++) {
+			RID region = server->region_create();
+			server->region_set_navmesh(region, navmesh);
+			server->region_set_transform(region, Transform3D(Basis(), Vector3(x * tile_size, 0, z * tile_size)));
+			server->region_set_map(region, map);
+			regions.push_back(region);
+		}
+	}
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Navigation map: %d tiles of %d polygons, synced in %d usec.", tiles * tiles, navmesh->get_polygon_count(), elapsed));
+
+	const float size = tiles * tile_size;
+	RandomPCG rng(1234);
+	PackedVector3Array origins;
+	PackedVector3Array destinations;
+	for (int i = 0; i < iterations; i++) {
+		origins.push_back(Vector3(rng.random(0.0f, 20.0f), 0, rng.random(0.0f, size)));
+		destinations.push_back(Vector3(rng.random(size - 20.0f, size), 0, rng.random(0.0f, size)));
+	}
+	const int path_points = _get_paths_point_count(server, map, origins, destinations);
+
+	// Stream a tile out and in again, only its neighbours are connected again.
+	const RID tile = regions[(tiles / 2) * tiles + tiles / 2];
+	server->region_set_map(tile, RID());
+	begin = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Tile removed, synced in %d usec, %d points in total.", elapsed, _get_paths_point_count(server, map, origins, destinations)));
+
+	server->region_set_map(tile, map);
+	begin = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	const int streamed_path_points = _get_paths_point_count(server, map, origins, destinations);
+	print_line(vformat("Tile added, synced in %d usec, %d points in total (%d before).", elapsed, streamed_path_points, path_points));
+
+	// Connecting all the regions again must give the same paths.
+	server->map_set_edge_connection_margin(map, server->map_get_edge_connection_margin(map));
+	begin = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("All regions connected again in %d usec, %d points in total.", elapsed, _get_paths_point_count(server, map, origins, destinations)));
+
+	for (int i = 0; i < regions.size(); i++) {
+		server->free(regions[i]);
+	}
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+static void test_crowd_benchmark() {
+	const int agent_count = 10000;
+	const int steps = 20;
+	const float size = 250.0;
+	const real_t delta = 1.0 / 60.0;
+
+	NavigationServer3D *server = NavigationServer3DManager::new_default_server();
+	ERR_FAIL_COND_MSG(!server, "No navigation server is available.");
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+
+	// Only controlled agents, the ones with a callback, are avoided. The
+	// receiver has no such method, so the callbacks do nothing.
+	Object *receiver = memnew(Object);
+
+	// Two crowds crossing each other.
+	RandomPCG rng(1234);
+	Vector<RID> agents;
+	Vector<Vector3> positions;
+	Vector<Vector3> velocities;
+	for (int i = 0; i < agent_count; i++) {
+		const Vector3 position(rng.random(0.0f, size), 0, rng.random(0.0f, size));
+		const Vector3 velocity = i % 2 ? Vector3(1.5, 0, 0) : Vector3(0, 0, -1.5);
+		RID agent = server->agent_create();
+		server->agent_set_map(agent, map);
+		server->agent_set_neighbor_dist(agent, 5.0);
+		server->agent_set_max_neighbors(agent, 10);
+		server->agent_set_time_horizon(agent, 2.0);
+		server->agent_set_radius(agent, 0.5);
+		server->agent_set_max_speed(agent, 2.0);
+		server->agent_set_position(agent, position);
+		server->agent_set_velocity(agent, velocity);
+		server->agent_set_target_velocity(agent, velocity);
+		server->agent_set_callback(agent, receiver, "_velocity_computed");
+		agents.push_back(agent);
+		positions.push_back(position);
+		velocities.push_back(velocity);
+	}
+	server->process(delta);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int s = 0; s < steps; s++) {
+		// The agents move between the steps, like the nodes would do.
+		for (int i = 0; i < agent_count; i++) {
+			positions.write[i] += velocities[i] * delta;
+			server->agent_set_position(agents[i], positions[i]);
+		}
+		server->process(delta);
+	}
+	const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Crowd of %d agents: %d steps in %d usec, %d usec per step.", agent_count, steps, elapsed, elapsed / steps));
+
+	for (int i = 0; i < agents.size(); i++) {
+		server->free(agents[i]);
+	}
+	server->free(map);
+	server->process(0.0);
+	memdelete(receiver);
+	memdelete(server);
+}
+
+static void test_flow_field_benchmark() {
+	const float size = 100;
+	const int units = 100;
+	const real_t step = 0.25;
+
+	NavigationServer3D *server = NavigationServer3DManager::new_default_server();
+	ERR_FAIL_COND_MSG(!server, "No navigation server is available.");
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	server->map_set_cell_size(map, 0.25);
+
+	Ref<NavigationMesh> navmesh = _create_maze_navmesh(int(size));
+	RID region = server->region_create();
+	server->region_set_navmesh(region, navmesh);
+	server->region_set_map(region, map);
+	server->process(0.0);
+
+	// All the units head to the same target, across the maze.
+	RandomPCG rng(1234);
+	PackedVector3Array positions;
+	for (int i = 0; i < units; i++) {
+		positions.push_back(Vector3(rng.random(0.0f, 20.0f), 0, rng.random(0.0f, size)));
+	}
+	PackedVector3Array targets;
+	targets.push_back(Vector3(size - 5.0, 0, size / 2.0));
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	int path_points = 0;
+	for (int i = 0; i < units; i++) {
+		path_points += server->map_get_path(map, positions[i], targets[0], true).size();
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("map_get_path: %d units in %d usec, %d points in total.", units, elapsed, path_points));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	server->map_get_flow_direction(map, targets, positions[0]);
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("map_get_flow_direction: %d polygons in %d usec.", navmesh->get_polygon_count(), elapsed));
+
+	// Walk the units along the flow field.
+	int arrived = 0;
+	int directions = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < units; i++) {
+		Vector3 position = positions[i];
+		for (int s = 0; s < size * 10; s++) {
+			const Vector3 direction = server->map_get_flow_direction(map, targets, position);
+			directions++;
+			if (direction == Vector3()) {
+				break;
+			}
+			position += direction * step;
+		}
+		if (position.distance_to(targets[0]) < 1.0) {
+			arrived++;
+		}
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("map_get_flow_direction: %d directions in %d usec, %d of %d units arrived.", directions, elapsed, arrived, units));
+
+	server->free(region);
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+REGISTER_TEST_COMMAND("navigation-3d-path-benchmark", &test_path_benchmark);
+REGISTER_TEST_COMMAND("navigation-3d-streaming-benchmark", &test_streaming_benchmark);
+REGISTER_TEST_COMMAND("navigation-3d-crowd-benchmark", &test_crowd_benchmark);
+REGISTER_TEST_COMMAND("navigation-3d-flow-field-benchmark", &test_flow_field_benchmark);
+
+} // namespace TestNavigation3D
@@ -30,16 +30,27 @@
 
 #include "test_physics_3d.h"
 
+#include "core/config/project_settings.h"
 #include "core/math/convex_hull.h"
 #include "core/math/math_funcs.h"
+#include "core/math/random_pcg.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
 #include "core/string/print_string.h"
 #include "core/templates/map.h"
+#include "core/templates/pair.h"
+#include "scene/resources/mesh.h"
 #include "servers/display_server.h"
+#include "servers/physics_3d/collision_solver_3d_sw.h"
+#include "servers/physics_3d/physics_server_3d_sw.h"
+#include "servers/physics_3d/sat_kernels_3d_sw.h"
+#include "servers/physics_3d/shape_3d_sw.h"
+#include "servers/physics_3d/soft_body_3d_sw.h"
 #include "servers/physics_server_3d.h"
 #include "servers/rendering_server.h"
 
+#include "tests/test_macros.h"
+
 class TestPhysics3DMainLoop : public MainLoop {
 	GDCLASS(TestPhysics3DMainLoop, MainLoop);
 
@@ -412,4 +423,951 @@ namespace TestPhysics3D {
 MainLoop *test() {
 	return memnew(TestPhysics3DMainLoop);
 }
+
+static Transform3D _random_transform(RandomPCG &p_rng) {
+	Basis basis(Vector3(p_rng.random(-Math_PI, Math_PI), p_rng.random(-Math_PI, Math_PI), p_rng.random(-Math_PI, Math_PI)));
+	basis.scale(Vector3(p_rng.random(0.5f, 2.0f), p_rng.random(0.5f, 2.0f), p_rng.random(0.5f, 2.0f)));
+	return Transform3D(basis, Vector3(p_rng.random(-4.0f, 4.0f), p_rng.random(-4.0f, 4.0f), p_rng.random(-4.0f, 4.0f)));
+}
+
+TEST_CASE("[Physics3D] SAT kernels match the scalar projection") {
+	const int batch = SATKernels3DSW::AXIS_BATCH;
+	RandomPCG rng(1234);
+
+	Vector<Vector3> points;
+	for (int i = 0; i < 24; i++) {
+		points.push_back(Vector3(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f)));
+	}
+
+	for (int test = 0; test < 64; test++) {
+		Transform3D xform = _random_transform(rng);
+		Vector3 half_extents(rng.random(0.1f, 2.0f), rng.random(0.1f, 2.0f), rng.random(0.1f, 2.0f));
+		real_t radius = rng.random(0.1f, 2.0f);
+		real_t height = rng.random(0.1f, 2.0f);
+
+		real_t axes_x[batch], axes_y[batch], axes_z[batch];
+		for (int i = 0; i < batch; i++) {
+			// Leave the last axis as zero, the padding value.
+			Vector3 axis = (i == batch - 1) ? Vector3() : Vector3(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f)).normalized();
+			axes_x[i] = axis.x;
+			axes_y[i] = axis.y;
+			axes_z[i] = axis.z;
+		}
+
+		real_t expected_min[3][batch], expected_max[3][batch];
+		SATKernels3DSW::set_level(SATKernels3DSW::LEVEL_SCALAR);
+		SATKernels3DSW::project_box(axes_x, axes_y, axes_z, batch, xform, half_extents, expected_min[0], expected_max[0]);
+		SATKernels3DSW::project_capsule(axes_x, axes_y, axes_z, batch, xform, radius, height, expected_min[1], expected_max[1]);
+		SATKernels3DSW::project_points(axes_x, axes_y, axes_z, batch, xform, points.ptr(), points.size(), expected_min[2], expected_max[2]);
+
+		for (int level = SATKernels3DSW::LEVEL_SCALAR + 1; level < SATKernels3DSW::LEVEL_MAX; level++) {
+			if (!SATKernels3DSW::is_level_supported(SATKernels3DSW::Level(level))) {
+				continue;
+			}
+			SATKernels3DSW::set_level(SATKernels3DSW::Level(level));
+
+			real_t min[3][batch], max[3][batch];
+			SATKernels3DSW::project_box(axes_x, axes_y, axes_z, batch, xform, half_extents, min[0], max[0]);
+			SATKernels3DSW::project_capsule(axes_x, axes_y, axes_z, batch, xform, radius, height, min[1], max[1]);
+			SATKernels3DSW::project_points(axes_x, axes_y, axes_z, batch, xform, points.ptr(), points.size(), min[2], max[2]);
+
+			for (int shape = 0; shape < 3; shape++) {
+				for (int i = 0; i < batch; i++) {
+					CHECK_MESSAGE(Math::is_equal_approx(min[shape][i], expected_min[shape][i], (real_t)1e-4), SATKernels3DSW::get_level_name(SATKernels3DSW::Level(level)), " kernel minimum should match the scalar one.");
+					CHECK_MESSAGE(Math::is_equal_approx(max[shape][i], expected_max[shape][i], (real_t)1e-4), SATKernels3DSW::get_level_name(SATKernels3DSW::Level(level)), " kernel maximum should match the scalar one.");
+				}
+			}
+		}
+	}
+
+	SATKernels3DSW::init();
+}
+
+static real_t _ccd_final_position(bool p_ccd, PhysicsServer3D::ShapeType p_shape_type, const Variant &p_shape_data) {
+	PhysicsServer3DSW *server = memnew(PhysicsServer3DSW(false));
+	server->init();
+
+	RID space = server->space_create();
+	server->space_set_active(space, true);
+	server->area_set_param(space, PhysicsServer3D::AREA_PARAM_GRAVITY, 0.0);
+
+	// A thin wall, much thinner than the distance travelled in a single step.
+	RID wall_shape = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(wall_shape, Vector3(0.05, 2, 2));
+	RID wall = server->body_create();
+	server->body_set_mode(wall, PhysicsServer3D::BODY_MODE_STATIC);
+	server->body_add_shape(wall, wall_shape);
+	server->body_set_state(wall, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(5, 0, 0)));
+	server->body_set_space(wall, space);
+
+	RID shape = server->shape_create(p_shape_type);
+	server->shape_set_data(shape, p_shape_data);
+	RID body = server->body_create();
+	server->body_add_shape(body, shape);
+	server->body_set_enable_continuous_collision_detection(body, p_ccd);
+	server->body_set_space(body, space);
+	server->body_set_state(body, PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY, Vector3(90, 0, 0));
+
+	for (int i = 0; i < 10; i++) {
+		server->step(1.0 / 30.0);
+	}
+
+	real_t position = Transform3D(server->body_get_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM)).origin.x;
+
+	server->free(body);
+	server->free(wall);
+	server->free(shape);
+	server->free(wall_shape);
+	server->free(space);
+	server->finish();
+	memdelete(server);
+
+	return position;
+}
+
+TEST_CASE("[Physics3D] Continuous collision detection stops fast bodies at thin walls") {
+	CHECK_MESSAGE(_ccd_final_position(false, PhysicsServer3D::SHAPE_SPHERE, 0.1) > 5.0, "Without CCD, the sphere should tunnel through the wall.");
+	CHECK_MESSAGE(_ccd_final_position(true, PhysicsServer3D::SHAPE_SPHERE, 0.1) < 5.0, "With CCD, the sphere should stop at the wall.");
+	CHECK_MESSAGE(_ccd_final_position(true, PhysicsServer3D::SHAPE_BOX, Vector3(0.1, 0.1, 0.1)) < 5.0, "With CCD, the box should stop at the wall.");
+}
+
+TEST_CASE("[Physics3D] Shape casts grazing past a shape do not hit it") {
+	SphereShape3DSW sphere;
+	sphere.set_data(0.5);
+	BoxShape3DSW box;
+	box.set_data(Vector3(0.5, 0.5, 0.5));
+
+	const Vector3 motion(10, 0, 0);
+	const real_t tolerance = 0.01;
+
+	// The sphere passes over the box, a bit more than the tolerance above it.
+	for (int i = 1; i <= 20; i++) {
+		const real_t gap = tolerance * (1.0 + i * 0.25);
+		const Transform3D sphere_xform(Basis(), Vector3(-5, 1 + gap, 0));
+
+		real_t toi = 0.0;
+		Vector3 normal;
+		CHECK_MESSAGE(!CollisionSolver3DSW::solve_toi(&sphere, sphere_xform, motion, &box, Transform3D(), tolerance, toi, normal), "The sphere should miss the box with a gap of ", gap, ".");
+	}
+
+	// Lowered into the box, the same cast hits its side.
+	real_t toi = 0.0;
+	Vector3 normal;
+	CHECK(CollisionSolver3DSW::solve_toi(&sphere, Transform3D(Basis(), Vector3(-5, 0.5, 0)), motion, &box, Transform3D(), tolerance, toi, normal));
+	CHECK(toi == doctest::Approx(0.4).epsilon(0.01));
+}
+
+TEST_CASE("[Physics3D] Speculative contacts keep stacks at rest and are not reported") {
+	ProjectSettings::get_singleton()->set_setting("physics/3d/use_speculative_contacts", true);
+
+	PhysicsServer3DSW *server = memnew(PhysicsServer3DSW(false));
+	server->init();
+
+	RID space = server->space_create();
+	server->space_set_active(space, true);
+
+	RID floor_shape = server->shape_create(PhysicsServer3D::SHAPE_PLANE);
+	server->shape_set_data(floor_shape, Plane(Vector3(0, 1, 0), 0));
+	RID floor = server->body_create();
+	server->body_set_mode(floor, PhysicsServer3D::BODY_MODE_STATIC);
+	server->body_add_shape(floor, floor_shape);
+	server->body_set_space(floor, space);
+
+	RID box_shape = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+	Vector<RID> boxes;
+	for (int i = 0; i < 3; i++) {
+		RID box = server->body_create();
+		server->body_add_shape(box, box_shape);
+		server->body_set_state(box, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, 0.5 + i, 0)));
+		server->body_set_state(box, PhysicsServer3D::BODY_STATE_CAN_SLEEP, false);
+		server->body_set_space(box, space);
+		boxes.push_back(box);
+	}
+	RID top = boxes[boxes.size() - 1];
+	server->body_set_max_contacts_reported(top, 4);
+
+	// Let the stack settle, then it must stay still.
+	for (int i = 0; i < 60; i++) {
+		server->step(1.0 / 60.0);
+	}
+	real_t max_speed = 0.0;
+	for (int i = 0; i < 120; i++) {
+		server->step(1.0 / 60.0);
+		for (int j = 0; j < boxes.size(); j++) {
+			max_speed = MAX(max_speed, Vector3(server->body_get_state(boxes[j], PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY)).length());
+		}
+	}
+	const Vector3 top_position = Transform3D(server->body_get_state(top, PhysicsServer3D::BODY_STATE_TRANSFORM)).origin;
+	CHECK_MESSAGE(max_speed < 0.1, "The stack should stay at rest.");
+	CHECK_MESSAGE(Math::abs(top_position.y - 2.5) < 0.05, "The stack should not sink.");
+	CHECK_MESSAGE(server->body_get_direct_state(top)->get_contact_count() > 0, "The top box should report its contacts.");
+
+	// Lifting the top box within the contact max separation leaves only speculative contacts.
+	server->body_set_state(top, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), top_position + Vector3(0, 0.03, 0)));
+	server->body_set_state(top, PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY, Vector3());
+	server->step(1.0 / 60.0);
+	CHECK_MESSAGE(server->body_get_direct_state(top)->get_contact_count() == 0, "Speculative contacts should not be reported.");
+
+	for (int i = 0; i < 60; i++) {
+		server->step(1.0 / 60.0);
+	}
+	CHECK_MESSAGE(server->body_get_direct_state(top)->get_contact_count() > 0, "The top box should report its contacts after landing again.");
+
+	for (int i = 0; i < boxes.size(); i++) {
+		server->free(boxes[i]);
+	}
+	server->free(box_shape);
+	server->free(floor);
+	server->free(floor_shape);
+	server->free(space);
+	server->finish();
+	memdelete(server);
+
+	ProjectSettings::get_singleton()->set_setting("physics/3d/use_speculative_contacts", false);
+}
+
+struct ContactFeatures {
+	Vector3 point;
+	int feature_A = 0;
+	int feature_B = 0;
+};
+
+static void _contact_features_result(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B, void *p_userdata) {
+	ContactFeatures contact;
+	contact.point = p_point_A;
+	contact.feature_A = p_index_A;
+	contact.feature_B = p_index_B;
+	((Vector<ContactFeatures> *)p_userdata)->push_back(contact);
+}
+
+static Vector<ContactFeatures> _collide_boxes(const BoxShape3DSW &p_box_A, const Transform3D &p_transform_A, const BoxShape3DSW &p_box_B, const Transform3D &p_transform_B) {
+	Vector<ContactFeatures> contacts;
+	CollisionSolver3DSW::solve_static(&p_box_A, p_transform_A, &p_box_B, p_transform_B, _contact_features_result, &contacts);
+	return contacts;
+}
+
+TEST_CASE("[Physics3D] Box contacts keep their features while the boxes move slightly") {
+	BoxShape3DSW small_box;
+	small_box.set_data(Vector3(0.5, 0.5, 0.5));
+	BoxShape3DSW large_box;
+	large_box.set_data(Vector3(2, 0.5, 2));
+
+	// The corners of the small box rest on the face of the large one, and the
+	// rotated boxes of the same size touch with edges crossing each other.
+	struct Case {
+		const BoxShape3DSW *box_A;
+		int contact_count;
+	};
+	const Case cases[2] = { { &small_box, 4 }, { &large_box, 8 } };
+
+	for (int i = 0; i < 2; i++) {
+		const Transform3D transform_A(Basis(Vector3(0, 1, 0), Math_PI * 0.125), Vector3(0, 0.99, 0));
+		const Transform3D transform_B;
+		const Vector<ContactFeatures> contacts = _collide_boxes(*cases[i].box_A, transform_A, large_box, transform_B);
+		REQUIRE(contacts.size() == cases[i].contact_count);
+
+		for (int j = 0; j < contacts.size(); j++) {
+			for (int k = j + 1; k < contacts.size(); k++) {
+				CHECK_MESSAGE((contacts[j].feature_A != contacts[k].feature_A || contacts[j].feature_B != contacts[k].feature_B), "Each contact should come from other features.");
+			}
+		}
+
+		const Transform3D moved_A(Basis(Vector3(0, 1, 0), Math_PI * 0.125 + 0.02), Vector3(0.01, 0.985, -0.01));
+		const Vector<ContactFeatures> moved_contacts = _collide_boxes(*cases[i].box_A, moved_A, large_box, transform_B);
+		REQUIRE(moved_contacts.size() == contacts.size());
+		for (int j = 0; j < contacts.size(); j++) {
+			int closest = -1;
+			for (int k = 0; k < moved_contacts.size(); k++) {
+				if (closest == -1 || moved_contacts[k].point.distance_to(contacts[j].point) < moved_contacts[closest].point.distance_to(contacts[j].point)) {
+					closest = k;
+				}
+			}
+			CHECK_MESSAGE(moved_contacts[closest].feature_A == contacts[j].feature_A, "The closest contact after moving should be on the same feature of A.");
+			CHECK_MESSAGE(moved_contacts[closest].feature_B == contacts[j].feature_B, "The closest contact after moving should be on the same feature of B.");
+		}
+	}
+}
+
+TEST_CASE("[Physics3D] Warm starting keeps tall stacks at rest") {
+	PhysicsServer3DSW *server = memnew(PhysicsServer3DSW(false));
+	server->init();
+
+	RID space = server->space_create();
+	server->space_set_active(space, true);
+
+	RID floor_shape = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(floor_shape, Vector3(10, 0.5, 10));
+	RID floor = server->body_create();
+	server->body_set_mode(floor, PhysicsServer3D::BODY_MODE_STATIC);
+	server->body_add_shape(floor, floor_shape);
+	server->body_set_state(floor, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, -0.5, 0)));
+	server->body_set_space(floor, space);
+
+	// The solver iterations alone can't hold the stack, it falls over unless
+	// the contacts keep their impulses from the previous steps.
+	RID box_shape = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+	const int box_count = 8;
+	Vector<RID> boxes;
+	for (int i = 0; i < box_count; i++) {
+		RID box = server->body_create();
+		server->body_add_shape(box, box_shape);
+		server->body_set_state(box, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, 0.5 + i, 0)));
+		server->body_set_state(box, PhysicsServer3D::BODY_STATE_CAN_SLEEP, false);
+		server->body_set_space(box, space);
+		boxes.push_back(box);
+	}
+
+	for (int i = 0; i < 120; i++) {
+		server->step(1.0 / 60.0);
+	}
+	real_t max_speed = 0.0;
+	for (int i = 0; i < 240; i++) {
+		server->step(1.0 / 60.0);
+		for (int j = 0; j < boxes.size(); j++) {
+			max_speed = MAX(max_speed, Vector3(server->body_get_state(boxes[j], PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY)).length());
+		}
+	}
+	const Vector3 top_position = Transform3D(server->body_get_state(boxes[box_count - 1], PhysicsServer3D::BODY_STATE_TRANSFORM)).origin;
+	CHECK_MESSAGE(max_speed < 0.1, "The stack should stay at rest.");
+	CHECK_MESSAGE(Math::abs(top_position.y - (box_count - 0.5)) < 0.1, "The stack should not sink.");
+	CHECK_MESSAGE(Vector2(top_position.x, top_position.z).length() < 0.05, "The stack should not drift.");
+
+	for (int i = 0; i < boxes.size(); i++) {
+		server->free(boxes[i]);
+	}
+	server->free(box_shape);
+	server->free(floor);
+	server->free(floor_shape);
+	server->free(space);
+	server->finish();
+	memdelete(server);
+}
+
+// Soft bodies only read the first surface, so a single indexed grid is all they need.
+class SoftBodyGridMesh : public Mesh {
+	Vector<Vector3> vertices;
+	Vector<int> indices;
+	AABB aabb;
+
+public:
+	virtual int get_surface_count() const override { return 1; }
+	virtual int surface_get_array_len(int p_idx) const override { return vertices.size(); }
+	virtual int surface_get_array_index_len(int p_idx) const override { return indices.size(); }
+	virtual Array surface_get_arrays(int p_surface) const override {
+		Array arrays;
+		arrays.resize(ARRAY_MAX);
+		arrays[ARRAY_VERTEX] = vertices;
+		arrays[ARRAY_INDEX] = indices;
+		return arrays;
+	}
+	virtual Array surface_get_blend_shape_arrays(int p_surface) const override { return Array(); }
+	virtual Dictionary surface_get_lods(int p_surface) const override { return Dictionary(); }
+	virtual uint32_t surface_get_format(int p_idx) const override { return ARRAY_FORMAT_VERTEX | ARRAY_FORMAT_INDEX; }
+	virtual PrimitiveType surface_get_primitive_type(int p_idx) const override { return PRIMITIVE_TRIANGLES; }
+	virtual void surface_set_material(int p_idx, const Ref<Material> &p_material) override {}
+	virtual Ref<Material> surface_get_material(int p_idx) const override { return Ref<Material>(); }
+	virtual int get_blend_shape_count() const override { return 0; }
+	virtual StringName get_blend_shape_name(int p_index) const override { return StringName(); }
+	virtual void set_blend_shape_name(int p_index, const StringName &p_name) override {}
+	virtual AABB get_aabb() const override { return aabb; }
+
+	// A horizontal square of p_cells x p_cells quads centered on p_center.
+	SoftBodyGridMesh(int p_cells, real_t p_size, const Vector3 &p_center) {
+		const int side = p_cells + 1;
+		const real_t cell_size = p_size / p_cells;
+		const Vector3 corner = p_center - Vector3(p_size * 0.5, 0, p_size * 0.5);
+		for (int z = 0; z < side; z++) {
+			for (int x = 0; x < side; x++) {
+				vertices.push_back(corner + Vector3(x * cell_size, 0, z * cell_size));
+			}
+		}
+		for (int z = 0; z < p_cells; z++) {
+			for (int x = 0; x < p_cells; x++) {
+				const int i = z * side + x;
+				indices.push_back(i);
+				indices.push_back(i + 1);
+				indices.push_back(i + side);
+				indices.push_back(i + 1);
+				indices.push_back(i + side + 1);
+				indices.push_back(i + side);
+			}
+		}
+		aabb = AABB(corner, Vector3(p_size, 0, p_size));
+	}
+};
+
+TEST_CASE("[Physics3D] Bodies woken by a soft body move in the same step") {
+	PhysicsServer3DSW *server = memnew(PhysicsServer3DSW(false));
+	server->init();
+
+	RID space = server->space_create();
+	server->space_set_active(space, true);
+
+	// A box asleep in mid-air, it only starts to move once the cloth falls onto it.
+	RID box_shape = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+	RID box = server->body_create();
+	server->body_add_shape(box, box_shape);
+	server->body_set_space(box, space);
+	server->body_set_state(box, PhysicsServer3D::BODY_STATE_SLEEPING, true);
+
+	RID cloth = server->soft_body_create();
+	server->soft_body_set_space(cloth, space);
+	server->soft_body_set_mesh(cloth, memnew(SoftBodyGridMesh(4, 2.0, Vector3(0, 1, 0))));
+
+	Vector3 position = Transform3D(server->body_get_state(box, PhysicsServer3D::BODY_STATE_TRANSFORM)).origin;
+	bool woken = false;
+	for (int i = 0; i < 60 && !woken; i++) {
+		server->step(1.0 / 60.0);
+
+		if (server->body_get_state(box, PhysicsServer3D::BODY_STATE_SLEEPING)) {
+			continue;
+		}
+		woken = true;
+
+		const Vector3 velocity = server->body_get_state(box, PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY);
+		const Vector3 new_position = Transform3D(server->body_get_state(box, PhysicsServer3D::BODY_STATE_TRANSFORM)).origin;
+		CHECK_MESSAGE(velocity.y < 0.0, "The cloth should push the box down.");
+		CHECK_MESSAGE(new_position.y < position.y, "The box should move in the step that woke it up.");
+	}
+	CHECK_MESSAGE(woken, "The cloth should wake the box up.");
+
+	server->free(cloth);
+	server->free(box);
+	server->free(box_shape);
+	server->free(space);
+	server->finish();
+	memdelete(server);
+}
+
+// A 61x61 cloth crumpled at random, so every link has something to correct.
+static SoftBody3DSW *_create_crumpled_cloth(Vector<Vector3> &r_positions) {
+	SoftBody3DSW *cloth = memnew(SoftBody3DSW);
+	cloth->set_mesh(memnew(SoftBodyGridMesh(60, 6.0, Vector3())));
+
+	RandomPCG rng(3);
+	r_positions.resize(cloth->get_node_count());
+	for (int i = 0; i < r_positions.size(); i++) {
+		r_positions.write[i] = cloth->get_node_position(i) + Vector3(rng.random(-0.05f, 0.05f), rng.random(-0.05f, 0.05f), rng.random(-0.05f, 0.05f));
+	}
+	return cloth;
+}
+
+TEST_CASE("[Physics3D] Colored soft body links match the scalar solver") {
+	Vector<Vector3> positions;
+	SoftBody3DSW *cloth = _create_crumpled_cloth(positions);
+	REQUIRE(positions.size() == 61 * 61);
+
+	// Links of a color share no node, so solving them in any order, several at once, gives the same result.
+	Vector<Vector3> colored;
+	cloth->solve_links_from(positions, true, nullptr, colored);
+	Vector<Vector3> scalar;
+	cloth->solve_links_from(positions, false, nullptr, scalar);
+
+	real_t max_correction = 0.0;
+	real_t max_error = 0.0;
+	for (int i = 0; i < positions.size(); i++) {
+		max_correction = MAX(max_correction, (scalar[i] - positions[i]).length());
+		max_error = MAX(max_error, (colored[i] - scalar[i]).length());
+	}
+	CHECK_MESSAGE(max_correction > 0.01, "The links should move the nodes.");
+	CHECK_MESSAGE(max_error < 1e-5, "The colored solver should match the scalar one.");
+
+	memdelete(cloth);
+}
+
+static Dictionary _random_heightmap_data(RandomPCG &p_rng, int p_width, int p_depth) {
+	PackedFloat32Array heights;
+	heights.resize(p_width * p_depth);
+	for (int z = 0; z < p_depth; z++) {
+		for (int x = 0; x < p_width; x++) {
+			// Rolling hills with some noise, so blocks have different ranges.
+			heights.write[z * p_width + x] = Math::sin(x * 0.05) * Math::cos(z * 0.07) * 8.0 + p_rng.random(-0.5f, 0.5f);
+		}
+	}
+
+	Dictionary d;
+	d["width"] = p_width;
+	d["depth"] = p_depth;
+	d["heights"] = heights;
+	return d;
+}
+
+static void _heightmap_cull_count(void *p_userdata, Shape3DSW *p_convex) {
+	Pair<AABB, int> *data = (Pair<AABB, int> *)p_userdata;
+	const FaceShape3DSW *face = static_cast<const FaceShape3DSW *>(p_convex);
+	AABB aabb(face->vertex[0], Vector3());
+	aabb.expand_to(face->vertex[1]);
+	aabb.expand_to(face->vertex[2]);
+	if (aabb.intersects_inclusive(data->first)) {
+		data->second++;
+	}
+}
+
+TEST_CASE("[Physics3D] Heightmap queries match a brute force search") {
+	const int width = 67;
+	const int depth = 53;
+	RandomPCG rng(4321);
+
+	Dictionary data = _random_heightmap_data(rng, width, depth);
+	PackedFloat32Array heights = data["heights"];
+	HeightMapShape3DSW shape;
+	shape.set_data(data);
+
+	Vector<Vector3> points;
+	points.resize(width * depth);
+	for (int z = 0; z < depth; z++) {
+		for (int x = 0; x < width; x++) {
+			points.write[z * width + x] = Vector3(x - 0.5 * (width - 1), heights[z * width + x], z - 0.5 * (depth - 1));
+		}
+	}
+
+	for (int test = 0; test < 200; test++) {
+		// Segments starting above the terrain, so the first hit is a front face.
+		Vector3 from(rng.random(-40.0f, 40.0f), rng.random(10.0f, 20.0f), rng.random(-30.0f, 30.0f));
+		Vector3 to(rng.random(-40.0f, 40.0f), rng.random(-20.0f, 5.0f), rng.random(-30.0f, 30.0f));
+
+		bool expected_hit = false;
+		Vector3 expected_point;
+		for (int z = 0; z < depth - 1; z++) {
+			for (int x = 0; x < width - 1; x++) {
+				const Vector3 &v00 = points[z * width + x];
+				const Vector3 &v10 = points[z * width + x + 1];
+				const Vector3 &v01 = points[(z + 1) * width + x];
+				const Vector3 &v11 = points[(z + 1) * width + x + 1];
+				Vector3 triangles[2][3] = { { v00, v10, v01 }, { v10, v11, v01 } };
+				for (int i = 0; i < 2; i++) {
+					Vector3 point;
+					if (Geometry3D::segment_intersects_triangle(from, to, triangles[i][0], triangles[i][1], triangles[i][2], &point)) {
+						if (!expected_hit || from.distance_to(point) < from.distance_to(expected_point)) {
+							expected_point = point;
+							expected_hit = true;
+						}
+					}
+				}
+			}
+		}
+
+		Vector3 point, normal;
+		bool hit = shape.intersect_segment(from, to, point, normal);
+		CHECK_MESSAGE(hit == expected_hit, "Segment hits should match the brute force search.");
+		if (hit && expected_hit) {
+			CHECK_MESSAGE(point.distance_to(expected_point) < 1e-3, "Segment hit points should match the brute force search.");
+		}
+	}
+
+	for (int test = 0; test < 100; test++) {
+		AABB query(Vector3(rng.random(-40.0f, 40.0f), rng.random(-10.0f, 10.0f), rng.random(-30.0f, 30.0f)), Vector3(rng.random(0.1f, 20.0f), rng.random(0.1f, 4.0f), rng.random(0.1f, 20.0f)));
+
+		int expected_count = 0;
+		for (int z = 0; z < depth - 1; z++) {
+			for (int x = 0; x < width - 1; x++) {
+				const Vector3 &v00 = points[z * width + x];
+				const Vector3 &v10 = points[z * width + x + 1];
+				const Vector3 &v01 = points[(z + 1) * width + x];
+				const Vector3 &v11 = points[(z + 1) * width + x + 1];
+				AABB first(v00, Vector3());
+				first.expand_to(v10);
+				first.expand_to(v01);
+				AABB second(v10, Vector3());
+				second.expand_to(v11);
+				second.expand_to(v01);
+				expected_count += first.intersects_inclusive(query) ? 1 : 0;
+				expected_count += second.intersects_inclusive(query) ? 1 : 0;
+			}
+		}
+
+		Pair<AABB, int> count(query, 0);
+		shape.cull(query, _heightmap_cull_count, &count);
+		CHECK_MESSAGE(count.second == expected_count, "Culling should report every face overlapping the query.");
+	}
+
+	for (int test = 0; test < 100; test++) {
+		Transform3D xform = _random_transform(rng);
+		Vector3 axis = Vector3(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f)).normalized();
+
+		real_t expected_min = 1e20;
+		real_t expected_max = -1e20;
+		for (int i = 0; i < points.size(); i++) {
+			real_t d = axis.dot(xform.xform(points[i]));
+			expected_min = MIN(expected_min, d);
+			expected_max = MAX(expected_max, d);
+		}
+
+		real_t min, max;
+		shape.project_range(axis, xform, min, max);
+		CHECK_MESSAGE(Math::is_equal_approx(min, expected_min, (real_t)1e-3), "Projection minimum should match the brute force search.");
+		CHECK_MESSAGE(Math::is_equal_approx(max, expected_max, (real_t)1e-3), "Projection maximum should match the brute force search.");
+
+		Vector3 support = shape.get_support(axis);
+		real_t expected_support = -1e20;
+		for (int i = 0; i < points.size(); i++) {
+			expected_support = MAX(expected_support, axis.dot(points[i]));
+		}
+		CHECK_MESSAGE(Math::is_equal_approx(axis.dot(support), expected_support, (real_t)1e-3), "Support point should be the farthest vertex.");
+	}
+}
+
+static void _sat_benchmark_result(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B, void *p_userdata) {
+	(*(int *)p_userdata)++;
+}
+
+static void test_sat_benchmark() {
+	const int iterations = 200000;
+
+	BoxShape3DSW box;
+	box.set_data(Vector3(0.5, 0.5, 0.5));
+
+	CapsuleShape3DSW capsule;
+	Dictionary capsule_data;
+	capsule_data["radius"] = 0.4;
+	capsule_data["height"] = 1.0;
+	capsule.set_data(capsule_data);
+
+	RandomPCG rng(1234);
+	Vector<Vector3> points;
+	for (int i = 0; i < 32; i++) {
+		points.push_back(Vector3(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f)).normalized() * 0.6);
+	}
+	ConvexPolygonShape3DSW convex;
+	convex.set_data(points);
+
+	struct ShapePair {
+		const char *name;
+		const Shape3DSW *shape_A;
+		const Shape3DSW *shape_B;
+	};
+
+	const ShapePair pairs[] = {
+		{ "box-box", &box, &box },
+		{ "box-capsule", &box, &capsule },
+		{ "capsule-capsule", &capsule, &capsule },
+		{ "convex-convex", &convex, &convex },
+	};
+
+	Transform3D transform_A;
+
+	for (int level = 0; level < SATKernels3DSW::LEVEL_MAX; level++) {
+		if (!SATKernels3DSW::is_level_supported(SATKernels3DSW::Level(level))) {
+			continue;
+		}
+		SATKernels3DSW::set_level(SATKernels3DSW::Level(level));
+
+		for (const ShapePair &pair : pairs) {
+			int contacts = 0;
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+			for (int i = 0; i < iterations; i++) {
+				// Overlapping, slowly rotating pair so all the axes get tested.
+				Transform3D transform_B(Basis(Vector3(0.3, 1.0, 0.2).normalized(), i * 0.001), Vector3(0.6, 0.4, 0.2));
+				CollisionSolver3DSW::solve_static(pair.shape_A, transform_A, pair.shape_B, transform_B, _sat_benchmark_result, &contacts);
+			}
+
+			uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+			print_line(vformat("%s %s: %d pairs in %d usec (%d contacts).", SATKernels3DSW::get_level_name(SATKernels3DSW::Level(level)), pair.name, iterations, elapsed, contacts));
+		}
+	}
+
+	SATKernels3DSW::init();
+}
+
+REGISTER_TEST_COMMAND("physics-3d-sat-benchmark", &test_sat_benchmark);
+
+static void test_query_benchmark() {
+	const int grid_size = 32;
+	const float grid_extent = grid_size;
+	const int ray_count = 4096;
+	const int motion_count = 1024;
+
+	PhysicsServer3DSW *server = memnew(PhysicsServer3DSW(false));
+	server->init();
+
+	RID space = server->space_create();
+	server->space_set_active(space, true);
+
+	RID box = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(box, Vector3(0.4, 0.4, 0.4));
+	RID sphere = server->shape_create(PhysicsServer3D::SHAPE_SPHERE);
+	server->shape_set_data(sphere, 0.25);
+
+	Vector<RID> bodies;
+	for (int x = 0; x < grid_size; x++) {
+		for (int z = 0; z < grid_size; z++) {
+			RID body = server->body_create();
+			server->body_set_mode(body, PhysicsServer3D::BODY_MODE_STATIC);
+			server->body_add_shape(body, box);
+			server->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(x, (x + z) % 3, z)));
+			server->body_set_space(body, space);
+			bodies.push_back(body);
+		}
+	}
+
+	server->step(1.0 / 60.0);
+	server->sync();
+
+	PhysicsDirectSpaceState3D *state = server->space_get_direct_state(space);
+
+	RandomPCG rng(1234);
+	Vector<Vector3> from;
+	Vector<Vector3> to;
+	for (int i = 0; i < ray_count; i++) {
+		Vector3 origin(rng.random(0.0f, grid_extent), 5.0, rng.random(0.0f, grid_extent));
+		from.push_back(origin);
+		to.push_back(origin + Vector3(rng.random(-2.0f, 2.0f), -10.0, rng.random(-2.0f, 2.0f)));
+	}
+
+	int hits = 0;
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < ray_count; i++) {
+		PhysicsDirectSpaceState3D::RayResult result;
+		if (state->intersect_ray(from[i], to[i], result)) {
+			hits++;
+		}
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("intersect_ray: %d rays in %d usec (%d hits).", ray_count, elapsed, hits));
+
+	Vector<PhysicsDirectSpaceState3D::RayResult> ray_results;
+	ray_results.resize(ray_count);
+	LocalVector<bool> ray_hits;
+	ray_hits.resize(ray_count);
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	hits = state->intersect_rays(from.ptr(), to.ptr(), ray_count, ray_results.ptrw(), ray_hits.ptr());
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("intersect_rays: %d rays in %d usec (%d hits).", ray_count, elapsed, hits));
+
+	Vector<Transform3D> xforms;
+	Vector<Vector3> motions;
+	for (int i = 0; i < motion_count; i++) {
+		xforms.push_back(Transform3D(Basis(), Vector3(rng.random(0.0f, grid_extent), 3.0, rng.random(0.0f, grid_extent))));
+		motions.push_back(Vector3(rng.random(-1.0f, 1.0f), -4.0, rng.random(-1.0f, 1.0f)));
+	}
+
+	real_t total_safe = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < motion_count; i++) {
+		real_t safe, unsafe;
+		state->cast_motion(sphere, xforms[i], motions[i], 0.0, safe, unsafe);
+		total_safe += safe;
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("cast_motion: %d motions in %d usec (safe sum %f).", motion_count, elapsed, total_safe));
+
+	LocalVector<real_t> closest_safe;
+	closest_safe.resize(motion_count);
+	LocalVector<real_t> closest_unsafe;
+	closest_unsafe.resize(motion_count);
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	state->cast_motions(sphere, xforms.ptr(), motions.ptr(), motion_count, 0.0, closest_safe.ptr(), closest_unsafe.ptr());
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	total_safe = 0;
+	for (int i = 0; i < motion_count; i++) {
+		total_safe += closest_safe[i];
+	}
+	print_line(vformat("cast_motions: %d motions in %d usec (safe sum %f).", motion_count, elapsed, total_safe));
+
+	server->end_sync();
+
+	for (int i = 0; i < bodies.size(); i++) {
+		server->free(bodies[i]);
+	}
+	server->free(box);
+	server->free(sphere);
+	server->free(space);
+	server->finish();
+	memdelete(server);
+}
+
+REGISTER_TEST_COMMAND("physics-3d-query-benchmark", &test_query_benchmark);
+
+static void test_snapshot_benchmark() {
+	const int body_count = 1000;
+	const int settle_frames = 60;
+	const int iterations = 100;
+
+	// Pairs need a stable order for the rollback to match.
+	Variant was_deterministic = GLOBAL_DEF("physics/3d/deterministic", false);
+	ProjectSettings::get_singleton()->set("physics/3d/deterministic", true);
+
+	PhysicsServer3DSW *server = memnew(PhysicsServer3DSW(false));
+	server->init();
+
+	RID space = server->space_create();
+	server->space_set_active(space, true);
+	server->area_set_param(space, PhysicsServer3D::AREA_PARAM_GRAVITY, 9.8);
+	server->area_set_param(space, PhysicsServer3D::AREA_PARAM_GRAVITY_VECTOR, Vector3(0, -1, 0));
+
+	RID floor_shape = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(floor_shape, Vector3(50, 1, 50));
+	RID floor = server->body_create();
+	server->body_set_mode(floor, PhysicsServer3D::BODY_MODE_STATIC);
+	server->body_add_shape(floor, floor_shape);
+	server->body_set_state(floor, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, -1, 0)));
+	server->body_set_space(floor, space);
+
+	RID box = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(box, Vector3(0.5, 0.5, 0.5));
+
+	Vector<RID> bodies;
+	for (int i = 0; i < body_count; i++) {
+		RID body = server->body_create();
+		server->body_add_shape(body, box);
+		server->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3((i % 10) * 1.1 - 5.0, 0.5 + (i / 100) * 1.1, ((i / 10) % 10) * 1.1 - 5.0)));
+		server->body_set_space(body, space);
+		bodies.push_back(body);
+	}
+
+	for (int i = 0; i < settle_frames; i++) {
+		server->step(1.0 / 60.0);
+	}
+
+	PackedByteArray state = server->space_save_state(space);
+	print_line(vformat("Space state: %d bodies, %d bytes.", body_count, state.size()));
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		state = server->space_save_state(space);
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("space_save_state: %d usec per save.", elapsed / iterations));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		server->space_restore_state(space, state);
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("space_restore_state: %d usec per restore.", elapsed / iterations));
+
+	// Step away from the saved state and roll back, the state should match again.
+	for (int i = 0; i < 10; i++) {
+		server->step(1.0 / 60.0);
+	}
+	server->space_restore_state(space, state);
+	print_line(vformat("Rollback matches the saved state: %s.", server->space_save_state(space) == state ? "yes" : "no"));
+
+	for (int i = 0; i < bodies.size(); i++) {
+		server->free(bodies[i]);
+	}
+	server->free(floor);
+	server->free(box);
+	server->free(floor_shape);
+	server->free(space);
+	server->finish();
+	memdelete(server);
+
+	ProjectSettings::get_singleton()->set("physics/3d/deterministic", was_deterministic);
+}
+
+REGISTER_TEST_COMMAND("physics-3d-snapshot-benchmark", &test_snapshot_benchmark);
+
+static void test_heightmap_benchmark() {
+	const int size = 4096;
+	const int iterations = 1000;
+	RandomPCG rng(1234);
+
+	HeightMapShape3DSW shape;
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	shape.set_data(_random_heightmap_data(rng, size, size));
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Heightmap %dx%d: set_data took %d usec.", size, size, elapsed));
+
+	const real_t extent = size * 0.5;
+
+	// Long rays crossing the whole terrain at a grazing angle.
+	int hits = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		Vector3 from(rng.random(-extent, extent), 12.0, -extent);
+		Vector3 to(rng.random(-extent, extent), -12.0, extent);
+		Vector3 point, normal;
+		hits += shape.intersect_segment(from, to, point, normal) ? 1 : 0;
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("intersect_segment: %d usec per ray, %d hits.", elapsed / iterations, hits));
+
+	// Large flat boxes above the terrain, most blocks are rejected by height.
+	Pair<AABB, int> count(AABB(), 0);
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		count.first = AABB(Vector3(rng.random(-extent, extent - 256), rng.random(-10.0f, 10.0f), rng.random(-extent, extent - 256)), Vector3(256, 1, 256));
+		shape.cull(count.first, _heightmap_cull_count, &count);
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("cull: %d usec per 256x256 query, %d faces.", elapsed / iterations, count.second));
+
+	real_t min = 0.0;
+	real_t max = 0.0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		shape.project_range(Vector3(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f)).normalized(), Transform3D(), min, max);
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("project_range: %d usec per projection.", elapsed / iterations));
+}
+
+REGISTER_TEST_COMMAND("physics-3d-heightmap-benchmark", &test_heightmap_benchmark);
+
+static void test_cloth_benchmark() {
+	const int iterations = 200;
+	const int frames = 120;
+
+	Vector<Vector3> positions;
+	SoftBody3DSW *cloth = _create_crumpled_cloth(positions);
+
+	Vector<Vector3> result;
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		cloth->solve_links_from(positions, false, nullptr, result);
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Scalar links: %d nodes in %d usec per iteration.", positions.size(), elapsed / iterations));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		cloth->solve_links_from(positions, true, nullptr, result);
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Colored links: %d nodes in %d usec per iteration.", positions.size(), elapsed / iterations));
+
+	memdelete(cloth);
+
+	// The whole step, with the cloth falling on a box.
+	PhysicsServer3DSW *server = memnew(PhysicsServer3DSW(false));
+	server->init();
+
+	RID space = server->space_create();
+	server->space_set_active(space, true);
+
+	RID box_shape = server->shape_create(PhysicsServer3D::SHAPE_BOX);
+	server->shape_set_data(box_shape, Vector3(1, 1, 1));
+	RID box = server->body_create();
+	server->body_set_mode(box, PhysicsServer3D::BODY_MODE_STATIC);
+	server->body_add_shape(box, box_shape);
+	server->body_set_space(box, space);
+
+	RID soft_body = server->soft_body_create();
+	server->soft_body_set_space(soft_body, space);
+	server->soft_body_set_mesh(soft_body, memnew(SoftBodyGridMesh(60, 6.0, Vector3(0, 2, 0))));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < frames; i++) {
+		server->step(1.0 / 60.0);
+	}
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Cloth step: %d usec per step.", elapsed / frames));
+
+	server->free(soft_body);
+	server->free(box);
+	server->free(box_shape);
+	server->free(space);
+	server->finish();
+	memdelete(server);
+}
+
+REGISTER_TEST_COMMAND("physics-3d-cloth-benchmark", &test_cloth_benchmark);
+
 } // namespace TestPhysics3D
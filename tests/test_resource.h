@@ -109,6 +109,51 @@ TEST_CASE("[Resource] Saving and loading") {
 			loaded_child_resource_text->get_name() == "I'm a child resource",
 			"The loaded child resource name should be equal to the expected value.");
 }
+
+TEST_CASE("[Resource] Cache retention budget") {
+	const String path_a = OS::get_singleton()->get_cache_path().plus_file("resource_retained_a.res");
+	const String path_b = OS::get_singleton()->get_cache_path().plus_file("resource_retained_b.res");
+	{
+		Ref<Resource> resource = memnew(Resource);
+		ResourceSaver::save(path_a, resource);
+		ResourceSaver::save(path_b, resource);
+	}
+
+	// Room for exactly one resource with the default cost estimate.
+	const Ref<Resource> probe = memnew(Resource);
+	ResourceCache::set_retention_budget(probe->get_cache_cost());
+
+	const uint64_t hits = ResourceCache::get_hit_count();
+	const uint64_t misses = ResourceCache::get_miss_count();
+	const uint64_t evictions = ResourceCache::get_eviction_count();
+
+	ResourceLoader::load(path_a);
+	CHECK_MESSAGE(
+			ResourceCache::get_miss_count() == misses + 1,
+			"The first load should be a cache miss.");
+	CHECK_MESSAGE(
+			ResourceCache::has(path_a),
+			"The resource should be kept alive after its last reference is released.");
+
+	ResourceLoader::load(path_a);
+	CHECK_MESSAGE(
+			ResourceCache::get_hit_count() == hits + 1,
+			"Loading a retained resource should be a cache hit.");
+
+	ResourceLoader::load(path_b);
+	CHECK_MESSAGE(
+			ResourceCache::get_eviction_count() == evictions + 1,
+			"Going over budget should evict the least recently used resource.");
+	CHECK(!ResourceCache::has(path_a));
+	CHECK(ResourceCache::has(path_b));
+	CHECK(ResourceCache::get_retained_memory() == probe->get_cache_cost());
+
+	ResourceCache::set_retention_budget(0);
+	CHECK_MESSAGE(
+			!ResourceCache::has(path_b),
+			"Disabling retention should release every retained resource.");
+	CHECK(ResourceCache::get_retained_memory() == 0);
+}
 } // namespace TestResource
 
 #endif // TEST_RESOURCE
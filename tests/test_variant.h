@@ -106,6 +106,29 @@ TEST_CASE("[Variant] Writer and parser float") {
 	CHECK_MESSAGE(b64_float_parsed == 340282001837565597733306976381245063168.0, "Should not overflow.");
 }
 
+TEST_CASE("[Variant] Parser strings longer than the readahead buffer") {
+	// Spans several readahead blocks, with escapes and newlines on both sides of the boundaries.
+	String long_str = String("abc\\\"def\nghi").repeat(1000);
+	String written;
+	VariantWriter::write_to_string(long_str, written);
+	written = "[" + written + ", 42]";
+
+	VariantParser::StreamString ss;
+	ss.s = written;
+	String errs;
+	int line = 1;
+	Variant parsed;
+	Error err = VariantParser::parse(&ss, parsed, errs, line);
+
+	CHECK_MESSAGE(err == OK, "Should parse without errors.");
+	REQUIRE(parsed.get_type() == Variant::ARRAY);
+	Array arr = parsed;
+	REQUIRE(arr.size() == 2);
+	CHECK_MESSAGE(String(arr[0]) == long_str, "Should parse back the same string.");
+	CHECK_MESSAGE(int(arr[1]) == 42, "Should keep parsing after the string.");
+	CHECK_MESSAGE(line == 1001, "Should count the newlines inside the string.");
+}
+
 TEST_CASE("[Variant] Assignment To Bool from Int,Float,String,Vec2,Vec2i,Vec3,Vec3i and Color") {
 	Variant int_v = 0;
 	Variant bool_v = true;